@@ -20,6 +20,7 @@ if (NOT PICO_BARE_METAL)
     pico_add_subdirectory(common/pico_binary_info)
     pico_add_subdirectory(common/pico_divider_headers)
     pico_add_subdirectory(common/pico_sync)
+    pico_add_subdirectory(common/pico_stdio_log)
     pico_add_subdirectory(common/pico_time)
     pico_add_subdirectory(common/pico_util)
     pico_add_subdirectory(common/pico_stdlib_headers)
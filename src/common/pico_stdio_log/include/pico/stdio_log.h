@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _PICO_STDIO_LOG_H
+#define _PICO_STDIO_LOG_H
+
+#include "pico.h"
+
+/** \file pico/stdio_log.h
+ * \defgroup pico_stdio_log pico_stdio_log
+ * \brief Deferred binary logging, where log messages are formatted on the host rather than on the device
+ *
+ * \ref PICO_LOG takes printf style arguments, but rather than formatting the message it records an ID for the format
+ * string, a timestamp and the raw argument values in a per-core ring buffer; this costs a few tens of cycles rather
+ * than the thousands needed to format the message. The format strings themselves are placed in a `pico_log_fmt` ELF
+ * section which is not loaded onto the device (similar to the way binary info records metadata in the ELF).
+ *
+ * The application drains the ring buffers with \ref stdio_log_read, and sends the resulting byte stream to the
+ * host in whatever way is convenient (a raw UART, a USB vendor interface, a memory dump...). The host tool
+ * `tools/pico_log_decode.py` then reconstructs the log text from the ELF and the captured stream:
+ *
+ *     tools/pico_log_decode.py app.elf capture.bin
+ *
+ * Each core has its own ring, so no lock is required between cores; a record is written with interrupts disabled
+ * on the current core, so PICO_LOG may be used from IRQ handlers. If there is no room for a record it is dropped
+ * (rather than blocking) and counted; the number of records dropped is also reported by the decoder.
+ *
+ * Notes:
+ * - float arguments are recorded as double, and integer arguments after the usual promotions (so a char takes a
+ *   whole word), so the argument types must match the conversions in the format as they would for printf
+ *   (the format is checked by the compiler as for printf)
+ * - %s is decoded by looking up the string in the ELF, so only works for strings (such as literals) which are part
+ *   of the binary image; other strings are shown by address
+ * - at most \ref PICO_STDIO_LOG_MAX_ARGS arguments may be passed
+ *
+ * \ingroup pico_stdio
+ */
+
+// PICO_CONFIG: PICO_STDIO_LOG_BUFFER_WORDS, Size of each core's log ring buffer in 32-bit words; must be a power of 2, type=int, default=256, min=16, group=pico_stdio_log
+#ifndef PICO_STDIO_LOG_BUFFER_WORDS
+#define PICO_STDIO_LOG_BUFFER_WORDS 256
+#endif
+
+// the maximum number of arguments to PICO_LOG (a 64-bit argument takes two words in the record, but counts as one)
+#define PICO_STDIO_LOG_MAX_ARGS 8
+
+// Each record is a sequence of little-endian 32-bit words:
+//
+//   header:    bits 31:24 PICO_STDIO_LOG_RECORD_MAGIC, bits 23:16 number of records dropped on this core since
+//              the previous record (saturating), bits 15:12 core number, bits 7:0 number of argument words
+//   format id: the offset of the format string within the pico_log_fmt section
+//   timestamp: time_us_32() when the record was written
+//   argument words
+#define PICO_STDIO_LOG_RECORD_MAGIC 0xa5u
+#define PICO_STDIO_LOG_RECORD_HEADER_WORDS 3u
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Write a log record
+ *  \ingroup pico_stdio_log
+ *
+ * This is called by \ref PICO_LOG, and is not generally called directly.
+ *
+ * \param fmt_id the ID of the format string (see \ref PICO_LOG)
+ * \param args the argument words
+ * \param arg_words the number of argument words
+ * \return true if the record was written, false if it was dropped because the ring buffer was full
+ */
+bool stdio_log_write(uint32_t fmt_id, const uint32_t *args, uint arg_words);
+
+/*! \brief Read whole log records from the ring buffers
+ *  \ingroup pico_stdio_log
+ *
+ * Records from the two cores are merged in timestamp order. This must only be called from one core/IRQ context
+ * at a time.
+ *
+ * \param buf the buffer to fill with the byte stream expected by `tools/pico_log_decode.py`
+ * \param len the size of buf in bytes; only whole records are copied
+ * \return the number of bytes copied to buf
+ */
+uint stdio_log_read(uint8_t *buf, uint len);
+
+/*! \brief Return the total number of log records which have been dropped because the ring buffer was full
+ *  \ingroup pico_stdio_log
+ */
+uint32_t stdio_log_get_dropped_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if !PICO_ON_DEVICE
+// On the host the section is loaded at an arbitrary address, so the format string ID is the offset from the start of
+// the section (as provided by the linker)
+extern const char __start_pico_log_fmt[];
+#define __pico_log_fmt_id(fmt) ((uint32_t)((fmt) - __start_pico_log_fmt))
+#else
+// On the device the linker script places the section at address 0 (and doesn't load it), so the address is the ID
+#define __pico_log_fmt_id(fmt) ((uint32_t)(uintptr_t)(fmt))
+#endif
+
+static inline uint __pico_log_put(uint32_t *words, uint n, const void *value, uint size) {
+    // zero pad values smaller than a word
+    words[n + (size - 1) / 4] = 0;
+    __builtin_memcpy(words + n, value, size);
+    return n + (size + 3) / 4;
+}
+
+// never called; lets the compiler check the arguments against the format
+static inline void __attribute__((format(printf, 1, 2))) __pico_log_check_format(__unused const char *fmt, ...) {}
+
+#ifndef __cplusplus
+// record an argument after the default argument promotions (x + 0 promotes small integer types, and decays arrays)
+#define __PICO_LOG_ARG(x) ({ \
+    __typeof__((x) + 0) __pico_log_value = (x); \
+    _Static_assert(sizeof(__pico_log_value) <= 8, "PICO_LOG arguments must be at most 64 bits"); \
+    if (_Generic(__pico_log_value, float: 1, default: 0)) { \
+        double __pico_log_double = _Generic(__pico_log_value, float: __pico_log_value, default: 0.0); \
+        __pico_log_n = __pico_log_put(__pico_log_words, __pico_log_n, &__pico_log_double, sizeof(double)); \
+    } else { \
+        __pico_log_n = __pico_log_put(__pico_log_words, __pico_log_n, &__pico_log_value, sizeof(__pico_log_value)); \
+    } \
+})
+#else
+static inline double __pico_log_promote(float f) { return f; }
+template<typename T> static inline T __pico_log_promote(T v) { return v; }
+#define __PICO_LOG_ARG(x) ({ \
+    auto __pico_log_value = __pico_log_promote(+(x)); \
+    static_assert(sizeof(__pico_log_value) <= 8, "PICO_LOG arguments must be at most 64 bits"); \
+    __pico_log_n = __pico_log_put(__pico_log_words, __pico_log_n, &__pico_log_value, sizeof(__pico_log_value)); \
+})
+#endif
+
+#define __PICO_LOG_ARGS_0()
+#define __PICO_LOG_ARGS_1(a) __PICO_LOG_ARG(a);
+#define __PICO_LOG_ARGS_2(a, ...) __PICO_LOG_ARG(a); __PICO_LOG_ARGS_1(__VA_ARGS__)
+#define __PICO_LOG_ARGS_3(a, ...) __PICO_LOG_ARG(a); __PICO_LOG_ARGS_2(__VA_ARGS__)
+#define __PICO_LOG_ARGS_4(a, ...) __PICO_LOG_ARG(a); __PICO_LOG_ARGS_3(__VA_ARGS__)
+#define __PICO_LOG_ARGS_5(a, ...) __PICO_LOG_ARG(a); __PICO_LOG_ARGS_4(__VA_ARGS__)
+#define __PICO_LOG_ARGS_6(a, ...) __PICO_LOG_ARG(a); __PICO_LOG_ARGS_5(__VA_ARGS__)
+#define __PICO_LOG_ARGS_7(a, ...) __PICO_LOG_ARG(a); __PICO_LOG_ARGS_6(__VA_ARGS__)
+#define __PICO_LOG_ARGS_8(a, ...) __PICO_LOG_ARG(a); __PICO_LOG_ARGS_7(__VA_ARGS__)
+#define __PICO_LOG_COUNT(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define __PICO_LOG_CONCAT1(a, b) a ## b
+#define __PICO_LOG_CONCAT(a, b) __PICO_LOG_CONCAT1(a, b)
+#define __PICO_LOG_ARGS_N(n) __PICO_LOG_CONCAT(__PICO_LOG_ARGS_, n)
+
+/*! \brief Record a log message, to be formatted on the host
+ *  \ingroup pico_stdio_log
+ *
+ * \param fmt the printf style format, which must be a string literal
+ * \param ... up to \ref PICO_STDIO_LOG_MAX_ARGS arguments
+ * \return true if the record was written, false if it was dropped because the ring buffer was full
+ */
+#define PICO_LOG(fmt, ...) ({ \
+    static const char __pico_log_fmt[] __attribute__((section("pico_log_fmt"), used)) = fmt; \
+    if (0) __pico_log_check_format(fmt, ##__VA_ARGS__); \
+    uint32_t __pico_log_words[PICO_STDIO_LOG_MAX_ARGS * 2]; \
+    uint __pico_log_n = 0; \
+    __PICO_LOG_ARGS_N(__PICO_LOG_COUNT(_, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0))(__VA_ARGS__) \
+    stdio_log_write(__pico_log_fmt_id(__pico_log_fmt), __pico_log_words, __pico_log_n); \
+})
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <string.h>
+#include "pico/stdio_log.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
+static_assert(PICO_STDIO_LOG_BUFFER_WORDS >= 16 && !(PICO_STDIO_LOG_BUFFER_WORDS & (PICO_STDIO_LOG_BUFFER_WORDS - 1)),
+              "PICO_STDIO_LOG_BUFFER_WORDS must be a power of 2");
+#define BUFFER_MASK (PICO_STDIO_LOG_BUFFER_WORDS - 1u)
+
+// Each ring has a single producer (its core, with interrupts disabled) and a single consumer (the caller of
+// stdio_log_read), so as for single-producer/single-consumer queues no lock is needed; head is only written by
+// the producer, and tail by the consumer. The indexes are free running, and masked when the buffer is accessed.
+typedef struct {
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropped;
+    uint32_t dropped_since_record;
+    uint32_t words[PICO_STDIO_LOG_BUFFER_WORDS];
+} stdio_log_ring_t;
+
+static stdio_log_ring_t rings[NUM_CORES];
+
+// make sure the section (and so __start_pico_log_fmt on the host) exists even if nothing is logged
+static const char stdio_log_fmt_base[] __attribute__((section("pico_log_fmt"), used)) = "";
+
+static inline uint32_t load_index(const uint32_t *index) {
+    return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+static inline void store_index(uint32_t *index, uint32_t value) {
+    __atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
+bool stdio_log_write(uint32_t fmt_id, const uint32_t *args, uint arg_words) {
+    uint core = get_core_num();
+    stdio_log_ring_t *ring = &rings[core];
+    bool written = false;
+    uint32_t save = save_and_disable_interrupts();
+    uint32_t head = ring->head;
+    if (PICO_STDIO_LOG_BUFFER_WORDS - (head - load_index(&ring->tail)) < PICO_STDIO_LOG_RECORD_HEADER_WORDS + arg_words) {
+        ring->dropped++;
+        ring->dropped_since_record++;
+    } else {
+        uint dropped = MIN(ring->dropped_since_record, 0xffu);
+        ring->words[head++ & BUFFER_MASK] = (PICO_STDIO_LOG_RECORD_MAGIC << 24) | (dropped << 16) | (core << 12) | arg_words;
+        ring->words[head++ & BUFFER_MASK] = fmt_id;
+        ring->words[head++ & BUFFER_MASK] = time_us_32();
+        for (uint i = 0; i < arg_words; i++) {
+            ring->words[head++ & BUFFER_MASK] = args[i];
+        }
+        ring->dropped_since_record = 0;
+        store_index(&ring->head, head);
+        written = true;
+    }
+    restore_interrupts(save);
+    return written;
+}
+
+uint stdio_log_read(uint8_t *buf, uint len) {
+    uint copied = 0;
+    while (true) {
+        // take the oldest record at the front of any ring
+        stdio_log_ring_t *oldest = NULL;
+        uint32_t oldest_time = 0;
+        for (uint core = 0; core < NUM_CORES; core++) {
+            stdio_log_ring_t *ring = &rings[core];
+            if (load_index(&ring->head) != ring->tail) {
+                uint32_t time = ring->words[(ring->tail + 2) & BUFFER_MASK];
+                if (!oldest || (int32_t)(time - oldest_time) < 0) {
+                    oldest = ring;
+                    oldest_time = time;
+                }
+            }
+        }
+        if (!oldest) break;
+        uint32_t tail = oldest->tail;
+        uint words = PICO_STDIO_LOG_RECORD_HEADER_WORDS + (oldest->words[tail & BUFFER_MASK] & 0xffu);
+        if (len - copied < words * 4) break;
+        for (uint i = 0; i < words; i++) {
+            // both the device and the host are little-endian
+            memcpy(buf + copied, &oldest->words[tail++ & BUFFER_MASK], 4);
+            copied += 4;
+        }
+        store_index(&oldest->tail, tail);
+    }
+    return copied;
+}
+
+uint32_t stdio_log_get_dropped_count(void) {
+    uint32_t dropped = 0;
+    for (uint core = 0; core < NUM_CORES; core++) {
+        dropped += rings[core].dropped;
+    }
+    return dropped;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _PICO_RWLOCK_H
+#define _PICO_RWLOCK_H
+
+#include "pico/lock_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file rwlock.h
+ *  \defgroup rwlock rwlock
+ *  \ingroup pico_sync
+ * \brief Reader-writer lock API for read-mostly data shared between cores
+ *
+ * A reader-writer lock may be held by any number of readers at once, or by a single writer. It suits data structures
+ * which are read far more often than they are modified (configuration or sensor tables for example), where a mutex
+ * would needlessly serialize the readers.
+ *
+ * Writers are preferred: once a writer is waiting for the lock, new readers wait too, so a steady stream of readers
+ * cannot starve a writer. As a consequence, the read lock must not be entered recursively (a deadlock will occur if
+ * a writer starts waiting in between), and neither lock may be entered by an owner who already holds the other.
+ *
+ * As with \ref mutex, it is generally a bad idea to call the blocking functions from within an IRQ handler. See
+ * \ref seqlock.h for data which must be read from IRQ handlers.
+ */
+
+/*! \brief reader-writer lock instance
+ * \ingroup rwlock
+ */
+typedef struct rwlock {
+    lock_core_t core;
+    lock_owner_id_t writer;     //! owner id of the writer, LOCK_INVALID_OWNER_ID if there is none
+    uint16_t readers;           //! number of readers holding the lock
+    uint16_t writers_waiting;   //! number of writers waiting for the lock
+} rwlock_t;
+
+/*! \brief  Initialise a reader-writer lock structure
+ *  \ingroup rwlock
+ *
+ * \param rw Pointer to reader-writer lock structure
+ */
+void rwlock_init(rwlock_t *rw);
+
+/*! \brief  Take a read lock, blocking if necessary
+ *  \ingroup rwlock
+ *
+ * This function will block until there is no writer holding or waiting for the lock.
+ *
+ * \param rw Pointer to reader-writer lock structure
+ */
+void rwlock_read_enter_blocking(rwlock_t *rw);
+
+/*! \brief Attempt to take a read lock without blocking
+ *  \ingroup rwlock
+ *
+ * \param rw Pointer to reader-writer lock structure
+ * \return true if the read lock was taken, false if a writer holds or is waiting for the lock
+ */
+bool rwlock_read_try_enter(rwlock_t *rw);
+
+/*! \brief Wait for a read lock with timeout
+ *  \ingroup rwlock
+ *
+ * \param rw Pointer to reader-writer lock structure
+ * \param timeout_ms The timeout in milliseconds.
+ * \return true if the read lock was taken, false if timeout occurred first
+ */
+bool rwlock_read_enter_timeout_ms(rwlock_t *rw, uint32_t timeout_ms);
+
+/*! \brief Wait for a read lock with timeout
+ *  \ingroup rwlock
+ *
+ * \param rw Pointer to reader-writer lock structure
+ * \param timeout_us The timeout in microseconds.
+ * \return true if the read lock was taken, false if timeout occurred first
+ */
+bool rwlock_read_enter_timeout_us(rwlock_t *rw, uint32_t timeout_us);
+
+/*! \brief Wait for a read lock until a specific time
+ *  \ingroup rwlock
+ *
+ * \param rw Pointer to reader-writer lock structure
+ * \param until The time after which to return if the read lock cannot be taken
+ * \return true if the read lock was taken, false if timeout occurred first
+ */
+bool rwlock_read_enter_block_until(rwlock_t *rw, absolute_time_t until);
+
+/*! \brief  Release a read lock
+ *  \ingroup rwlock
+ *
+ * \param rw Pointer to reader-writer lock structure
+ */
+void rwlock_read_exit(rwlock_t *rw);
+
+/*! \brief  Take the write lock, blocking if necessary
+ *  \ingroup rwlock
+ *
+ * This function will block until there are no readers and no other writer holding the lock.
+ *
+ * \param rw Pointer to reader-writer lock structure
+ */
+void rwlock_write_enter_blocking(rwlock_t *rw);
+
+/*! \brief Attempt to take the write lock without blocking
+ *  \ingroup rwlock
+ *
+ * \param rw Pointer to reader-writer lock structure
+ * \return true if the write lock was taken, false if a reader or writer holds the lock
+ */
+bool rwlock_write_try_enter(rwlock_t *rw);
+
+/*! \brief Wait for the write lock with timeout
+ *  \ingroup rwlock
+ *
+ * Whilst waiting, new readers are held off; they are released again if the timeout occurs.
+ *
+ * \param rw Pointer to reader-writer lock structure
+ * \param timeout_ms The timeout in milliseconds.
+ * \return true if the write lock was taken, false if timeout occurred first
+ */
+bool rwlock_write_enter_timeout_ms(rwlock_t *rw, uint32_t timeout_ms);
+
+/*! \brief Wait for the write lock with timeout
+ *  \ingroup rwlock
+ *
+ * Whilst waiting, new readers are held off; they are released again if the timeout occurs.
+ *
+ * \param rw Pointer to reader-writer lock structure
+ * \param timeout_us The timeout in microseconds.
+ * \return true if the write lock was taken, false if timeout occurred first
+ */
+bool rwlock_write_enter_timeout_us(rwlock_t *rw, uint32_t timeout_us);
+
+/*! \brief Wait for the write lock until a specific time
+ *  \ingroup rwlock
+ *
+ * Whilst waiting, new readers are held off; they are released again if the timeout occurs.
+ *
+ * \param rw Pointer to reader-writer lock structure
+ * \param until The time after which to return if the write lock cannot be taken
+ * \return true if the write lock was taken, false if timeout occurred first
+ */
+bool rwlock_write_enter_block_until(rwlock_t *rw, absolute_time_t until);
+
+/*! \brief  Release the write lock
+ *  \ingroup rwlock
+ *
+ * \param rw Pointer to reader-writer lock structure
+ */
+void rwlock_write_exit(rwlock_t *rw);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
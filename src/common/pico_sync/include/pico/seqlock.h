@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _PICO_SEQLOCK_H
+#define _PICO_SEQLOCK_H
+
+#include "pico/lock_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file seqlock.h
+ *  \defgroup seqlock seqlock
+ *  \ingroup pico_sync
+ * \brief Sequence lock API for small snapshots which are read without blocking
+ *
+ * A sequence lock protects a small plain data structure (a set of sensor readings for example) which is written
+ * occasionally and read often, including from IRQ handlers. Readers never block the writer and never take a lock;
+ * instead a reader copies the data and retries if a write happened during the copy.
+ *
+ * The lock holds a sequence number which is odd whilst a write is in progress. A write is made with the sequence
+ * lock's spin lock held and interrupts disabled, so a reader in an IRQ handler can never interrupt a write on its
+ * own core (and so spin forever); a reader on the other core only retries for as long as the write takes. The
+ * protected data should therefore be small, and must not contain pointers that a reader follows, as they may be
+ * inconsistent until the read is validated.
+ *
+ * \ref seqlock_read and \ref seqlock_write copy a whole snapshot; \ref seqlock_read_begin, \ref seqlock_read_retry,
+ * \ref seqlock_write_begin and \ref seqlock_write_end may be used directly to read or update it in place:
+ *
+ * \code
+ * uint32_t seq;
+ * do {
+ *     seq = seqlock_read_begin(&lock);
+ *     x = readings.x;
+ *     y = readings.y;
+ * } while (seqlock_read_retry(&lock, seq));
+ * \endcode
+ */
+
+/*! \brief sequence lock instance
+ * \ingroup seqlock
+ */
+typedef struct seqlock {
+    lock_core_t core;           //! spin lock serializing writers
+    volatile uint32_t sequence; //! odd whilst a write is in progress
+} seqlock_t;
+
+/*! \brief  Initialise a sequence lock structure
+ *  \ingroup seqlock
+ *
+ * \param sl Pointer to sequence lock structure
+ */
+void seqlock_init(seqlock_t *sl);
+
+/*! \brief  Start reading data protected by a sequence lock
+ *  \ingroup seqlock
+ *
+ * This waits for any write in progress (on the other core) to complete.
+ *
+ * \param sl Pointer to sequence lock structure
+ * \return the sequence number, to pass to \ref seqlock_read_retry
+ */
+static inline uint32_t seqlock_read_begin(const seqlock_t *sl) {
+    uint32_t seq;
+    while ((seq = sl->sequence) & 1u) {
+        tight_loop_contents();
+    }
+    __mem_fence_acquire();
+    return seq;
+}
+
+/*! \brief  Finish reading data protected by a sequence lock
+ *  \ingroup seqlock
+ *
+ * \param sl Pointer to sequence lock structure
+ * \param seq The sequence number returned by \ref seqlock_read_begin
+ * \return true if the data was written during the read, so the read must be retried
+ */
+static inline bool seqlock_read_retry(const seqlock_t *sl, uint32_t seq) {
+    __mem_fence_acquire();
+    return sl->sequence != seq;
+}
+
+/*! \brief  Start writing data protected by a sequence lock
+ *  \ingroup seqlock
+ *
+ * This disables interrupts on the calling core until \ref seqlock_write_end is called
+ *
+ * \param sl Pointer to sequence lock structure
+ * \return the saved interrupt state, to pass to \ref seqlock_write_end
+ */
+static inline uint32_t seqlock_write_begin(seqlock_t *sl) {
+    uint32_t save = spin_lock_blocking(sl->core.spin_lock);
+    sl->sequence = sl->sequence + 1;
+    __mem_fence_release();
+    return save;
+}
+
+/*! \brief  Finish writing data protected by a sequence lock
+ *  \ingroup seqlock
+ *
+ * \param sl Pointer to sequence lock structure
+ * \param save The interrupt state returned by \ref seqlock_write_begin
+ */
+static inline void seqlock_write_end(seqlock_t *sl, uint32_t save) {
+    __mem_fence_release();
+    sl->sequence = sl->sequence + 1;
+    spin_unlock(sl->core.spin_lock, save);
+}
+
+/*! \brief  Take a consistent snapshot of data protected by a sequence lock
+ *  \ingroup seqlock
+ *
+ * This may be called from an IRQ handler.
+ *
+ * \param sl Pointer to sequence lock structure
+ * \param dst The buffer to copy the snapshot into
+ * \param src The protected data
+ * \param size The size of the protected data
+ * \return the number of times the copy was retried because of a concurrent write
+ */
+uint seqlock_read(const seqlock_t *sl, void *dst, const void *src, size_t size);
+
+/*! \brief  Update data protected by a sequence lock
+ *  \ingroup seqlock
+ *
+ * \param sl Pointer to sequence lock structure
+ * \param dst The protected data
+ * \param src The new value of the data
+ * \param size The size of the protected data
+ */
+void seqlock_write(seqlock_t *sl, void *dst, const void *src, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
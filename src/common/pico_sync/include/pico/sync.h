@@ -15,5 +15,7 @@
 #include "pico/sem.h"
 #include "pico/mutex.h"
 #include "pico/critical_section.h"
+#include "pico/rwlock.h"
+#include "pico/seqlock.h"
 
 #endif
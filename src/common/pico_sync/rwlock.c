@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "pico/rwlock.h"
+#include "pico/time.h"
+
+void rwlock_init(rwlock_t *rw) {
+    lock_init(&rw->core, next_striped_spin_lock_num());
+    rw->writer = LOCK_INVALID_OWNER_ID;
+    rw->readers = 0;
+    rw->writers_waiting = 0;
+    __mem_fence_release();
+}
+
+// must be called with the spin lock held
+static inline bool can_read(rwlock_t *rw) {
+    return !lock_is_owner_id_valid(rw->writer) && !rw->writers_waiting;
+}
+
+// must be called with the spin lock held
+static inline bool can_write(rwlock_t *rw) {
+    return !lock_is_owner_id_valid(rw->writer) && !rw->readers;
+}
+
+void __time_critical_func(rwlock_read_enter_blocking)(rwlock_t *rw) {
+    do {
+        uint32_t save = spin_lock_blocking(rw->core.spin_lock);
+        if (can_read(rw)) {
+            uint __unused total = ++rw->readers;
+            spin_unlock(rw->core.spin_lock, save);
+            assert(total); // check for overflow
+            break;
+        }
+        lock_internal_spin_unlock_with_wait(&rw->core, save);
+    } while (true);
+}
+
+bool __time_critical_func(rwlock_read_try_enter)(rwlock_t *rw) {
+    bool entered;
+    uint32_t save = spin_lock_blocking(rw->core.spin_lock);
+    if (can_read(rw)) {
+        uint __unused total = ++rw->readers;
+        assert(total); // check for overflow
+        entered = true;
+    } else {
+        entered = false;
+    }
+    spin_unlock(rw->core.spin_lock, save);
+    return entered;
+}
+
+bool __time_critical_func(rwlock_read_enter_timeout_ms)(rwlock_t *rw, uint32_t timeout_ms) {
+    return rwlock_read_enter_block_until(rw, make_timeout_time_ms(timeout_ms));
+}
+
+bool __time_critical_func(rwlock_read_enter_timeout_us)(rwlock_t *rw, uint32_t timeout_us) {
+    return rwlock_read_enter_block_until(rw, make_timeout_time_us(timeout_us));
+}
+
+bool __time_critical_func(rwlock_read_enter_block_until)(rwlock_t *rw, absolute_time_t until) {
+    assert(rw->core.spin_lock);
+    do {
+        uint32_t save = spin_lock_blocking(rw->core.spin_lock);
+        if (can_read(rw)) {
+            uint __unused total = ++rw->readers;
+            spin_unlock(rw->core.spin_lock, save);
+            assert(total); // check for overflow
+            return true;
+        }
+        if (lock_internal_spin_unlock_with_best_effort_wait_or_timeout(&rw->core, save, until)) {
+            // timed out
+            return false;
+        }
+        // not timed out; spin lock already unlocked, so loop again
+    } while (true);
+}
+
+void __time_critical_func(rwlock_read_exit)(rwlock_t *rw) {
+    uint32_t save = spin_lock_blocking(rw->core.spin_lock);
+    assert(rw->readers);
+    if (!--rw->readers) {
+        // a writer may be waiting for the last reader
+        lock_internal_spin_unlock_with_notify(&rw->core, save);
+    } else {
+        spin_unlock(rw->core.spin_lock, save);
+    }
+}
+
+void __time_critical_func(rwlock_write_enter_blocking)(rwlock_t *rw) {
+    lock_owner_id_t caller = lock_get_caller_owner_id();
+    bool waiting = false;
+    do {
+        uint32_t save = spin_lock_blocking(rw->core.spin_lock);
+        if (can_write(rw)) {
+            rw->writer = caller;
+            if (waiting) rw->writers_waiting--;
+            spin_unlock(rw->core.spin_lock, save);
+            break;
+        }
+        if (!waiting) {
+            // hold off new readers until we have the lock
+            rw->writers_waiting++;
+            waiting = true;
+        }
+        lock_internal_spin_unlock_with_wait(&rw->core, save);
+    } while (true);
+}
+
+bool __time_critical_func(rwlock_write_try_enter)(rwlock_t *rw) {
+    bool entered;
+    uint32_t save = spin_lock_blocking(rw->core.spin_lock);
+    if (can_write(rw)) {
+        rw->writer = lock_get_caller_owner_id();
+        entered = true;
+    } else {
+        entered = false;
+    }
+    spin_unlock(rw->core.spin_lock, save);
+    return entered;
+}
+
+bool __time_critical_func(rwlock_write_enter_timeout_ms)(rwlock_t *rw, uint32_t timeout_ms) {
+    return rwlock_write_enter_block_until(rw, make_timeout_time_ms(timeout_ms));
+}
+
+bool __time_critical_func(rwlock_write_enter_timeout_us)(rwlock_t *rw, uint32_t timeout_us) {
+    return rwlock_write_enter_block_until(rw, make_timeout_time_us(timeout_us));
+}
+
+bool __time_critical_func(rwlock_write_enter_block_until)(rwlock_t *rw, absolute_time_t until) {
+    assert(rw->core.spin_lock);
+    lock_owner_id_t caller = lock_get_caller_owner_id();
+    bool waiting = false;
+    do {
+        uint32_t save = spin_lock_blocking(rw->core.spin_lock);
+        if (can_write(rw)) {
+            rw->writer = caller;
+            if (waiting) rw->writers_waiting--;
+            spin_unlock(rw->core.spin_lock, save);
+            return true;
+        }
+        if (!waiting) {
+            // hold off new readers until we have the lock
+            rw->writers_waiting++;
+            waiting = true;
+        }
+        if (lock_internal_spin_unlock_with_best_effort_wait_or_timeout(&rw->core, save, until)) {
+            // timed out; stop holding off readers, and wake any that are waiting
+            save = spin_lock_blocking(rw->core.spin_lock);
+            rw->writers_waiting--;
+            lock_internal_spin_unlock_with_notify(&rw->core, save);
+            return false;
+        }
+        // not timed out; spin lock already unlocked, so loop again
+    } while (true);
+}
+
+void __time_critical_func(rwlock_write_exit)(rwlock_t *rw) {
+    uint32_t save = spin_lock_blocking(rw->core.spin_lock);
+    assert(lock_is_owner_id_valid(rw->writer));
+    rw->writer = LOCK_INVALID_OWNER_ID;
+    lock_internal_spin_unlock_with_notify(&rw->core, save);
+}
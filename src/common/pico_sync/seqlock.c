@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <string.h>
+#include "pico/seqlock.h"
+
+void seqlock_init(seqlock_t *sl) {
+    lock_init(&sl->core, next_striped_spin_lock_num());
+    sl->sequence = 0;
+    __mem_fence_release();
+}
+
+uint __time_critical_func(seqlock_read)(const seqlock_t *sl, void *dst, const void *src, size_t size) {
+    uint retries = 0;
+    uint32_t seq = seqlock_read_begin(sl);
+    memcpy(dst, src, size);
+    while (seqlock_read_retry(sl, seq)) {
+        retries++;
+        seq = seqlock_read_begin(sl);
+        memcpy(dst, src, size);
+    }
+    return retries;
+}
+
+void __time_critical_func(seqlock_write)(seqlock_t *sl, void *dst, const void *src, size_t size) {
+    uint32_t save = seqlock_write_begin(sl);
+    memcpy(dst, src, size);
+    seqlock_write_end(sl, save);
+}
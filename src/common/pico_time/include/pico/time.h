@@ -350,6 +350,20 @@ bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp);
 #define PICO_TIME_DEFAULT_ALARM_POOL_MAX_TIMERS 16
 #endif
 
+// PICO_CONFIG: PICO_TIME_TIMER_WHEEL_LEVELS, Number of 64 slot levels in the hierarchical timing wheel of timer wheel alarm pools, min=1, max=8, default=4, advanced=true, group=pico_time
+#ifndef PICO_TIME_TIMER_WHEEL_LEVELS
+/*!
+ * \brief Number of 64 slot levels in the hierarchical timing wheel used by timer wheel alarm pools
+ * \ingroup alarm
+ *
+ * Alarms up to 64^PICO_TIME_TIMER_WHEEL_LEVELS ticks in the future are placed directly in the wheel; alarms
+ * further in the future are supported, but are re-inserted each time the top level of the wheel wraps around.
+ *
+ * \sa alarm_pool_create_timer_wheel_on_timer()
+ */
+#define PICO_TIME_TIMER_WHEEL_LEVELS 4
+#endif
+
 /**
  * \brief The identifier for an alarm
  *
@@ -449,6 +463,80 @@ static inline alarm_pool_t *alarm_pool_create_with_unused_hardware_alarm(uint ma
     return alarm_pool_create_on_timer_with_unused_hardware_alarm(alarm_pool_get_default_timer(), max_timers);
 }
 
+/**
+ * \brief Create a timer wheel alarm pool
+ * \ingroup alarm
+ *
+ * A timer wheel alarm pool supports the same alarm and repeating timer APIs as a regular alarm pool, however
+ * it stores its alarms in a hierarchical timing wheel with a granularity of \p tick_us, rather than
+ * ordering them exactly. Adding, canceling and re-arming an alarm are all O(1) regardless of the number of
+ * alarms in the pool, and all the alarms due in the same tick are called from a single IRQ.
+ *
+ * This makes timer wheel pools a good fit for large numbers of coarse-grained timeouts (e.g. protocol
+ * retransmits or watchdog-style deadlines) where it is acceptable for callbacks to be called up to
+ * \p tick_us late; callbacks are called on the first tick boundary at or after their target time.
+ * Repeating timers with a negative delay are still scheduled relative to their exact (rather than
+ * rounded) previous target time, so they do not drift.
+ *
+ * The alarm pool will call callbacks from an alarm IRQ Handler on the core of this function is called from.
+ *
+ * \note This method will hard assert if the timer_alarm is already claimed.
+ *
+ * \param timer the timer instance to use
+ * \param timer_alarm_num the timer_alarm to use to back this pool
+ * \param max_timers the maximum number of timers
+ * \param tick_us the granularity of the timer wheel in microseconds (must be non zero)
+ * \sa alarm_pool_create_on_timer()
+ * \sa PICO_TIME_TIMER_WHEEL_LEVELS
+ */
+alarm_pool_t *alarm_pool_create_timer_wheel_on_timer(alarm_pool_timer_t *timer, uint timer_alarm_num, uint max_timers, uint32_t tick_us);
+
+/**
+ * \brief Create a timer wheel alarm pool, claiming an unused timer_alarm to back it.
+ * \ingroup alarm
+ *
+ * \note This method will hard assert if the there is no free hardware to claim.
+ *
+ * \param timer the timer instance to use
+ * \param max_timers the maximum number of timers
+ * \param tick_us the granularity of the timer wheel in microseconds (must be non zero)
+ * \sa alarm_pool_create_timer_wheel_on_timer()
+ */
+alarm_pool_t *alarm_pool_create_timer_wheel_on_timer_with_unused_hardware_alarm(alarm_pool_timer_t *timer, uint max_timers, uint32_t tick_us);
+
+/**
+ * \brief Create a timer wheel alarm pool on the default timer
+ * \ingroup alarm
+ *
+ * \param timer_alarm_num the timer_alarm to use to back this pool
+ * \param max_timers the maximum number of timers
+ * \param tick_us the granularity of the timer wheel in microseconds (must be non zero)
+ * \sa alarm_pool_create_timer_wheel_on_timer()
+ */
+static inline alarm_pool_t *alarm_pool_create_timer_wheel(uint timer_alarm_num, uint max_timers, uint32_t tick_us) {
+    return alarm_pool_create_timer_wheel_on_timer(alarm_pool_get_default_timer(), timer_alarm_num, max_timers, tick_us);
+}
+
+/**
+ * \brief Create a timer wheel alarm pool on the default timer, claiming an unused timer_alarm to back it.
+ * \ingroup alarm
+ *
+ * \param max_timers the maximum number of timers
+ * \param tick_us the granularity of the timer wheel in microseconds (must be non zero)
+ * \sa alarm_pool_create_timer_wheel_on_timer()
+ */
+static inline alarm_pool_t *alarm_pool_create_timer_wheel_with_unused_hardware_alarm(uint max_timers, uint32_t tick_us) {
+    return alarm_pool_create_timer_wheel_on_timer_with_unused_hardware_alarm(alarm_pool_get_default_timer(), max_timers, tick_us);
+}
+
+/**
+ * \brief Return the tick granularity of a timer wheel alarm pool
+ * \ingroup alarm
+ * \param pool the pool
+ * \return the tick in microseconds, or 0 if the pool is not a timer wheel alarm pool
+ */
+uint32_t alarm_pool_timer_wheel_tick_us(alarm_pool_t *pool);
+
 /**
  * \brief Return the timer alarm used by an alarm pool
  * \ingroup alarm
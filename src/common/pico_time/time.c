@@ -14,17 +14,39 @@ const absolute_time_t ABSOLUTE_TIME_INITIALIZED_VAR(nil_time, 0);
 const absolute_time_t ABSOLUTE_TIME_INITIALIZED_VAR(at_the_end_of_time, INT64_MAX);
 
 typedef struct alarm_pool_entry {
-    // next entry link or -1
+    // next entry link (in either the free list, the new list, or a timer wheel slot) or -1
     int16_t next;
     // low 15 bits are a sequence number used in the low word of the alarm_id so that
     // the alarm_id for this entry only repeats every 32767 adds (note this value is never zero)
-    // the top bit is a cancellation flag.
+    // the top bit is a cancellation flag, which is also set while the entry is on the free list.
     volatile uint16_t sequence;
+    // -1 if the entry is not in the heap/wheel, otherwise for a heap pool the position of this entry
+    // in the heap, or for a timer wheel pool the previous entry in the same slot (or -2 - slot for
+    // the first entry in the slot). This is owned by the IRQ handler
+    int16_t position;
+    // next entry link in the list of pending cancellations or -1
+    int16_t cancel_next;
     int64_t target;
     alarm_callback_t callback;
     void *user_data;
 } alarm_pool_entry_t;
 
+// each level of a timer wheel has 64 slots, so that a single 64 bit word can track which are occupied
+#define TIMER_WHEEL_SLOT_BITS 6u
+#define TIMER_WHEEL_SLOTS (1u << TIMER_WHEEL_SLOT_BITS)
+
+typedef struct alarm_pool_timer_wheel {
+    // time of tick 0
+    int64_t base_time;
+    // the next tick to be processed
+    int64_t tick;
+    uint32_t tick_us;
+    // a bit per slot which is non-empty for each level
+    uint64_t occupied[PICO_TIME_TIMER_WHEEL_LEVELS];
+    // the first entry in each slot or -1
+    int16_t slot_heads[PICO_TIME_TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS];
+} alarm_pool_timer_wheel_t;
+
 struct alarm_pool {
     uint8_t timer_alarm_num;
     uint8_t core_num;
@@ -32,11 +54,20 @@ struct alarm_pool {
     int16_t free_head;
     // this is protected by the lock (threads add to it, the IRQ handler removes from it)
     volatile int16_t new_head;
-    volatile bool has_pending_cancellations;
-
-    // this is owned by the IRQ handler so doesn't need additional locking
-    int16_t ordered_head;
+    // this is protected by the lock (threads add to it, the IRQ handler removes from it)
+    volatile int16_t cancel_head;
+
+    // the heap or wheel is owned by the IRQ handler so doesn't need additional locking.
+    //
+    // A regular pool has a heap, which is a binary min-heap of entry indexes ordered by target time, so
+    // that adding, re-arming and removing an alarm are all O(log n).
+    //
+    // A timer wheel pool has a wheel instead, which is a hierarchical timing wheel where adding, re-arming
+    // and removing an alarm are all O(1), at the cost of alarms only firing on tick boundaries
+    uint16_t heap_size;
     uint16_t num_entries;
+    int16_t *heap;
+    alarm_pool_timer_wheel_t *wheel;
     alarm_pool_timer_t *timer;
     spin_lock_t *lock;
     alarm_pool_entry_t *entries;
@@ -45,9 +76,11 @@ struct alarm_pool {
 #if !PICO_TIME_DEFAULT_ALARM_POOL_DISABLED
 // To avoid bringing in calloc, we statically allocate the arrays and the heap
 static alarm_pool_entry_t default_alarm_pool_entries[PICO_TIME_DEFAULT_ALARM_POOL_MAX_TIMERS];
+static int16_t default_alarm_pool_heap[PICO_TIME_DEFAULT_ALARM_POOL_MAX_TIMERS];
 
 static alarm_pool_t default_alarm_pool = {
         .entries = default_alarm_pool_entries,
+        .heap = default_alarm_pool_heap,
 };
 
 static inline bool default_alarm_pool_initialized(void) {
@@ -107,32 +140,281 @@ PICO_RUNTIME_INIT_FUNC_RUNTIME(runtime_init_default_alarm_pool, PICO_RUNTIME_INI
 #endif
 #endif
 
-// note the timer is created with IRQs on this core
-alarm_pool_t *alarm_pool_create_on_timer(alarm_pool_timer_t *timer, uint hardware_alarm_num, uint max_timers) {
-    alarm_pool_t *pool = (alarm_pool_t *) malloc(sizeof(alarm_pool_t));
-    if (pool) {
-        pool->entries = (alarm_pool_entry_t *) calloc(max_timers, sizeof(alarm_pool_entry_t));
-        ta_hardware_alarm_claim(timer, hardware_alarm_num);
-        alarm_pool_post_alloc_init(pool, timer, hardware_alarm_num, max_timers);
+static void alarm_pool_irq_handler(void);
+static void alarm_pool_timer_wheel_irq_handler(void);
+
+// marker which we can use in place of handler function to indicate we are a repeating timer
+
+#define repeating_timer_marker ((alarm_callback_t)alarm_pool_irq_handler)
+#include "hardware/gpio.h"
+
+static inline void alarm_pool_heap_set(alarm_pool_t *pool, uint heap_index, int16_t index) {
+    pool->heap[heap_index] = index;
+    pool->entries[index].position = (int16_t)heap_index;
+}
+
+static void alarm_pool_heap_sift_up(alarm_pool_t *pool, uint heap_index) {
+    int16_t index = pool->heap[heap_index];
+    int64_t target = pool->entries[index].target;
+    while (heap_index) {
+        uint parent = (heap_index - 1) / 2;
+        // note >= as if we add a new item for the same time as another, then it should not move ahead of it
+        if (target - pool->entries[pool->heap[parent]].target >= 0) break;
+        alarm_pool_heap_set(pool, heap_index, pool->heap[parent]);
+        heap_index = parent;
     }
-    return pool;
+    alarm_pool_heap_set(pool, heap_index, index);
 }
 
-alarm_pool_t *alarm_pool_create_on_timer_with_unused_hardware_alarm(alarm_pool_timer_t *timer, uint max_timers) {
-    alarm_pool_t *pool = (alarm_pool_t *) malloc(sizeof(alarm_pool_t));
-    if (pool) {
-        pool->entries = (alarm_pool_entry_t *) calloc(max_timers, sizeof(alarm_pool_entry_t));
-        alarm_pool_post_alloc_init(pool, timer, (uint) ta_hardware_alarm_claim_unused(timer, true), max_timers);
+static void alarm_pool_heap_sift_down(alarm_pool_t *pool, uint heap_index) {
+    int16_t index = pool->heap[heap_index];
+    int64_t target = pool->entries[index].target;
+    uint size = pool->heap_size;
+    while (true) {
+        uint child = heap_index * 2 + 1;
+        if (child >= size) break;
+        if (child + 1 < size &&
+            pool->entries[pool->heap[child + 1]].target - pool->entries[pool->heap[child]].target < 0) {
+            child++;
+        }
+        // note > as a re-armed item for the same time as another should follow it
+        if (pool->entries[pool->heap[child]].target - target > 0) break;
+        alarm_pool_heap_set(pool, heap_index, pool->heap[child]);
+        heap_index = child;
     }
-    return pool;
+    alarm_pool_heap_set(pool, heap_index, index);
 }
 
-static void alarm_pool_irq_handler(void);
+static void alarm_pool_heap_insert(alarm_pool_t *pool, int16_t index) {
+    uint heap_index = pool->heap_size++;
+    pool->heap[heap_index] = index;
+    alarm_pool_heap_sift_up(pool, heap_index);
+}
 
-// marker which we can use in place of handler function to indicate we are a repeating timer
+static void alarm_pool_heap_remove(alarm_pool_t *pool, uint heap_index) {
+    pool->entries[pool->heap[heap_index]].position = -1;
+    uint last = --pool->heap_size;
+    if (heap_index != last) {
+        alarm_pool_heap_set(pool, heap_index, pool->heap[last]);
+        if (heap_index && pool->entries[pool->heap[heap_index]].target -
+                          pool->entries[pool->heap[(heap_index - 1) / 2]].target < 0) {
+            alarm_pool_heap_sift_up(pool, heap_index);
+        } else {
+            alarm_pool_heap_sift_down(pool, heap_index);
+        }
+    }
+}
+
+#define TIMER_WHEEL_NO_TICK INT64_MAX
+
+static inline uint timer_wheel_level_shift(uint level) {
+    return level * TIMER_WHEEL_SLOT_BITS;
+}
+
+// the first tick at or after the given time
+static int64_t timer_wheel_tick_at_or_after(alarm_pool_timer_wheel_t *wheel, int64_t time) {
+    int64_t delta = time - wheel->base_time;
+    if (delta <= 0) return 0;
+    return (delta + wheel->tick_us - 1) / wheel->tick_us;
+}
+
+static inline int64_t timer_wheel_tick_time(alarm_pool_timer_wheel_t *wheel, int64_t tick) {
+    return wheel->base_time + tick * wheel->tick_us;
+}
+
+static void timer_wheel_insert(alarm_pool_t *pool, int16_t index) {
+    alarm_pool_timer_wheel_t *wheel = pool->wheel;
+    alarm_pool_entry_t *entry = &pool->entries[index];
+    int64_t target_tick = timer_wheel_tick_at_or_after(wheel, entry->target);
+    int64_t delta = target_tick - wheel->tick;
+    if (delta < 0) {
+        // overdue, so fire on the next tick processed
+        target_tick = wheel->tick;
+        delta = 0;
+    }
+    uint level = 0;
+    while (level < PICO_TIME_TIMER_WHEEL_LEVELS - 1 && delta >> timer_wheel_level_shift(level + 1)) {
+        level++;
+    }
+    if (delta >> timer_wheel_level_shift(PICO_TIME_TIMER_WHEEL_LEVELS)) {
+        // beyond the range of the wheel; park it in the furthest slot, it will be re-inserted when that slot is cascaded
+        target_tick = wheel->tick + (1ll << timer_wheel_level_shift(PICO_TIME_TIMER_WHEEL_LEVELS)) - 1;
+    }
+    uint slot_num = (uint)((uint64_t)target_tick >> timer_wheel_level_shift(level)) & (TIMER_WHEEL_SLOTS - 1);
+    uint slot = level * TIMER_WHEEL_SLOTS + slot_num;
+    // add to the front of the slot's list; the head entry's position encodes the slot so it can be unlinked in O(1)
+    int16_t head = wheel->slot_heads[slot];
+    entry->next = head;
+    if (head >= 0) pool->entries[head].position = index;
+    entry->position = (int16_t)(-2 - (int)slot);
+    wheel->slot_heads[slot] = index;
+    wheel->occupied[level] |= 1ull << slot_num;
+}
+
+static void timer_wheel_remove(alarm_pool_t *pool, int16_t index) {
+    alarm_pool_timer_wheel_t *wheel = pool->wheel;
+    alarm_pool_entry_t *entry = &pool->entries[index];
+    int16_t prev = entry->position;
+    int16_t next = entry->next;
+    if (prev >= 0) {
+        pool->entries[prev].next = next;
+    } else {
+        uint slot = (uint)(-2 - prev);
+        wheel->slot_heads[slot] = next;
+        if (next < 0) {
+            wheel->occupied[slot / TIMER_WHEEL_SLOTS] &= ~(1ull << (slot & (TIMER_WHEEL_SLOTS - 1)));
+        }
+    }
+    if (next >= 0) pool->entries[next].position = prev;
+    entry->position = -1;
+}
+
+// remove all entries from a slot, returning the first (they remain linked via next)
+static int16_t timer_wheel_take_slot(alarm_pool_t *pool, uint level, uint slot_num) {
+    alarm_pool_timer_wheel_t *wheel = pool->wheel;
+    uint slot = level * TIMER_WHEEL_SLOTS + slot_num;
+    int16_t head = wheel->slot_heads[slot];
+    wheel->slot_heads[slot] = -1;
+    wheel->occupied[level] &= ~(1ull << slot_num);
+    return head;
+}
+
+static inline uint timer_wheel_first_occupied(uint64_t occupied, uint from_slot_num) {
+    uint64_t rotated = (occupied >> from_slot_num) | (occupied << ((TIMER_WHEEL_SLOTS - from_slot_num) & (TIMER_WHEEL_SLOTS - 1)));
+    return (uint)__builtin_ctzll(rotated);
+}
+
+// the next tick (not before the current tick) at which the wheel has any work to do, i.e. a level 0 slot
+// to fire, or a higher level slot to cascade
+static int64_t timer_wheel_next_tick(alarm_pool_timer_wheel_t *wheel) {
+    int64_t next_tick = TIMER_WHEEL_NO_TICK;
+    for (uint level = 0; level < PICO_TIME_TIMER_WHEEL_LEVELS; level++) {
+        uint64_t occupied = wheel->occupied[level];
+        if (occupied) {
+            uint shift = timer_wheel_level_shift(level);
+            // the first slot boundary for this level at or after the current tick
+            int64_t boundary = (wheel->tick + (1ll << shift) - 1) >> shift;
+            int64_t tick = (boundary + timer_wheel_first_occupied(occupied, (uint)boundary & (TIMER_WHEEL_SLOTS - 1))) << shift;
+            if (tick < next_tick) next_tick = tick;
+        }
+    }
+    return next_tick;
+}
+
+static inline bool timer_wheel_is_empty(alarm_pool_timer_wheel_t *wheel) {
+    for (uint level = 0; level < PICO_TIME_TIMER_WHEEL_LEVELS; level++) {
+        if (wheel->occupied[level]) return false;
+    }
+    return true;
+}
+
+static inline void alarm_pool_storage_insert(alarm_pool_t *pool, int16_t index) {
+    if (pool->wheel) {
+        timer_wheel_insert(pool, index);
+    } else {
+        alarm_pool_heap_insert(pool, index);
+    }
+}
+
+static inline void alarm_pool_storage_remove(alarm_pool_t *pool, int16_t index) {
+    if (pool->wheel) {
+        timer_wheel_remove(pool, index);
+    } else {
+        alarm_pool_heap_remove(pool, (uint)pool->entries[index].position);
+    }
+}
+
+// call the callback for an entry that is due, returning the delta for rescheduling it (or 0 to not reschedule)
+static inline int64_t alarm_pool_call_entry(alarm_pool_t *pool, int16_t index) {
+    alarm_pool_entry_t *entry = &pool->entries[index];
+    // note that an entry with the top bit of its sequence set has been canceled, but not yet
+    // removed by us; it is on the cancellation list, and will be freed when that is processed
+    uint16_t sequence = entry->sequence;
+    if ((int16_t)sequence < 0) return 0;
+    // special case repeating timer without making another function call which adds overhead
+    if (entry->callback == repeating_timer_marker) {
+        repeating_timer_t *rpt = (repeating_timer_t *)entry->user_data;
+        return rpt->callback(rpt) ? rpt->delay_us : 0;
+    } else {
+        alarm_id_t id = make_alarm_id(index, sequence);
+        return entry->callback(id, entry->user_data);
+    }
+}
+
+static inline int64_t alarm_pool_next_target(alarm_pool_timer_t *timer, int64_t target, int64_t delta) {
+    if (delta < 0) {
+        // delta is (positive) delta from last fire time
+        return target - delta;
+    } else {
+        // delta is relative to now
+        return (int64_t) ta_time_us_64(timer) + delta;
+    }
+}
+
+// add a fired entry (which has already been removed from the heap/wheel) back to the free list (under lock),
+// unless it has since been canceled in which case it is freed when the cancellation is processed
+static void alarm_pool_free_fired_entry(alarm_pool_t *pool, int16_t index) {
+    alarm_pool_entry_t *entry = &pool->entries[index];
+    uint32_t save = spin_lock_blocking(pool->lock);
+    if ((int16_t)entry->sequence >= 0) {
+        // mark the entry so that its (now stale) alarm_id can no longer be canceled
+        entry->sequence |= 0x8000;
+        entry->next = pool->free_head;
+        pool->free_head = index;
+    }
+    spin_unlock(pool->lock, save);
+}
+
+// process any new or canceled alarms
+static void alarm_pool_process_pending(alarm_pool_t *pool) {
+    // take both lists together under the lock (a canceled alarm may also still be on the new list)
+    uint32_t save = spin_lock_blocking(pool->lock);
+    // must re-read heads under lock
+    int16_t new_index = pool->new_head;
+    int16_t cancel_index = pool->cancel_head;
+    // clear the lists
+    pool->new_head = -1;
+    pool->cancel_head = -1;
+    spin_unlock(pool->lock, save);
+    // insert each of the new items
+    while (new_index >= 0) {
+        alarm_pool_entry_t *new_entry = &pool->entries[new_index];
+        int16_t next = new_entry->next;
+        // no need to insert an item which has already been canceled
+        if ((int16_t)new_entry->sequence >= 0) {
+            alarm_pool_storage_insert(pool, new_index);
+        }
+        new_index = next;
+    }
+    // remove each of the canceled items, chaining them together to add back to the free list
+    int16_t free_head = -1;
+    int16_t *free_tail = &free_head;
+    while (cancel_index >= 0) {
+        alarm_pool_entry_t *entry = &pool->entries[cancel_index];
+        if (entry->position != -1) {
+            alarm_pool_storage_remove(pool, cancel_index);
+        }
+        *free_tail = cancel_index;
+        free_tail = &entry->next;
+        cancel_index = entry->cancel_next;
+    }
+    if (free_head >= 0) {
+        save = spin_lock_blocking(pool->lock);
+        *free_tail = pool->free_head;
+        pool->free_head = free_head;
+        spin_unlock(pool->lock, save);
+    }
+}
+
+static inline alarm_pool_t *alarm_pool_from_current_irq(alarm_pool_timer_t **timer_out, uint *timer_alarm_num) {
+    alarm_pool_timer_t *timer = ta_from_current_irq(timer_alarm_num);
+    uint timer_num = ta_timer_num(timer);
+    alarm_pool_t *pool = pools[timer_num][*timer_alarm_num];
+    assert(pool->timer_alarm_num == *timer_alarm_num);
+    *timer_out = timer;
+    return pool;
+}
 
-#define repeating_timer_marker ((alarm_callback_t)alarm_pool_irq_handler)
-#include "hardware/gpio.h"
 static void alarm_pool_irq_handler(void) {
     // This IRQ handler does the main work, as it always (assuming the IRQ hasn't been enabled on both cores
     // which is unsupported) run on the alarm pool's core, and can't be preempted by itself, meaning
@@ -140,10 +422,8 @@ static void alarm_pool_irq_handler(void) {
     // This simplifies the code considerably, and makes it much faster in general, even though we are forced to take
     // two IRQs per alarm.
     uint timer_alarm_num;
-    alarm_pool_timer_t *timer = ta_from_current_irq(&timer_alarm_num);
-    uint timer_num = ta_timer_num(timer);
-    alarm_pool_t *pool = pools[timer_num][timer_alarm_num];
-    assert(pool->timer_alarm_num == timer_alarm_num);
+    alarm_pool_timer_t *timer;
+    alarm_pool_t *pool = alarm_pool_from_current_irq(&timer, &timer_alarm_num);
     int64_t earliest_target;
     // 1. clear force bits if we were forced (do this outside the loop, as forcing is hopefully rare)
     ta_clear_force_irq(timer, timer_alarm_num);
@@ -154,123 +434,35 @@ static void alarm_pool_irq_handler(void) {
         //    don't want to delay an existing callback because a later one is added, and
         //    if both are due now, then we have a race anyway (but we prefer to fire existing
         //    timers before new ones anyway.
-        int16_t earliest_index = pool->ordered_head;
-        // by default, we loop if there was any event pending (we will mark it false
-        // later if there is no work to do)
-        if (earliest_index >= 0) {
+        if (pool->heap_size) {
+            int16_t earliest_index = pool->heap[0];
             alarm_pool_entry_t *earliest_entry = &pool->entries[earliest_index];
             earliest_target = earliest_entry->target;
             if (((int64_t)ta_time_us_64(timer) - earliest_target) >= 0) {
                 // time to call the callback now (or in the past)
-                // note that an entry->target of < 0 means the entry has been canceled (not this is set
-                // by this function, in response to the entry having been queued by the cancel_alarm API
-                // meaning that we don't need to worry about tearing of the 64 bit value)
-                int64_t delta;
-                if (earliest_target >= 0) {
-                    // special case repeating timer without making another function call which adds overhead
-                    if (earliest_entry->callback == repeating_timer_marker) {
-                        repeating_timer_t *rpt = (repeating_timer_t *)earliest_entry->user_data;
-                        delta = rpt->callback(rpt) ? rpt->delay_us : 0;
-                    } else {
-                        alarm_id_t id = make_alarm_id(pool->ordered_head, earliest_entry->sequence);
-                        delta = earliest_entry->callback(id, earliest_entry->user_data);
-                    }
-                } else {
-                    // negative target means cancel alarm
-                    delta = 0;
-                }
+                int64_t delta = alarm_pool_call_entry(pool, earliest_index);
                 if (delta) {
-                    int64_t next_time;
-                    if (delta < 0) {
-                        // delta is (positive) delta from last fire time
-                        next_time = earliest_target - delta;
-                    } else {
-                        // delta is relative to now
-                        next_time = (int64_t) ta_time_us_64(timer) + delta;
-                    }
-                    earliest_entry->target = next_time;
-                    // need to re-add, unless we are the only entry or already at the front
-                    if (earliest_entry->next >= 0 && next_time - pool->entries[earliest_entry->next].target >= 0) {
-                        // unlink this item
-                        pool->ordered_head = earliest_entry->next;
-                        int16_t *prev = &pool->ordered_head;
-                        // find insertion point; note >= as if we add a new item for the same time as another, then it follows
-                        while (*prev >= 0 && (next_time - pool->entries[*prev].target) >= 0) {
-                            prev = &pool->entries[*prev].next;
-                        }
-                        earliest_entry->next = *prev;
-                        *prev = earliest_index;
-                    }
+                    earliest_entry->target = alarm_pool_next_target(timer, earliest_target, delta);
+                    // the entry is still at the front of the heap, so just move it down to its new position
+                    alarm_pool_heap_sift_down(pool, 0);
                 } else {
                     // need to remove the item
-                    pool->ordered_head = earliest_entry->next;
-                    // and add it back to the free list (under lock)
-                    uint32_t save = spin_lock_blocking(pool->lock);
-                    earliest_entry->next = pool->free_head;
-                    pool->free_head = earliest_index;
-                    spin_unlock(pool->lock, save);
+                    alarm_pool_heap_remove(pool, 0);
+                    alarm_pool_free_fired_entry(pool, earliest_index);
                 }
             }
         }
-        // if we have any new alarms, add them to the ordered list
-        if (pool->new_head >= 0) {
-            uint32_t save = spin_lock_blocking(pool->lock);
-            // must re-read new head under lock
-            int16_t new_index = pool->new_head;
-            // clear the list
-            pool->new_head = -1;
-            spin_unlock(pool->lock, save);
-            // insert each of the new items
-            while (new_index >= 0) {
-                alarm_pool_entry_t *new_entry = &pool->entries[new_index];
-                int64_t new_entry_time = new_entry->target;
-                int16_t *prev = &pool->ordered_head;
-                // find insertion point; note >= as if we add a new item for the same time as another, then it follows
-                while (*prev >= 0 && (new_entry_time - pool->entries[*prev].target) >= 0) {
-                    prev = &pool->entries[*prev].next;
-                }
-                int16_t next = *prev;
-                *prev = new_index;
-                new_index = new_entry->next;
-                new_entry->next = next;
-            }
+        // if we have any new or canceled alarms, then add them to or remove them from the heap
+        if (pool->new_head >= 0 || pool->cancel_head >= 0) {
+            alarm_pool_process_pending(pool);
         }
-        // if we have any canceled alarms, then mark them for removal by setting their due time to -1 (which will
-        // cause them to be handled the next time round and removed)
-        if (pool->has_pending_cancellations) {
-            pool->has_pending_cancellations = false;
-            __compiler_memory_barrier();
-            int16_t *prev = &pool->ordered_head;
-            // set target for canceled items to -1, and move to front of the list
-            for(int16_t index = pool->ordered_head; index != -1; ) {
-                alarm_pool_entry_t *entry = &pool->entries[index];
-                int16_t next = entry->next;
-                if ((int16_t)entry->sequence < 0) {
-                    // mark for deletion
-                    entry->target = -1;
-                    if (index != pool->ordered_head) {
-                        // move to start of queue
-                        *prev = entry->next;
-                        entry->next = pool->ordered_head;
-                        pool->ordered_head = index;
-                    }
-                } else {
-                    prev = &entry->next;
-                }
-                index = next;
-            }
-        }
-        earliest_index = pool->ordered_head;
-        if (earliest_index < 0) break;
+        if (!pool->heap_size) break;
         // need to wait
-        alarm_pool_entry_t *earliest_entry = &pool->entries[earliest_index];
-        earliest_target = earliest_entry->target;
+        earliest_target = pool->entries[pool->heap[0]].target;
         // we are leaving a timeout every 2^32 microseconds anyway if there is no valid target, so we can choose any value.
         // best_effort_wfe_or_timeout now relies on it being the last value set, and arguably this is the
         // best value anyway, as it is the furthest away from the last fire.
-        if (earliest_target != -1) { // cancelled alarm has target of -1
-            ta_set_timeout(timer, timer_alarm_num, earliest_target);
-        }
+        ta_set_timeout(timer, timer_alarm_num, earliest_target);
         // check we haven't now passed the target time; if not we don't want to loop again
     } while ((earliest_target - (int64_t)ta_time_us_64(timer)) <= 0);
     // We always want the timer IRQ to wake a WFE so that best_effort_wfe_or_timeout() will wake up. It will wake
@@ -278,6 +470,144 @@ static void alarm_pool_irq_handler(void) {
     __sev();
 }
 
+// process the given tick, which must be the next tick at which the wheel has work to do
+static void timer_wheel_process_tick(alarm_pool_t *pool, alarm_pool_timer_t *timer, int64_t tick) {
+    alarm_pool_timer_wheel_t *wheel = pool->wheel;
+    wheel->tick = tick;
+    // cascade any higher level slots which start at this tick, highest first, so that their entries
+    // move down into lower levels (or the level 0 slot for this tick)
+    for (uint level = PICO_TIME_TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+        uint shift = timer_wheel_level_shift(level);
+        if (!(tick & ((1ll << shift) - 1))) {
+            uint slot_num = (uint)((uint64_t)tick >> shift) & (TIMER_WHEEL_SLOTS - 1);
+            if (wheel->occupied[level] & (1ull << slot_num)) {
+                int16_t index = timer_wheel_take_slot(pool, level, slot_num);
+                while (index >= 0) {
+                    int16_t next = pool->entries[index].next;
+                    timer_wheel_insert(pool, index);
+                    index = next;
+                }
+            }
+        }
+    }
+    // then fire everything in the level 0 slot for this tick as one batch; note the tick is advanced
+    // first, so that re-armed entries are inserted relative to the next tick
+    int16_t index = timer_wheel_take_slot(pool, 0, (uint)tick & (TIMER_WHEEL_SLOTS - 1));
+    wheel->tick = tick + 1;
+    while (index >= 0) {
+        alarm_pool_entry_t *entry = &pool->entries[index];
+        int16_t next = entry->next;
+        entry->position = -1;
+        int64_t delta = alarm_pool_call_entry(pool, index);
+        if (delta) {
+            entry->target = alarm_pool_next_target(timer, entry->target, delta);
+            if (timer_wheel_tick_at_or_after(wheel, entry->target) <= tick) {
+                // still due in this tick (a repeating timer with a period shorter than the tick), so fire it again
+                continue;
+            }
+            timer_wheel_insert(pool, index);
+        } else {
+            alarm_pool_free_fired_entry(pool, index);
+        }
+        index = next;
+    }
+}
+
+static void alarm_pool_timer_wheel_irq_handler(void) {
+    // This follows the same structure as alarm_pool_irq_handler, however rather than firing the earliest alarm
+    // each time round the loop, it fires all alarms that are due in each tick as a batch
+    uint timer_alarm_num;
+    alarm_pool_timer_t *timer;
+    alarm_pool_t *pool = alarm_pool_from_current_irq(&timer, &timer_alarm_num);
+    alarm_pool_timer_wheel_t *wheel = pool->wheel;
+    int64_t next_target;
+    ta_clear_force_irq(timer, timer_alarm_num);
+    do {
+        ta_clear_irq(timer, timer_alarm_num);
+        int64_t now = (int64_t)ta_time_us_64(timer);
+        // the last tick which is due
+        int64_t now_tick = (now - wheel->base_time) / wheel->tick_us;
+        int64_t tick;
+        while ((tick = timer_wheel_next_tick(wheel)) <= now_tick) {
+            timer_wheel_process_tick(pool, timer, tick);
+        }
+        if (pool->new_head >= 0 || pool->cancel_head >= 0) {
+            // if the wheel is empty, there is no need to cascade through the idle time, so move
+            // its tick forward to now
+            if (timer_wheel_is_empty(wheel) && wheel->tick < now_tick) {
+                wheel->tick = now_tick;
+            }
+            alarm_pool_process_pending(pool);
+        }
+        tick = timer_wheel_next_tick(wheel);
+        if (tick == TIMER_WHEEL_NO_TICK) break;
+        next_target = timer_wheel_tick_time(wheel, tick);
+        ta_set_timeout(timer, timer_alarm_num, next_target);
+        // check we haven't now passed the target time; if not we don't want to loop again
+    } while ((next_target - (int64_t)ta_time_us_64(timer)) <= 0);
+    __sev();
+}
+
+static alarm_pool_t *alarm_pool_alloc(uint max_timers, uint32_t wheel_tick_us) {
+    alarm_pool_t *pool = (alarm_pool_t *) malloc(sizeof(alarm_pool_t));
+    if (pool) {
+        pool->entries = (alarm_pool_entry_t *) calloc(max_timers, sizeof(alarm_pool_entry_t));
+        if (wheel_tick_us) {
+            pool->heap = NULL;
+            pool->wheel = (alarm_pool_timer_wheel_t *) malloc(sizeof(alarm_pool_timer_wheel_t));
+            if (pool->wheel) pool->wheel->tick_us = wheel_tick_us;
+        } else {
+            pool->heap = (int16_t *) calloc(max_timers, sizeof(int16_t));
+            pool->wheel = NULL;
+        }
+        if (!pool->entries || !(pool->heap || pool->wheel)) {
+            free(pool->entries);
+            free(pool->heap);
+            free(pool->wheel);
+            free(pool);
+            pool = NULL;
+        }
+    }
+    return pool;
+}
+
+// note the timer is created with IRQs on this core
+alarm_pool_t *alarm_pool_create_on_timer(alarm_pool_timer_t *timer, uint hardware_alarm_num, uint max_timers) {
+    alarm_pool_t *pool = alarm_pool_alloc(max_timers, 0);
+    if (pool) {
+        ta_hardware_alarm_claim(timer, hardware_alarm_num);
+        alarm_pool_post_alloc_init(pool, timer, hardware_alarm_num, max_timers);
+    }
+    return pool;
+}
+
+alarm_pool_t *alarm_pool_create_on_timer_with_unused_hardware_alarm(alarm_pool_timer_t *timer, uint max_timers) {
+    alarm_pool_t *pool = alarm_pool_alloc(max_timers, 0);
+    if (pool) {
+        alarm_pool_post_alloc_init(pool, timer, (uint) ta_hardware_alarm_claim_unused(timer, true), max_timers);
+    }
+    return pool;
+}
+
+alarm_pool_t *alarm_pool_create_timer_wheel_on_timer(alarm_pool_timer_t *timer, uint hardware_alarm_num, uint max_timers, uint32_t tick_us) {
+    invalid_params_if(PICO_TIME, !tick_us);
+    alarm_pool_t *pool = alarm_pool_alloc(max_timers, tick_us);
+    if (pool) {
+        ta_hardware_alarm_claim(timer, hardware_alarm_num);
+        alarm_pool_post_alloc_init(pool, timer, hardware_alarm_num, max_timers);
+    }
+    return pool;
+}
+
+alarm_pool_t *alarm_pool_create_timer_wheel_on_timer_with_unused_hardware_alarm(alarm_pool_timer_t *timer, uint max_timers, uint32_t tick_us) {
+    invalid_params_if(PICO_TIME, !tick_us);
+    alarm_pool_t *pool = alarm_pool_alloc(max_timers, tick_us);
+    if (pool) {
+        alarm_pool_post_alloc_init(pool, timer, (uint) ta_hardware_alarm_claim_unused(timer, true), max_timers);
+    }
+    return pool;
+}
+
 void alarm_pool_post_alloc_init(alarm_pool_t *pool, alarm_pool_timer_t *timer, uint hardware_alarm_num, uint max_timers) {
     pool->timer = timer;
     pool->lock = spin_lock_instance(next_striped_spin_lock_num());
@@ -285,14 +615,29 @@ void alarm_pool_post_alloc_init(alarm_pool_t *pool, alarm_pool_timer_t *timer, u
     invalid_params_if(PICO_TIME, max_timers > 65536);
     pool->num_entries = (uint16_t)max_timers;
     pool->core_num = (uint8_t) get_core_num();
-    pool->new_head = pool->ordered_head = -1;
+    pool->new_head = pool->cancel_head = -1;
+    pool->heap_size = 0;
     pool->free_head = (int16_t)(max_timers - 1);
     for(uint i=0;i<max_timers;i++) {
         pool->entries[i].next = (int16_t)(i-1);
+        pool->entries[i].position = -1;
+        // free entries are marked as canceled, so that they cannot be canceled again
+        pool->entries[i].sequence |= 0x8000;
+    }
+    if (pool->wheel) {
+        alarm_pool_timer_wheel_t *wheel = pool->wheel;
+        wheel->base_time = (int64_t)ta_time_us_64(timer);
+        wheel->tick = 0;
+        for (uint i = 0; i < count_of(wheel->occupied); i++) {
+            wheel->occupied[i] = 0;
+        }
+        for (uint i = 0; i < count_of(wheel->slot_heads); i++) {
+            wheel->slot_heads[i] = -1;
+        }
     }
     pools[ta_timer_num(timer)][hardware_alarm_num] = pool;
 
-    ta_enable_irq_handler(timer, hardware_alarm_num, alarm_pool_irq_handler);
+    ta_enable_irq_handler(timer, hardware_alarm_num, pool->wheel ? alarm_pool_timer_wheel_irq_handler : alarm_pool_irq_handler);
 }
 
 void alarm_pool_destroy(alarm_pool_t *pool) {
@@ -302,13 +647,19 @@ void alarm_pool_destroy(alarm_pool_t *pool) {
         return;
     }
 #endif
-    ta_disable_irq_handler(pool->timer, pool->timer_alarm_num, alarm_pool_irq_handler);
+    ta_disable_irq_handler(pool->timer, pool->timer_alarm_num, pool->wheel ? alarm_pool_timer_wheel_irq_handler : alarm_pool_irq_handler);
     assert(pools[ta_timer_num(pool->timer)][pool->timer_alarm_num] == pool);
     pools[ta_timer_num(pool->timer)][pool->timer_alarm_num] = NULL;
     free(pool->entries);
+    free(pool->heap);
+    free(pool->wheel);
     free(pool);
 }
 
+uint32_t alarm_pool_timer_wheel_tick_us(alarm_pool_t *pool) {
+    return pool->wheel ? pool->wheel->tick_us : 0;
+}
+
 alarm_id_t alarm_pool_add_alarm_at(alarm_pool_t *pool, absolute_time_t time, alarm_callback_t callback,
                                    void *user_data, bool fire_if_past) {
     if (!fire_if_past) {
@@ -335,6 +686,7 @@ alarm_id_t alarm_pool_add_alarm_at_force_in_context(alarm_pool_t *pool, absolute
     entry->callback = callback;
     entry->user_data = user_data;
     entry->target = (int64_t)to_us_since_boot(time);
+    entry->position = -1;
     uint16_t next_sequence = (entry->sequence + 1) & 0x7fff;
     if (!next_sequence) next_sequence = 1; // zero is not allowed
     entry->sequence = next_sequence;
@@ -358,13 +710,14 @@ bool alarm_pool_cancel_alarm(alarm_pool_t *pool, alarm_id_t alarm_id) {
     bool canceled = false;
     alarm_pool_entry_t *entry = &pool->entries[index];
     uint32_t save = spin_lock_blocking(pool->lock);
-    // note this will not be true if the entry is already canceled (as the entry->sequence
+    // note this will not be true if the entry is already canceled or has been freed (as the entry->sequence
     // will have the top bit set)
     uint current_sequence = entry->sequence;
     if (sequence == current_sequence) {
         entry->sequence = (uint16_t)(current_sequence | 0x8000);
-        __compiler_memory_barrier();
-        pool->has_pending_cancellations = true;
+        // add to the list of cancellations for the IRQ handler to remove from the heap
+        entry->cancel_next = pool->cancel_head;
+        pool->cancel_head = index;
         canceled = true;
     }
     spin_unlock(pool->lock, save);
@@ -536,16 +889,9 @@ int64_t alarm_pool_remaining_alarm_time_us(alarm_pool_t *pool, alarm_id_t alarm_
         alarm_pool_entry_t *entry = &pool->entries[index];
         if (entry->sequence == sequence) {
             uint32_t save = spin_lock_blocking(pool->lock);
-            int16_t search_index = pool->ordered_head;
-            while (search_index >= 0) {
-                entry = &pool->entries[search_index];
-                if (index == search_index) {
-                    if (entry->sequence == sequence) {
-                        rc = entry->target - (int64_t) ta_time_us_64(pool->timer);
-                    }
-                    break;
-                }
-                search_index = entry->next;
+            // a matching sequence (checked under the lock) means the alarm has been neither canceled nor freed
+            if (entry->sequence == sequence) {
+                rc = entry->target - (int64_t) ta_time_us_64(pool->timer);
             }
             spin_unlock(pool->lock, save);
         }
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdlib.h>
+#include "pico/util/arena.h"
+
+static inline uint8_t *chunk_start(arena_chunk_t *chunk) {
+    return (uint8_t *)(chunk + 1);
+}
+
+static inline uint8_t *chunk_end(arena_chunk_t *chunk) {
+    return (uint8_t *)chunk + chunk->size;
+}
+
+static void use_chunk(arena_t *a, arena_chunk_t *chunk) {
+    chunk->prev = a->chunk;
+    a->chunk = chunk;
+    a->ptr = chunk_start(chunk);
+    a->end = chunk_end(chunk);
+}
+
+// free a heap chunk, or keep it as the spare if it is a regular sized chunk
+static void release_chunk(arena_t *a, arena_chunk_t *chunk) {
+    if (!chunk->heap) return;
+    if (chunk->size == a->chunk_size && !a->spare) {
+        a->spare = chunk;
+    } else {
+        free(chunk);
+    }
+}
+
+void arena_init(arena_t *a, void *buf, size_t size, size_t chunk_size) {
+    a->chunk = NULL;
+    a->ptr = NULL;
+    a->end = NULL;
+    a->chunk_size = chunk_size;
+    a->spare = NULL;
+    if (buf && size > sizeof(arena_chunk_t)) {
+        arena_chunk_t *chunk = (arena_chunk_t *)buf;
+        chunk->size = size;
+        chunk->heap = false;
+        use_chunk(a, chunk);
+    }
+}
+
+void arena_deinit(arena_t *a) {
+    arena_reset(a);
+    if (a->spare) {
+        free(a->spare);
+        a->spare = NULL;
+    }
+}
+
+void *arena_alloc_new_chunk(arena_t *a, size_t size, size_t align) {
+    if (!a->chunk_size) return NULL;
+    size_t need = sizeof(arena_chunk_t) + align - 1 + size;
+    if (need < size) return NULL;
+    arena_chunk_t *chunk;
+    if (need <= a->chunk_size && a->spare) {
+        chunk = a->spare;
+        a->spare = NULL;
+    } else {
+        size_t chunk_size = MAX(need, a->chunk_size);
+        chunk = (arena_chunk_t *)malloc(chunk_size);
+        if (!chunk) return NULL;
+        chunk->size = chunk_size;
+        chunk->heap = true;
+    }
+    use_chunk(a, chunk);
+    return arena_alloc_aligned(a, size, align);
+}
+
+void arena_reset_to_mark(arena_t *a, arena_mark_t mark) {
+    while (a->chunk != mark.chunk) {
+        arena_chunk_t *chunk = a->chunk;
+        a->chunk = chunk->prev;
+        release_chunk(a, chunk);
+    }
+    if (a->chunk) {
+        a->ptr = mark.ptr;
+        a->end = chunk_end(a->chunk);
+    } else {
+        a->ptr = NULL;
+        a->end = NULL;
+    }
+}
+
+void arena_reset(arena_t *a) {
+    // release every heap chunk, back to the caller supplied buffer (the first chunk) if any
+    arena_chunk_t *first = a->chunk;
+    while (first && first->prev) {
+        first = first->prev;
+    }
+    arena_mark_t mark = {NULL, NULL};
+    if (first && !first->heap) {
+        mark.chunk = first;
+        mark.ptr = chunk_start(first);
+    }
+    arena_reset_to_mark(a, mark);
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _PICO_UTIL_ARENA_H
+#define _PICO_UTIL_ARENA_H
+
+#include "pico.h"
+
+/** \file arena.h
+ * \defgroup arena arena
+ * \brief Region based (bump) allocator, for many small allocations which are all freed together
+ *
+ * An arena hands out memory by advancing a pointer through a chunk of memory, so an allocation costs a few
+ * instructions and takes no lock; individual allocations are never freed, instead the whole arena (or everything
+ * allocated since a mark) is released at once. This suits code such as request handlers, which allocate many small
+ * objects which all die at the end of the request.
+ *
+ * The memory comes from a caller supplied buffer, and/or (if a chunk size is given) from chunks allocated with malloc
+ * as the arena grows, so the malloc mutex (see pico_malloc) is only taken once per chunk rather than once per object.
+ * When a reset releases heap chunks, one is kept for reuse, so an arena which is repeatedly filled and reset doesn't
+ * call malloc or free at all in the steady state.
+ *
+ * An arena is not safe for concurrent use from both cores (or from an IRQ handler and the code it interrupts). Each
+ * core can instead allocate from its own arena, lock free; see \ref arena_per_core_t.
+ * \ingroup pico_util
+ */
+
+// PICO_CONFIG: PICO_ARENA_DEFAULT_ALIGNMENT, Alignment of allocations made by arena_alloc, type=int, default=8, group=arena
+#ifndef PICO_ARENA_DEFAULT_ALIGNMENT
+#define PICO_ARENA_DEFAULT_ALIGNMENT 8
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// the header at the start of each chunk of an arena
+typedef struct arena_chunk {
+    struct arena_chunk *prev;
+    size_t size;
+    bool heap;
+} arena_chunk_t;
+
+typedef struct {
+    arena_chunk_t *chunk;
+    uint8_t *ptr;
+    uint8_t *end;
+    size_t chunk_size;
+    arena_chunk_t *spare;
+} arena_t;
+
+/*! \brief A position in an arena to return to with \ref arena_reset_to_mark
+ *  \ingroup arena
+ */
+typedef struct {
+    arena_chunk_t *chunk;
+    uint8_t *ptr;
+} arena_mark_t;
+
+/*! \brief Initialise an arena
+ *  \ingroup arena
+ *
+ * \param a Pointer to an arena_t structure, used as a handle
+ * \param buf A buffer to allocate from first, or NULL. The buffer must be aligned for a pointer, and a few bytes of it
+ * are used for a chunk header
+ * \param size The size of buf
+ * \param chunk_size The size of the chunks to allocate with malloc when buf is full (an allocation which doesn't fit
+ * in a chunk of this size gets a chunk of its own), or 0 to allocate from buf only
+ */
+void arena_init(arena_t *a, void *buf, size_t size, size_t chunk_size);
+
+/*! \brief Release all the memory allocated with malloc by an arena
+ *  \ingroup arena
+ *
+ * The arena must be initialised again before it is used again
+ *
+ * \param a Pointer to an arena_t structure, used as a handle
+ */
+void arena_deinit(arena_t *a);
+
+/*! \brief Allocate a new chunk and allocate from it
+ *  \ingroup arena
+ *
+ * This is called by \ref arena_alloc_aligned, and is not generally called directly
+ */
+void *arena_alloc_new_chunk(arena_t *a, size_t size, size_t align);
+
+/*! \brief Allocate memory with a given alignment from an arena
+ *  \ingroup arena
+ *
+ * \param a Pointer to an arena_t structure, used as a handle
+ * \param size The size of the allocation
+ * \param align The alignment of the allocation, which must be a power of 2
+ * \return the allocation, or NULL if there is no room (and no more memory could be allocated with malloc)
+ */
+static inline void *arena_alloc_aligned(arena_t *a, size_t size, size_t align) {
+    uintptr_t p = ((uintptr_t)a->ptr + align - 1) & ~(uintptr_t)(align - 1);
+    if (a->chunk && p <= (uintptr_t)a->end && size <= (uintptr_t)a->end - p) {
+        a->ptr = (uint8_t *)(p + size);
+        return (void *)p;
+    }
+    return arena_alloc_new_chunk(a, size, align);
+}
+
+/*! \brief Allocate memory from an arena
+ *  \ingroup arena
+ *
+ * The allocation is aligned to \ref PICO_ARENA_DEFAULT_ALIGNMENT bytes
+ *
+ * \param a Pointer to an arena_t structure, used as a handle
+ * \param size The size of the allocation
+ * \return the allocation, or NULL if there is no room (and no more memory could be allocated with malloc)
+ */
+static inline void *arena_alloc(arena_t *a, size_t size) {
+    return arena_alloc_aligned(a, size, PICO_ARENA_DEFAULT_ALIGNMENT);
+}
+
+/*! \brief Allocate zeroed memory from an arena
+ *  \ingroup arena
+ *
+ * \param a Pointer to an arena_t structure, used as a handle
+ * \param size The size of the allocation
+ * \return the allocation, or NULL if there is no room (and no more memory could be allocated with malloc)
+ */
+static inline void *arena_alloc_zeroed(arena_t *a, size_t size) {
+    void *mem = arena_alloc(a, size);
+    if (mem) __builtin_memset(mem, 0, size);
+    return mem;
+}
+
+/*! \brief Get a mark for the current position in an arena
+ *  \ingroup arena
+ *
+ * \param a Pointer to an arena_t structure, used as a handle
+ * \return a mark, to pass to \ref arena_reset_to_mark
+ */
+static inline arena_mark_t arena_mark(const arena_t *a) {
+    arena_mark_t mark = {a->chunk, a->ptr};
+    return mark;
+}
+
+/*! \brief Release everything allocated from an arena since a mark was taken
+ *  \ingroup arena
+ *
+ * Heap chunks allocated since the mark are freed (except for one which is kept for reuse). Marks taken after this
+ * mark are no longer valid.
+ *
+ * \param a Pointer to an arena_t structure, used as a handle
+ * \param mark The mark, which was returned by \ref arena_mark for this arena
+ */
+void arena_reset_to_mark(arena_t *a, arena_mark_t mark);
+
+/*! \brief Release everything allocated from an arena
+ *  \ingroup arena
+ *
+ * \param a Pointer to an arena_t structure, used as a handle
+ */
+void arena_reset(arena_t *a);
+
+/*! \brief A set of arenas, one per core, for lock free allocation from both cores
+ *  \ingroup arena
+ */
+typedef struct {
+    arena_t core[NUM_CORES];
+} arena_per_core_t;
+
+/*! \brief Initialise a set of per-core arenas, which allocate from heap chunks only
+ *  \ingroup arena
+ *
+ * \param pc Pointer to an arena_per_core_t structure, used as a handle
+ * \param chunk_size The size of the chunks to allocate with malloc
+ */
+static inline void arena_per_core_init(arena_per_core_t *pc, size_t chunk_size) {
+    for (uint core = 0; core < NUM_CORES; core++) {
+        arena_init(&pc->core[core], NULL, 0, chunk_size);
+    }
+}
+
+/*! \brief Release all the memory allocated with malloc by a set of per-core arenas
+ *  \ingroup arena
+ *
+ * \param pc Pointer to an arena_per_core_t structure, used as a handle
+ */
+static inline void arena_per_core_deinit(arena_per_core_t *pc) {
+    for (uint core = 0; core < NUM_CORES; core++) {
+        arena_deinit(&pc->core[core]);
+    }
+}
+
+/*! \brief Get the calling core's arena from a set of per-core arenas
+ *  \ingroup arena
+ *
+ * The arena must only be used from this core, and not from IRQ handlers which may interrupt other users of it
+ *
+ * \param pc Pointer to an arena_per_core_t structure, used as a handle
+ * \return this core's arena
+ */
+static inline arena_t *arena_per_core_get(arena_per_core_t *pc) {
+    return &pc->core[get_core_num()];
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
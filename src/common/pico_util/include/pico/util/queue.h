@@ -20,6 +20,10 @@
  * \brief Multi-core and IRQ safe queue implementation
  *
  * Note that this queue stores values of a specified size, and pushed values are copied into the queue
+ *
+ * A queue initialized with \ref queue_init_spsc is a lock-free single-producer/single-consumer queue; it
+ * supports the same API, but must only ever be added to from one core/IRQ context, and removed from (or peeked)
+ * from one (possibly different) core/IRQ context.
  * \ingroup pico_util
  */
 
@@ -36,6 +40,7 @@ typedef struct {
     uint16_t rptr;
     uint16_t element_size;
     uint16_t element_count;
+    bool spsc;
 #if PICO_QUEUE_MAX_LEVEL
     uint16_t max_level;
 #endif
@@ -62,6 +67,20 @@ static inline void queue_init(queue_t *q, uint element_size, uint element_count)
     queue_init_with_spinlock(q, element_size, element_count, next_striped_spin_lock_num());
 }
 
+/*! \brief Initialise a lock-free single-producer/single-consumer queue
+ *  \ingroup queue
+ *
+ * The queue is accessed without a spin lock, using only ordered loads and stores of the read and write
+ * indexes; this is considerably faster than a regular queue, but is only safe if all additions are made from
+ * a single core/IRQ context (the producer) and all removals and peeks are made from a single core/IRQ context
+ * (the consumer). The blocking functions wait with __wfe(), and every addition or removal does a __sev().
+ *
+ * \param q Pointer to a queue_t structure, used as a handle
+ * \param element_size Size of each value in the queue
+ * \param element_count Maximum number of entries in the queue
+ */
+void queue_init_spsc(queue_t *q, uint element_size, uint element_count);
+
 /*! \brief Destroy the specified queue.
  *  \ingroup queue
  *
@@ -81,7 +100,12 @@ void queue_free(queue_t *q);
  * spin lock is not externally locked
  */
 static inline uint queue_get_level_unsafe(queue_t *q) {
-    int32_t rc = (int32_t)q->wptr - (int32_t)q->rptr;
+    // note the indexes are read once each, as they may be updated concurrently in a single-producer/single-consumer queue
+#if defined(__GNUC__)
+    int32_t rc = (int32_t)__atomic_load_n(&q->wptr, __ATOMIC_RELAXED) - (int32_t)__atomic_load_n(&q->rptr, __ATOMIC_RELAXED);
+#else
+    int32_t rc = (int32_t)*(volatile uint16_t *)&q->wptr - (int32_t)*(volatile uint16_t *)&q->rptr;
+#endif
     if (rc < 0) {
         rc += q->element_count + 1;
     }
@@ -95,6 +119,8 @@ static inline uint queue_get_level_unsafe(queue_t *q) {
  * \return Number of entries in the queue
  */
 static inline uint queue_get_level(queue_t *q) {
+    // the level of a single-producer/single-consumer queue is only ever a snapshot anyway
+    if (q->spsc) return queue_get_level_unsafe(q);
     uint32_t save = spin_lock_blocking(q->core.spin_lock);
     uint level = queue_get_level_unsafe(q);
     spin_unlock(q->core.spin_lock, save);
@@ -121,6 +147,10 @@ static inline uint queue_get_max_level(queue_t *q) {
  * \param q Pointer to a queue_t structure, used as a handle
  */
 static inline void queue_reset_max_level(queue_t *q) {
+    if (q->spsc) {
+        q->max_level = queue_get_level_unsafe(q);
+        return;
+    }
     uint32_t save = spin_lock_blocking(q->core.spin_lock);
     q->max_level = queue_get_level_unsafe(q);
     spin_unlock(q->core.spin_lock, save);
@@ -189,6 +219,82 @@ bool queue_try_remove(queue_t *q, void *data);
  */
 bool queue_try_peek(queue_t *q, void *data);
 
+// bulk and zero-copy queue access functions (all non-blocking):
+
+/*! \brief Non-blocking add of as many values as will fit in the queue, up to a maximum count
+ *  \ingroup queue
+ *
+ * All the values are added under a single acquisition of the queue's spin lock
+ *
+ * \param q Pointer to a queue_t structure, used as a handle
+ * \param data Pointer to an array of count values to be copied into the queue
+ * \param count Maximum number of values to add
+ * \return the number of values added (the first values in the array), which may be 0 if the queue is full
+ */
+uint queue_try_add_many(queue_t *q, const void *data, uint count);
+
+/*! \brief Non-blocking removal of as many values as are available in the queue, up to a maximum count
+ *  \ingroup queue
+ *
+ * All the values are removed under a single acquisition of the queue's spin lock
+ *
+ * \param q Pointer to a queue_t structure, used as a handle
+ * \param data Pointer to an array to receive up to count removed values, or NULL if the data isn't required
+ * \param count Maximum number of values to remove
+ * \return the number of values removed, which may be 0 if the queue is empty
+ */
+uint queue_try_remove_many(queue_t *q, void *data, uint count);
+
+/*! \brief Reserve space for values to be written in place at the back of the queue
+ *  \ingroup queue
+ *
+ * Returns a pointer directly into the queue's storage, at which up to *count contiguous values may be written.
+ * The values are not visible to consumers of the queue until they are added by \ref queue_commit_add.
+ *
+ * Only one reservation may be outstanding at a time, and values must not be added to the queue by other means
+ * until it is committed, so if there are multiple producers, they must serialize their use of this function
+ * and \ref queue_commit_add between themselves.
+ *
+ * \param q Pointer to a queue_t structure, used as a handle
+ * \param count On entry, the maximum number of values wanted; on return, the number of contiguous values
+ *              reserved (which may be fewer due to the queue being nearly full or wrapping around)
+ * \return pointer to the first reserved value, or NULL (leaving *count unchanged) if the queue is full
+ */
+void *queue_try_reserve_add(queue_t *q, uint *count);
+
+/*! \brief Add values previously written in place following \ref queue_try_reserve_add
+ *  \ingroup queue
+ *
+ * \param q Pointer to a queue_t structure, used as a handle
+ * \param count The number of values to add, which must be no more than were reserved
+ */
+void queue_commit_add(queue_t *q, uint count);
+
+/*! \brief Access values to be read in place at the front of the queue
+ *  \ingroup queue
+ *
+ * Returns a pointer directly into the queue's storage, from which up to *count contiguous values may be read.
+ * The values remain in the queue until they are removed by \ref queue_commit_remove.
+ *
+ * Only one reservation may be outstanding at a time, and values must not be removed from the queue by other
+ * means until it is committed, so if there are multiple consumers, they must serialize their use of this
+ * function and \ref queue_commit_remove between themselves.
+ *
+ * \param q Pointer to a queue_t structure, used as a handle
+ * \param count On entry, the maximum number of values wanted; on return, the number of contiguous values
+ *              available (which may be fewer due to the queue level or wrapping around)
+ * \return pointer to the first value, or NULL (leaving *count unchanged) if the queue is empty
+ */
+const void *queue_try_reserve_remove(queue_t *q, uint *count);
+
+/*! \brief Remove values previously read in place following \ref queue_try_reserve_remove
+ *  \ingroup queue
+ *
+ * \param q Pointer to a queue_t structure, used as a handle
+ * \param count The number of values to remove, which must be no more than were reserved
+ */
+void queue_commit_remove(queue_t *q, uint count);
+
 // blocking queue access functions:
 
 /*! \brief Blocking add of value to queue
@@ -221,6 +327,75 @@ void queue_remove_blocking(queue_t *q, void *data);
  */
 void queue_peek_blocking(queue_t *q, void *data);
 
+/*! \brief Blocking add of value to queue with timeout
+ *  \ingroup queue
+ *
+ * \param q Pointer to a queue_t structure, used as a handle
+ * \param data Pointer to value to be copied into the queue
+ * \param until The time after which to give up waiting for space in the queue
+ * \return true if the value was added, false if the timeout was reached first
+ *
+ * If the queue is full this function will block, until a removal happens on the queue or the timeout is reached.
+ * Any number of producers may block on the same (non single-producer/single-consumer) queue; they are all woken
+ * by each removal, and re-check the queue under its spin lock, so each free slot is used by exactly one of them.
+ */
+bool queue_add_block_until(queue_t *q, const void *data, absolute_time_t until);
+
+/*! \brief Blocking remove entry from queue with timeout
+ *  \ingroup queue
+ *
+ * \param q Pointer to a queue_t structure, used as a handle
+ * \param data Pointer to the location to receive the removed value, or NULL if the data isn't required
+ * \param until The time after which to give up waiting for a value
+ * \return true if a value was removed, false if the timeout was reached first
+ *
+ * If the queue is empty this function will block until a value is added or the timeout is reached.
+ * Any number of consumers may block on the same (non single-producer/single-consumer) queue; they are all woken
+ * by each addition, and re-check the queue under its spin lock, so each value is removed by exactly one of them.
+ */
+bool queue_remove_block_until(queue_t *q, void *data, absolute_time_t until);
+
+/*! \brief Blocking peek at next value to be removed from queue with timeout
+ *  \ingroup queue
+ *
+ * \param q Pointer to a queue_t structure, used as a handle
+ * \param data Pointer to the location to receive the peeked value, or NULL if the data isn't required
+ * \param until The time after which to give up waiting for a value
+ * \return true if there was a value to peek, false if the timeout was reached first
+ *
+ * If the queue is empty function will block until a value is added or the timeout is reached
+ */
+bool queue_peek_block_until(queue_t *q, void *data, absolute_time_t until);
+
+/*! \brief Block until the queue holds at least the specified number of values, or a timeout is reached
+ *  \ingroup queue
+ *
+ * This allows a consumer to wait for a batch of values to accumulate, and then remove them all at once
+ * with \ref queue_try_remove_many (or \ref queue_try_reserve_remove), rather than waking up to remove
+ * each value individually. No values are removed by this function.
+ *
+ * Note that if there are multiple consumers, other consumers may remove values between this function
+ * returning and the caller removing them.
+ *
+ * \param q Pointer to a queue_t structure, used as a handle
+ * \param level The number of values to wait for, which must be no more than the queue's element count
+ * \param until The time after which to give up waiting
+ * \return true if the queue level reached the specified level, false if the timeout was reached first
+ */
+bool queue_wait_for_level_until(queue_t *q, uint level, absolute_time_t until);
+
+/*! \brief Block until the queue holds at least the specified number of values
+ *  \ingroup queue
+ *
+ * \param q Pointer to a queue_t structure, used as a handle
+ * \param level The number of values to wait for, which must be no more than the queue's element count
+ *
+ * \sa queue_wait_for_level_until
+ */
+static inline void queue_wait_for_level_blocking(queue_t *q, uint level) {
+    queue_wait_for_level_until(q, level, at_the_end_of_time);
+}
+
 #ifdef __cplusplus
 }
 #endif
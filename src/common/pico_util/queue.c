@@ -15,6 +15,13 @@ void queue_init_with_spinlock(queue_t *q, uint element_size, uint element_count,
     q->element_size = (uint16_t)element_size;
     q->wptr = 0;
     q->rptr = 0;
+    q->spsc = false;
+}
+
+void queue_init_spsc(queue_t *q, uint element_size, uint element_count) {
+    // the spin lock is never used, but we initialize the lock_core so the queue_t is still well-formed
+    queue_init(q, element_size, element_count);
+    q->spsc = true;
 }
 
 void queue_free(queue_t *q) {
@@ -41,83 +48,326 @@ static inline uint16_t inc_index(queue_t *q, uint16_t index) {
     return index;
 }
 
-static bool queue_add_internal(queue_t *q, const void *data, bool block) {
+static inline uint16_t advance_index(queue_t *q, uint16_t index, uint n) {
+    uint next = index + n;
+    if (next > q->element_count) { // > because we have element_count + 1 elements
+        next -= q->element_count + 1u;
+    }
+    return (uint16_t)next;
+}
+
+static inline void update_max_level(__unused queue_t *q) {
+#if PICO_QUEUE_MAX_LEVEL
+    uint16_t level = (uint16_t)queue_get_level_unsafe(q);
+    if (level > q->max_level) {
+        q->max_level = level;
+    }
+#endif
+}
+
+// copy an element, letting the compiler use a single load/store for common small element sizes
+static inline void copy_element(queue_t *q, void *dst, const void *src) {
+    switch (q->element_size) {
+        case 1: memcpy(dst, src, 1); break;
+        case 2: memcpy(dst, src, 2); break;
+        case 4: memcpy(dst, src, 4); break;
+        case 8: memcpy(dst, src, 8); break;
+        default: memcpy(dst, src, q->element_size); break;
+    }
+}
+
+// Single-producer/single-consumer queues use no lock; each index is only ever written by one side, so
+// it is sufficient that the element is copied in before wptr is published (and copied out before rptr
+// is published), and that the other side's index is read before touching the element.
+
+static inline uint16_t spsc_load_index(const uint16_t *index) {
+#if defined(__GNUC__)
+    // (an atomic rather than volatile access, so that thread sanitizers on the host understand the ordering)
+    return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+#else
+    return *(const volatile uint16_t *)index;
+#endif
+}
+
+static inline void spsc_store_index(uint16_t *index, uint16_t value) {
+#if defined(__GNUC__)
+    __atomic_store_n(index, value, __ATOMIC_RELEASE);
+#else
+    *(volatile uint16_t *)index = value;
+#endif
+}
+
+// wait for the other side of a single-producer/single-consumer queue to make progress; returns false if
+// not blocking, or the timeout has been reached
+static bool queue_spsc_wait(bool block, absolute_time_t until) {
+    if (!block) return false;
+    if (is_at_the_end_of_time(until)) {
+        __wfe();
+        return true;
+    }
+    return !best_effort_wfe_or_timeout(until);
+}
+
+// wait (having found the queue not in the required state) with the spin lock held; the spin lock is always
+// released, and false is returned if not blocking, or the timeout has been reached
+static bool queue_wait_locked(queue_t *q, uint32_t save, bool block, absolute_time_t until) {
+    if (!block) {
+        spin_unlock(q->core.spin_lock, save);
+        return false;
+    }
+    if (is_at_the_end_of_time(until)) {
+        lock_internal_spin_unlock_with_wait(&q->core, save);
+        return true;
+    }
+    return !lock_internal_spin_unlock_with_best_effort_wait_or_timeout(&q->core, save, until);
+}
+
+static bool queue_spsc_add(queue_t *q, const void *data, bool block, absolute_time_t until) {
+    uint16_t wptr = q->wptr; // only written by us
+    uint16_t next_wptr = (uint16_t)(wptr == q->element_count ? 0 : wptr + 1);
+    while (next_wptr == spsc_load_index(&q->rptr)) {
+        if (!queue_spsc_wait(block, until)) return false;
+    }
+    // make sure the consumer has finished reading the element before we overwrite it
+    __mem_fence_acquire();
+    copy_element(q, element_ptr(q, wptr), data);
+    __mem_fence_release();
+    spsc_store_index(&q->wptr, next_wptr);
+    update_max_level(q);
+    __sev();
+    return true;
+}
+
+static bool queue_spsc_remove(queue_t *q, void *data, bool block, absolute_time_t until, bool peek) {
+    uint16_t rptr = q->rptr; // only written by us
+    while (rptr == spsc_load_index(&q->wptr)) {
+        if (!queue_spsc_wait(block, until)) return false;
+    }
+    // make sure the producer has finished writing the element before we read it
+    __mem_fence_acquire();
+    if (data) {
+        copy_element(q, data, element_ptr(q, rptr));
+    }
+    if (!peek) {
+        __mem_fence_release();
+        spsc_store_index(&q->rptr, (uint16_t)(rptr == q->element_count ? 0 : rptr + 1));
+        __sev();
+    }
+    return true;
+}
+
+static bool queue_add_internal(queue_t *q, const void *data, bool block, absolute_time_t until) {
+    if (q->spsc) return queue_spsc_add(q, data, block, until);
     do {
         uint32_t save = spin_lock_blocking(q->core.spin_lock);
         if (queue_get_level_unsafe(q) != q->element_count) {
-            memcpy(element_ptr(q, q->wptr), data, q->element_size);
+            copy_element(q, element_ptr(q, q->wptr), data);
             q->wptr = inc_index(q, q->wptr);
             lock_internal_spin_unlock_with_notify(&q->core, save);
             return true;
         }
-        if (block) {
-            lock_internal_spin_unlock_with_wait(&q->core, save);
-        } else {
-            spin_unlock(q->core.spin_lock, save);
+        if (!queue_wait_locked(q, save, block, until)) {
             return false;
         }
     } while (true);
 }
 
-static bool queue_remove_internal(queue_t *q, void *data, bool block) {
+static bool queue_remove_internal(queue_t *q, void *data, bool block, absolute_time_t until) {
+    if (q->spsc) return queue_spsc_remove(q, data, block, until, false);
     do {
         uint32_t save = spin_lock_blocking(q->core.spin_lock);
         if (queue_get_level_unsafe(q) != 0) {
             if (data) {
-                memcpy(data, element_ptr(q, q->rptr), q->element_size);
+                copy_element(q, data, element_ptr(q, q->rptr));
             }
             q->rptr = inc_index(q, q->rptr);
             lock_internal_spin_unlock_with_notify(&q->core, save);
             return true;
         }
-        if (block) {
-            lock_internal_spin_unlock_with_wait(&q->core, save);
-        } else {
-            spin_unlock(q->core.spin_lock, save);
+        if (!queue_wait_locked(q, save, block, until)) {
             return false;
         }
     } while (true);
 }
 
-static bool queue_peek_internal(queue_t *q, void *data, bool block) {
+static bool queue_peek_internal(queue_t *q, void *data, bool block, absolute_time_t until) {
+    if (q->spsc) return queue_spsc_remove(q, data, block, until, true);
     do {
         uint32_t save = spin_lock_blocking(q->core.spin_lock);
         if (queue_get_level_unsafe(q) != 0) {
             if (data) {
-                memcpy(data, element_ptr(q, q->rptr), q->element_size);
+                copy_element(q, data, element_ptr(q, q->rptr));
             }
             lock_internal_spin_unlock_with_notify(&q->core, save);
             return true;
         }
-        if (block) {
-            lock_internal_spin_unlock_with_wait(&q->core, save);
-        } else {
-            spin_unlock(q->core.spin_lock, save);
+        if (!queue_wait_locked(q, save, block, until)) {
             return false;
         }
     } while (true);
 }
 
+// The bulk and zero-copy functions below work on both kinds of queue; for a single-producer/single-consumer
+// queue the "lock" is a no-op, and the fences and index accesses provide the required ordering.
+
+static inline uint32_t queue_lock(queue_t *q) {
+    return q->spsc ? 0 : spin_lock_blocking(q->core.spin_lock);
+}
+
+static inline void queue_unlock(queue_t *q, uint32_t save, bool notify) {
+    if (q->spsc) {
+        if (notify) __sev();
+    } else if (notify) {
+        lock_internal_spin_unlock_with_notify(&q->core, save);
+    } else {
+        spin_unlock(q->core.spin_lock, save);
+    }
+}
+
+static inline uint queue_get_free_unsafe(queue_t *q) {
+    return q->element_count - queue_get_level_unsafe(q);
+}
+
+// copy n elements into the queue starting at index, handling wrap-around
+static void copy_elements_in(queue_t *q, uint16_t index, const uint8_t *src, uint n) {
+    uint first = MIN(n, q->element_count + 1u - index);
+    memcpy(element_ptr(q, index), src, first * q->element_size);
+    if (n > first) {
+        memcpy(q->data, src + first * q->element_size, (n - first) * q->element_size);
+    }
+}
+
+// copy n elements out of the queue starting at index, handling wrap-around
+static void copy_elements_out(queue_t *q, uint16_t index, uint8_t *dst, uint n) {
+    uint first = MIN(n, q->element_count + 1u - index);
+    memcpy(dst, element_ptr(q, index), first * q->element_size);
+    if (n > first) {
+        memcpy(dst + first * q->element_size, q->data, (n - first) * q->element_size);
+    }
+}
+
+uint queue_try_add_many(queue_t *q, const void *data, uint count) {
+    uint32_t save = queue_lock(q);
+    uint n = MIN(count, queue_get_free_unsafe(q));
+    if (n) {
+        // make sure any removal of the elements we are about to overwrite has completed
+        __mem_fence_acquire();
+        copy_elements_in(q, q->wptr, (const uint8_t *)data, n);
+        __mem_fence_release();
+        spsc_store_index(&q->wptr, advance_index(q, q->wptr, n));
+        update_max_level(q);
+    }
+    queue_unlock(q, save, n != 0);
+    return n;
+}
+
+uint queue_try_remove_many(queue_t *q, void *data, uint count) {
+    uint32_t save = queue_lock(q);
+    uint n = MIN(count, queue_get_level_unsafe(q));
+    if (n) {
+        // make sure the addition of the elements we are about to read has completed
+        __mem_fence_acquire();
+        if (data) {
+            copy_elements_out(q, q->rptr, (uint8_t *)data, n);
+        }
+        __mem_fence_release();
+        spsc_store_index(&q->rptr, advance_index(q, q->rptr, n));
+    }
+    queue_unlock(q, save, n != 0);
+    return n;
+}
+
+void *queue_try_reserve_add(queue_t *q, uint *count) {
+    uint32_t save = queue_lock(q);
+    uint16_t wptr = q->wptr;
+    uint n = MIN(MIN(*count, queue_get_free_unsafe(q)), q->element_count + 1u - wptr);
+    queue_unlock(q, save, false);
+    if (!n) return NULL;
+    __mem_fence_acquire();
+    *count = n;
+    return element_ptr(q, wptr);
+}
+
+void queue_commit_add(queue_t *q, uint count) {
+    uint32_t save = queue_lock(q);
+    assert(count <= queue_get_free_unsafe(q));
+    __mem_fence_release();
+    spsc_store_index(&q->wptr, advance_index(q, q->wptr, count));
+    update_max_level(q);
+    queue_unlock(q, save, true);
+}
+
+const void *queue_try_reserve_remove(queue_t *q, uint *count) {
+    uint32_t save = queue_lock(q);
+    uint16_t rptr = q->rptr;
+    uint n = MIN(MIN(*count, queue_get_level_unsafe(q)), q->element_count + 1u - rptr);
+    queue_unlock(q, save, false);
+    if (!n) return NULL;
+    __mem_fence_acquire();
+    *count = n;
+    return element_ptr(q, rptr);
+}
+
+void queue_commit_remove(queue_t *q, uint count) {
+    uint32_t save = queue_lock(q);
+    assert(count <= queue_get_level_unsafe(q));
+    __mem_fence_release();
+    spsc_store_index(&q->rptr, advance_index(q, q->rptr, count));
+    queue_unlock(q, save, true);
+}
+
 bool queue_try_add(queue_t *q, const void *data) {
-    return queue_add_internal(q, data, false);
+    return queue_add_internal(q, data, false, at_the_end_of_time);
 }
 
 bool queue_try_remove(queue_t *q, void *data) {
-    return queue_remove_internal(q, data, false);
+    return queue_remove_internal(q, data, false, at_the_end_of_time);
 }
 
 bool queue_try_peek(queue_t *q, void *data) {
-    return queue_peek_internal(q, data, false);
+    return queue_peek_internal(q, data, false, at_the_end_of_time);
 }
 
 void queue_add_blocking(queue_t *q, const void *data) {
-    queue_add_internal(q, data, true);
+    queue_add_internal(q, data, true, at_the_end_of_time);
 }
 
 void queue_remove_blocking(queue_t *q, void *data) {
-    queue_remove_internal(q, data, true);
+    queue_remove_internal(q, data, true, at_the_end_of_time);
 }
 
 void queue_peek_blocking(queue_t *q, void *data) {
-    queue_peek_internal(q, data, true);
+    queue_peek_internal(q, data, true, at_the_end_of_time);
+}
+
+bool queue_add_block_until(queue_t *q, const void *data, absolute_time_t until) {
+    return queue_add_internal(q, data, true, until);
+}
+
+bool queue_remove_block_until(queue_t *q, void *data, absolute_time_t until) {
+    return queue_remove_internal(q, data, true, until);
+}
+
+bool queue_peek_block_until(queue_t *q, void *data, absolute_time_t until) {
+    return queue_peek_internal(q, data, true, until);
+}
+
+bool queue_wait_for_level_until(queue_t *q, uint level, absolute_time_t until) {
+    assert(level <= q->element_count);
+    if (q->spsc) {
+        while (queue_get_level_unsafe(q) < level) {
+            if (!queue_spsc_wait(true, until)) return false;
+        }
+        return true;
+    }
+    do {
+        uint32_t save = spin_lock_blocking(q->core.spin_lock);
+        if (queue_get_level_unsafe(q) >= level) {
+            spin_unlock(q->core.spin_lock, save);
+            return true;
+        }
+        if (!queue_wait_locked(q, save, true, until)) {
+            return false;
+        }
+    } while (true);
 }
@@ -1,6 +1,7 @@
 set(CMAKE_DIR cmake)
 set(COMMON_DIR common)
 set(HOST_DIR host)
+set(RP2_COMMON_DIR rp2_common)
 
 include (${CMAKE_DIR}/no_hardware.cmake)
 
@@ -16,6 +17,7 @@ include (${CMAKE_DIR}/no_hardware.cmake)
  pico_add_subdirectory(${COMMON_DIR}/pico_binary_info)
  pico_add_subdirectory(${COMMON_DIR}/pico_divider_headers)
  pico_add_subdirectory(${COMMON_DIR}/pico_sync)
+ pico_add_subdirectory(${COMMON_DIR}/pico_stdio_log)
  pico_add_subdirectory(${COMMON_DIR}/pico_time)
  pico_add_subdirectory(${COMMON_DIR}/pico_util)
  pico_add_subdirectory(${COMMON_DIR}/pico_stdlib_headers)
@@ -39,6 +41,10 @@ include (${CMAKE_DIR}/no_hardware.cmake)
  pico_add_subdirectory(${HOST_DIR}/pico_stdlib)
  pico_add_subdirectory(${HOST_DIR}/pico_time_adapter)
 
+# shared with rp2_common (note only the async_context types which don't use hardware IRQs are usable on host)
+ pico_add_subdirectory(${RP2_COMMON_DIR}/pico_async_context)
+
 unset(CMAKE_DIR)
 unset(COMMON_DIR)
-unset(HOST_DIR)
\ No newline at end of file
+unset(HOST_DIR)
+unset(RP2_COMMON_DIR)
\ No newline at end of file
@@ -152,6 +152,28 @@ void spin_lock_unclaim(uint lock_num);
 int spin_lock_claim_unused(bool required);
 uint spin_lock_num(spin_lock_t *lock);
 
+// host only: returns true if the calling thread has interrupts disabled
+bool host_interrupts_are_disabled(void);
+
+// host only: make the calling thread the thread for the given core (also setting its core number); the main
+// thread is core 0
+void host_set_core_thread(uint core_num);
+
+// host only: called by a core's thread before it exits
+void host_clear_core_thread(uint core_num);
+
+// host only: set the handler for "core IRQs" raised on the given core by host_raise_core_irq. The handler is called
+// on the core's own thread at the next safe point where the core has interrupts enabled: when it enables interrupts,
+// in __wfe, __sev or tight_loop_contents, or in host_check_core_irq. A core spinning without reaching a safe point
+// is never interrupted
+void host_set_core_irq_handler(uint core_num, void (*handler)(void));
+
+// host only: mark a core IRQ pending on the given core, and wake the core if it is in __wfe
+void host_raise_core_irq(uint core_num);
+
+// host only: a safe point at which the calling core runs its core IRQ handler if one is pending
+void host_check_core_irq(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2020 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "hardware/sync.h"
+#include "hardware/platform_defs.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#define HOST_THREADS 1
+#endif
+
+// Each core is a thread (core 0 being the main thread, and core 1 being started by pico_multicore), and emulated
+// IRQs (e.g. the timer alarm IRQs) are handled on their own threads, which take on the core number of the core
+// the IRQ is targeted at while calling the handler.
+//
+// Each core has its own "interrupts disabled" mutex. Disabling interrupts takes the mutex for the calling thread's
+// core, and IRQ emulation also holds it while calling an IRQ handler, so that the handler cannot run concurrently
+// with code on that core which has interrupts disabled (including code holding a spin lock via spin_lock_blocking),
+// just as on the device. Code on the other core is unaffected.
+//
+// A core may also be interrupted on its own thread (a "core IRQ", used by pico_multicore for lockout and resetting
+// core 1). Rather than using a signal (as the handler needs to take locks, and may not return), raising a core IRQ
+// just marks it pending and sends an event; the core's thread calls the handler at the next "safe point" where it has
+// interrupts enabled and holds no internal locks: when it enables interrupts, in __wfe, __sev and tight_loop_contents,
+// or via host_check_core_irq (which pico_multicore calls when polling the FIFO status).
+
+static struct _spin_lock_t {
+    bool locked;
+} _spinlocks[NUM_SPIN_LOCKS];
+
+static uint8_t striped_spin_lock_num = PICO_SPINLOCK_ID_STRIPED_FIRST;
+
+#if HOST_THREADS
+static_assert(NUM_CORES == 2, "");
+static pthread_mutex_t interrupts_mutex[NUM_CORES] = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER };
+static __thread volatile bool interrupts_disabled;
+static __thread uint interrupts_disabled_core;
+
+static pthread_mutex_t event_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t event_cond = PTHREAD_COND_INITIALIZER;
+// each thread has its own event "register", which is set if the event count has changed since it last did a WFE
+static uint32_t event_count;
+static uint32_t event_waiters;
+static __thread uint32_t event_count_seen;
+
+static bool core_thread_valid[NUM_CORES];
+static void (*core_irq_handlers[NUM_CORES])(void);
+static bool core_irq_pending[NUM_CORES];
+// the core number + 1 if this thread is a core's own thread (rather than an IRQ thread), or 0
+static __thread uint core_thread_num_plus_one;
+static __thread bool in_core_irq;
+
+static void run_pending_core_irq(void) {
+    if (!core_thread_num_plus_one || interrupts_disabled || in_core_irq) return;
+    uint core_num = core_thread_num_plus_one - 1;
+    while (__atomic_exchange_n(&core_irq_pending[core_num], false, __ATOMIC_ACQUIRE)) {
+        void (*handler)(void) = __atomic_load_n(&core_irq_handlers[core_num], __ATOMIC_ACQUIRE);
+        if (handler) {
+            // the handler may not return (when resetting core 1), in which case the thread exits
+            in_core_irq = true;
+            handler();
+            in_core_irq = false;
+        }
+    }
+}
+
+// the main thread is core 0
+static void __attribute__((constructor)) host_core0_thread_init(void) {
+    host_set_core_thread(0);
+}
+#endif
+
+PICO_WEAK_FUNCTION_DEF(save_and_disable_interrupts)
+
+uint32_t PICO_WEAK_FUNCTION_IMPL_NAME(save_and_disable_interrupts)() {
+#if HOST_THREADS
+    // as with PRIMASK, the return value is 1 if interrupts were already disabled
+    if (interrupts_disabled) return 1;
+    interrupts_disabled = true;
+    interrupts_disabled_core = get_core_num();
+    pthread_mutex_lock(&interrupts_mutex[interrupts_disabled_core]);
+#endif
+    return 0;
+}
+
+PICO_WEAK_FUNCTION_DEF(restore_interrupts)
+
+void PICO_WEAK_FUNCTION_IMPL_NAME(restore_interrupts)(uint32_t status) {
+    if (!status) enable_interrupts();
+}
+
+PICO_WEAK_FUNCTION_DEF(restore_interrupts_from_disabled)
+
+void PICO_WEAK_FUNCTION_IMPL_NAME(restore_interrupts_from_disabled)(uint32_t status) {
+    if (!status) enable_interrupts();
+}
+
+PICO_WEAK_FUNCTION_DEF(disable_interrupts)
+
+void PICO_WEAK_FUNCTION_IMPL_NAME(disable_interrupts)(void) {
+    save_and_disable_interrupts();
+}
+
+PICO_WEAK_FUNCTION_DEF(enable_interrupts)
+
+void PICO_WEAK_FUNCTION_IMPL_NAME(enable_interrupts)(void) {
+#if HOST_THREADS
+    if (interrupts_disabled) {
+        pthread_mutex_unlock(&interrupts_mutex[interrupts_disabled_core]);
+        interrupts_disabled = false;
+        run_pending_core_irq();
+    }
+#endif
+}
+
+bool host_interrupts_are_disabled(void) {
+#if HOST_THREADS
+    return interrupts_disabled;
+#else
+    return false;
+#endif
+}
+
+PICO_WEAK_FUNCTION_DEF(spin_lock_instance)
+
+spin_lock_t *PICO_WEAK_FUNCTION_IMPL_NAME(spin_lock_instance)(uint lock_num) {
+    assert(lock_num < NUM_SPIN_LOCKS);
+    return &_spinlocks[lock_num];
+}
+
+PICO_WEAK_FUNCTION_DEF(spin_lock_get_num)
+
+uint PICO_WEAK_FUNCTION_IMPL_NAME(spin_lock_get_num)(spin_lock_t *lock) {
+    return lock - _spinlocks;
+}
+
+PICO_WEAK_FUNCTION_DEF(spin_lock_init)
+
+spin_lock_t *PICO_WEAK_FUNCTION_IMPL_NAME(spin_lock_init)(uint lock_num) {
+    spin_lock_t *lock = spin_lock_instance(lock_num);
+    spin_unlock_unsafe(lock);
+    return lock;
+}
+
+PICO_WEAK_FUNCTION_DEF(spin_lock_unsafe_blocking)
+
+void PICO_WEAK_FUNCTION_IMPL_NAME(spin_lock_unsafe_blocking)(spin_lock_t *lock) {
+    while (__atomic_test_and_set(&lock->locked, __ATOMIC_ACQUIRE)) {
+        // spin without writing, as the hardware does
+        while (__atomic_load_n(&lock->locked, __ATOMIC_RELAXED)) {
+            tight_loop_contents();
+        }
+    }
+}
+
+PICO_WEAK_FUNCTION_DEF(spin_lock_blocking)
+
+uint32_t PICO_WEAK_FUNCTION_IMPL_NAME(spin_lock_blocking)(spin_lock_t *lock) {
+    uint32_t save = save_and_disable_interrupts();
+    spin_lock_unsafe_blocking(lock);
+    return save;
+}
+
+PICO_WEAK_FUNCTION_DEF(is_spin_locked)
+
+bool PICO_WEAK_FUNCTION_IMPL_NAME(is_spin_locked)(const spin_lock_t *lock) {
+    return __atomic_load_n(&lock->locked, __ATOMIC_RELAXED);
+}
+
+PICO_WEAK_FUNCTION_DEF(spin_unlock_unsafe)
+
+void PICO_WEAK_FUNCTION_IMPL_NAME(spin_unlock_unsafe)(spin_lock_t *lock) {
+    __atomic_clear(&lock->locked, __ATOMIC_RELEASE);
+}
+
+PICO_WEAK_FUNCTION_DEF(spin_unlock)
+
+void PICO_WEAK_FUNCTION_IMPL_NAME(spin_unlock)(spin_lock_t *lock, uint32_t saved_irq) {
+    spin_unlock_unsafe(lock);
+    restore_interrupts(saved_irq);
+}
+
+PICO_WEAK_FUNCTION_DEF(__sev)
+
+void PICO_WEAK_FUNCTION_IMPL_NAME(__sev)() {
+#if HOST_THREADS
+    __atomic_add_fetch(&event_count, 1, __ATOMIC_SEQ_CST);
+    // only take the mutex if someone is waiting; a waiter increments event_waiters before checking event_count
+    if (__atomic_load_n(&event_waiters, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&event_mutex);
+        pthread_cond_broadcast(&event_cond);
+        pthread_mutex_unlock(&event_mutex);
+    }
+    run_pending_core_irq();
+#endif
+}
+
+PICO_WEAK_FUNCTION_DEF(__wfi)
+
+void PICO_WEAK_FUNCTION_IMPL_NAME(__wfi)() {
+    panic("Can't wait on irq for host implementation");
+}
+
+PICO_WEAK_FUNCTION_DEF(__wfe)
+
+void PICO_WEAK_FUNCTION_IMPL_NAME(__wfe)() {
+#if HOST_THREADS
+    // a pending core IRQ wakes the core, as an IRQ does on the device
+    run_pending_core_irq();
+    uint32_t count = __atomic_load_n(&event_count, __ATOMIC_SEQ_CST);
+    if (count == event_count_seen) {
+        pthread_mutex_lock(&event_mutex);
+        __atomic_add_fetch(&event_waiters, 1, __ATOMIC_SEQ_CST);
+        while ((count = __atomic_load_n(&event_count, __ATOMIC_SEQ_CST)) == event_count_seen) {
+            pthread_cond_wait(&event_cond, &event_mutex);
+        }
+        __atomic_sub_fetch(&event_waiters, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&event_mutex);
+    }
+    event_count_seen = count;
+    run_pending_core_irq();
+#else
+    panic("Can't wait for event without threads");
+#endif
+}
+
+void host_set_core_thread(uint core_num) {
+    assert(core_num < NUM_CORES);
+    host_set_core_num(core_num);
+#if HOST_THREADS
+    core_thread_num_plus_one = core_num + 1;
+    __atomic_store_n(&core_thread_valid[core_num], true, __ATOMIC_RELEASE);
+#endif
+}
+
+void host_clear_core_thread(uint core_num) {
+    assert(core_num < NUM_CORES);
+#if HOST_THREADS
+    __atomic_store_n(&core_thread_valid[core_num], false, __ATOMIC_RELEASE);
+    core_thread_num_plus_one = 0;
+    __atomic_store_n(&core_irq_pending[core_num], false, __ATOMIC_RELAXED);
+#endif
+}
+
+void host_set_core_irq_handler(uint core_num, void (*handler)(void)) {
+    assert(core_num < NUM_CORES);
+#if HOST_THREADS
+    __atomic_store_n(&core_irq_handlers[core_num], handler, __ATOMIC_RELEASE);
+#else
+    ((void)handler);
+#endif
+}
+
+void host_raise_core_irq(uint core_num) {
+    assert(core_num < NUM_CORES);
+#if HOST_THREADS
+    if (__atomic_load_n(&core_thread_valid[core_num], __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&core_irq_pending[core_num], true, __ATOMIC_RELEASE);
+        // wake the core if it is in __wfe, so that it runs the handler
+        __sev();
+    }
+#endif
+}
+
+void host_check_core_irq(void) {
+#if HOST_THREADS
+    run_pending_core_irq();
+#endif
+}
+
+// tight_loop_contents (which is weak in pico_platform) is a safe point for core IRQs, so that a core spinning in a
+// loop can still be locked out or reset
+void tight_loop_contents() {
+    host_check_core_irq();
+}
+
+PICO_WEAK_FUNCTION_DEF(clear_spin_locks)
+
+void PICO_WEAK_FUNCTION_IMPL_NAME(clear_spin_locks)(void) {
+    for (uint i = 0; i < NUM_SPIN_LOCKS; i++) {
+        spin_unlock_unsafe(spin_lock_instance(i));
+    }
+}
+
+PICO_WEAK_FUNCTION_DEF(next_striped_spin_lock_num)
+uint PICO_WEAK_FUNCTION_IMPL_NAME(next_striped_spin_lock_num)() {
+    uint8_t rc = __atomic_load_n(&striped_spin_lock_num, __ATOMIC_RELAXED);
+    uint8_t next;
+    do {
+        next = rc == PICO_SPINLOCK_ID_STRIPED_LAST ? PICO_SPINLOCK_ID_STRIPED_FIRST : (uint8_t)(rc + 1);
+    } while (!__atomic_compare_exchange_n(&striped_spin_lock_num, &rc, next, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return rc;
+}
+
+PICO_WEAK_FUNCTION_DEF(spin_lock_claim)
+void PICO_WEAK_FUNCTION_IMPL_NAME(spin_lock_claim)(uint lock_num) {
+}
+
+PICO_WEAK_FUNCTION_DEF(spin_lock_claim_mask)
+void PICO_WEAK_FUNCTION_IMPL_NAME(spin_lock_claim_mask)(uint32_t mask) {
+}
+
+PICO_WEAK_FUNCTION_DEF(spin_lock_unclaim)
+void PICO_WEAK_FUNCTION_IMPL_NAME(spin_lock_unclaim)(uint lock_num) {
+}
+
+PICO_WEAK_FUNCTION_DEF(spin_lock_claim_unused)
+int PICO_WEAK_FUNCTION_IMPL_NAME(spin_lock_claim_unused)(bool required) {
+    return 0;
+}
+
+PICO_WEAK_FUNCTION_DEF(spin_lock_num)
+uint PICO_WEAK_FUNCTION_IMPL_NAME(spin_lock_num)(spin_lock_t *lock) {
+    return 0;
+}
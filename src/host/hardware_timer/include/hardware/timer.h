@@ -41,6 +41,18 @@ void hardware_alarm_set_callback(uint alarm_num, hardware_alarm_callback_t callb
 bool hardware_alarm_set_target(uint alarm_num, absolute_time_t t);
 void hardware_alarm_cancel(uint alarm_num);
 void hardware_alarm_force_irq(uint alarm_num);
+
+// Host only: the alarm IRQs are emulated by a timer thread which calls an alarm's IRQ handler for as long as
+// the alarm has fired (or the IRQ has been forced) and the IRQ has not been cleared. The following are used by
+// the host pico_time_adapter to drive alarm pools directly from the emulated IRQs
+typedef void (*hardware_alarm_irq_handler_t)(void);
+void hardware_alarm_set_irq_handler(uint alarm_num, hardware_alarm_irq_handler_t irq_handler);
+// arm the alarm to fire at target (immediately if target has already passed)
+void hardware_alarm_arm(uint alarm_num, uint64_t target);
+// returns true, and the target time, if the alarm is armed
+bool hardware_alarm_get_armed_target(uint alarm_num, uint64_t *target);
+void hardware_alarm_clear_irq(uint alarm_num);
+void hardware_alarm_clear_force_irq(uint alarm_num);
 #ifdef __cplusplus
 }
 #endif
@@ -53,8 +53,8 @@ uint64_t PICO_WEAK_FUNCTION_IMPL_NAME(time_us_64)() {
 #endif
 }
 
-PICO_WEAK_FUNCTION_DEF(timer_us_32)
-uint32_t PICO_WEAK_FUNCTION_IMPL_NAME(timer_us_32)() {
+PICO_WEAK_FUNCTION_DEF(time_us_32)
+uint32_t PICO_WEAK_FUNCTION_IMPL_NAME(time_us_32)() {
     return (uint32_t) time_us_64();
 }
 
@@ -85,6 +85,253 @@ void PICO_WEAK_FUNCTION_IMPL_NAME(busy_wait_until)(absolute_time_t target) {
 #endif
 }
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include "hardware/sync.h"
+
+// The alarm IRQs are emulated by a timer thread, which calls an alarm's IRQ handler (as the core which set the
+// handler, with interrupts disabled on that core, see save_and_disable_interrupts) for as long as the alarm has fired,
+// or its IRQ is forced, and the IRQ has not been cleared
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_once_t once;
+    uint8_t claimed;
+    uint8_t armed;
+    uint8_t irq_pending;
+    uint8_t irq_forced;
+    uint64_t target[NUM_ALARMS];
+    hardware_alarm_irq_handler_t irq_handlers[NUM_ALARMS];
+    uint8_t irq_cores[NUM_ALARMS];
+    hardware_alarm_callback_t callbacks[NUM_ALARMS];
+} alarm_state = {
+        .mutex = PTHREAD_MUTEX_INITIALIZER,
+        .once = PTHREAD_ONCE_INIT,
+};
+
+static void alarm_thread_wait_until(uint64_t target) {
+#ifdef __APPLE__
+    uint64_t now = time_us_64();
+    if (target <= now) return;
+    struct timespec ts = {
+            .tv_sec = (time_t)((target - now) / 1000000),
+            .tv_nsec = (long)((target - now) % 1000000) * 1000,
+    };
+    pthread_cond_timedwait_relative_np(&alarm_state.cond, &alarm_state.mutex, &ts);
+#else
+    // the condition variable uses CLOCK_MONOTONIC, the same clock as time_us_64
+    struct timespec ts = {
+            .tv_sec = (time_t)(target / 1000000),
+            .tv_nsec = (long)(target % 1000000) * 1000,
+    };
+    pthread_cond_timedwait(&alarm_state.cond, &alarm_state.mutex, &ts);
+#endif
+}
+
+static void *alarm_thread(__unused void *arg) {
+    pthread_mutex_lock(&alarm_state.mutex);
+    while (true) {
+        uint64_t now = time_us_64();
+        uint64_t next_target = UINT64_MAX;
+        for (uint alarm_num = 0; alarm_num < NUM_ALARMS; alarm_num++) {
+            if (alarm_state.armed & (1u << alarm_num)) {
+                if (alarm_state.target[alarm_num] <= now) {
+                    // the alarm fires, disarming itself
+                    alarm_state.armed &= (uint8_t)~(1u << alarm_num);
+                    alarm_state.irq_pending |= (uint8_t)(1u << alarm_num);
+                } else if (alarm_state.target[alarm_num] < next_target) {
+                    next_target = alarm_state.target[alarm_num];
+                }
+            }
+        }
+        uint irqs = alarm_state.irq_pending | alarm_state.irq_forced;
+        uint alarm_num;
+        for (alarm_num = 0; alarm_num < NUM_ALARMS; alarm_num++) {
+            if ((irqs & (1u << alarm_num)) && alarm_state.irq_handlers[alarm_num]) break;
+        }
+        if (alarm_num < NUM_ALARMS) {
+            // the lowest numbered alarm wins, as if it had the highest IRQ priority
+            hardware_alarm_irq_handler_t handler = alarm_state.irq_handlers[alarm_num];
+            uint core_num = alarm_state.irq_cores[alarm_num];
+            pthread_mutex_unlock(&alarm_state.mutex);
+            // run the handler as the core the IRQ is targeted at
+            host_set_core_num(core_num);
+            uint32_t save = save_and_disable_interrupts();
+            uint prev_exception = host_set_current_exception(VTABLE_FIRST_IRQ + alarm_num);
+            handler();
+            host_set_current_exception(prev_exception);
+            restore_interrupts(save);
+            pthread_mutex_lock(&alarm_state.mutex);
+        } else if (next_target == UINT64_MAX) {
+            pthread_cond_wait(&alarm_state.cond, &alarm_state.mutex);
+        } else {
+            alarm_thread_wait_until(next_target);
+        }
+    }
+    return NULL;
+}
+
+static void alarm_thread_start(void) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+#ifndef __APPLE__
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+    pthread_cond_init(&alarm_state.cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, alarm_thread, NULL)) {
+        panic("Failed to create timer thread");
+    }
+    pthread_detach(thread);
+}
+
+// lock the alarm state, starting the timer thread if need be. Interrupts are disabled while the state is locked,
+// as the timer registers would be accessed atomically on the device, so the calling core must not be locked out (or
+// reset) by the other core while holding the mutex
+static uint32_t alarm_state_lock(void) {
+    pthread_once(&alarm_state.once, alarm_thread_start);
+    uint32_t save = save_and_disable_interrupts();
+    pthread_mutex_lock(&alarm_state.mutex);
+    return save;
+}
+
+static void alarm_state_unlock(uint32_t save) {
+    pthread_mutex_unlock(&alarm_state.mutex);
+    restore_interrupts(save);
+}
+
+// unlock the alarm state, waking the timer thread to re-evaluate it
+static void alarm_state_unlock_and_notify(uint32_t save) {
+    pthread_cond_signal(&alarm_state.cond);
+    alarm_state_unlock(save);
+}
+
+void hardware_alarm_claim(uint alarm_num) {
+    check_hardware_alarm_num_param(alarm_num);
+    uint32_t save = alarm_state_lock();
+    if (alarm_state.claimed & (1u << alarm_num)) {
+        panic("Hardware alarm %d already claimed", alarm_num);
+    }
+    alarm_state.claimed |= (uint8_t)(1u << alarm_num);
+    alarm_state_unlock(save);
+}
+
+void hardware_alarm_unclaim(uint alarm_num) {
+    check_hardware_alarm_num_param(alarm_num);
+    uint32_t save = alarm_state_lock();
+    assert(alarm_state.claimed & (1u << alarm_num));
+    alarm_state.claimed &= (uint8_t)~(1u << alarm_num);
+    alarm_state_unlock(save);
+}
+
+int hardware_alarm_claim_unused(bool required) {
+    int alarm_num = -1;
+    uint32_t save = alarm_state_lock();
+    for (uint i = 0; i < NUM_ALARMS; i++) {
+        if (!(alarm_state.claimed & (1u << i))) {
+            alarm_state.claimed |= (uint8_t)(1u << i);
+            alarm_num = (int)i;
+            break;
+        }
+    }
+    alarm_state_unlock(save);
+    if (alarm_num < 0 && required) {
+        panic("No hardware alarms available");
+    }
+    return alarm_num;
+}
+
+void hardware_alarm_set_irq_handler(uint alarm_num, hardware_alarm_irq_handler_t irq_handler) {
+    check_hardware_alarm_num_param(alarm_num);
+    uint32_t save = alarm_state_lock();
+    alarm_state.irq_handlers[alarm_num] = irq_handler;
+    // as on the device, the IRQ is taken on the core which enabled it
+    alarm_state.irq_cores[alarm_num] = (uint8_t)get_core_num();
+    alarm_state_unlock_and_notify(save);
+}
+
+void hardware_alarm_arm(uint alarm_num, uint64_t target) {
+    check_hardware_alarm_num_param(alarm_num);
+    uint32_t save = alarm_state_lock();
+    alarm_state.target[alarm_num] = target;
+    alarm_state.armed |= (uint8_t)(1u << alarm_num);
+    alarm_state_unlock_and_notify(save);
+}
+
+bool hardware_alarm_get_armed_target(uint alarm_num, uint64_t *target) {
+    check_hardware_alarm_num_param(alarm_num);
+    uint32_t save = alarm_state_lock();
+    bool armed = alarm_state.armed & (1u << alarm_num);
+    if (armed) *target = alarm_state.target[alarm_num];
+    alarm_state_unlock(save);
+    return armed;
+}
+
+void hardware_alarm_clear_irq(uint alarm_num) {
+    check_hardware_alarm_num_param(alarm_num);
+    uint32_t save = alarm_state_lock();
+    alarm_state.irq_pending &= (uint8_t)~(1u << alarm_num);
+    alarm_state_unlock(save);
+}
+
+void hardware_alarm_clear_force_irq(uint alarm_num) {
+    check_hardware_alarm_num_param(alarm_num);
+    uint32_t save = alarm_state_lock();
+    alarm_state.irq_forced &= (uint8_t)~(1u << alarm_num);
+    alarm_state_unlock(save);
+}
+
+static void hardware_alarm_irq_handler(void) {
+    uint alarm_num = __get_current_exception() - VTABLE_FIRST_IRQ;
+    hardware_alarm_callback_t callback = NULL;
+    uint32_t save = alarm_state_lock();
+    alarm_state.irq_pending &= (uint8_t)~(1u << alarm_num);
+    alarm_state.irq_forced &= (uint8_t)~(1u << alarm_num);
+    callback = alarm_state.callbacks[alarm_num];
+    alarm_state_unlock(save);
+    if (callback) callback(alarm_num);
+}
+
+PICO_WEAK_FUNCTION_DEF(hardware_alarm_set_callback)
+void PICO_WEAK_FUNCTION_IMPL_NAME(hardware_alarm_set_callback)(uint alarm_num, hardware_alarm_callback_t callback) {
+    check_hardware_alarm_num_param(alarm_num);
+    uint32_t save = alarm_state_lock();
+    alarm_state.callbacks[alarm_num] = callback;
+    alarm_state.irq_handlers[alarm_num] = callback ? hardware_alarm_irq_handler : NULL;
+    alarm_state.irq_cores[alarm_num] = (uint8_t)get_core_num();
+    if (!callback) alarm_state.armed &= (uint8_t)~(1u << alarm_num);
+    alarm_state_unlock_and_notify(save);
+}
+
+PICO_WEAK_FUNCTION_DEF(hardware_alarm_set_target)
+bool PICO_WEAK_FUNCTION_IMPL_NAME(hardware_alarm_set_target)(uint alarm_num, absolute_time_t target) {
+    // as on device, return true (and don't arm the alarm) if the target has already passed
+    if (time_reached(target)) {
+        hardware_alarm_cancel(alarm_num);
+        return true;
+    }
+    hardware_alarm_arm(alarm_num, to_us_since_boot(target));
+    return false;
+}
+
+PICO_WEAK_FUNCTION_DEF(hardware_alarm_cancel)
+void PICO_WEAK_FUNCTION_IMPL_NAME(hardware_alarm_cancel)(uint alarm_num) {
+    check_hardware_alarm_num_param(alarm_num);
+    uint32_t save = alarm_state_lock();
+    alarm_state.armed &= (uint8_t)~(1u << alarm_num);
+    alarm_state_unlock(save);
+}
+
+PICO_WEAK_FUNCTION_DEF(hardware_alarm_force_irq)
+void PICO_WEAK_FUNCTION_IMPL_NAME(hardware_alarm_force_irq)(uint alarm_num) {
+    check_hardware_alarm_num_param(alarm_num);
+    uint32_t save = alarm_state_lock();
+    alarm_state.irq_forced |= (uint8_t)(1u << alarm_num);
+    alarm_state_unlock_and_notify(save);
+}
+
+#else
 static uint8_t claimed_alarms;
 
 void hardware_alarm_claim(uint alarm_num) {
@@ -104,6 +351,24 @@ int hardware_alarm_claim_unused(bool required) {
     return alarm_id;
 }
 
+void hardware_alarm_set_irq_handler(uint alarm_num, hardware_alarm_irq_handler_t irq_handler) {
+    panic_unsupported();
+}
+
+void hardware_alarm_arm(uint alarm_num, uint64_t target) {
+    panic_unsupported();
+}
+
+bool hardware_alarm_get_armed_target(uint alarm_num, uint64_t *target) {
+    return false;
+}
+
+void hardware_alarm_clear_irq(uint alarm_num) {
+}
+
+void hardware_alarm_clear_force_irq(uint alarm_num) {
+}
+
 PICO_WEAK_FUNCTION_DEF(hardware_alarm_set_callback)
 void PICO_WEAK_FUNCTION_IMPL_NAME(hardware_alarm_set_callback)(uint alarm_num, hardware_alarm_callback_t callback) {
     panic_unsupported();
@@ -123,3 +388,4 @@ PICO_WEAK_FUNCTION_DEF(hardware_alarm_force_irq)
 void PICO_WEAK_FUNCTION_IMPL_NAME(hardware_alarm_force_irq)(uint alarm_num) {
     panic_unsupported();
 }
+#endif
@@ -8,30 +8,73 @@
 #define _PICO_MULTICORE_H
 
 #include "pico/types.h"
+#include "pico/sync.h"
+
+// On the host, core 1 is a thread, the inter-core FIFOs are lock-free rings, and the doorbells are atomic bit masks
+// (which don't currently raise IRQs). Lockout and multicore_reset_core1 interrupt the other core's thread with a
+// core IRQ (see host_raise_core_irq in hardware/sync.h), which it takes at its next safe point (e.g. in __wfe,
+// tight_loop_contents, or a FIFO call); resetting core 1 unwinds it from there, so it holds no host library locks.
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// PICO_CONFIG: PARAM_ASSERTIONS_ENABLED_PICO_MULTICORE, Enable/disable assertions in the pico_multicore module, type=bool, default=0, group=pico_multicore
+#ifndef PARAM_ASSERTIONS_ENABLED_PICO_MULTICORE
+#define PARAM_ASSERTIONS_ENABLED_PICO_MULTICORE 0
+#endif
+
+// PICO_CONFIG: PICO_HOST_MULTICORE_FIFO_DEPTH, Number of entries in each of the host inter-core FIFOs, type=int, default=8, group=pico_multicore
+#ifndef PICO_HOST_MULTICORE_FIFO_DEPTH
+#define PICO_HOST_MULTICORE_FIFO_DEPTH 8
+#endif
+
+// FIFO status bits, as returned by multicore_fifo_get_status
+#define SIO_FIFO_ST_VLD_BITS 0x00000001u
+#define SIO_FIFO_ST_RDY_BITS 0x00000002u
+#define SIO_FIFO_ST_WOF_BITS 0x00000004u
+#define SIO_FIFO_ST_ROE_BITS 0x00000008u
+
+// note core 1 is stopped at its next point with interrupts enabled (and not within __wfe); as on the device, any locks
+// it holds at the time stay held
 void multicore_reset_core1(void);
 void multicore_launch_core1(void (*entry)(void));
+// the stack is not used; core 1 runs on its thread's stack
 void multicore_launch_core1_with_stack(void (*entry)(void), uint32_t *stack_bottom, size_t stack_size_bytes);
 void multicore_launch_core1_raw(void (*entry)(void), uint32_t *sp, uint32_t vector_table);
 
 bool multicore_fifo_rvalid(void);
 bool multicore_fifo_wready(void);
 void multicore_fifo_push_blocking(uint32_t data);
+static inline void multicore_fifo_push_blocking_inline(uint32_t data) {
+    multicore_fifo_push_blocking(data);
+}
 bool multicore_fifo_push_timeout_us(uint32_t data, uint64_t timeout_us);
-uint32_t multicore_fifo_pop_blocking();
+uint32_t multicore_fifo_pop_blocking(void);
+static inline uint32_t multicore_fifo_pop_blocking_inline(void) {
+    return multicore_fifo_pop_blocking();
+}
 bool multicore_fifo_pop_timeout_us(uint64_t timeout_us, uint32_t *out);
 void multicore_fifo_drain(void);
 void multicore_fifo_clear_irq(void);
 uint32_t multicore_fifo_get_status(void);
 
+void multicore_doorbell_claim(uint doorbell_num, uint core_mask);
+int multicore_doorbell_claim_unused(uint core_mask, bool required);
+void multicore_doorbell_unclaim(uint doorbell_num, uint core_mask);
+void multicore_doorbell_set_other_core(uint doorbell_num);
+void multicore_doorbell_clear_other_core(uint doorbell_num);
+void multicore_doorbell_set_current_core(uint doorbell_num);
+void multicore_doorbell_clear_current_core(uint doorbell_num);
+bool multicore_doorbell_is_set_current_core(uint doorbell_num);
+bool multicore_doorbell_is_set_other_core(uint doorbell_num);
+
 // call this from the lockout victim thread
 void multicore_lockout_victim_init(void);
+void multicore_lockout_victim_deinit(void);
+bool multicore_lockout_victim_is_initialized(uint core_num);
 
-// start locking out the other core (it will be
+// start locking out the other core (it will be paused, with interrupts disabled, until the lockout is ended)
 bool multicore_lockout_start_timeout_us(uint64_t timeout_us);
 void multicore_lockout_start_blocking(void);
 
@@ -0,0 +1,443 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <pthread.h>
+#include <setjmp.h>
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+#include "hardware/claim.h"
+
+static_assert(NUM_CORES == 2, "");
+static_assert(!(PICO_HOST_MULTICORE_FIFO_DEPTH & (PICO_HOST_MULTICORE_FIFO_DEPTH - 1)), "FIFO depth must be a power of 2");
+
+// Each FIFO is a bounded lock-free ring; although each core normally has a single writer and a single reader, an IRQ
+// handler on a core may push or pop concurrently with the core's thread on the host, so the ring is multi-producer
+// and multi-consumer safe. Each slot has a sequence number, which says whether the slot is ready to be written for
+// a given tail position, or ready to be read for a given head position; the sequence numbers are stored relative to
+// the slot index so that a zero initialized ring is empty.
+typedef struct {
+    uint32_t seq[PICO_HOST_MULTICORE_FIFO_DEPTH];
+    uint32_t data[PICO_HOST_MULTICORE_FIFO_DEPTH];
+    uint32_t head;
+    uint32_t tail;
+} host_fifo_t;
+
+// fifos[n] holds the values sent by core n to the other core
+static host_fifo_t fifos[NUM_CORES];
+
+static inline uint32_t fifo_slot_seq(host_fifo_t *fifo, uint index) {
+    return __atomic_load_n(&fifo->seq[index], __ATOMIC_ACQUIRE) + index;
+}
+
+static inline void fifo_set_slot_seq(host_fifo_t *fifo, uint index, uint32_t seq) {
+    __atomic_store_n(&fifo->seq[index], seq - index, __ATOMIC_RELEASE);
+}
+
+static bool fifo_try_push(host_fifo_t *fifo, uint32_t data) {
+    uint32_t pos = __atomic_load_n(&fifo->tail, __ATOMIC_RELAXED);
+    uint index;
+    do {
+        index = pos % PICO_HOST_MULTICORE_FIFO_DEPTH;
+        int32_t diff = (int32_t)(fifo_slot_seq(fifo, index) - pos);
+        if (diff < 0) return false; // full
+        if (diff > 0) {
+            // another writer got here first
+            pos = __atomic_load_n(&fifo->tail, __ATOMIC_RELAXED);
+            continue;
+        }
+    } while (!__atomic_compare_exchange_n(&fifo->tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    fifo->data[index] = data;
+    fifo_set_slot_seq(fifo, index, pos + 1);
+    return true;
+}
+
+static bool fifo_try_pop(host_fifo_t *fifo, uint32_t *data) {
+    uint32_t pos = __atomic_load_n(&fifo->head, __ATOMIC_RELAXED);
+    uint index;
+    do {
+        index = pos % PICO_HOST_MULTICORE_FIFO_DEPTH;
+        int32_t diff = (int32_t)(fifo_slot_seq(fifo, index) - (pos + 1));
+        if (diff < 0) return false; // empty
+        if (diff > 0) {
+            // another reader got here first
+            pos = __atomic_load_n(&fifo->head, __ATOMIC_RELAXED);
+            continue;
+        }
+    } while (!__atomic_compare_exchange_n(&fifo->head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    uint32_t value = fifo->data[index];
+    fifo_set_slot_seq(fifo, index, pos + PICO_HOST_MULTICORE_FIFO_DEPTH);
+    if (data) *data = value;
+    return true;
+}
+
+static bool fifo_is_empty(host_fifo_t *fifo) {
+    uint32_t pos = __atomic_load_n(&fifo->head, __ATOMIC_RELAXED);
+    return fifo_slot_seq(fifo, pos % PICO_HOST_MULTICORE_FIFO_DEPTH) != pos + 1;
+}
+
+static bool fifo_is_full(host_fifo_t *fifo) {
+    uint32_t pos = __atomic_load_n(&fifo->tail, __ATOMIC_RELAXED);
+    return fifo_slot_seq(fifo, pos % PICO_HOST_MULTICORE_FIFO_DEPTH) != pos;
+}
+
+static inline host_fifo_t *fifo_tx(void) {
+    return &fifos[get_core_num()];
+}
+
+static inline host_fifo_t *fifo_rx(void) {
+    return &fifos[get_core_num() ^ 1u];
+}
+
+// wait for an event, returning false if the timeout has been reached
+static bool wait_for_event_until(absolute_time_t until) {
+    if (is_at_the_end_of_time(until)) {
+        __wfe();
+        return true;
+    }
+    return !best_effort_wfe_or_timeout(until);
+}
+
+bool multicore_fifo_rvalid(void) {
+    // a polling loop is a safe point for core IRQs
+    host_check_core_irq();
+    return !fifo_is_empty(fifo_rx());
+}
+
+bool multicore_fifo_wready(void) {
+    host_check_core_irq();
+    return !fifo_is_full(fifo_tx());
+}
+
+static bool multicore_fifo_push_block_until(uint32_t data, absolute_time_t until) {
+    host_fifo_t *tx = fifo_tx();
+    while (!fifo_try_push(tx, data)) {
+        if (!wait_for_event_until(until)) return false;
+    }
+    // Fire off an event to the other core
+    __sev();
+    return true;
+}
+
+static bool multicore_fifo_pop_block_until(absolute_time_t until, uint32_t *out) {
+    host_fifo_t *rx = fifo_rx();
+    while (!fifo_try_pop(rx, out)) {
+        if (!wait_for_event_until(until)) return false;
+    }
+    // unlike the device, a core waiting for FIFO space waits for an event, so we need to send one
+    __sev();
+    return true;
+}
+
+void multicore_fifo_push_blocking(uint32_t data) {
+    multicore_fifo_push_block_until(data, at_the_end_of_time);
+}
+
+bool multicore_fifo_push_timeout_us(uint32_t data, uint64_t timeout_us) {
+    return multicore_fifo_push_block_until(data, make_timeout_time_us(timeout_us));
+}
+
+uint32_t multicore_fifo_pop_blocking(void) {
+    uint32_t data;
+    multicore_fifo_pop_block_until(at_the_end_of_time, &data);
+    return data;
+}
+
+bool multicore_fifo_pop_timeout_us(uint64_t timeout_us, uint32_t *out) {
+    return multicore_fifo_pop_block_until(make_timeout_time_us(timeout_us), out);
+}
+
+void multicore_fifo_drain(void) {
+    host_fifo_t *rx = fifo_rx();
+    while (fifo_try_pop(rx, NULL)) {
+    }
+    __sev();
+}
+
+void multicore_fifo_clear_irq(void) {
+    // the host FIFOs never overflow or underflow (there is no raw FIFO access), so there are no sticky flags to clear
+}
+
+uint32_t multicore_fifo_get_status(void) {
+    return (multicore_fifo_rvalid() ? SIO_FIFO_ST_VLD_BITS : 0) | (multicore_fifo_wready() ? SIO_FIFO_ST_RDY_BITS : 0);
+}
+
+// doorbells[n] holds the doorbells active on core n
+static uint32_t doorbells[NUM_CORES];
+static uint8_t doorbell_claimed[NUM_CORES];
+static_assert(NUM_DOORBELLS <= 8, "");
+
+static inline void check_doorbell_num_param(__unused uint doorbell_num) {
+    invalid_params_if(PICO_MULTICORE, doorbell_num >= NUM_DOORBELLS);
+}
+
+static bool multicore_doorbell_claim_under_lock(uint doorbell_num, uint core_mask, bool required) {
+    uint claimed_cores_for_doorbell = 0;
+    for (uint i = 0; i < NUM_CORES; i++) {
+        if (doorbell_claimed[i] & (1u << doorbell_num)) claimed_cores_for_doorbell |= 1u << i;
+    }
+    if (claimed_cores_for_doorbell & core_mask) {
+        if (required) {
+            panic("Multicore doorbell %d already claimed on core mask 0x%x; requested core mask 0x%x\n",
+                  doorbell_num, claimed_cores_for_doorbell, core_mask);
+        }
+        return false;
+    }
+    for (uint i = 0; i < NUM_CORES; i++) {
+        if (core_mask & (1u << i)) doorbell_claimed[i] |= (uint8_t)(1u << doorbell_num);
+    }
+    return true;
+}
+
+void multicore_doorbell_claim(uint doorbell_num, uint core_mask) {
+    check_doorbell_num_param(doorbell_num);
+    uint32_t save = hw_claim_lock();
+    multicore_doorbell_claim_under_lock(doorbell_num, core_mask, true);
+    hw_claim_unlock(save);
+}
+
+int multicore_doorbell_claim_unused(uint core_mask, bool required) {
+    int rc = PICO_ERROR_INSUFFICIENT_RESOURCES;
+    uint32_t save = hw_claim_lock();
+    for (int i = NUM_DOORBELLS - 1; i >= 0; i--) {
+        if (multicore_doorbell_claim_under_lock((uint)i, core_mask, false)) {
+            rc = i;
+            break;
+        }
+    }
+    if (required && rc < 0) {
+        panic("No free doorbells");
+    }
+    hw_claim_unlock(save);
+    return rc;
+}
+
+void multicore_doorbell_unclaim(uint doorbell_num, uint core_mask) {
+    check_doorbell_num_param(doorbell_num);
+    uint32_t save = hw_claim_lock();
+    for (uint i = 0; i < NUM_CORES; i++) {
+        if (core_mask & (1u << i)) doorbell_claimed[i] &= (uint8_t)~(1u << doorbell_num);
+    }
+    hw_claim_unlock(save);
+}
+
+void multicore_doorbell_set_other_core(uint doorbell_num) {
+    check_doorbell_num_param(doorbell_num);
+    __atomic_or_fetch(&doorbells[get_core_num() ^ 1u], 1u << doorbell_num, __ATOMIC_SEQ_CST);
+    __sev();
+}
+
+void multicore_doorbell_clear_other_core(uint doorbell_num) {
+    check_doorbell_num_param(doorbell_num);
+    __atomic_and_fetch(&doorbells[get_core_num() ^ 1u], ~(1u << doorbell_num), __ATOMIC_SEQ_CST);
+}
+
+void multicore_doorbell_set_current_core(uint doorbell_num) {
+    check_doorbell_num_param(doorbell_num);
+    __atomic_or_fetch(&doorbells[get_core_num()], 1u << doorbell_num, __ATOMIC_SEQ_CST);
+    __sev();
+}
+
+void multicore_doorbell_clear_current_core(uint doorbell_num) {
+    check_doorbell_num_param(doorbell_num);
+    __atomic_and_fetch(&doorbells[get_core_num()], ~(1u << doorbell_num), __ATOMIC_SEQ_CST);
+}
+
+bool multicore_doorbell_is_set_current_core(uint doorbell_num) {
+    check_doorbell_num_param(doorbell_num);
+    return __atomic_load_n(&doorbells[get_core_num()], __ATOMIC_SEQ_CST) & (1u << doorbell_num);
+}
+
+bool multicore_doorbell_is_set_other_core(uint doorbell_num) {
+    check_doorbell_num_param(doorbell_num);
+    return __atomic_load_n(&doorbells[get_core_num() ^ 1u], __ATOMIC_SEQ_CST) & (1u << doorbell_num);
+}
+
+// Lockout works as on the device, except that rather than being sent over the FIFO (and the victim taking the FIFO
+// IRQ), the request id is put in a per core mailbox, and the victim core is interrupted with a core IRQ
+
+static bool lockout_victim_initialized[NUM_CORES];
+static uint32_t lockout_request_id = 0x73a8831eu;
+static uint32_t lockout_requests[NUM_CORES];
+static uint32_t lockout_responses[NUM_CORES];
+static mutex_t lockout_mutex;
+
+static void multicore_lockout_handler(void) {
+    uint core_num = get_core_num();
+    uint32_t request_id = __atomic_exchange_n(&lockout_requests[core_num], 0, __ATOMIC_SEQ_CST);
+    if (request_id && request_id == __atomic_load_n(&lockout_request_id, __ATOMIC_SEQ_CST)) {
+        // valid lockout request received
+        uint32_t save = save_and_disable_interrupts();
+        __atomic_store_n(&lockout_responses[core_num], request_id, __ATOMIC_SEQ_CST);
+        __sev();
+        // wait for the lockout to expire
+        while (request_id == __atomic_load_n(&lockout_request_id, __ATOMIC_SEQ_CST)) {
+            // when lockout_request_id is updated, the other core calls __sev
+            __wfe();
+        }
+        restore_interrupts_from_disabled(save);
+    }
+}
+
+static pthread_t core1_thread;
+static bool core1_thread_started;
+static bool core1_running;
+static bool core1_reset_requested;
+static void (*core1_entry)(void);
+static jmp_buf core1_reset_jmp;
+
+// called on a core's own thread at a safe point after host_raise_core_irq, so with interrupts enabled
+static void multicore_core_irq_handler(void) {
+    uint core_num = get_core_num();
+    if (core_num == 1 && __atomic_load_n(&core1_reset_requested, __ATOMIC_SEQ_CST)) {
+        // abandon whatever core 1 was doing; as this is a safe point it holds no host library locks
+        longjmp(core1_reset_jmp, 1);
+    }
+    if (__atomic_load_n(&lockout_victim_initialized[core_num], __ATOMIC_SEQ_CST)) {
+        multicore_lockout_handler();
+    }
+}
+
+static void *core1_thread_func(__unused void *arg) {
+    host_set_core_thread(1);
+    if (!setjmp(core1_reset_jmp)) {
+        core1_entry();
+    }
+    host_clear_core_thread(1);
+    __atomic_store_n(&core1_running, false, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+
+void multicore_reset_core1(void) {
+    if (core1_thread_started) {
+        __atomic_store_n(&core1_reset_requested, true, __ATOMIC_SEQ_CST);
+        host_raise_core_irq(1);
+        pthread_join(core1_thread, NULL);
+        core1_thread_started = false;
+        __atomic_store_n(&core1_reset_requested, false, __ATOMIC_SEQ_CST);
+    }
+    // Core 1 will be in un-initialized state
+    __atomic_store_n(&lockout_victim_initialized[1], false, __ATOMIC_SEQ_CST);
+    // and (as on the device) drains its own mailbox FIFO
+    while (fifo_try_pop(&fifos[0], NULL)) {
+    }
+    __sev();
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    if (core1_thread_started) {
+        if (__atomic_load_n(&core1_running, __ATOMIC_SEQ_CST)) {
+            panic("Core 1 is already running");
+        }
+        pthread_join(core1_thread, NULL);
+        core1_thread_started = false;
+    }
+    // as the launch handshake does on the device, leave both FIFOs empty
+    for (uint i = 0; i < NUM_CORES; i++) {
+        while (fifo_try_pop(&fifos[i], NULL)) {
+        }
+    }
+    core1_entry = entry;
+    __atomic_store_n(&core1_running, true, __ATOMIC_SEQ_CST);
+    host_set_core_irq_handler(1, multicore_core_irq_handler);
+    if (pthread_create(&core1_thread, NULL, core1_thread_func, NULL)) {
+        panic("Failed to create core 1 thread");
+    }
+    core1_thread_started = true;
+}
+
+void multicore_launch_core1_with_stack(void (*entry)(void), __unused uint32_t *stack_bottom, __unused size_t stack_size_bytes) {
+    multicore_launch_core1(entry);
+}
+
+void multicore_launch_core1_raw(void (*entry)(void), __unused uint32_t *sp, __unused uint32_t vector_table) {
+    multicore_launch_core1(entry);
+}
+
+static void check_lockout_mutex_init(void) {
+    // use known available lock - we only need it briefly
+    uint32_t save = hw_claim_lock();
+    if (!mutex_is_initialized(&lockout_mutex)) {
+        mutex_init(&lockout_mutex);
+    }
+    hw_claim_unlock(save);
+}
+
+void multicore_lockout_victim_init(void) {
+    check_lockout_mutex_init();
+    uint core_num = get_core_num();
+    host_set_core_irq_handler(core_num, multicore_core_irq_handler);
+    __atomic_store_n(&lockout_victim_initialized[core_num], true, __ATOMIC_SEQ_CST);
+}
+
+void multicore_lockout_victim_deinit(void) {
+    __atomic_store_n(&lockout_victim_initialized[get_core_num()], false, __ATOMIC_SEQ_CST);
+}
+
+bool multicore_lockout_victim_is_initialized(uint core_num) {
+    return __atomic_load_n(&lockout_victim_initialized[core_num], __ATOMIC_SEQ_CST);
+}
+
+static bool multicore_lockout_handshake(uint32_t request_id, absolute_time_t until) {
+    uint other_core_num = get_core_num() ^ 1u;
+    __atomic_store_n(&lockout_requests[other_core_num], request_id, __ATOMIC_SEQ_CST);
+    host_raise_core_irq(other_core_num);
+    while (__atomic_load_n(&lockout_responses[other_core_num], __ATOMIC_SEQ_CST) != request_id) {
+        if (!wait_for_event_until(until)) return false;
+    }
+    return true;
+}
+
+static uint32_t update_lockout_request_id(void) {
+    // generate new number and then update shared variable
+    uint32_t new_request_id = __atomic_add_fetch(&lockout_request_id, 1, __ATOMIC_SEQ_CST);
+    // notify other core
+    __sev();
+    return new_request_id;
+}
+
+static bool multicore_lockout_start_block_until(absolute_time_t until) {
+    check_lockout_mutex_init();
+    if (!mutex_enter_block_until(&lockout_mutex, until)) {
+        return false;
+    }
+    // generate a new request_id number
+    uint32_t request_id = update_lockout_request_id();
+    // attempt to lock out
+    bool rc = multicore_lockout_handshake(request_id, until);
+    if (!rc) {
+        // lockout failed - cancel it
+        update_lockout_request_id();
+    }
+    mutex_exit(&lockout_mutex);
+    return rc;
+}
+
+bool multicore_lockout_start_timeout_us(uint64_t timeout_us) {
+    return multicore_lockout_start_block_until(make_timeout_time_us(timeout_us));
+}
+
+void multicore_lockout_start_blocking(void) {
+    multicore_lockout_start_block_until(at_the_end_of_time);
+}
+
+static bool multicore_lockout_end_block_until(absolute_time_t until) {
+    assert(mutex_is_initialized(&lockout_mutex));
+    if (!mutex_enter_block_until(&lockout_mutex, until)) {
+        return false;
+    }
+    // lockout finished - cancel it
+    update_lockout_request_id();
+    mutex_exit(&lockout_mutex);
+    return true;
+}
+
+bool multicore_lockout_end_timeout_us(uint64_t timeout_us) {
+    return multicore_lockout_end_block_until(make_timeout_time_us(timeout_us));
+}
+
+void multicore_lockout_end_blocking(void) {
+    multicore_lockout_end_block_until(at_the_end_of_time);
+}
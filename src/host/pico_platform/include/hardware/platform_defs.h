@@ -21,6 +21,8 @@
 
 #define NUM_SPIN_LOCKS 32u
 
+#define NUM_DOORBELLS 8u
+
 #define XOSC_HZ 12000000u
 
 #define NUM_SPIN_LOCKS 32u
@@ -128,6 +128,9 @@ void __noreturn panic_unsupported();
 
 void __noreturn panic(const char *fmt, ...);
 
+// there is no need to save space on host
+#define panic_compact(...) panic(__VA_ARGS__)
+
 // arggggghhhh there is a weak function called sem_init used by SDL
 #define sem_init sem_init_alternative
 
@@ -150,12 +153,18 @@ static inline int32_t __mul_instruction(int32_t a,int32_t b)
 static inline void __compiler_memory_barrier(void) {
 }
 
+// returns the core number of the calling thread; this is 0 unless the thread is core 1 (see pico_multicore), or
+// is emulating an IRQ on core 1
 uint get_core_num();
 
-static inline uint __get_current_exception(void) {
-    return 0;
+// called by the multicore and IRQ emulation to set the core number of the calling thread; returns the previous value
+uint host_set_core_num(uint core_num);
 
-}
+// returns the exception number of the emulated IRQ being handled by the calling thread, or 0 if none
+uint __get_current_exception(void);
+
+// called by IRQ emulation to record the exception number being handled by the calling thread; returns the previous value
+uint host_set_current_exception(uint exception_num);
 
 void busy_wait_at_least_cycles(uint32_t minimum_cycles);
 
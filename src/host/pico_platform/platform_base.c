@@ -15,9 +15,33 @@ void PICO_WEAK_FUNCTION_IMPL_NAME(tight_loop_contents)() {
 }
 
 
+#if defined(__unix__) || defined(__APPLE__)
+static __thread uint current_core_num;
+static __thread uint current_exception;
+#else
+static uint current_core_num;
+static uint current_exception;
+#endif
+
 PICO_WEAK_FUNCTION_DEF(get_core_num)
 uint PICO_WEAK_FUNCTION_IMPL_NAME(get_core_num)() {
-    return 0;
+    return current_core_num;
+}
+
+uint host_set_core_num(uint core_num) {
+    uint prev = current_core_num;
+    current_core_num = core_num;
+    return prev;
+}
+
+uint __get_current_exception(void) {
+    return current_exception;
+}
+
+uint host_set_current_exception(uint exception_num) {
+    uint prev = current_exception;
+    current_exception = exception_num;
+    return prev;
 }
 
 void __noreturn panic_unsupported() {
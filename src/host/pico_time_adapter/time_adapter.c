@@ -6,66 +6,84 @@
 
 #include "pico/time.h"
 #include "pico/time_adapter.h"
+#include "hardware/timer.h"
+
+// Alarm pools are driven by the host hardware_timer alarm IRQ emulation. All functions are weak so that
+// they can be replaced (e.g. by pico_host_sdl, or a simulated timer in tests)
+
+static uint8_t host_timer_instance;
 
 PICO_WEAK_FUNCTION_DEF(ta_clear_force_irq)
-void PICO_WEAK_FUNCTION_IMPL_NAME(ta_clear_force_irq)(alarm_pool_timer_t *timer, uint hardware_alarm_num) {
-    panic_unsupported();
+void PICO_WEAK_FUNCTION_IMPL_NAME(ta_clear_force_irq)(__unused alarm_pool_timer_t *timer, uint hardware_alarm_num) {
+    hardware_alarm_clear_force_irq(hardware_alarm_num);
 }
 PICO_WEAK_FUNCTION_DEF(ta_clear_irq)
-void PICO_WEAK_FUNCTION_IMPL_NAME(ta_clear_irq)(alarm_pool_timer_t *timer, uint hardware_alarm_num) {
-    panic_unsupported();
+void PICO_WEAK_FUNCTION_IMPL_NAME(ta_clear_irq)(__unused alarm_pool_timer_t *timer, uint hardware_alarm_num) {
+    hardware_alarm_clear_irq(hardware_alarm_num);
 }
 PICO_WEAK_FUNCTION_DEF(ta_force_irq)
-void PICO_WEAK_FUNCTION_IMPL_NAME(ta_force_irq)(alarm_pool_timer_t *timer, uint hardware_alarm_num) {
-    panic_unsupported();
-}
-PICO_WEAK_FUNCTION_DEF(ta_get_handler_hardware_alarm_num)
-int PICO_WEAK_FUNCTION_IMPL_NAME(ta_get_handler_hardware_alarm_num)() {
-    panic_unsupported();
+void PICO_WEAK_FUNCTION_IMPL_NAME(ta_force_irq)(__unused alarm_pool_timer_t *timer, uint hardware_alarm_num) {
+    hardware_alarm_force_irq(hardware_alarm_num);
 }
 PICO_WEAK_FUNCTION_DEF(ta_set_timeout)
-void PICO_WEAK_FUNCTION_IMPL_NAME(ta_set_timeout)(alarm_pool_timer_t *timer, uint hardware_alarm_num, int64_t target) {
-    panic_unsupported();
+void PICO_WEAK_FUNCTION_IMPL_NAME(ta_set_timeout)(__unused alarm_pool_timer_t *timer, uint hardware_alarm_num, int64_t target) {
+    // as on device, we never want to set the timeout to be later than our current one
+    uint64_t current;
+    if (!hardware_alarm_get_armed_target(hardware_alarm_num, &current) || target < (int64_t)current) {
+        hardware_alarm_arm(hardware_alarm_num, (uint64_t)target);
+    }
 }
 PICO_WEAK_FUNCTION_DEF(ta_wakes_up_on_or_before)
-bool PICO_WEAK_FUNCTION_IMPL_NAME(ta_wakes_up_on_or_before)(alarm_pool_timer_t *timer, uint hardware_alarm_num, int64_t target) {
-    panic_unsupported();
+bool PICO_WEAK_FUNCTION_IMPL_NAME(ta_wakes_up_on_or_before)(__unused alarm_pool_timer_t *timer, uint hardware_alarm_num, int64_t target) {
+    uint64_t current;
+    return hardware_alarm_get_armed_target(hardware_alarm_num, &current) && (int64_t)current <= target;
 }
 PICO_WEAK_FUNCTION_DEF(ta_enable_irq_handler)
-void PICO_WEAK_FUNCTION_IMPL_NAME(ta_enable_irq_handler)(alarm_pool_timer_t *timer, uint hardware_alarm_num, void (*irq_handler)(void)) {
-    panic_unsupported();
+void PICO_WEAK_FUNCTION_IMPL_NAME(ta_enable_irq_handler)(__unused alarm_pool_timer_t *timer, uint hardware_alarm_num, void (*irq_handler)(void)) {
+    hardware_alarm_cancel(hardware_alarm_num);
+    hardware_alarm_set_irq_handler(hardware_alarm_num, irq_handler);
 }
 PICO_WEAK_FUNCTION_DEF(ta_disable_irq_handler)
-void PICO_WEAK_FUNCTION_IMPL_NAME(ta_disable_irq_handler)(alarm_pool_timer_t *timer, uint hardware_alarm_num, void (*irq_handler)(void)) {
-    panic_unsupported();
+void PICO_WEAK_FUNCTION_IMPL_NAME(ta_disable_irq_handler)(__unused alarm_pool_timer_t *timer, uint hardware_alarm_num, __unused void (*irq_handler)(void)) {
+    hardware_alarm_cancel(hardware_alarm_num);
+    hardware_alarm_set_irq_handler(hardware_alarm_num, NULL);
+    hardware_alarm_clear_force_irq(hardware_alarm_num);
+    hardware_alarm_clear_irq(hardware_alarm_num);
+    hardware_alarm_unclaim(hardware_alarm_num);
 }
 PICO_WEAK_FUNCTION_DEF(ta_hardware_alarm_claim)
-void PICO_WEAK_FUNCTION_IMPL_NAME(ta_hardware_alarm_claim)(alarm_pool_timer_t *timer, uint hardware_alaram_num) {
-    panic_unsupported();
+void PICO_WEAK_FUNCTION_IMPL_NAME(ta_hardware_alarm_claim)(__unused alarm_pool_timer_t *timer, uint hardware_alarm_num) {
+    hardware_alarm_claim(hardware_alarm_num);
 }
 PICO_WEAK_FUNCTION_DEF(ta_hardware_alarm_claim_unused)
-int PICO_WEAK_FUNCTION_IMPL_NAME(ta_hardware_alarm_claim_unused)(alarm_pool_timer_t *timer, bool required) {
-    panic_unsupported();
+int PICO_WEAK_FUNCTION_IMPL_NAME(ta_hardware_alarm_claim_unused)(__unused alarm_pool_timer_t *timer, bool required) {
+    return hardware_alarm_claim_unused(required);
 }
 
 PICO_WEAK_FUNCTION_DEF(ta_from_current_irq);
 alarm_pool_timer_t *PICO_WEAK_FUNCTION_IMPL_NAME(ta_from_current_irq)(uint *alarm_num) {
-    panic_unsupported();
+    *alarm_num = __get_current_exception() - VTABLE_FIRST_IRQ;
+    return &host_timer_instance;
 }
 
 PICO_WEAK_FUNCTION_DEF(ta_timer_num);
-uint ta_timer_num(alarm_pool_timer_t *timer) {
-    panic_unsupported();
+uint PICO_WEAK_FUNCTION_IMPL_NAME(ta_timer_num)(__unused alarm_pool_timer_t *timer) {
+    return 0;
 }
 
 PICO_WEAK_FUNCTION_DEF(ta_timer_instance);
-alarm_pool_timer_t *ta_timer_instance(uint instance_num) {
-    panic_unsupported();
+alarm_pool_timer_t *PICO_WEAK_FUNCTION_IMPL_NAME(ta_timer_instance)(__unused uint instance_num) {
+    return &host_timer_instance;
 }
 
 PICO_WEAK_FUNCTION_DEF(ta_default_timer_instance);
-alarm_pool_timer_t *ta_default_timer_instance(void) {
-    panic_unsupported();
-
+alarm_pool_timer_t *PICO_WEAK_FUNCTION_IMPL_NAME(ta_default_timer_instance)(void) {
+    return &host_timer_instance;
 }
 
+#if !PICO_TIME_DEFAULT_ALARM_POOL_DISABLED && !PICO_RUNTIME_SKIP_INIT_DEFAULT_ALARM_POOL
+// there are no runtime init functions on host, so initialize the default alarm pool before main() instead
+static void __attribute__((constructor)) host_runtime_init_default_alarm_pool(void) {
+    runtime_init_default_alarm_pool();
+}
+#endif
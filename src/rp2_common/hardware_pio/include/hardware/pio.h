@@ -995,6 +995,114 @@ int pio_add_program_at_offset(PIO pio, const pio_program_t *program, uint offset
  */
 void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset);
 
+/** \brief Magic number at the start of a PIO program blob ("PIOB")
+ *  \ingroup hardware_pio
+ */
+#define PIO_PROGRAM_BLOB_MAGIC 0x424f4950u
+
+/** \brief Version of the PIO program blob layout understood by \ref pio_load_program_blob()
+ *  \ingroup hardware_pio
+ */
+#define PIO_PROGRAM_BLOB_VERSION 1
+
+#define PIO_PROGRAM_BLOB_FLAG_SIDESET_OPT     0x01u ///< side-set is optional
+#define PIO_PROGRAM_BLOB_FLAG_SIDESET_PINDIRS 0x02u ///< side-set drives pin directions
+#define PIO_PROGRAM_BLOB_FLAG_IN_SHIFT_RIGHT  0x04u
+#define PIO_PROGRAM_BLOB_FLAG_AUTOPUSH        0x08u
+#define PIO_PROGRAM_BLOB_FLAG_OUT_SHIFT_RIGHT 0x10u
+#define PIO_PROGRAM_BLOB_FLAG_AUTOPULL        0x20u
+
+/** \brief Header of a PIO program blob, as generated by `pioasm -o blob`
+ *  \ingroup hardware_pio
+ *
+ * A blob is a self-contained, position independent description of a PIO program and its default state machine
+ * configuration, so that programs can be stored (e.g. in a flash partition) and loaded at runtime without being
+ * compiled into the firmware. The header is followed by `length` 16-bit instructions, padded to a multiple of 4 bytes;
+ * all values are little-endian. Multiple blobs may be stored one after another; see \ref pio_program_blob_size().
+ *
+ * Counts which are -1 are not specified by the program, and are left at their \ref pio_get_default_sm_config() values.
+ */
+typedef struct pio_program_blob_header {
+    uint32_t magic;             ///< PIO_PROGRAM_BLOB_MAGIC
+    uint8_t version;            ///< PIO_PROGRAM_BLOB_VERSION
+    uint8_t length;             ///< number of instructions
+    int8_t origin;              ///< required instruction memory origin or -1
+    uint8_t pio_version;
+    uint32_t relocation_mask;   ///< bit n is set if instruction n is a jmp whose target is relative to the program
+    uint8_t wrap_target;        ///< relative to the program
+    uint8_t wrap;               ///< relative to the program
+    uint8_t sideset_bit_count;  ///< including the enable bit if side-set is optional; 0 for no side-set
+    uint8_t flags;              ///< PIO_PROGRAM_BLOB_FLAG_xxx
+    int8_t in_pin_count;        ///< -1 if neither the in pin count nor the in shift is specified
+    uint8_t push_threshold;
+    int8_t out_pin_count;       ///< -1 if neither the out pin count nor the out shift is specified
+    uint8_t pull_threshold;
+    int8_t set_pin_count;
+    uint8_t fifo_join;          ///< \ref pio_fifo_join
+    int8_t mov_status_type;     ///< \ref pio_mov_status_type or -1
+    uint8_t mov_status_n;
+    uint16_t clkdiv_int;
+    uint8_t clkdiv_frac;
+    uint8_t used_gpio_ranges;   ///< bitmap with one bit per 16 pins
+} pio_program_blob_header_t;
+
+static_assert(sizeof(pio_program_blob_header_t) == 28, "");
+
+/*! \brief Return the instructions of a PIO program blob
+ *  \ingroup hardware_pio
+ *
+ * \param blob the blob
+ * \return the instructions following the header
+ */
+static inline const uint16_t *pio_program_blob_instructions(const pio_program_blob_header_t *blob) {
+    return (const uint16_t *)(blob + 1);
+}
+
+/*! \brief Return the size in bytes of a PIO program blob, i.e. the offset of the next blob if several are stored together
+ *  \ingroup hardware_pio
+ *
+ * \param blob the blob
+ * \return the size of the header and instructions, rounded up to a multiple of 4 bytes
+ */
+static inline uint pio_program_blob_size(const pio_program_blob_header_t *blob) {
+    return (uint)sizeof(pio_program_blob_header_t) + ((blob->length * 2u + 3u) & ~3u);
+}
+
+/*! \brief Check that data is a valid PIO program blob
+ *  \ingroup hardware_pio
+ *
+ * \param blob the blob data, which must be word aligned
+ * \param size the number of bytes of data available
+ * \return the size of the blob in bytes, or negative for error: PICO_ERROR_INVALID_DATA if the data is not a
+ * valid blob, or PICO_ERROR_VERSION_MISMATCH if the blob is a different layout version
+ */
+int pio_program_blob_validate(const void *blob, size_t size);
+
+/*! \brief Attempt to load the program in a PIO program blob, and get its default state machine configuration
+ *  \ingroup hardware_pio
+ *
+ * The program is placed in the same way as \ref pio_add_program(), relocating the instructions marked in the blob's
+ * relocation mask as they are copied to instruction memory. The configuration is what the `pioasm` generated
+ * `<program>_program_get_default_config()` would return for the loaded offset; the pin mappings still need to be
+ * set before the state machine is initialized with it.
+ *
+ * \param pio The PIO instance; e.g. \ref pio0 or \ref pio1
+ * \param blob the blob data, which must be word aligned
+ * \param size the number of bytes of data available
+ * \param config if not NULL, receives the default configuration of the program
+ * \return the instruction memory offset the program is loaded at, or negative for error
+ */
+int pio_load_program_blob(PIO pio, const void *blob, size_t size, pio_sm_config *config);
+
+/*! \brief Remove a program loaded by \ref pio_load_program_blob() from a PIO instance's instruction memory
+ *  \ingroup hardware_pio
+ *
+ * \param pio The PIO instance; e.g. \ref pio0 or \ref pio1
+ * \param blob the blob the program was loaded from
+ * \param loaded_offset the loaded offset returned when the program was loaded
+ */
+void pio_unload_program_blob(PIO pio, const void *blob, uint loaded_offset);
+
 /*! \brief Clears all of a PIO instance's instruction memory
  *  \ingroup hardware_pio
  *
@@ -205,6 +205,99 @@ void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offse
     hw_claim_unlock(save);
 }
 
+int pio_program_blob_validate(const void *blob_data, size_t size) {
+    const pio_program_blob_header_t *blob = (const pio_program_blob_header_t *)blob_data;
+    if (size < sizeof(pio_program_blob_header_t) || blob->magic != PIO_PROGRAM_BLOB_MAGIC) return PICO_ERROR_INVALID_DATA;
+    if (blob->version != PIO_PROGRAM_BLOB_VERSION) return PICO_ERROR_VERSION_MISMATCH;
+    if (!blob->length || blob->length > PIO_INSTRUCTION_COUNT || pio_program_blob_size(blob) > size ||
+        blob->wrap_target >= blob->length || blob->wrap >= blob->length || blob->sideset_bit_count > 5) {
+        return PICO_ERROR_INVALID_DATA;
+    }
+    return (int)pio_program_blob_size(blob);
+}
+
+static void pio_program_blob_get_config(const pio_program_blob_header_t *blob, uint offset, pio_sm_config *c) {
+    *c = pio_get_default_sm_config();
+    sm_config_set_wrap(c, offset + blob->wrap_target, offset + blob->wrap);
+    if (blob->in_pin_count >= 0) {
+        sm_config_set_in_pin_count(c, (uint)blob->in_pin_count);
+        sm_config_set_in_shift(c, blob->flags & PIO_PROGRAM_BLOB_FLAG_IN_SHIFT_RIGHT,
+                               blob->flags & PIO_PROGRAM_BLOB_FLAG_AUTOPUSH, blob->push_threshold);
+    }
+    if (blob->out_pin_count >= 0) {
+        sm_config_set_out_pin_count(c, (uint)blob->out_pin_count);
+        sm_config_set_out_shift(c, blob->flags & PIO_PROGRAM_BLOB_FLAG_OUT_SHIFT_RIGHT,
+                                blob->flags & PIO_PROGRAM_BLOB_FLAG_AUTOPULL, blob->pull_threshold);
+    }
+    if (blob->set_pin_count >= 0) {
+        sm_config_set_set_pin_count(c, (uint)blob->set_pin_count);
+    }
+    if (blob->sideset_bit_count) {
+        sm_config_set_sideset(c, blob->sideset_bit_count, blob->flags & PIO_PROGRAM_BLOB_FLAG_SIDESET_OPT,
+                              blob->flags & PIO_PROGRAM_BLOB_FLAG_SIDESET_PINDIRS);
+    }
+    if (blob->mov_status_type >= 0) {
+        sm_config_set_mov_status(c, (enum pio_mov_status_type)blob->mov_status_type, blob->mov_status_n);
+    }
+    if (blob->fifo_join != PIO_FIFO_JOIN_NONE) {
+        sm_config_set_fifo_join(c, (enum pio_fifo_join)blob->fifo_join);
+    }
+    if (blob->clkdiv_int != 1 || blob->clkdiv_frac) {
+        sm_config_set_clkdiv_int_frac8(c, blob->clkdiv_int, blob->clkdiv_frac);
+    }
+}
+
+int pio_load_program_blob(PIO pio, const void *blob_data, size_t size, pio_sm_config *config) {
+    int rc = pio_program_blob_validate(blob_data, size);
+    if (rc < 0) return rc;
+    const pio_program_blob_header_t *blob = (const pio_program_blob_header_t *)blob_data;
+    const uint16_t *instructions = pio_program_blob_instructions(blob);
+    pio_program_t program = {
+            .instructions = instructions,
+            .length = blob->length,
+            .origin = blob->origin,
+            .pio_version = blob->pio_version,
+#if PICO_PIO_VERSION > 0
+            .used_gpio_ranges = blob->used_gpio_ranges,
+#endif
+    };
+    uint32_t save = hw_claim_lock();
+    int offset = find_offset_for_program(pio, &program);
+    if (offset >= 0) {
+        rc = add_program_at_offset_check(pio, &program, (uint)offset);
+        if (rc) offset = rc;
+    }
+    if (offset >= 0) {
+        // copy and relocate in one pass, using the blob's relocation mask
+        uint32_t relocation_mask = blob->relocation_mask;
+        for (uint i = 0; i < program.length; ++i, relocation_mask >>= 1) {
+            uint16_t instr = instructions[i];
+#if PICO_PIO_USE_GPIO_BASE
+            if (pio_instr_bits_wait == _pio_major_instr_bits(instr) && !((_pio_arg1(instr) & 3u))) {
+                // see add_program_at_offset
+                instr ^= (uint16_t)pio_get_gpio_base(pio);
+            }
+#endif
+            pio->instr_mem[(uint)offset + i] = (relocation_mask & 1u) ? instr + (uint)offset : instr;
+        }
+        _used_instruction_space[pio_get_index(pio)] |= ((1u << program.length) - 1) << (uint)offset;
+    }
+    hw_claim_unlock(save);
+    if (offset >= 0 && config) {
+        pio_program_blob_get_config(blob, (uint)offset, config);
+    }
+    return offset;
+}
+
+void pio_unload_program_blob(PIO pio, const void *blob_data, uint loaded_offset) {
+    const pio_program_blob_header_t *blob = (const pio_program_blob_header_t *)blob_data;
+    uint32_t program_mask = ((1u << blob->length) - 1) << loaded_offset;
+    uint32_t save = hw_claim_lock();
+    assert(program_mask == (_used_instruction_space[pio_get_index(pio)] & program_mask));
+    _used_instruction_space[pio_get_index(pio)] &= ~program_mask;
+    hw_claim_unlock(save);
+}
+
 void pio_clear_instruction_memory(PIO pio) {
     uint32_t save = hw_claim_lock();
     _used_instruction_space[pio_get_index(pio)] = 0;
@@ -4,31 +4,70 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <stdio.h>
+#include <string.h>
 #include "pico/async_context_base.h"
 
+// at_time_list is a doubly linked list kept in next_time order (with workers for the same time in the order they
+// were added), so the next due worker is always at the head
+
+static bool at_time_worker_is_queued(async_context_t *self, async_at_time_worker_t *worker) {
+    // the link check guards against stale state left over from a previous (since deinitialized) context
+    return worker->context == self && (worker->prev ? worker->prev->next == worker : self->at_time_list == worker);
+}
+
+static void at_time_worker_unlink(async_context_t *self, async_at_time_worker_t *worker) {
+    if (worker->prev) {
+        worker->prev->next = worker->next;
+    } else {
+        self->at_time_list = worker->next;
+    }
+    if (worker->next) {
+        worker->next->prev = worker->prev;
+    }
+    worker->context = NULL;
+}
+
+static void at_time_worker_insert(async_context_t *self, async_at_time_worker_t *worker) {
+    async_at_time_worker_t *prev = NULL;
+    async_at_time_worker_t *next = self->at_time_list;
+    while (next && absolute_time_diff_us(next->next_time, worker->next_time) >= 0) {
+        prev = next;
+        next = next->next;
+    }
+    worker->prev = prev;
+    worker->next = next;
+    if (prev) {
+        prev->next = worker;
+    } else {
+        self->at_time_list = worker;
+    }
+    if (next) {
+        next->prev = worker;
+    }
+    worker->context = self;
+}
+
 bool async_context_base_add_at_time_worker(async_context_t *self, async_at_time_worker_t *worker) {
-    async_at_time_worker_t **prev = &self->at_time_list;
-    while (*prev) {
-        if (worker == *prev) {
-            return false;
+    if (at_time_worker_is_queued(self, worker)) {
+        // next_time may have been changed, so move the worker if it is now out of order
+        if ((worker->prev && absolute_time_diff_us(worker->prev->next_time, worker->next_time) < 0) ||
+            (worker->next && absolute_time_diff_us(worker->next_time, worker->next->next_time) < 0)) {
+            at_time_worker_unlink(self, worker);
+            at_time_worker_insert(self, worker);
         }
-        prev = &(*prev)->next;
+        return false;
     }
-    *prev = worker;
-    worker->next = NULL;
+    at_time_worker_insert(self, worker);
     return true;
 }
 
 bool async_context_base_remove_at_time_worker(async_context_t *self, async_at_time_worker_t *worker) {
-    async_at_time_worker_t **prev = &self->at_time_list;
-    while (*prev) {
-        if (worker == *prev) {
-            *prev = worker->next;
-            return true;
-        }
-        prev = &(*prev)->next;
+    if (!at_time_worker_is_queued(self, worker)) {
+        return false;
     }
-    return false;
+    at_time_worker_unlink(self, worker);
+    return true;
 }
 
 bool async_context_base_add_when_pending_worker(async_context_t *self, async_when_pending_worker_t *worker) {
@@ -57,21 +96,10 @@ bool async_context_base_remove_when_pending_worker(async_context_t *self, async_
 }
 
 async_at_time_worker_t *async_context_base_remove_ready_at_time_worker(async_context_t *self) {
-    async_at_time_worker_t **best_prev = NULL;
-    if (self->at_time_list) {
-        absolute_time_t earliest = get_absolute_time();
-        for (async_at_time_worker_t **prev = &self->at_time_list; *prev; prev = &(*prev)->next) {
-            if (absolute_time_diff_us((*prev)->next_time, earliest) >= 0) {
-                earliest = (*prev)->next_time;
-                assert(!is_at_the_end_of_time(earliest)); // should never be less than now
-                best_prev = prev;
-            }
-        }
-    }
-    async_at_time_worker_t *rc;
-    if (best_prev) {
-        rc = *best_prev;
-        *best_prev = rc->next;
+    async_at_time_worker_t *rc = self->at_time_list;
+    if (rc && absolute_time_diff_us(rc->next_time, get_absolute_time()) >= 0) {
+        assert(!is_at_the_end_of_time(rc->next_time)); // should never be less than now
+        at_time_worker_unlink(self, rc);
     } else {
         rc = NULL;
     }
@@ -79,26 +107,86 @@ async_at_time_worker_t *async_context_base_remove_ready_at_time_worker(async_con
 }
 
 void async_context_base_refresh_next_timeout(async_context_t *self) {
-    absolute_time_t earliest = at_the_end_of_time;
-    for (async_at_time_worker_t *worker = self->at_time_list; worker; ) {
-        async_at_time_worker_t *next = worker->next;
-        if (absolute_time_diff_us(worker->next_time, earliest) > 0) {
-            earliest = worker->next_time;
+    self->next_time = self->at_time_list ? self->at_time_list->next_time : at_the_end_of_time;
+}
+
+#if ASYNC_CONTEXT_INSTRUMENTATION
+static void record_run(async_worker_stats_t *stats, uint64_t run_time_us) {
+    stats->run_count++;
+    stats->total_run_time_us += run_time_us;
+    if (run_time_us > stats->max_run_time_us) {
+        stats->max_run_time_us = run_time_us > UINT32_MAX ? UINT32_MAX : (uint32_t)run_time_us;
+    }
+}
+
+static bool when_pending_worker_is_present(async_context_t *self, async_when_pending_worker_t *worker) {
+    for (async_when_pending_worker_t *w = self->when_pending_list; w; w = w->next) {
+        if (w == worker) return true;
+    }
+    return false;
+}
+
+void async_context_base_record_when_pending_worker_run(async_context_t *self, async_when_pending_worker_t *worker, uint64_t run_time_us) {
+    // the worker may have removed itself and no longer exist (e.g. a worker used for async_context_execute_sync)
+    if (when_pending_worker_is_present(self, worker)) {
+        record_run(&worker->stats, run_time_us);
+    }
+}
+
+void async_context_base_lock_acquired(async_context_t *self) {
+    self->lock_acquired_time_us = time_us_64();
+}
+
+void async_context_base_lock_releasing(async_context_t *self) {
+    uint64_t hold_time_us = time_us_64() - self->lock_acquired_time_us;
+    self->stats.lock_count++;
+    self->stats.total_lock_hold_time_us += hold_time_us;
+    if (hold_time_us > self->stats.max_lock_hold_time_us) {
+        self->stats.max_lock_hold_time_us = hold_time_us > UINT32_MAX ? UINT32_MAX : (uint32_t)hold_time_us;
+    }
+}
+#endif
+
+void async_context_base_run_at_time_worker(async_context_t *self, async_at_time_worker_t *worker) {
+#if ASYNC_CONTEXT_INSTRUMENTATION
+    uint64_t start_us = time_us_64();
+    int64_t lateness_us = (int64_t)(start_us - to_us_since_boot(worker->next_time));
+    uint bucket = 0;
+    if (lateness_us > 0) {
+        // bucket n holds lateness of 2^(n-1) to 2^n - 1 us
+        bucket = 64u - (uint)__builtin_clzll((uint64_t)lateness_us);
+        if (bucket >= ASYNC_CONTEXT_LATENESS_HISTOGRAM_BUCKETS) bucket = ASYNC_CONTEXT_LATENESS_HISTOGRAM_BUCKETS - 1;
+        if ((uint64_t)lateness_us > worker->stats.max_lateness_us) {
+            worker->stats.max_lateness_us = lateness_us > UINT32_MAX ? UINT32_MAX : (uint32_t)lateness_us;
         }
-        worker = next;
     }
-    self->next_time = earliest;
+    self->stats.lateness_histogram[bucket]++;
+    worker->do_work(self, worker);
+    record_run(&worker->stats, time_us_64() - start_us);
+#else
+    worker->do_work(self, worker);
+#endif
+}
+
+void async_context_base_run_when_pending_worker(async_context_t *self, async_when_pending_worker_t *worker) {
+#if ASYNC_CONTEXT_INSTRUMENTATION
+    uint64_t start_us = time_us_64();
+    worker->do_work(self, worker);
+    async_context_base_record_when_pending_worker_run(self, worker, time_us_64() - start_us);
+#else
+    worker->do_work(self, worker);
+#endif
 }
 
 absolute_time_t async_context_base_execute_once(async_context_t *self) {
     async_at_time_worker_t *at_time_worker;
     while (NULL != (at_time_worker = async_context_base_remove_ready_at_time_worker(self))) {
-        at_time_worker->do_work(self, at_time_worker);
+        async_context_base_run_at_time_worker(self, at_time_worker);
     }
     for(async_when_pending_worker_t *when_pending_worker = self->when_pending_list; when_pending_worker; when_pending_worker = when_pending_worker->next) {
         if (when_pending_worker->work_pending) {
             when_pending_worker->work_pending = false;
-            when_pending_worker->do_work(self, when_pending_worker);
+            async_context_base_run_when_pending_worker(self, when_pending_worker);
         }
     }
     async_context_base_refresh_next_timeout(self);
@@ -106,13 +194,8 @@ absolute_time_t async_context_base_execute_once(async_context_t *self) {
 }
 
 bool async_context_base_needs_servicing(async_context_t *self) {
-    absolute_time_t now = get_absolute_time();
-    if (self->at_time_list) {
-        for (async_at_time_worker_t *worker = self->at_time_list; worker; worker = worker->next) {
-            if (absolute_time_diff_us(worker->next_time, now) >= 0) {
-                return true;
-            }
-        }
+    if (self->at_time_list && absolute_time_diff_us(self->at_time_list->next_time, get_absolute_time()) >= 0) {
+        return true;
     }
     for(async_when_pending_worker_t *when_pending_worker = self->when_pending_list; when_pending_worker; when_pending_worker = when_pending_worker->next) {
         if (when_pending_worker->work_pending) {
@@ -120,4 +203,56 @@ bool async_context_base_needs_servicing(async_context_t *self) {
         }
     }
     return false;
-}
\ No newline at end of file
+}
+
+#if ASYNC_CONTEXT_INSTRUMENTATION
+void async_context_get_stats(async_context_t *context, async_context_stats_t *stats) {
+    async_context_acquire_lock_blocking(context);
+    *stats = context->stats;
+    async_context_release_lock(context);
+}
+
+void async_context_reset_stats(async_context_t *context) {
+    async_context_acquire_lock_blocking(context);
+    memset(&context->stats, 0, sizeof(context->stats));
+    for (async_at_time_worker_t *worker = context->at_time_list; worker; worker = worker->next) {
+        memset(&worker->stats, 0, sizeof(worker->stats));
+    }
+    for (async_when_pending_worker_t *worker = context->when_pending_list; worker; worker = worker->next) {
+        memset(&worker->stats, 0, sizeof(worker->stats));
+    }
+    async_context_release_lock(context);
+}
+
+static void print_worker_stats(const char *type, void *do_work, const async_worker_stats_t *stats) {
+    printf("  %s %p: runs %u, run time avg %uus max %uus", type, do_work, (uint)stats->run_count,
+           (uint)async_worker_stats_average_run_time_us(stats), (uint)stats->max_run_time_us);
+    if (stats->max_lateness_us) printf(", max lateness %uus", (uint)stats->max_lateness_us);
+    printf("\n");
+}
+
+void async_context_print_stats(async_context_t *context) {
+    async_context_acquire_lock_blocking(context);
+    const async_context_stats_t *stats = &context->stats;
+    printf("async_context %p: lock held %u times, avg %uus max %uus\n", context, (uint)stats->lock_count,
+           stats->lock_count ? (uint)(stats->total_lock_hold_time_us / stats->lock_count) : 0,
+           (uint)stats->max_lock_hold_time_us);
+    printf("  at time lateness:");
+    for (uint i = 0; i < ASYNC_CONTEXT_LATENESS_HISTOGRAM_BUCKETS; i++) {
+        if (!stats->lateness_histogram[i]) continue;
+        if (i == ASYNC_CONTEXT_LATENESS_HISTOGRAM_BUCKETS - 1) {
+            printf(" >=%uus:%u", 1u << (i - 1), (uint)stats->lateness_histogram[i]);
+        } else {
+            printf(" <%uus:%u", 1u << i, (uint)stats->lateness_histogram[i]);
+        }
+    }
+    printf("\n");
+    for (async_at_time_worker_t *worker = context->at_time_list; worker; worker = worker->next) {
+        print_worker_stats("at time worker", (void *)(uintptr_t)worker->do_work, &worker->stats);
+    }
+    for (async_when_pending_worker_t *worker = context->when_pending_list; worker; worker = worker->next) {
+        print_worker_stats("when pending worker", (void *)(uintptr_t)worker->do_work, &worker->stats);
+    }
+    async_context_release_lock(context);
+}
+#endif
@@ -198,7 +198,9 @@ void async_context_freertos_acquire_lock_blocking(async_context_t *self_base) {
     // Lock the other core and stop low_prio_irq running
     assert(!portCHECK_IF_IN_ISR());
     xSemaphoreTakeRecursive(self->lock_mutex, portMAX_DELAY);
-    self->nesting++;
+    if (!self->nesting++) {
+        async_context_base_lock_acquired(self_base);
+    }
 }
 
 void async_context_freertos_lock_check(__unused async_context_t *self_base) {
@@ -261,6 +263,7 @@ void async_context_freertos_release_lock(async_context_t *self_base) {
         } else {
             process_under_lock(self);
         }
+        async_context_base_lock_releasing(self_base);
     }
     --self->nesting;
     xSemaphoreGiveRecursive(self->lock_mutex);
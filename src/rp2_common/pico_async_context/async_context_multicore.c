@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "pico/async_context_multicore.h"
+#include "pico/async_context_base.h"
+#include "pico/multicore.h"
+#include "pico/sync.h"
+
+static const async_context_type_t template;
+// core 1 is dedicated to a single async_context_multicore
+static async_context_multicore_t *core1_context;
+
+async_context_multicore_config_t async_context_multicore_default_config(void) {
+    async_context_multicore_config_t config = {
+            .run_queue_length = ASYNC_CONTEXT_MULTICORE_DEFAULT_RUN_QUEUE_LENGTH,
+    };
+    return config;
+}
+
+static inline uint recursive_mutex_enter_count(recursive_mutex_t *mutex) {
+    return mutex->enter_count;
+}
+
+static inline lock_owner_id_t recursive_mutex_owner(recursive_mutex_t *mutex) {
+    return mutex->owner;
+}
+
+static void lock_acquire(async_context_multicore_t *self) {
+    recursive_mutex_enter_blocking(&self->lock_mutex);
+    if (recursive_mutex_enter_count(&self->lock_mutex) == 1) {
+        async_context_base_lock_acquired(&self->core);
+    }
+}
+
+static void lock_release(async_context_multicore_t *self) {
+    if (recursive_mutex_enter_count(&self->lock_mutex) == 1) {
+        async_context_base_lock_releasing(&self->core);
+    }
+    recursive_mutex_exit(&self->lock_mutex);
+}
+
+static void async_context_multicore_wake_up(async_context_multicore_t *self) {
+    for (uint i = 0; i < NUM_CORES; i++) {
+        sem_release(&self->work_needed_sem[i]);
+    }
+}
+
+// The run queue functions must be called with the spin lock held
+static bool run_queue_push(async_context_multicore_t *self, uint queue_num, async_when_pending_worker_t *worker) {
+    if (self->run_queue_count[queue_num] == self->run_queue_length) return false;
+    uint index = self->run_queue_head[queue_num] + self->run_queue_count[queue_num];
+    if (index >= self->run_queue_length) index -= self->run_queue_length;
+    self->run_queues[queue_num][index] = worker;
+    self->run_queue_count[queue_num]++;
+    return true;
+}
+
+static async_when_pending_worker_t *run_queue_pop(async_context_multicore_t *self, uint queue_num) {
+    async_when_pending_worker_t *worker = self->run_queues[queue_num][self->run_queue_head[queue_num]];
+    if (++self->run_queue_head[queue_num] == self->run_queue_length) self->run_queue_head[queue_num] = 0;
+    self->run_queue_count[queue_num]--;
+    return worker;
+}
+
+static void run_queues_remove(async_context_multicore_t *self, async_when_pending_worker_t *worker) {
+    for (uint queue_num = 0; queue_num < NUM_CORES; queue_num++) {
+        uint index = self->run_queue_head[queue_num];
+        for (uint i = 0; i < self->run_queue_count[queue_num]; i++) {
+            if (self->run_queues[queue_num][index] == worker) self->run_queues[queue_num][index] = NULL;
+            if (++index == self->run_queue_length) index = 0;
+        }
+    }
+}
+
+// Take the next worker to run on core_num, from its own run queue, or failing that from the other core's. The worker
+// is marked as running on core_num with its work_pending flag cleared
+static async_when_pending_worker_t *take_work(async_context_multicore_t *self, uint core_num) {
+    uint32_t save = spin_lock_blocking(self->spin_lock);
+    async_when_pending_worker_t *worker = NULL;
+    for (uint i = 0; i < NUM_CORES && !worker; i++) {
+        uint queue_num = (core_num + i) % NUM_CORES;
+        while (self->run_queue_count[queue_num]) {
+            worker = run_queue_pop(self, queue_num);
+            // skip removed workers, and workers no longer pending or which are running on the other core; in the
+            // latter case the other core will find the work still pending when it is done
+            if (worker && worker->work_pending && self->running[core_num ^ 1] != worker) break;
+            worker = NULL;
+        }
+    }
+    if (worker) {
+        worker->work_pending = false;
+        self->running[core_num] = worker;
+    }
+    spin_unlock(self->spin_lock, save);
+    return worker;
+}
+
+// Called when a worker has finished running on core_num; returns true if it should be run again straight away
+static bool finish_work(async_context_multicore_t *self, uint core_num, async_when_pending_worker_t *worker,
+                        __unused uint64_t run_time_us) {
+    uint32_t save = spin_lock_blocking(self->spin_lock);
+    bool again = false;
+    if (self->running_removed[core_num]) {
+        // the worker was removed whilst running, so it may no longer exist (or is being waited for to be freed)
+        self->running_removed[core_num] = false;
+        self->running[core_num] = NULL;
+    } else {
+#if ASYNC_CONTEXT_INSTRUMENTATION
+        async_context_base_record_when_pending_worker_run(&self->core, worker, run_time_us);
+#endif
+        again = worker->work_pending && self->rerun[core_num];
+        if (again) {
+            worker->work_pending = false;
+        } else {
+            self->running[core_num] = NULL;
+            // a worker which set its own work_pending flag is run on the next pass, as with the other async_contexts
+            if (worker->work_pending) self->scan_needed = true;
+        }
+    }
+    self->rerun[core_num] = false;
+    spin_unlock(self->spin_lock, save);
+    return again;
+}
+
+// Do one pass of work on core_num, returning the time of the next "at time" worker
+static absolute_time_t execute_work(async_context_multicore_t *self, uint core_num) {
+    lock_acquire(self);
+    async_at_time_worker_t *at_time_worker;
+    while (NULL != (at_time_worker = async_context_base_remove_ready_at_time_worker(&self->core))) {
+        async_context_base_run_at_time_worker(&self->core, at_time_worker);
+    }
+    async_context_base_refresh_next_timeout(&self->core);
+    absolute_time_t next_time = self->core.next_time;
+    if (self->scan_needed) {
+        // pick up workers whose work_pending flag was set directly, or which didn't fit in a run queue
+        self->scan_needed = false;
+        uint32_t save = spin_lock_blocking(self->spin_lock);
+        for (async_when_pending_worker_t *worker = self->core.when_pending_list; worker; worker = worker->next) {
+            if (worker->work_pending && !run_queue_push(self, core_num, worker)) {
+                self->scan_needed = true;
+                break;
+            }
+        }
+        spin_unlock(self->spin_lock, save);
+    }
+    lock_release(self);
+
+    async_when_pending_worker_t *worker;
+    while (NULL != (worker = take_work(self, core_num))) {
+        bool again;
+        do {
+#if ASYNC_CONTEXT_INSTRUMENTATION
+            uint64_t start_us = time_us_64();
+            worker->do_work(&self->core, worker);
+            again = finish_work(self, core_num, worker, time_us_64() - start_us);
+#else
+            worker->do_work(&self->core, worker);
+            again = finish_work(self, core_num, worker, 0);
+#endif
+        } while (again);
+    }
+    return next_time;
+}
+
+static void core1_entry(void) {
+    async_context_multicore_t *self = core1_context;
+    while (!self->stopping) {
+        absolute_time_t next_time = execute_work(self, 1);
+        sem_acquire_block_until(&self->work_needed_sem[1], next_time);
+    }
+    sem_release(&self->core1_done_sem);
+}
+
+bool async_context_multicore_init(async_context_multicore_t *self, async_context_multicore_config_t *config) {
+    assert(get_core_num() == 0);
+    if (core1_context || !config->run_queue_length || config->run_queue_length > UINT16_MAX) return false;
+    memset(self, 0, sizeof(*self));
+    self->core.type = &template;
+    self->core.flags = ASYNC_CONTEXT_FLAG_POLLED | ASYNC_CONTEXT_FLAG_CALLBACK_FROM_NON_IRQ;
+    self->core.core_num = 0;
+    self->core.next_time = at_the_end_of_time;
+    self->run_queue_length = (uint16_t)config->run_queue_length;
+    for (uint i = 0; i < NUM_CORES; i++) {
+        self->run_queues[i] = (async_when_pending_worker_t **)calloc(self->run_queue_length, sizeof(async_when_pending_worker_t *));
+        if (!self->run_queues[i]) {
+            for (uint j = 0; j < i; j++) free(self->run_queues[j]);
+            return false;
+        }
+        sem_init(&self->work_needed_sem[i], 0, 1);
+    }
+    recursive_mutex_init(&self->lock_mutex);
+    self->spin_lock = spin_lock_instance(next_striped_spin_lock_num());
+    sem_init(&self->core1_done_sem, 0, 1);
+    core1_context = self;
+    multicore_launch_core1(core1_entry);
+    return true;
+}
+
+static void async_context_multicore_deinit(async_context_t *self_base) {
+    async_context_multicore_t *self = (async_context_multicore_t *)self_base;
+    assert(get_core_num() == 0);
+    self->stopping = true;
+    sem_release(&self->work_needed_sem[1]);
+    sem_acquire_blocking(&self->core1_done_sem);
+    multicore_reset_core1();
+    for (uint i = 0; i < NUM_CORES; i++) {
+        free(self->run_queues[i]);
+    }
+    core1_context = NULL;
+    memset(self, 0, sizeof(*self));
+}
+
+static void async_context_multicore_acquire_lock_blocking(async_context_t *self_base) {
+    lock_acquire((async_context_multicore_t *)self_base);
+}
+
+static void async_context_multicore_release_lock(async_context_t *self_base) {
+    lock_release((async_context_multicore_t *)self_base);
+}
+
+static void async_context_multicore_lock_check(async_context_t *self_base) {
+    async_context_multicore_t *self = (async_context_multicore_t *)self_base;
+    if (recursive_mutex_enter_count(&self->lock_mutex) < 1 || recursive_mutex_owner(&self->lock_mutex) != lock_get_caller_owner_id()) {
+        panic_compact("async_context lock_check failed");
+    }
+}
+
+static uint32_t async_context_multicore_execute_sync(async_context_t *self_base, uint32_t (*func)(void *param), void *param) {
+    // the caller's core is as good as any other, so just run under the lock
+    async_context_multicore_acquire_lock_blocking(self_base);
+    uint32_t rc = func(param);
+    async_context_multicore_release_lock(self_base);
+    return rc;
+}
+
+static bool async_context_multicore_add_at_time_worker(async_context_t *self_base, async_at_time_worker_t *worker) {
+    async_context_multicore_t *self = (async_context_multicore_t *)self_base;
+    lock_acquire(self);
+    bool rc = async_context_base_add_at_time_worker(self_base, worker);
+    async_context_base_refresh_next_timeout(self_base);
+    lock_release(self);
+    // the cores may be waiting for a later time
+    async_context_multicore_wake_up(self);
+    return rc;
+}
+
+static bool async_context_multicore_remove_at_time_worker(async_context_t *self_base, async_at_time_worker_t *worker) {
+    async_context_multicore_t *self = (async_context_multicore_t *)self_base;
+    lock_acquire(self);
+    bool rc = async_context_base_remove_at_time_worker(self_base, worker);
+    lock_release(self);
+    return rc;
+}
+
+static bool async_context_multicore_add_when_pending_worker(async_context_t *self_base, async_when_pending_worker_t *worker) {
+    async_context_multicore_t *self = (async_context_multicore_t *)self_base;
+    lock_acquire(self);
+    bool rc = async_context_base_add_when_pending_worker(self_base, worker);
+    bool pending = rc && worker->work_pending;
+    if (pending) self->scan_needed = true;
+    lock_release(self);
+    if (pending) async_context_multicore_wake_up(self);
+    return rc;
+}
+
+static bool async_context_multicore_remove_when_pending_worker(async_context_t *self_base, async_when_pending_worker_t *worker) {
+    async_context_multicore_t *self = (async_context_multicore_t *)self_base;
+    lock_acquire(self);
+    bool rc = async_context_base_remove_when_pending_worker(self_base, worker);
+    if (rc) {
+        // make sure the worker isn't run from a run queue after it has been removed, nor touched again once it
+        // returns if it is running
+        uint32_t save = spin_lock_blocking(self->spin_lock);
+        run_queues_remove(self, worker);
+        for (uint i = 0; i < NUM_CORES; i++) {
+            if (self->running[i] == worker) self->running_removed[i] = true;
+        }
+        spin_unlock(self->spin_lock, save);
+    }
+    lock_release(self);
+    if (rc) {
+        // when pending workers run without the lock, so wait for the worker to return if it is running on another
+        // core, so the caller may free it; it may be running on this core if it is removing itself
+        uint core_num = get_core_num();
+        bool running;
+        do {
+            uint32_t save = spin_lock_blocking(self->spin_lock);
+            running = false;
+            for (uint i = 0; i < NUM_CORES; i++) {
+                if (i != core_num && self->running[i] == worker) running = true;
+            }
+            spin_unlock(self->spin_lock, save);
+            if (running) tight_loop_contents();
+        } while (running);
+    }
+    return rc;
+}
+
+static void async_context_multicore_set_work_pending(async_context_t *self_base, async_when_pending_worker_t *worker) {
+    async_context_multicore_t *self = (async_context_multicore_t *)self_base;
+    uint core_num = get_core_num();
+    uint32_t save = spin_lock_blocking(self->spin_lock);
+    bool was_pending = worker->work_pending;
+    worker->work_pending = true;
+    if (self->running[0] == worker || self->running[1] == worker) {
+        // the core running the worker will run it again when it is done
+        self->rerun[self->running[0] == worker ? 0 : 1] = true;
+    } else if (was_pending || !run_queue_push(self, core_num, worker)) {
+        // the worker is either already queued, or had its work_pending flag set directly (in which case it isn't),
+        // or the run queue is full
+        self->scan_needed = true;
+    }
+    spin_unlock(self->spin_lock, save);
+    async_context_multicore_wake_up(self);
+}
+
+static void async_context_multicore_poll(async_context_t *self_base) {
+    execute_work((async_context_multicore_t *)self_base, get_core_num());
+}
+
+static void async_context_multicore_wait_until(__unused async_context_t *self_base, absolute_time_t until) {
+    sleep_until(until);
+}
+
+static void async_context_multicore_wait_for_work_until(async_context_t *self_base, absolute_time_t until) {
+    async_context_multicore_t *self = (async_context_multicore_t *)self_base;
+    lock_acquire(self);
+    absolute_time_t next_time = self_base->next_time;
+    lock_release(self);
+    sem_acquire_block_until(&self->work_needed_sem[get_core_num()], absolute_time_min(next_time, until));
+}
+
+static const async_context_type_t template = {
+        .type = ASYNC_CONTEXT_MULTICORE,
+        .acquire_lock_blocking = async_context_multicore_acquire_lock_blocking,
+        .release_lock = async_context_multicore_release_lock,
+        .lock_check = async_context_multicore_lock_check,
+        .execute_sync = async_context_multicore_execute_sync,
+        .add_at_time_worker = async_context_multicore_add_at_time_worker,
+        .remove_at_time_worker = async_context_multicore_remove_at_time_worker,
+        .add_when_pending_worker = async_context_multicore_add_when_pending_worker,
+        .remove_when_pending_worker = async_context_multicore_remove_when_pending_worker,
+        .set_work_pending = async_context_multicore_set_work_pending,
+        .poll = async_context_multicore_poll,
+        .wait_until = async_context_multicore_wait_until,
+        .wait_for_work_until = async_context_multicore_wait_for_work_until,
+        .deinit = async_context_multicore_deinit,
+};
@@ -76,6 +76,9 @@ static void async_context_threadsafe_background_wake_up(async_context_t *self_ba
 static inline void lock_acquire(async_context_threadsafe_background_t *self) {
     // Lock the other core and stop low_prio_irq running
     recursive_mutex_enter_blocking(&self->lock_mutex);
+    if (recursive_mutex_enter_count(&self->lock_mutex) == 1) {
+        async_context_base_lock_acquired(&self->core);
+    }
 }
 
 static void async_context_threadsafe_background_lock_check(async_context_t *self_base) {
@@ -126,6 +129,7 @@ static void lock_release(async_context_threadsafe_background_t *self) {
 #else
         process_under_lock(self);
 #endif
+        async_context_base_lock_releasing(&self->core);
     }
     recursive_mutex_exit(&self->lock_mutex);
 #if ASYNC_CONTEXT_THREADSAFE_BACKGROUND_MULTI_CORE
@@ -296,7 +300,9 @@ static void low_priority_irq_handler(void) {
         // if the recurse count is not 1 then we have pre-empted something which held the lock on the same core,
         // so we cannot do processing here (however processing will be done when that lock is released)
         if (recursive_mutex_enter_count(&self->lock_mutex) == 1) {
+            async_context_base_lock_acquired(&self->core);
             process_under_lock(self);
+            async_context_base_lock_releasing(&self->core);
         }
         recursive_mutex_exit(&self->lock_mutex);
     }
@@ -53,6 +53,11 @@
  * \ref async_context_poll() is not required, and is a no-op. This context implements async_context locking and is thus
  * safe to call from any task, and from either core, according to the specific notes on each API.
  *
+ * async_context_multicore - Work is performed on core 1, which is dedicated to the async_context, and also on core 0
+ * whenever it calls \ref async_context_poll(). "when pending" workers are distributed across both cores, so unlike the
+ * other contexts this one does NOT provide a single logical thread of execution for them; see
+ * async_context_multicore.h for details.
+ *
  * Each async_context provides bespoke methods of instantiation which are provided in the corresponding headers (e.g.
  * async_context_poll.h, async_context_threadsafe_background.h, asycn_context_freertos.h).
  * async_contexts are de-initialized by the common async_context_deint() method.
@@ -74,10 +79,47 @@ enum {
     ASYNC_CONTEXT_POLL = 1,
     ASYNC_CONTEXT_THREADSAFE_BACKGROUND = 2,
     ASYNC_CONTEXT_FREERTOS = 3,
+    ASYNC_CONTEXT_MULTICORE = 4,
 };
 
+// PICO_CONFIG: ASYNC_CONTEXT_INSTRUMENTATION, Enable collection of worker run time and lateness statistics and lock hold time statistics by async_contexts (see async_context_get_stats()), type=bool, default=0, group=pico_async_context
+#ifndef ASYNC_CONTEXT_INSTRUMENTATION
+#define ASYNC_CONTEXT_INSTRUMENTATION 0
+#endif
+
+// PICO_CONFIG: ASYNC_CONTEXT_LATENESS_HISTOGRAM_BUCKETS, Number of buckets in the histogram of "at time" worker lateness when ASYNC_CONTEXT_INSTRUMENTATION is enabled, type=int, default=16, min=2, max=32, group=pico_async_context
+#ifndef ASYNC_CONTEXT_LATENESS_HISTOGRAM_BUCKETS
+#define ASYNC_CONTEXT_LATENESS_HISTOGRAM_BUCKETS 16
+#endif
+
 typedef struct async_context async_context_t;
 
+/*! \brief Statistics for a single worker, collected when ASYNC_CONTEXT_INSTRUMENTATION is enabled
+ *  \ingroup pico_async_context
+ */
+typedef struct async_worker_stats {
+    uint32_t run_count;          ///< number of times do_work has been called
+    uint32_t max_run_time_us;    ///< longest time a single call to do_work took
+    uint64_t total_run_time_us;  ///< total time spent in do_work
+    uint32_t max_lateness_us;    ///< "at time" workers only; the latest do_work has been called after next_time
+} async_worker_stats_t;
+
+/*! \brief Statistics for an async_context, collected when ASYNC_CONTEXT_INSTRUMENTATION is enabled
+ *  \ingroup pico_async_context
+ */
+typedef struct async_context_stats {
+    /*!
+     * \brief histogram of how late "at time" workers are called after their next_time
+     *
+     * Bucket 0 counts calls less than 1us late, and bucket n counts calls from 2^(n-1) to 2^n - 1 us late,
+     * except for the last bucket which also counts anything later.
+     */
+    uint32_t lateness_histogram[ASYNC_CONTEXT_LATENESS_HISTOGRAM_BUCKETS];
+    uint32_t lock_count;                ///< number of times the lock has been acquired (outermost acquisitions only)
+    uint32_t max_lock_hold_time_us;     ///< longest time the lock has been held
+    uint64_t total_lock_hold_time_us;   ///< total time the lock has been held
+} async_context_stats_t;
+
 /*! \brief A "timeout" instance used by an async_context
  *  \ingroup pico_async_context
  *
@@ -110,6 +152,20 @@ typedef struct async_work_on_timeout {
      * \brief User data associated with the timeout instance
      */
     void *user_data;
+    /*!
+     * \brief private link list pointer to the previous (earlier) timeout
+     */
+    struct async_work_on_timeout *prev;
+    /*!
+     * \brief private pointer to the async_context this timeout is queued on, or NULL
+     */
+    async_context_t *context;
+#if ASYNC_CONTEXT_INSTRUMENTATION
+    /*!
+     * \brief Run time and lateness statistics for the timeout
+     */
+    async_worker_stats_t stats;
+#endif
 } async_at_time_worker_t;
 
 /*! \brief A "worker" instance used by an async_context
@@ -142,6 +198,12 @@ typedef struct async_when_pending_worker {
      * \brief User data associated with the worker instance
      */
     void *user_data;
+#if ASYNC_CONTEXT_INSTRUMENTATION
+    /*!
+     * \brief Run time statistics for the worker
+     */
+    async_worker_stats_t stats;
+#endif
 } async_when_pending_worker_t;
 
 #define ASYNC_CONTEXT_FLAG_CALLBACK_FROM_NON_IRQ 0x1
@@ -183,6 +245,10 @@ struct async_context {
     absolute_time_t next_time;
     uint16_t flags;
     uint8_t  core_num;
+#if ASYNC_CONTEXT_INSTRUMENTATION
+    async_context_stats_t stats;
+    uint64_t lock_acquired_time_us;
+#endif
 };
 
 /*!
@@ -262,7 +328,8 @@ static inline uint32_t async_context_execute_sync(async_context_t *context, uint
  *
  * An "at time" worker will run at or after a specific point in time, and is automatically when (just before) it runs.
  *
- * The time to fire is specified in the next_time field of the worker.
+ * The time to fire is specified in the next_time field of the worker. If the worker is already present, it is
+ * rescheduled to fire at its (possibly updated) next_time.
  *
  * \note for async_contexts that provide locking (not async_context_poll), this method is threadsafe. and may be called from within any 
  * worker method called by the async_context or from any other non-IRQ context.
@@ -464,6 +531,51 @@ static inline void async_context_deinit(async_context_t *context) {
     context->type->deinit(context);
 }
 
+#if ASYNC_CONTEXT_INSTRUMENTATION
+/*!
+ * \brief Get a copy of the statistics for an async_context
+ * \ingroup pico_async_context
+ *
+ * Per worker statistics are held in the stats field of each worker, and may be read directly by the owner of the
+ * async_context lock.
+ *
+ * \note lock hold times are only collected by async_contexts that provide locking (not async_context_poll)
+ *
+ * \param context the async_context
+ * \param stats the structure to fill in
+ */
+void async_context_get_stats(async_context_t *context, async_context_stats_t *stats);
+
+/*!
+ * \brief Reset the statistics for an async_context, and for all the workers currently added to it
+ * \ingroup pico_async_context
+ *
+ * \param context the async_context
+ */
+void async_context_reset_stats(async_context_t *context);
+
+/*!
+ * \brief Print the statistics for an async_context and all the workers currently added to it
+ * \ingroup pico_async_context
+ *
+ * Workers are identified by their do_work function address
+ *
+ * \param context the async_context
+ */
+void async_context_print_stats(async_context_t *context);
+
+/*!
+ * \brief Return the average time taken by a call to do_work for a worker
+ * \ingroup pico_async_context
+ *
+ * \param stats the worker's statistics
+ * \return the average run time in microseconds, or 0 if the worker has not run
+ */
+static inline uint32_t async_worker_stats_average_run_time_us(const async_worker_stats_t *stats) {
+    return stats->run_count ? (uint32_t)(stats->total_run_time_us / stats->run_count) : 0;
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
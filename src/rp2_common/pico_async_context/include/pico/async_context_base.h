@@ -26,6 +26,24 @@ void async_context_base_refresh_next_timeout(async_context_t *self);
 absolute_time_t async_context_base_execute_once(async_context_t *self);
 bool async_context_base_needs_servicing(async_context_t *self);
 
+// call a worker's do_work, collecting statistics if ASYNC_CONTEXT_INSTRUMENTATION is enabled; these must be
+// called under lock (or from the single thread of a non-locking async_context)
+void async_context_base_run_at_time_worker(async_context_t *self, async_at_time_worker_t *worker);
+void async_context_base_run_when_pending_worker(async_context_t *self, async_when_pending_worker_t *worker);
+
+#if ASYNC_CONTEXT_INSTRUMENTATION
+// record a do_work call; must be called under lock. Nothing is recorded if the worker is no longer in the context's
+// list, as it may have removed itself during do_work and no longer exist
+void async_context_base_record_when_pending_worker_run(async_context_t *self, async_when_pending_worker_t *worker, uint64_t run_time_us);
+// to be called by async_context implementations just after the outermost acquisition, and just before the
+// outermost release of their lock
+void async_context_base_lock_acquired(async_context_t *self);
+void async_context_base_lock_releasing(async_context_t *self);
+#else
+static inline void async_context_base_lock_acquired(__unused async_context_t *self) {}
+static inline void async_context_base_lock_releasing(__unused async_context_t *self) {}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
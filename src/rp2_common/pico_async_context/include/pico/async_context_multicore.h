@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _PICO_ASYNC_CONTEXT_MULTICORE_H
+#define _PICO_ASYNC_CONTEXT_MULTICORE_H
+
+/** \file pico/async_context_multicore.h
+ *  \defgroup async_context_multicore async_context_multicore
+ *  \ingroup pico_async_context
+ *
+ * \brief async_context_multicore provides an implementation of \ref async_context that distributes "when pending"
+ * work across both cores.
+ *
+ * Core 1 is dedicated to running work for the async_context, and core 0 runs work whenever it calls
+ * \ref async_context_poll() (so the async_context is of the polled variety, and core 0 may instead call
+ * \ref async_context_wait_for_work_until() or just leave core 1 to do all the work).
+ *
+ * When a "when pending" worker is marked as having work pending, it is placed on the run queue of the calling core,
+ * and a core with no work of its own will steal work from the other core's run queue. A worker is never run
+ * concurrently with itself; if it is marked as having work pending while running, it is run again afterwards.
+ *
+ * \note Unlike the other async_context types, "when pending" workers are run WITHOUT the async_context lock held,
+ * and different workers may run at the same time on both cores, so they must synchronize any shared state themselves
+ * (which may be done by calling \ref async_context_acquire_lock_blocking()). "at time" workers are run with the
+ * async_context lock held, so they run one at a time. Libraries which expect all their workers to be
+ * serialized by the async_context lock (e.g. lwIP or BTstack) should use one of the other async_context types.
+ *
+ * \note If a "when pending" worker is running on another core when it is removed, \ref
+ * async_context_remove_when_pending_worker() waits for its do_work to return (with the async_context lock released),
+ * so the worker may be freed as soon as it has been removed. A worker may also remove itself from its own do_work.
+ * Because of the wait, a worker must not be removed with the async_context lock held (e.g. from an "at time"
+ * worker) if its do_work may itself be waiting for the lock.
+ *
+ * \note This async_context uses core 1 (via \ref pico_multicore), which must not otherwise be in use. On the host
+ * platform the cores are threads, so this may be used to measure scaling on a PC.
+ */
+
+#include "pico/async_context.h"
+#include "pico/sem.h"
+#include "pico/mutex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// PICO_CONFIG: ASYNC_CONTEXT_MULTICORE_DEFAULT_RUN_QUEUE_LENGTH, Default length of each core's run queue of "when pending" workers for async_context_multicore, type=int, default=16, min=1, group=pico_async_context
+#ifndef ASYNC_CONTEXT_MULTICORE_DEFAULT_RUN_QUEUE_LENGTH
+#define ASYNC_CONTEXT_MULTICORE_DEFAULT_RUN_QUEUE_LENGTH 16
+#endif
+
+typedef struct async_context_multicore async_context_multicore_t;
+
+/**
+ * \brief Configuration object for async_context_multicore instances.
+ */
+typedef struct async_context_multicore_config {
+    /**
+     * \brief the length of each core's run queue
+     *
+     * If a run queue is full, the work is still done, but found by a slower scan of all the workers
+     */
+    uint run_queue_length;
+} async_context_multicore_config_t;
+
+struct async_context_multicore {
+    async_context_t core;
+    recursive_mutex_t lock_mutex;
+    spin_lock_t *spin_lock; // protects the run queues and running state, and the work_pending flag of queued workers
+    async_when_pending_worker_t **run_queues[NUM_CORES];
+    uint16_t run_queue_head[NUM_CORES];
+    uint16_t run_queue_count[NUM_CORES];
+    uint16_t run_queue_length;
+    async_when_pending_worker_t *running[NUM_CORES];
+    bool rerun[NUM_CORES];
+    bool running_removed[NUM_CORES]; // the worker running on each core has been removed, so may no longer exist
+    semaphore_t work_needed_sem[NUM_CORES];
+    semaphore_t core1_done_sem;
+    volatile bool scan_needed;
+    volatile bool stopping;
+};
+
+/*!
+ * \brief Initialize an async_context_multicore instance using the specified configuration
+ * \ingroup async_context_multicore
+ *
+ * If this method succeeds (returns true), then the async_context is available for use
+ * and can be de-initialized by calling async_context_deinit(). This method must be called on core 0,
+ * and launches core 1.
+ *
+ * \param self a pointer to async_context_multicore structure to initialize
+ * \param config the configuration object specifying characteristics for the async_context
+ * \return true if initialization is successful, false otherwise
+ */
+bool async_context_multicore_init(async_context_multicore_t *self, async_context_multicore_config_t *config);
+
+/*!
+ * \brief Return a copy of the default configuration object used by \ref async_context_multicore_init_with_defaults()
+ * \ingroup async_context_multicore
+ *
+ * The caller can then modify just the settings it cares about, and call \ref async_context_multicore_init()
+ * \return the default configuration object
+ */
+async_context_multicore_config_t async_context_multicore_default_config(void);
+
+/*!
+ * \brief Initialize an async_context_multicore instance with default values
+ * \ingroup async_context_multicore
+ *
+ * If this method succeeds (returns true), then the async_context is available for use
+ * and can be de-initialized by calling async_context_deinit().
+ *
+ * \param self a pointer to async_context_multicore structure to initialize
+ * \return true if initialization is successful, false otherwise
+ */
+static inline bool async_context_multicore_init_with_defaults(async_context_multicore_t *self) {
+    async_context_multicore_config_t config = async_context_multicore_default_config();
+    return async_context_multicore_init(self, &config);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,9 +12,19 @@
 *
 * \brief Multi-core safety for malloc, calloc and free
 *
-* This library does not provide any additional functions
+* By default the C library allocator is used, protected by a mutex when pico_multicore is in use. With
+* \ref PICO_MALLOC_POOL=1, allocations of up to 256 bytes are instead served from a pool of fixed size classes.
+* Each core keeps its own cache of free blocks of each size class, so most allocations and frees take no lock, and
+* blocks of one size are kept together in slabs, so long running workloads which allocate many small objects of
+* varying lifetime don't fragment the C library heap. Larger allocations (and allocations for which the pool is
+* exhausted) fall back to the C library allocator.
+*
+* With \ref PICO_MALLOC_STATS=1, pico_malloc also keeps statistics of heap usage, including the peak usage and
+* allocation totals for each call site; see \ref malloc_get_stats.
 */
 
+#include "pico.h"
+
 // PICO_CONFIG: PICO_USE_MALLOC_MUTEX, Whether to protect malloc etc with a mutex, type=bool, default=1 with pico_multicore, 0 otherwise, group=pico_malloc
 #if LIB_PICO_MULTICORE && !defined(PICO_USE_MALLOC_MUTEX)
 #define PICO_USE_MALLOC_MUTEX 1
@@ -35,4 +45,184 @@
 #define PICO_DEBUG_MALLOC_LOW_WATER 0
 #endif
 
+// PICO_CONFIG: PICO_MALLOC_POOL, Enable/disable serving small allocations from a pool of fixed size classes with per-core free lists, falling back to the C library allocator for larger allocations, type=bool, default=0, group=pico_malloc
+#ifndef PICO_MALLOC_POOL
+#define PICO_MALLOC_POOL 0
+#endif
+
+// PICO_CONFIG: PICO_MALLOC_POOL_SIZE, Size in bytes of the pool for PICO_MALLOC_POOL; this is reserved in .bss, so is no longer available to the C library heap, type=int, default=16384, depends=PICO_MALLOC_POOL, group=pico_malloc
+#ifndef PICO_MALLOC_POOL_SIZE
+#define PICO_MALLOC_POOL_SIZE 16384
+#endif
+
+// PICO_CONFIG: PICO_MALLOC_POOL_SLAB_SIZE, Size in bytes of the slabs which the pool is divided into; each slab is assigned to a single size class when first needed, type=int, default=1024, depends=PICO_MALLOC_POOL, group=pico_malloc
+#ifndef PICO_MALLOC_POOL_SLAB_SIZE
+#define PICO_MALLOC_POOL_SLAB_SIZE 1024
+#endif
+
+// PICO_CONFIG: PICO_MALLOC_POOL_CACHE_BLOCKS, Number of free blocks of each size class cached per core before half of them are returned to the shared free list, type=int, default=16, min=2, depends=PICO_MALLOC_POOL, group=pico_malloc
+#ifndef PICO_MALLOC_POOL_CACHE_BLOCKS
+#define PICO_MALLOC_POOL_CACHE_BLOCKS 16
+#endif
+
+// PICO_CONFIG: PICO_SPINLOCK_ID_MALLOC_POOL, Spinlock ID protecting the shared free lists of PICO_MALLOC_POOL; by default this is a striped (shared) spin lock, as it is only held briefly, min=0, max=31, default=PICO_SPINLOCK_ID_STRIPED_LAST, depends=PICO_MALLOC_POOL, group=pico_malloc
+#ifndef PICO_SPINLOCK_ID_MALLOC_POOL
+#define PICO_SPINLOCK_ID_MALLOC_POOL PICO_SPINLOCK_ID_STRIPED_LAST
+#endif
+
+// PICO_CONFIG: PICO_MALLOC_STATS, Enable/disable collection of heap statistics (see malloc_get_stats), type=bool, default=0, group=pico_malloc
+#ifndef PICO_MALLOC_STATS
+#define PICO_MALLOC_STATS 0
+#endif
+
+// PICO_CONFIG: PICO_MALLOC_STATS_CALL_SITES, Number of call sites (return addresses) for which PICO_MALLOC_STATS keeps allocation totals, type=int, default=16, min=0, depends=PICO_MALLOC_STATS, group=pico_malloc
+#ifndef PICO_MALLOC_STATS_CALL_SITES
+#define PICO_MALLOC_STATS_CALL_SITES 16
+#endif
+
+// PICO_CONFIG: PICO_SPINLOCK_ID_MALLOC_STATS, Spinlock ID protecting the statistics collected by PICO_MALLOC_STATS; by default this is a striped (shared) spin lock, as it is only held briefly, min=0, max=31, default=PICO_SPINLOCK_ID_STRIPED_LAST, depends=PICO_MALLOC_STATS, group=pico_malloc
+#ifndef PICO_SPINLOCK_ID_MALLOC_STATS
+#define PICO_SPINLOCK_ID_MALLOC_STATS PICO_SPINLOCK_ID_STRIPED_LAST
+#endif
+
+// the number of allocation size buckets in malloc_stats_t: up to 16 bytes, up to 32 bytes, ... up to 1024 bytes, and
+// larger
+#define PICO_MALLOC_STATS_NUM_SIZE_BUCKETS 8
+
+// the number of size classes in the pool, which are 8, 16, 24, 32, 48, 64, 96, 128, 192 and 256 bytes
+#define PICO_MALLOC_POOL_NUM_CLASSES 10
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Heap statistics
+ *  \ingroup pico_malloc
+ *
+ * Sizes of allocations in use are their usable size (as returned by malloc_usable_size for the C library heap, or
+ * the block size for \ref PICO_MALLOC_POOL), which may be a little more than the size requested. The heap_ fields
+ * describe the C library heap only, not the allocation pool.
+ */
+typedef struct malloc_stats {
+    uint32_t bytes_in_use;           ///< the size of all allocations in use
+    uint32_t peak_bytes_in_use;      ///< the highest value of bytes_in_use (since \ref malloc_stats_reset_peak)
+    uint32_t allocs;                 ///< the number of successful allocations; a realloc counts as a free and an allocation
+    uint32_t frees;                  ///< the number of allocations freed
+    uint32_t failed_allocs;          ///< the number of allocations which failed
+    uint32_t size_allocs[PICO_MALLOC_STATS_NUM_SIZE_BUCKETS]; ///< the number of allocations by requested size: up to 16 bytes, up to 32 bytes, ... up to 1024 bytes, and larger
+    uint32_t other_call_site_allocs; ///< the number of allocations from call sites which did not fit in the call site table
+    uint32_t heap_size;              ///< the size of the C library heap, from the end of .bss to the stack limit
+    uint32_t heap_free;              ///< the free space in the C library heap, including space not yet claimed by malloc
+    uint32_t heap_free_top;          ///< the free space at the top of the C library heap, which is one contiguous block
+    uint32_t heap_fragmentation;     ///< the percentage of heap_free lying in holes below the top of the heap, rather than in heap_free_top
+} malloc_stats_t;
+
+/*! \brief Allocation totals for one call site
+ *  \ingroup pico_malloc
+ */
+typedef struct malloc_call_site_stats {
+    uintptr_t call_site; ///< the return address of the call to malloc, calloc or realloc
+    uint32_t allocs;     ///< the number of allocations from this call site
+    uint32_t bytes;      ///< the total size requested by this call site
+} malloc_call_site_stats_t;
+
+/*! \brief Get the heap statistics
+ *  \ingroup pico_malloc
+ *
+ * This requires \ref PICO_MALLOC_STATS=1. The counts are kept as allocations are made; the free space of the C
+ * library heap is read from mallinfo when this is called, with the malloc mutex held, but nothing is allocated.
+ * This should not be called from an IRQ handler.
+ *
+ * The free space at the top of the heap (the C library's top chunk, plus the space it has not yet claimed with sbrk) is
+ * a lower bound on the largest allocation which will succeed; a hole lower in the heap may be larger. A
+ * heap_fragmentation near 100 with a small heap_free_top means the free space is scattered in holes between
+ * allocations. Note that newlib-nano's mallinfo does not report its top chunk, so all its free chunks count as holes.
+ *
+ * \param stats the stats to fill in
+ */
+void malloc_get_stats(malloc_stats_t *stats);
+
+/*! \brief Find the size of the largest allocation from the C library heap which would currently succeed, by trial allocation
+ *  \ingroup pico_malloc
+ *
+ * \warning This is a debugging aid which modifies the heap; use the non-allocating heap_free_top and heap_fragmentation
+ * from \ref malloc_get_stats for monitoring.
+ *
+ * This requires \ref PICO_MALLOC_STATS=1. The C library does not report the largest free block, so it is found by a
+ * binary search of trial allocations (to a granularity of 8 bytes), with the malloc mutex held throughout:
+ *
+ * - it makes around 20 calls to malloc and free, blocking other allocations on both cores meanwhile;
+ * - the trial allocations grow the heap (with sbrk) up to the stack limit, and the C library does not return that
+ *   space afterwards, so later calls to \ref malloc_get_stats report it as claimed;
+ * - it must not be called from an IRQ handler.
+ *
+ * Trial allocations extending past the stack limit (which can succeed with \ref PICO_USE_OPTIMISTIC_SBRK) are treated
+ * as failures, and errno is preserved.
+ *
+ * \return the size of the largest free block in bytes
+ */
+uint32_t malloc_debug_get_largest_free_block(void);
+
+/*! \brief Get the allocation totals for each call site
+ *  \ingroup pico_malloc
+ *
+ * This requires \ref PICO_MALLOC_STATS=1. The totals are kept for the first \ref PICO_MALLOC_STATS_CALL_SITES call
+ * sites which allocate; later call sites are only counted in malloc_stats_t.other_call_site_allocs. Since the totals
+ * are never decreased, a call site whose total keeps increasing while the application is in a steady state is a
+ * likely source of a leak. Use addr2line (or the map file) to find the code at a call site.
+ *
+ * \param sites the array to fill in, in decreasing order of bytes
+ * \param max_sites the size of the array
+ * \return the number of call sites filled in
+ */
+uint malloc_get_call_site_stats(malloc_call_site_stats_t *sites, uint max_sites);
+
+/*! \brief Reset the peak bytes in use to the current bytes in use
+ *  \ingroup pico_malloc
+ *
+ * This requires \ref PICO_MALLOC_STATS=1
+ */
+void malloc_stats_reset_peak(void);
+
+/*! \brief Print the heap statistics and the call site totals with printf
+ *  \ingroup pico_malloc
+ *
+ * This requires \ref PICO_MALLOC_STATS=1
+ */
+void malloc_dump_stats(void);
+
+/*! \brief Usage of one size class of the allocation pool
+ *  \ingroup pico_malloc
+ */
+typedef struct malloc_pool_class_stats {
+    uint32_t block_size;    ///< the size of the blocks in this class
+    uint32_t slabs;         ///< the number of slabs assigned to this class
+    uint32_t blocks_in_use; ///< the number of blocks currently allocated
+    uint32_t blocks_free;   ///< the number of free blocks in this class's slabs
+} malloc_pool_class_stats_t;
+
+/*! \brief Usage of the allocation pool
+ *  \ingroup pico_malloc
+ */
+typedef struct malloc_pool_stats {
+    uint32_t slabs_used;        ///< the number of slabs assigned to a size class
+    uint32_t slabs_total;       ///< the number of slabs in the pool
+    uint32_t fallback_allocs;   ///< the number of allocations passed on to the C library allocator (too large, or the size class was exhausted)
+    malloc_pool_class_stats_t classes[PICO_MALLOC_POOL_NUM_CLASSES];
+} malloc_pool_stats_t;
+
+/*! \brief Get the usage of the allocation pool
+ *  \ingroup pico_malloc
+ *
+ * This requires \ref PICO_MALLOC_POOL=1. The slabs and free blocks of each size class show how much of the pool
+ * is held by each size; a slab stays assigned to its size class once all its blocks are freed.
+ *
+ * \param stats the stats to fill in
+ */
+void malloc_pool_get_stats(malloc_pool_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
\ No newline at end of file
@@ -7,16 +7,26 @@
 #include <stdlib.h>
 #include "pico.h"
 #include "pico/malloc.h"
+#if PICO_MALLOC_POOL
+#include <string.h>
+#include "malloc_pool.h"
+#endif
 
 #if PICO_USE_MALLOC_MUTEX
 #include "pico/mutex.h"
 auto_init_mutex(malloc_mutex);
 #endif
 
-#if PICO_DEBUG_MALLOC
+#if PICO_DEBUG_MALLOC || PICO_MALLOC_STATS
 #include <stdio.h>
 #endif
 
+#if PICO_MALLOC_STATS
+#include <errno.h>
+#include <malloc.h>
+#include "hardware/sync.h"
+#endif
+
 extern void *REAL_FUNC(malloc)(size_t size);
 extern void *REAL_FUNC(calloc)(size_t count, size_t size);
 extern void *REAL_FUNC(realloc)(void *mem, size_t size);
@@ -65,10 +75,99 @@ static inline void check_alloc(__unused void *mem, __unused uint size) {
 #endif
 }
 
-void *WRAPPER_FUNC(malloc)(size_t size) {
+#if PICO_MALLOC_STATS
+static malloc_stats_t stats;
+static malloc_call_site_stats_t call_sites[PICO_MALLOC_STATS_CALL_SITES];
+
+#if __PICOLIBC__
+// PICOLIBC implementations of calloc and realloc may call malloc and free, which must not be counted again; as for
+// the mutex, we record the exception nesting of the outer call
+static uint8_t stats_exception_level_plus_one[NUM_CORES];
+#define STATS_OUTER_BEGIN() stats_exception_level_plus_one[get_core_num()] = (uint8_t)(__get_current_exception() + 1);
+#define STATS_OUTER_END() stats_exception_level_plus_one[get_core_num()] = 0;
+#define STATS_NESTED() (stats_exception_level_plus_one[get_core_num()] == __get_current_exception() + 1)
+#else
+#define STATS_OUTER_BEGIN() ((void)0);
+#define STATS_OUTER_END() ((void)0);
+#define STATS_NESTED() false
+#endif
+
+static inline spin_lock_t *stats_spin_lock(void) {
+    return spin_lock_instance(PICO_SPINLOCK_ID_MALLOC_STATS);
+}
+
+static size_t usable_size(void *mem) {
+    if (!mem) return 0;
+#if PICO_MALLOC_POOL
+    if (malloc_pool_owns(mem)) return malloc_pool_block_size(mem);
+#endif
+    return malloc_usable_size(mem);
+}
+
+static uint size_bucket(size_t size) {
+    if (size <= 16) return 0;
+    return MIN(PICO_MALLOC_STATS_NUM_SIZE_BUCKETS - 1, 28u - (uint)__builtin_clz((uint32_t)(size - 1)));
+}
+
+// record the freeing of freed bytes and/or an allocation (of requested bytes, which failed if allocated is NULL)
+static void stats_record(size_t freed, void *allocated, size_t requested, uintptr_t call_site) {
+    size_t allocated_size = usable_size(allocated);
+#ifdef __arm__
+    // clear the thumb bit
+    call_site &= ~(uintptr_t)1;
+#endif
+    uint32_t save = spin_lock_blocking(stats_spin_lock());
+    if (freed) {
+        stats.frees++;
+        stats.bytes_in_use -= (uint32_t)freed;
+    }
+    if (allocated) {
+        stats.allocs++;
+        stats.bytes_in_use += (uint32_t)allocated_size;
+        stats.peak_bytes_in_use = MAX(stats.peak_bytes_in_use, stats.bytes_in_use);
+        stats.size_allocs[size_bucket(requested)]++;
+        uint i;
+        for (i = 0; i < PICO_MALLOC_STATS_CALL_SITES; i++) {
+            if (call_sites[i].call_site == call_site || !call_sites[i].allocs) break;
+        }
+        if (i < PICO_MALLOC_STATS_CALL_SITES) {
+            call_sites[i].call_site = call_site;
+            call_sites[i].allocs++;
+            call_sites[i].bytes += (uint32_t)requested;
+        } else {
+            stats.other_call_site_allocs++;
+        }
+    } else if (requested) {
+        stats.failed_allocs++;
+    }
+    spin_unlock(stats_spin_lock(), save);
+}
+#else
+#define STATS_OUTER_BEGIN() ((void)0);
+#define STATS_OUTER_END() ((void)0);
+#endif
+
+static void *do_malloc(size_t size) {
+#if PICO_MALLOC_POOL
+    void *rc = malloc_pool_alloc(size);
+    if (!rc) {
+        MALLOC_ENTER(false)
+        rc = REAL_FUNC(malloc)(size);
+        MALLOC_EXIT(false)
+    }
+#else
     MALLOC_ENTER(false)
     void *rc = REAL_FUNC(malloc)(size);
     MALLOC_EXIT(false)
+#endif
+    return rc;
+}
+
+void *WRAPPER_FUNC(malloc)(size_t size) {
+    void *rc = do_malloc(size);
+#if PICO_MALLOC_STATS
+    if (!STATS_NESTED()) stats_record(0, rc, size, (uintptr_t)__builtin_return_address(0));
+#endif
 #if PICO_DEBUG_MALLOC
     if (!rc) {
         printf("malloc %d failed to allocate memory\n", (uint) size);
@@ -81,9 +180,28 @@ void *WRAPPER_FUNC(malloc)(size_t size) {
 }
 
 void *WRAPPER_FUNC(calloc)(size_t count, size_t size) {
+#if PICO_MALLOC_POOL
+    // a pool allocation is only attempted if count * size doesn't overflow
+    void *rc = count <= MALLOC_POOL_MAX_SIZE && size <= MALLOC_POOL_MAX_SIZE ? malloc_pool_alloc(count * size) : NULL;
+    if (rc) {
+        memset(rc, 0, count * size);
+    } else {
+        STATS_OUTER_BEGIN()
+        MALLOC_ENTER(true)
+        rc = REAL_FUNC(calloc)(count, size);
+        MALLOC_EXIT(true)
+        STATS_OUTER_END()
+    }
+#else
+    STATS_OUTER_BEGIN()
     MALLOC_ENTER(true)
     void *rc = REAL_FUNC(calloc)(count, size);
     MALLOC_EXIT(true)
+    STATS_OUTER_END()
+#endif
+#if PICO_MALLOC_STATS
+    stats_record(0, rc, count * size, (uintptr_t)__builtin_return_address(0));
+#endif
 #if PICO_DEBUG_MALLOC
     if (!rc) {
         printf("calloc %d failed to allocate memory\n", (uint) (count * size));
@@ -95,10 +213,46 @@ void *WRAPPER_FUNC(calloc)(size_t count, size_t size) {
     return rc;
 }
 
+#if PICO_MALLOC_POOL
+static void *pool_realloc(void *mem, size_t size) {
+    size_t block_size = malloc_pool_block_size(mem);
+    // keep the block unless the allocation has grown out of it, or shrunk enough to fit a smaller size class
+    if (size <= block_size && (size > block_size / 2 || block_size <= 16)) return mem;
+    void *rc = do_malloc(size);
+    if (rc) {
+        memcpy(rc, mem, MIN(size, block_size));
+        malloc_pool_free(mem);
+    }
+    return rc;
+}
+#endif
+
 void *WRAPPER_FUNC(realloc)(void *mem, size_t size) {
+#if PICO_MALLOC_STATS
+    size_t old_size = usable_size(mem);
+#endif
+#if PICO_MALLOC_POOL
+    void *rc;
+    if (malloc_pool_owns(mem)) {
+        rc = pool_realloc(mem, size);
+    } else {
+        STATS_OUTER_BEGIN()
+        MALLOC_ENTER(true)
+        rc = REAL_FUNC(realloc)(mem, size);
+        MALLOC_EXIT(true)
+        STATS_OUTER_END()
+    }
+#else
+    STATS_OUTER_BEGIN()
     MALLOC_ENTER(true)
     void *rc = REAL_FUNC(realloc)(mem, size);
     MALLOC_EXIT(true)
+    STATS_OUTER_END()
+#endif
+#if PICO_MALLOC_STATS
+    // the old allocation is freed unless the realloc failed (realloc to size 0 may free it and return NULL)
+    stats_record(rc || !size ? old_size : 0, rc, size, (uintptr_t)__builtin_return_address(0));
+#endif
 #if PICO_DEBUG_MALLOC
     if (!rc) {
         printf("realloc %d failed to allocate memory\n", (uint) size);
@@ -111,7 +265,126 @@ void *WRAPPER_FUNC(realloc)(void *mem, size_t size) {
 }
 
 void WRAPPER_FUNC(free)(void *mem) {
+#if PICO_MALLOC_STATS
+    if (mem && !STATS_NESTED()) stats_record(usable_size(mem), NULL, 0, 0);
+#endif
+#if PICO_MALLOC_POOL
+    if (malloc_pool_owns(mem)) {
+        malloc_pool_free(mem);
+        return;
+    }
+#endif
     MALLOC_ENTER(false)
     REAL_FUNC(free)(mem);
     MALLOC_EXIT(false)
 }
+
+#if PICO_MALLOC_STATS
+extern char end; /* Set by linker.  */
+
+void malloc_get_stats(malloc_stats_t *out) {
+    uint32_t save = spin_lock_blocking(stats_spin_lock());
+    *out = stats;
+    spin_unlock(stats_spin_lock(), save);
+    out->heap_size = (uint32_t)(&__StackLimit - &end);
+    MALLOC_ENTER(true)
+    struct mallinfo info = mallinfo();
+    MALLOC_EXIT(true)
+    // the free chunks, plus the space malloc has not yet claimed with sbrk
+    uint32_t unclaimed = out->heap_size - MIN(out->heap_size, (uint32_t)info.arena);
+    out->heap_free = (uint32_t)info.fordblks + unclaimed;
+    // keepcost is the size of the top chunk, which is contiguous with the unclaimed space
+    out->heap_free_top = MIN((uint32_t)info.keepcost + unclaimed, out->heap_free);
+    out->heap_fragmentation = out->heap_free ? (out->heap_free - out->heap_free_top) * 100 / out->heap_free : 0;
+}
+
+uint32_t malloc_debug_get_largest_free_block(void) {
+    int saved_errno = errno;
+    MALLOC_ENTER(true)
+    struct mallinfo info = mallinfo();
+    uint32_t heap_size = (uint32_t)(&__StackLimit - &end);
+    uint32_t heap_free = (uint32_t)info.fordblks + heap_size - MIN(heap_size, (uint32_t)info.arena);
+    // find the largest allocation which succeeds within the heap, to a granularity of 8 bytes
+    uint32_t lo = 0, hi = heap_free / 8;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi + 1) / 2;
+        char *mem = (char *)REAL_FUNC(malloc)(mid * 8);
+        if (mem) REAL_FUNC(free)(mem);
+        if (mem && mem + mid * 8 <= &__StackLimit) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    MALLOC_EXIT(true)
+    errno = saved_errno;
+    return lo * 8;
+}
+
+uint malloc_get_call_site_stats(malloc_call_site_stats_t *sites, uint max_sites) {
+    uint n = 0;
+    uint32_t save = spin_lock_blocking(stats_spin_lock());
+    for (uint i = 0; i < PICO_MALLOC_STATS_CALL_SITES && call_sites[i].allocs; i++) {
+        // insertion sort in decreasing order of bytes, keeping the first max_sites
+        uint j = MIN(n, max_sites);
+        while (j > 0 && sites[j - 1].bytes < call_sites[i].bytes) {
+            if (j < max_sites) sites[j] = sites[j - 1];
+            j--;
+        }
+        if (j < max_sites) {
+            sites[j] = call_sites[i];
+            n = MIN(n + 1, max_sites);
+        }
+    }
+    spin_unlock(stats_spin_lock(), save);
+    return n;
+}
+
+void malloc_stats_reset_peak(void) {
+    uint32_t save = spin_lock_blocking(stats_spin_lock());
+    stats.peak_bytes_in_use = stats.bytes_in_use;
+    spin_unlock(stats_spin_lock(), save);
+}
+
+void malloc_dump_stats(void) {
+    malloc_stats_t s;
+    malloc_get_stats(&s);
+    printf("heap: %u bytes in use (peak %u), %u allocs, %u frees, %u failed\n", (uint)s.bytes_in_use,
+           (uint)s.peak_bytes_in_use, (uint)s.allocs, (uint)s.frees, (uint)s.failed_allocs);
+    printf("heap: %u/%u bytes free, %u at the top (%u%% fragmented)\n", (uint)s.heap_free, (uint)s.heap_size,
+           (uint)s.heap_free_top, (uint)s.heap_fragmentation);
+    printf("allocs by size:");
+    for (uint i = 0; i < PICO_MALLOC_STATS_NUM_SIZE_BUCKETS - 1; i++) {
+        printf(" <=%u: %u", 16u << i, (uint)s.size_allocs[i]);
+    }
+    printf(" >%u: %u\n", 16u << (PICO_MALLOC_STATS_NUM_SIZE_BUCKETS - 2),
+           (uint)s.size_allocs[PICO_MALLOC_STATS_NUM_SIZE_BUCKETS - 1]);
+    malloc_call_site_stats_t sites[PICO_MALLOC_STATS_CALL_SITES];
+    uint n = malloc_get_call_site_stats(sites, PICO_MALLOC_STATS_CALL_SITES);
+    for (uint i = 0; i < n; i++) {
+        printf("call site %p: %u allocs, %u bytes\n", (void *)sites[i].call_site, (uint)sites[i].allocs,
+               (uint)sites[i].bytes);
+    }
+    if (s.other_call_site_allocs) printf("other call sites: %u allocs\n", (uint)s.other_call_site_allocs);
+}
+#else
+void malloc_get_stats(__unused malloc_stats_t *stats) {
+    panic_unsupported();
+}
+
+uint malloc_get_call_site_stats(__unused malloc_call_site_stats_t *sites, __unused uint max_sites) {
+    panic_unsupported();
+}
+
+uint32_t malloc_debug_get_largest_free_block(void) {
+    panic_unsupported();
+}
+
+void malloc_stats_reset_peak(void) {
+    panic_unsupported();
+}
+
+void malloc_dump_stats(void) {
+    panic_unsupported();
+}
+#endif
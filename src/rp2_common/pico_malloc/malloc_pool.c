@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "pico.h"
+#include "hardware/sync.h"
+#include "malloc_pool.h"
+
+#if PICO_MALLOC_POOL
+
+// The pool is divided into slabs, each of which is assigned to a size class when that class first needs more
+// blocks, and then split into blocks of the class's size. Free blocks are kept on singly linked lists: each core has
+// a small cache of free blocks per class, which is only accessed by that core (with interrupts disabled, as malloc
+// may be called from IRQ handlers), and blocks move between the caches and a shared free list per class, protected
+// by a spin lock, in batches of half the cache size. A block may be freed on a different core to the one which
+// allocated it; it simply goes to the freeing core's cache.
+
+static_assert(PICO_MALLOC_POOL_SLAB_SIZE >= 4 * MALLOC_POOL_MAX_SIZE && !(PICO_MALLOC_POOL_SLAB_SIZE & 7),
+              "PICO_MALLOC_POOL_SLAB_SIZE must be a multiple of 8, and at least 1024");
+static_assert(PICO_MALLOC_POOL_SIZE >= PICO_MALLOC_POOL_SLAB_SIZE && !(PICO_MALLOC_POOL_SIZE % PICO_MALLOC_POOL_SLAB_SIZE),
+              "PICO_MALLOC_POOL_SIZE must be a multiple of PICO_MALLOC_POOL_SLAB_SIZE");
+static_assert(PICO_MALLOC_POOL_CACHE_BLOCKS >= 2, "");
+
+#define NUM_SLABS (PICO_MALLOC_POOL_SIZE / PICO_MALLOC_POOL_SLAB_SIZE)
+#define CACHE_BATCH (PICO_MALLOC_POOL_CACHE_BLOCKS / 2)
+
+static const uint16_t class_block_size[PICO_MALLOC_POOL_NUM_CLASSES] = {8, 16, 24, 32, 48, 64, 96, 128, 192, 256};
+
+// the size class for each size, in units of 8 bytes (rounded up)
+static const uint8_t size_class[MALLOC_POOL_MAX_SIZE / 8 + 1] = {
+        0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7, 8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9
+};
+
+typedef struct block {
+    struct block *next;
+} block_t;
+
+typedef struct {
+    block_t *free;
+    uint32_t count;
+    // the blocks allocated and freed on this core
+    uint32_t allocs;
+    uint32_t frees;
+} malloc_pool_cache_t;
+
+uint8_t __malloc_pool[PICO_MALLOC_POOL_SIZE] __aligned(8);
+
+// the size class of each slab, plus one; 0 for a slab which has not yet been assigned
+static uint8_t slab_class[NUM_SLABS];
+static uint next_slab;
+static uint32_t class_slabs[PICO_MALLOC_POOL_NUM_CLASSES];
+static block_t *shared_free[PICO_MALLOC_POOL_NUM_CLASSES];
+static malloc_pool_cache_t caches[NUM_CORES][PICO_MALLOC_POOL_NUM_CLASSES];
+// the allocations on each core not served from the pool
+static uint32_t fallbacks[NUM_CORES];
+
+static inline spin_lock_t *pool_spin_lock(void) {
+    return spin_lock_instance(PICO_SPINLOCK_ID_MALLOC_POOL);
+}
+
+static inline uint slab_of(const void *mem) {
+    return (uint)(((const uint8_t *)mem - __malloc_pool) / PICO_MALLOC_POOL_SLAB_SIZE);
+}
+
+// assign the next free slab to the given class, adding its blocks to the class's shared free list; must be called
+// with the spin lock held
+static bool assign_slab(uint cls) {
+    if (next_slab == NUM_SLABS) return false;
+    uint slab = next_slab++;
+    slab_class[slab] = (uint8_t)(cls + 1);
+    class_slabs[cls]++;
+    uint size = class_block_size[cls];
+    uint8_t *start = __malloc_pool + slab * PICO_MALLOC_POOL_SLAB_SIZE;
+    // link the blocks in address order
+    block_t *head = shared_free[cls];
+    for (int i = (int)(PICO_MALLOC_POOL_SLAB_SIZE / size) - 1; i >= 0; i--) {
+        block_t *block = (block_t *)(start + (uint)i * size);
+        block->next = head;
+        head = block;
+    }
+    shared_free[cls] = head;
+    return true;
+}
+
+// move a batch of blocks from the shared free list to the (empty) cache; must be called with interrupts disabled
+static void cache_refill(malloc_pool_cache_t *cache, uint cls) {
+    spin_lock_t *lock = pool_spin_lock();
+    spin_lock_unsafe_blocking(lock);
+    if (shared_free[cls] || assign_slab(cls)) {
+        block_t *head = shared_free[cls];
+        block_t *tail = head;
+        uint n = 1;
+        while (n < CACHE_BATCH && tail->next) {
+            tail = tail->next;
+            n++;
+        }
+        shared_free[cls] = tail->next;
+        tail->next = NULL;
+        cache->free = head;
+        cache->count = n;
+    }
+    spin_unlock_unsafe(lock);
+}
+
+// move a batch of blocks from the (full) cache to the shared free list; must be called with interrupts disabled
+static void cache_spill(malloc_pool_cache_t *cache, uint cls) {
+    block_t *head = cache->free;
+    block_t *tail = head;
+    for (uint n = 1; n < CACHE_BATCH; n++) {
+        tail = tail->next;
+    }
+    cache->free = tail->next;
+    cache->count -= CACHE_BATCH;
+    spin_lock_t *lock = pool_spin_lock();
+    spin_lock_unsafe_blocking(lock);
+    tail->next = shared_free[cls];
+    shared_free[cls] = head;
+    spin_unlock_unsafe(lock);
+}
+
+void *malloc_pool_alloc(size_t size) {
+    uint32_t save = save_and_disable_interrupts();
+    uint core = get_core_num();
+    if (size > MALLOC_POOL_MAX_SIZE) {
+        fallbacks[core]++;
+        restore_interrupts(save);
+        return NULL;
+    }
+    uint cls = size_class[(size + 7) / 8];
+    malloc_pool_cache_t *cache = &caches[core][cls];
+    if (!cache->free) {
+        cache_refill(cache, cls);
+    }
+    block_t *block = cache->free;
+    if (block) {
+        cache->free = block->next;
+        cache->count--;
+        cache->allocs++;
+    } else {
+        fallbacks[core]++;
+    }
+    restore_interrupts(save);
+    return block;
+}
+
+size_t malloc_pool_block_size(const void *mem) {
+    return class_block_size[slab_class[slab_of(mem)] - 1];
+}
+
+void malloc_pool_free(void *mem) {
+    uint cls = slab_class[slab_of(mem)] - 1u;
+    block_t *block = (block_t *)mem;
+    uint32_t save = save_and_disable_interrupts();
+    malloc_pool_cache_t *cache = &caches[get_core_num()][cls];
+    block->next = cache->free;
+    cache->free = block;
+    cache->frees++;
+    if (++cache->count > PICO_MALLOC_POOL_CACHE_BLOCKS) {
+        cache_spill(cache, cls);
+    }
+    restore_interrupts(save);
+}
+
+void malloc_pool_get_stats(malloc_pool_stats_t *stats) {
+    uint32_t save = spin_lock_blocking(pool_spin_lock());
+    stats->slabs_used = next_slab;
+    stats->slabs_total = NUM_SLABS;
+    stats->fallback_allocs = 0;
+    for (uint core = 0; core < NUM_CORES; core++) {
+        stats->fallback_allocs += fallbacks[core];
+    }
+    for (uint cls = 0; cls < PICO_MALLOC_POOL_NUM_CLASSES; cls++) {
+        malloc_pool_class_stats_t *class_stats = &stats->classes[cls];
+        uint32_t in_use = 0;
+        for (uint core = 0; core < NUM_CORES; core++) {
+            // the other core's counts may be slightly stale; in_use is the sum over both cores, as blocks may be
+            // freed on a different core
+            in_use += caches[core][cls].allocs - caches[core][cls].frees;
+        }
+        class_stats->block_size = class_block_size[cls];
+        class_stats->slabs = class_slabs[cls];
+        class_stats->blocks_in_use = in_use;
+        class_stats->blocks_free = class_slabs[cls] * (PICO_MALLOC_POOL_SLAB_SIZE / class_block_size[cls]) - in_use;
+    }
+    spin_unlock(pool_spin_lock(), save);
+}
+#else
+void malloc_pool_get_stats(__unused malloc_pool_stats_t *stats) {
+    panic_unsupported();
+}
+#endif
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _PICO_MALLOC_POOL_H
+#define _PICO_MALLOC_POOL_H
+
+#include "pico/malloc.h"
+
+// Internal interface between the malloc wrappers and the allocation pool (PICO_MALLOC_POOL)
+
+// the largest allocation served from the pool
+#define MALLOC_POOL_MAX_SIZE 256u
+
+// returns a block of at least size bytes from the pool, or NULL if the size is too large or its class is exhausted
+void *malloc_pool_alloc(size_t size);
+
+// returns true if mem was allocated from the pool
+static inline bool malloc_pool_owns(const void *mem) {
+    extern uint8_t __malloc_pool[PICO_MALLOC_POOL_SIZE];
+    return (const uint8_t *)mem >= __malloc_pool && (const uint8_t *)mem < __malloc_pool + PICO_MALLOC_POOL_SIZE;
+}
+
+// returns the usable size of a block allocated from the pool
+size_t malloc_pool_block_size(const void *mem);
+
+// returns a block allocated from the pool to the pool
+void malloc_pool_free(void *mem);
+
+#endif
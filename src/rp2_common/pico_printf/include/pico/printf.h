@@ -79,6 +79,19 @@ bool weak_raw_vprintf(const char *fmt, va_list args);
  */
 int vfctprintf(void (*out)(char character, void *arg), void *arg, const char *format, va_list va);
 
+/**
+ * \brief printf with span output function
+ * Like vfctprintf(), but the output function is called with runs of characters (literal text between conversions,
+ * converted fields and padding) rather than one character at a time, which is much cheaper for output functions
+ * that copy into a buffer or hand the characters on to a driver
+ * \param out An output function which takes a pointer to len characters (not null terminated) and an argument pointer
+ * \param arg An argument pointer for user data passed to output function
+ * \param format A string that specifies the format of the output
+ * \param va The arguments for the format
+ * \return The number of characters that are sent to the output function, not counting the terminating null character
+ */
+int vspanprintf(void (*out)(const char *s, size_t len, void *arg), void *arg, const char *format, va_list va);
+
 #else
 
 #define weak_raw_printf(...) ({printf(__VA_ARGS__); true;})
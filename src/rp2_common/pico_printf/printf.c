@@ -33,6 +33,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "pico.h"
 #include "pico/printf.h"
@@ -107,8 +108,8 @@
 
 #endif
 
-// output function type
-typedef void (*out_fct_type)(char character, void *buffer, size_t idx, size_t maxlen);
+// output function type; outputs the len characters at s, starting at index idx of the output
+typedef void (*out_fct_type)(const char *s, size_t len, void *buffer, size_t idx, size_t maxlen);
 
 #if !PICO_PRINTF_ALWAYS_INCLUDED
 // we don't have a way to specify a truly weak symbol reference (the linker will always include targets in a single link step,
@@ -124,29 +125,70 @@ typedef struct {
     void *arg;
 } out_fct_wrap_type;
 
+// wrapper (used as buffer) for span output function type
+typedef struct {
+    void (*fct)(const char *s, size_t len, void *arg);
+    void *arg;
+} out_span_fct_wrap_type;
+
 // internal buffer output
-static inline void _out_buffer(char character, void *buffer, size_t idx, size_t maxlen) {
+static inline void _out_buffer(const char *s, size_t len, void *buffer, size_t idx, size_t maxlen) {
     if (idx < maxlen) {
-        ((char *) buffer)[idx] = character;
+        memcpy((char *) buffer + idx, s, len < maxlen - idx ? len : maxlen - idx);
     }
 }
 
 // internal null output
-static inline void _out_null(char character, void *buffer, size_t idx, size_t maxlen) {
-    (void) character;
+static inline void _out_null(const char *s, size_t len, void *buffer, size_t idx, size_t maxlen) {
+    (void) s;
+    (void) len;
     (void) buffer;
     (void) idx;
     (void) maxlen;
 }
 
 // internal output function wrapper
-static inline void _out_fct(char character, void *buffer, size_t idx, size_t maxlen) {
+static void _out_fct(const char *s, size_t len, void *buffer, size_t idx, size_t maxlen) {
+    (void) idx;
+    (void) maxlen;
+    for (size_t i = 0; i < len; i++) {
+        if (s[i]) {
+            // buffer is the output fct pointer
+            ((out_fct_wrap_type *) buffer)->fct(s[i], ((out_fct_wrap_type *) buffer)->arg);
+        }
+    }
+}
+
+// internal span output function wrapper
+static inline void _out_span_fct(const char *s, size_t len, void *buffer, size_t idx, size_t maxlen) {
     (void) idx;
     (void) maxlen;
-    if (character) {
+    if (len) {
         // buffer is the output fct pointer
-        ((out_fct_wrap_type *) buffer)->fct(character, ((out_fct_wrap_type *) buffer)->arg);
+        ((out_span_fct_wrap_type *) buffer)->fct(s, len, ((out_span_fct_wrap_type *) buffer)->arg);
+    }
+}
+
+// output a span of characters
+static inline size_t _out_span(out_fct_type out, char *buffer, size_t idx, size_t maxlen, const char *s, size_t len) {
+    out(s, len, buffer, idx, maxlen);
+    return idx + len;
+}
+
+// output a single character
+static inline size_t _out_char(out_fct_type out, char *buffer, size_t idx, size_t maxlen, char character) {
+    return _out_span(out, buffer, idx, maxlen, &character, 1);
+}
+
+// output count spaces of padding
+static size_t _out_spaces(out_fct_type out, char *buffer, size_t idx, size_t maxlen, size_t count) {
+    static const char spaces[16] = "                ";
+    while (count) {
+        size_t len = count < sizeof(spaces) ? count : sizeof(spaces);
+        idx = _out_span(out, buffer, idx, maxlen, spaces, len);
+        count -= len;
     }
+    return idx;
 }
 
 
@@ -176,28 +218,29 @@ static unsigned int _atoi(const char **str) {
 }
 
 
+// large enough for the ntoa or ftoa conversion buffer, or "fni+"
+#define _OUT_REV_BUFFER_SIZE MAX(MAX(PICO_PRINTF_NTOA_BUFFER_SIZE, PICO_PRINTF_FTOA_BUFFER_SIZE), 4U)
+
 // output the specified string in reverse, taking care of any zero-padding
 static size_t _out_rev(out_fct_type out, char *buffer, size_t idx, size_t maxlen, const char *buf, size_t len,
                        unsigned int width, unsigned int flags) {
     const size_t start_idx = idx;
 
     // pad spaces up to given width
-    if (!(flags & FLAGS_LEFT) && !(flags & FLAGS_ZEROPAD)) {
-        for (size_t i = len; i < width; i++) {
-            out(' ', buffer, idx++, maxlen);
-        }
+    if (!(flags & FLAGS_LEFT) && !(flags & FLAGS_ZEROPAD) && len < width) {
+        idx = _out_spaces(out, buffer, idx, maxlen, width - len);
     }
 
-    // reverse string
-    while (len) {
-        out(buf[--len], buffer, idx++, maxlen);
+    // reverse string, so it can be output as a single span
+    char rev[_OUT_REV_BUFFER_SIZE];
+    for (size_t i = 0; i < len; i++) {
+        rev[i] = buf[len - 1 - i];
     }
+    idx = _out_span(out, buffer, idx, maxlen, rev, len);
 
     // append pad spaces up to given width
-    if (flags & FLAGS_LEFT) {
-        while (idx - start_idx < width) {
-            out(' ', buffer, idx++, maxlen);
-        }
+    if ((flags & FLAGS_LEFT) && idx - start_idx < width) {
+        idx = _out_spaces(out, buffer, idx, maxlen, width - (idx - start_idx));
     }
 
     return idx;
@@ -542,13 +585,13 @@ static size_t _etoa(out_fct_type out, char *buffer, size_t idx, size_t maxlen, d
     // output the exponent part
     if (minwidth) {
         // output the exponential symbol
-        out((flags & FLAGS_UPPERCASE) ? 'E' : 'e', buffer, idx++, maxlen);
+        idx = _out_char(out, buffer, idx, maxlen, (flags & FLAGS_UPPERCASE) ? 'E' : 'e');
         // output the exponent value
         idx = _ntoa_long(out, buffer, idx, maxlen, (uint)((expval < 0) ? -expval : expval), expval < 0, 10, 0, minwidth - 1,
                          FLAGS_ZEROPAD | FLAGS_PLUS);
         // might need to right-pad spaces
-        if (flags & FLAGS_LEFT) {
-            while (idx - start_idx < width) out(' ', buffer, idx++, maxlen);
+        if ((flags & FLAGS_LEFT) && idx - start_idx < width) {
+            idx = _out_spaces(out, buffer, idx, maxlen, width - (idx - start_idx));
         }
     }
     return idx;
@@ -573,9 +616,12 @@ static int _vsnprintf(out_fct_type out, char *buffer, const size_t maxlen, const
     while (*format) {
         // format specifier?  %[flags][width][.precision][length]
         if (*format != '%') {
-            // no
-            out(*format, buffer, idx++, maxlen);
-            format++;
+            // no, so output all the text up to the next specifier as a single span
+            const char *start = format;
+            while (*format && *format != '%') {
+                format++;
+            }
+            idx = _out_span(out, buffer, idx, maxlen, start, (size_t) (format - start));
             continue;
         } else {
             // yes, evaluate it
@@ -767,7 +813,7 @@ static int _vsnprintf(out_fct_type out, char *buffer, const size_t maxlen, const
                 if (*format == 'F') flags |= FLAGS_UPPERCASE;
                 idx = _ftoa(out, buffer, idx, maxlen, va_arg(va, double), precision, width, flags);
 #else
-                for(int i=0;i<2;i++) out('?', buffer, idx++, maxlen);
+                idx = _out_span(out, buffer, idx, maxlen, "??", 2);
                 va_arg(va, double);
 #endif
                 format++;
@@ -781,26 +827,21 @@ static int _vsnprintf(out_fct_type out, char *buffer, const size_t maxlen, const
                 if ((*format == 'E') || (*format == 'G')) flags |= FLAGS_UPPERCASE;
                 idx = _etoa(out, buffer, idx, maxlen, va_arg(va, double), precision, width, flags);
 #else
-                for(int i=0;i<2;i++) out('?', buffer, idx++, maxlen);
+                idx = _out_span(out, buffer, idx, maxlen, "??", 2);
                 va_arg(va, double);
 #endif
                 format++;
                 break;
             case 'c' : {
-                unsigned int l = 1U;
                 // pre padding
-                if (!(flags & FLAGS_LEFT)) {
-                    while (l++ < width) {
-                        out(' ', buffer, idx++, maxlen);
-                    }
+                if (!(flags & FLAGS_LEFT) && width > 1U) {
+                    idx = _out_spaces(out, buffer, idx, maxlen, width - 1U);
                 }
                 // char output
-                out((char) va_arg(va, int), buffer, idx++, maxlen);
+                idx = _out_char(out, buffer, idx, maxlen, (char) va_arg(va, int));
                 // post padding
-                if (flags & FLAGS_LEFT) {
-                    while (l++ < width) {
-                        out(' ', buffer, idx++, maxlen);
-                    }
+                if ((flags & FLAGS_LEFT) && width > 1U) {
+                    idx = _out_spaces(out, buffer, idx, maxlen, width - 1U);
                 }
                 format++;
                 break;
@@ -813,20 +854,14 @@ static int _vsnprintf(out_fct_type out, char *buffer, const size_t maxlen, const
                 if (flags & FLAGS_PRECISION) {
                     l = (l < precision ? l : precision);
                 }
-                if (!(flags & FLAGS_LEFT)) {
-                    while (l++ < width) {
-                        out(' ', buffer, idx++, maxlen);
-                    }
+                if (!(flags & FLAGS_LEFT) && l < width) {
+                    idx = _out_spaces(out, buffer, idx, maxlen, width - l);
                 }
                 // string output
-                while ((*p != 0) && (!(flags & FLAGS_PRECISION) || precision--)) {
-                    out(*(p++), buffer, idx++, maxlen);
-                }
+                idx = _out_span(out, buffer, idx, maxlen, p, l);
                 // post padding
-                if (flags & FLAGS_LEFT) {
-                    while (l++ < width) {
-                        out(' ', buffer, idx++, maxlen);
-                    }
+                if ((flags & FLAGS_LEFT) && l < width) {
+                    idx = _out_spaces(out, buffer, idx, maxlen, width - l);
                 }
                 format++;
                 break;
@@ -852,19 +887,21 @@ static int _vsnprintf(out_fct_type out, char *buffer, const size_t maxlen, const
             }
 
             case '%' :
-                out('%', buffer, idx++, maxlen);
+                idx = _out_char(out, buffer, idx, maxlen, '%');
                 format++;
                 break;
 
             default :
-                out(*format, buffer, idx++, maxlen);
+                idx = _out_char(out, buffer, idx, maxlen, *format);
                 format++;
                 break;
         }
     }
 
     // termination
-    out((char) 0, buffer, idx < maxlen ? idx : maxlen - 1U, maxlen);
+    if (out == _out_buffer && maxlen) {
+        buffer[idx < maxlen ? idx : maxlen - 1U] = 0;
+    }
 
     // return written chars without terminating \0
     return (int) idx;
@@ -898,6 +935,11 @@ int vfctprintf(void (*out)(char character, void *arg), void *arg, const char *fo
     return _vsnprintf(_out_fct, (char *) (uintptr_t) &out_fct_wrap, (size_t) -1, format, va);
 }
 
+int vspanprintf(void (*out)(const char *s, size_t len, void *arg), void *arg, const char *format, va_list va) {
+    const out_span_fct_wrap_type out_fct_wrap = {out, arg};
+    return _vsnprintf(_out_span_fct, (char *) (uintptr_t) &out_fct_wrap, (size_t) -1, format, va);
+}
+
 #if LIB_PICO_PRINTF_PICO
 #if !PICO_PRINTF_ALWAYS_INCLUDED
 /**
@@ -910,12 +952,14 @@ static void _putchar(char character) {
 }
 
 // internal _putchar wrapper
-static inline void _out_char(char character, void *buffer, size_t idx, size_t maxlen) {
+static void _out_putchar(const char *s, size_t len, void *buffer, size_t idx, size_t maxlen) {
     (void) buffer;
     (void) idx;
     (void) maxlen;
-    if (character) {
-        _putchar(character);
+    for (size_t i = 0; i < len; i++) {
+        if (s[i]) {
+            _putchar(s[i]);
+        }
     }
 }
 
@@ -930,7 +974,7 @@ bool weak_raw_printf(const char *fmt, ...) {
 bool weak_raw_vprintf(const char *fmt, va_list args) {
     if (lazy_vsnprintf) {
         char buffer[1];
-        lazy_vsnprintf(_out_char, buffer, (size_t) -1, fmt, args);
+        lazy_vsnprintf(_out_putchar, buffer, (size_t) -1, fmt, args);
         return true;
     } else {
         puts(fmt);
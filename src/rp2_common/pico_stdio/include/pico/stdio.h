@@ -41,6 +41,31 @@
 #define PICO_STDIO_DEADLOCK_TIMEOUT_MS 1000
 #endif
 
+// PICO_CONFIG: PICO_STDIO_WAIT_FOR_CHARS_AVAILABLE, Enable the drivers' chars available callbacks while waiting for input so that a waiting core wakes as soon as input arrives (this installs stdio_uart's RX IRQ handler for example), type=bool, default=0, group=pico_stdio
+#ifndef PICO_STDIO_WAIT_FOR_CHARS_AVAILABLE
+#define PICO_STDIO_WAIT_FOR_CHARS_AVAILABLE 0
+#endif
+
+// PICO_CONFIG: PICO_STDIO_INPUT_POLL_INTERVAL_US, Interval at which to poll the drivers for input while waiting, type=int, default=100, group=pico_stdio
+#ifndef PICO_STDIO_INPUT_POLL_INTERVAL_US
+#define PICO_STDIO_INPUT_POLL_INTERVAL_US 100
+#endif
+
+// PICO_CONFIG: PICO_STDIO_BUFFERED_OUTPUT, Enable support for buffered output, where each core appends output to its own ring buffer which is written to the drivers in the background (see stdio_set_buffered_output), type=bool, default=0, group=pico_stdio
+#ifndef PICO_STDIO_BUFFERED_OUTPUT
+#define PICO_STDIO_BUFFERED_OUTPUT 0
+#endif
+
+// PICO_CONFIG: PICO_STDIO_OUTPUT_BUFFER_SIZE, Size in bytes of each core's output ring buffer for buffered output; must be a power of 2, type=int, default=1024, depends=PICO_STDIO_BUFFERED_OUTPUT, group=pico_stdio
+#ifndef PICO_STDIO_OUTPUT_BUFFER_SIZE
+#define PICO_STDIO_OUTPUT_BUFFER_SIZE 1024
+#endif
+
+// PICO_CONFIG: PICO_STDIO_OUTPUT_OVERFLOW_DEFAULT, Initial policy for output which does not fit in the buffer for buffered output, type=enum, enumvalues=STDIO_OUTPUT_OVERFLOW_DROP|STDIO_OUTPUT_OVERFLOW_BLOCK|STDIO_OUTPUT_OVERFLOW_OVERWRITE, default=STDIO_OUTPUT_OVERFLOW_DROP, depends=PICO_STDIO_BUFFERED_OUTPUT, group=pico_stdio
+#ifndef PICO_STDIO_OUTPUT_OVERFLOW_DEFAULT
+#define PICO_STDIO_OUTPUT_OVERFLOW_DEFAULT STDIO_OUTPUT_OVERFLOW_DROP
+#endif
+
 // PICO_CONFIG: PICO_STDIO_SHORT_CIRCUIT_CLIB_FUNCS, Directly replace common stdio functions such as putchar from the C-library to avoid pulling in lots of c library code for simple output, type=bool, default=1, advanced=true, group=pico_stdio
 #ifndef PICO_STDIO_SHORT_CIRCUIT_CLIB_FUNCS
 #define PICO_STDIO_SHORT_CIRCUIT_CLIB_FUNCS 1
@@ -53,6 +78,25 @@ extern "C" {
 #include <stdarg.h>
 
 typedef struct stdio_driver stdio_driver_t;
+typedef struct async_context async_context_t;
+
+/*! \brief What to do with buffered output which does not fit in the current core's output buffer
+ * \ingroup pico_stdio
+ * \see stdio_set_output_overflow
+ */
+enum stdio_output_overflow {
+    STDIO_OUTPUT_OVERFLOW_DROP,      ///< Discard the output which does not fit
+    STDIO_OUTPUT_OVERFLOW_BLOCK,     ///< Wait for space; output is still discarded if called from an IRQ handler, or after \ref PICO_STDIO_DEADLOCK_TIMEOUT_MS
+    STDIO_OUTPUT_OVERFLOW_OVERWRITE, ///< Discard the oldest buffered output to make room
+};
+
+/*! \brief Counts of output discarded by buffered output, summed over both cores
+ * \ingroup pico_stdio
+ */
+typedef struct stdio_output_stats {
+    uint32_t dropped;     ///< characters discarded because they did not fit in the buffer
+    uint32_t overwritten; ///< characters of buffered output discarded to make room for newer output
+} stdio_output_stats_t;
 
 /*! \brief Initialize all of the present standard stdio types that are linked into the binary.
  * \ingroup pico_stdio
@@ -154,6 +198,10 @@ static inline int puts_raw(const char *s) {
 /*! \brief get notified when there are input characters available
  * \ingroup pico_stdio
  *
+ * The callback may be called from an IRQ handler. Note that when \ref PICO_STDIO_WAIT_FOR_CHARS_AVAILABLE is 1, stdio
+ * also uses the drivers' notifications itself while waiting for input, so cancelling the callback does not
+ * necessarily stop a driver generating them.
+ *
  * \param fn Callback function to be called when characters are available. Pass NULL to cancel any existing callback
  * \param param Pointer to pass to the callback
  */
@@ -163,7 +211,13 @@ void stdio_set_chars_available_callback(void (*fn)(void*), void *param);
  * \ingroup pico_stdio
  *
  * This method returns as soon as input is available, but more characters may
- * be returned up to the end of the buffer.
+ * be returned up to the end of the buffer. The drivers are read in turn, starting
+ * after the one which last returned input, so that no driver can starve the others.
+ *
+ * While waiting, the core sleeps (with WFE), polling the drivers every \ref PICO_STDIO_INPUT_POLL_INTERVAL_US.
+ * When \ref PICO_STDIO_WAIT_FOR_CHARS_AVAILABLE is 1, the drivers' chars available callbacks are enabled on the
+ * first wait, and wake the core as soon as a driver reports input (the drivers are still polled, as a driver's
+ * callback is not always driven; stdio_usb only reports input if its background task is enabled, for example).
  *
  * \param buf the buffer to read into
  * \param len the length of the buffer
@@ -172,6 +226,19 @@ void stdio_set_chars_available_callback(void (*fn)(void*), void *param);
  */
 int stdio_get_until(char *buf, int len, absolute_time_t until);
 
+/*! \brief Read whatever input is available into a buffer, without waiting
+ * \ingroup pico_stdio
+ *
+ * Unlike \ref stdio_get_until, which returns the input from a single driver, this reads from each
+ * driver in turn until the buffer is full or no more input is available, so it can be used to drain
+ * all pending input in one call (for example from a chars available callback).
+ *
+ * \param buf the buffer to read into
+ * \param len the length of the buffer
+ * \return the number of characters read, or PICO_ERROR_NO_DATA if none were available
+ */
+int stdio_get_available(char *buf, int len);
+
 /*! \brief Prints a buffer to stdout with optional newline and carriage return insertion
  * \ingroup pico_stdio
  *
@@ -186,6 +253,51 @@ int stdio_get_until(char *buf, int len, absolute_time_t until);
  */
 int stdio_put_string(const char *s, int len, bool newline, bool cr_translation);
 
+/*! \brief Enable or disable buffered output
+ * \ingroup pico_stdio
+ *
+ * By default, output is written to each driver by the caller, with a mutex held so that output from the two cores
+ * is not interleaved; a printf may therefore wait for output from the other core to be written to a slow UART.
+ *
+ * With buffered output, each core instead appends its output to its own ring buffer (of size
+ * \ref PICO_STDIO_OUTPUT_BUFFER_SIZE) without taking any lock, and a worker on the given async_context writes the
+ * buffered output to the drivers in chunks. Output which does not fit in the buffer is handled according to the
+ * policy set by \ref stdio_set_output_overflow. Note that:
+ *
+ * - output from the two cores is only interleaved when written, so whole lines are usually kept together, but this
+ *   is not guaranteed for long lines, or for output from an IRQ handler which interrupts output on the same core
+ * - output without CR/LF translation (\ref stdio_putchar_raw and \ref stdio_puts_raw) is not buffered; the buffered
+ *   output is flushed, and the output written directly
+ * - \ref stdio_flush waits for the buffered output to be written (except in an IRQ handler)
+ * - with a polled context (such as pico_async_context_poll), the output is written when the context is polled;
+ *   waiting for output to be written (in \ref stdio_flush, for unbuffered output, or for space in the buffer with
+ *   \ref STDIO_OUTPUT_OVERFLOW_BLOCK) polls the context if on the context's core, which may run its other workers
+ *
+ * This requires \ref PICO_STDIO_BUFFERED_OUTPUT=1
+ *
+ * \param context the async_context to write the output from (a pico_async_context_threadsafe_background context
+ * runs the worker from a low priority IRQ), or NULL to flush the buffered output and return to writing output
+ * directly
+ * \return true if successful
+ */
+bool stdio_set_buffered_output(async_context_t *context);
+
+/*! \brief Set the policy for buffered output which does not fit in the current core's output buffer
+ * \ingroup pico_stdio
+ *
+ * The initial policy is \ref PICO_STDIO_OUTPUT_OVERFLOW_DEFAULT
+ *
+ * \param overflow the policy
+ */
+void stdio_set_output_overflow(enum stdio_output_overflow overflow);
+
+/*! \brief Get the counts of buffered output which has been discarded
+ * \ingroup pico_stdio
+ *
+ * \param stats the stats to fill in
+ */
+void stdio_get_output_stats(stdio_output_stats_t *stats);
+
 /*! \brief Alias for \ref getchar that definitely does not go thru the implementation
  * in the standard C library even when \ref PICO_STDIO_SHORT_CIRCUIT_CLIB_FUNCS == 0
  *
@@ -15,9 +15,13 @@
 #include "pico/stdio.h"
 #include "pico/stdio/driver.h"
 #include "pico/time.h"
+#include "hardware/sync.h"
 #if PICO_STDOUT_MUTEX
 #include "pico/mutex.h"
 #endif
+#if PICO_STDIO_BUFFERED_OUTPUT
+#include "pico/async_context.h"
+#endif
 
 #if LIB_PICO_STDIO_UART
 #include "pico/stdio_uart.h"
@@ -37,6 +41,45 @@
 
 static stdio_driver_t *drivers;
 static stdio_driver_t *filter;
+// the driver to read input from first, so that the drivers are read in turn; NULL for the first driver
+static stdio_driver_t *next_input_driver;
+
+#if PICO_STDIO_WAIT_FOR_CHARS_AVAILABLE
+static void (*chars_available_callback)(void*);
+static void *chars_available_param;
+// stdio_chars_available is registered with the drivers either on behalf of the application's callback, or for
+// stdio_get_until to wait on
+static bool chars_available_for_callback;
+static bool chars_available_for_input;
+
+static void stdio_chars_available(__unused void *param) {
+    // wake up any core waiting for input in stdio_get_until
+    __sev();
+    void (*fn)(void*) = chars_available_callback;
+    if (fn) fn(chars_available_param);
+}
+
+static void stdio_register_chars_available(stdio_driver_t *driver, bool enable) {
+    if (driver->set_chars_available_callback) {
+        driver->set_chars_available_callback(enable ? stdio_chars_available : NULL, NULL);
+    }
+}
+
+static void stdio_update_chars_available(void) {
+    bool enable = chars_available_for_callback || chars_available_for_input;
+    for (stdio_driver_t *driver = drivers; driver; driver = driver->next) {
+        stdio_register_chars_available(driver, enable);
+    }
+}
+
+// have the drivers notify us when input is available, to wake a core waiting for input
+static void stdio_input_enable_notifications(void) {
+    if (!chars_available_for_input) {
+        chars_available_for_input = true;
+        stdio_update_chars_available();
+    }
+}
+#endif
 
 #if PICO_STDOUT_MUTEX
 auto_init_mutex(print_mutex);
@@ -49,12 +92,19 @@ void stdout_serialize_end(void) {
     mutex_exit(&print_mutex);
 }
 
+static __unused bool stdout_serialize_try_begin(void) {
+    return mutex_try_enter(&print_mutex, NULL);
+}
+
 #else
 static bool stdout_serialize_begin(void) {
     return true;
 }
 static void stdout_serialize_end(void) {
 }
+static __unused bool stdout_serialize_try_begin(void) {
+    return true;
+}
 #endif
 static void stdio_out_chars_no_crlf(stdio_driver_t *driver, const char *s, int len) {
     driver->out_chars(s, len);
@@ -89,23 +139,280 @@ static void stdio_out_chars_crlf(stdio_driver_t *driver, const char *s, int len)
 #endif
 }
 
+static void stdio_out_chars_all(const char *s, int len, bool cr_translation) {
+    void (*out_func)(stdio_driver_t *, const char *, int) = cr_translation ? stdio_out_chars_crlf : stdio_out_chars_no_crlf;
+    for (stdio_driver_t *driver = drivers; driver; driver = driver->next) {
+        if (!driver->out_chars) continue;
+        if (filter && filter != driver) continue;
+        out_func(driver, s, len);
+    }
+}
+
+static void stdio_flush_drivers(void) {
+    for (stdio_driver_t *d = drivers; d; d = d->next) {
+        if (d->out_flush) d->out_flush();
+    }
+}
+
+#if PICO_STDIO_BUFFERED_OUTPUT
+static_assert(PICO_STDIO_OUTPUT_BUFFER_SIZE >= 16 && !(PICO_STDIO_OUTPUT_BUFFER_SIZE & (PICO_STDIO_OUTPUT_BUFFER_SIZE - 1)),
+              "PICO_STDIO_OUTPUT_BUFFER_SIZE must be a power of 2");
+#define OUTPUT_BUFFER_MASK (PICO_STDIO_OUTPUT_BUFFER_SIZE - 1u)
+#define OUTPUT_DRAIN_CHUNK_SIZE 256
+
+// Each core appends to its own ring with interrupts disabled (so IRQ handlers on the same core are serialized
+// with it), and the drain worker is the only consumer, so no lock is needed between the cores. The indexes are
+// free running, and masked when the buffer is accessed.
+//
+// When overwriting, the producer doesn't look at tail at all, and may overwrite characters while the drain worker
+// is copying them out, so it publishes the range it is about to write in reserved first; the worker checks this
+// after copying, and discards anything which may have been overwritten.
+typedef struct {
+    uint32_t head;
+    uint32_t reserved;
+    uint32_t tail;
+    uint32_t dropped;     // written by the producer
+    uint32_t overwritten; // written by the consumer
+    char buf[PICO_STDIO_OUTPUT_BUFFER_SIZE];
+} stdio_output_ring_t;
+
+static stdio_output_ring_t output_rings[NUM_CORES];
+static async_context_t *output_context;
+static enum stdio_output_overflow output_overflow = PICO_STDIO_OUTPUT_OVERFLOW_DEFAULT;
+
+static inline uint32_t output_load_index(const uint32_t *index) {
+    return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+static inline void output_store_index(uint32_t *index, uint32_t value) {
+    __atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
+static void output_drain(async_context_t *context, async_when_pending_worker_t *worker);
+static void output_drain_retry(async_context_t *context, async_at_time_worker_t *worker);
+
+static async_when_pending_worker_t output_drain_worker = {
+        .do_work = output_drain
+};
+
+static async_at_time_worker_t output_retry_worker = {
+        .do_work = output_drain_retry
+};
+
+// copy len characters out of the ring starting at index pos
+static void output_ring_copy_out(const stdio_output_ring_t *ring, uint32_t pos, char *dst, uint len) {
+    uint offset = pos & OUTPUT_BUFFER_MASK;
+    uint n = MIN(len, PICO_STDIO_OUTPUT_BUFFER_SIZE - offset);
+    memcpy(dst, ring->buf + offset, n);
+    memcpy(dst + n, ring->buf, len - n);
+}
+
+static void output_ring_copy_in(stdio_output_ring_t *ring, uint32_t pos, const char *src, uint len) {
+    uint offset = pos & OUTPUT_BUFFER_MASK;
+    uint n = MIN(len, PICO_STDIO_OUTPUT_BUFFER_SIZE - offset);
+    memcpy(ring->buf + offset, src, n);
+    memcpy(ring->buf, src + n, len - n);
+}
+
+// take up to len characters from the ring; returns the number taken, which is only 0 if the ring is empty
+static uint output_ring_take(stdio_output_ring_t *ring, char *dst, uint len) {
+    uint32_t tail = ring->tail;
+    uint n;
+    do {
+        uint32_t head = output_load_index(&ring->head);
+        if (head - tail > PICO_STDIO_OUTPUT_BUFFER_SIZE) {
+            // overwritten before we got to it
+            ring->overwritten += head - tail - PICO_STDIO_OUTPUT_BUFFER_SIZE;
+            tail = head - PICO_STDIO_OUTPUT_BUFFER_SIZE;
+        }
+        n = MIN(len, head - tail);
+        if (!n) break;
+        output_ring_copy_out(ring, tail, dst, n);
+        __mem_fence_acquire();
+        uint32_t reserved = output_load_index(&ring->reserved);
+        if (reserved - tail > PICO_STDIO_OUTPUT_BUFFER_SIZE) {
+            // the oldest characters may have been overwritten while we were copying them
+            uint discard = MIN(n, reserved - tail - PICO_STDIO_OUTPUT_BUFFER_SIZE);
+            ring->overwritten += discard;
+            memmove(dst, dst + discard, n - discard);
+            n -= discard;
+            tail += discard;
+        }
+    } while (!n);
+    output_store_index(&ring->tail, tail + n);
+    return n;
+}
+
+static void output_drain(async_context_t *context, __unused async_when_pending_worker_t *worker) {
+    if (!stdout_serialize_try_begin()) {
+        // output is being written directly (see stdio_put_string), so try again shortly
+        async_context_add_at_time_worker_in_ms(context, &output_retry_worker, 1);
+        return;
+    }
+    char chunk[OUTPUT_DRAIN_CHUNK_SIZE];
+    bool more;
+    do {
+        more = false;
+        for (uint core = 0; core < NUM_CORES; core++) {
+            // empty each core's ring in turn, to keep lines from the two cores together
+            uint n;
+            while ((n = output_ring_take(&output_rings[core], chunk, sizeof(chunk)))) {
+                stdio_out_chars_all(chunk, (int)n, true);
+                more = true;
+            }
+        }
+    } while (more);
+    stdio_flush_drivers();
+    stdout_serialize_end();
+}
+
+static void output_drain_retry(async_context_t *context, __unused async_at_time_worker_t *worker) {
+    async_context_set_work_pending(context, &output_drain_worker);
+}
+
+static bool output_is_empty(void) {
+    for (uint core = 0; core < NUM_CORES; core++) {
+        if (output_load_index(&output_rings[core].head) != output_rings[core].tail) return false;
+    }
+    return true;
+}
+
+// give the drain worker a chance to run; the workers of a polled context only run when it is polled, so we poll it
+// ourselves if we are on its core (which may also run its other pending workers)
+static void output_wait_for_worker(void) {
+    if ((output_context->flags & ASYNC_CONTEXT_FLAG_POLLED) && get_core_num() == async_context_core_num(output_context)) {
+        async_context_poll(output_context);
+    } else {
+        busy_wait_us(10);
+    }
+}
+
+// wait for the drain worker to empty the rings; this can't be done from an IRQ handler, as the worker may be run
+// from a lower priority IRQ on the same core
+static void output_wait_for_drain(void) {
+    if (__get_current_exception()) return;
+    absolute_time_t until = make_timeout_time_ms(PICO_STDIO_DEADLOCK_TIMEOUT_MS);
+    while (!output_is_empty() && !time_reached(until)) {
+        async_context_set_work_pending(output_context, &output_drain_worker);
+        output_wait_for_worker();
+    }
+}
+
+static void output_append(const char *s, uint len) {
+    stdio_output_ring_t *ring = &output_rings[get_core_num()];
+    absolute_time_t until = nil_time;
+    while (len) {
+        uint32_t save = save_and_disable_interrupts();
+        uint32_t head = ring->head;
+        uint32_t used = head - output_load_index(&ring->tail);
+        uint n = len;
+        if (output_overflow != STDIO_OUTPUT_OVERFLOW_OVERWRITE) {
+            // (used may be more than the buffer size if we were overwriting until recently)
+            n = MIN(n, used < PICO_STDIO_OUTPUT_BUFFER_SIZE ? PICO_STDIO_OUTPUT_BUFFER_SIZE - used : 0);
+        }
+        if (n) {
+            output_store_index(&ring->reserved, head + n);
+            // make sure reserved is visible before we start overwriting
+            __mem_fence_release();
+            // only the last buffer full of a long string can be kept
+            uint skip = n > PICO_STDIO_OUTPUT_BUFFER_SIZE ? n - PICO_STDIO_OUTPUT_BUFFER_SIZE : 0;
+            output_ring_copy_in(ring, head + skip, s + skip, n - skip);
+            output_store_index(&ring->head, head + n);
+        }
+        s += n;
+        len -= n;
+        bool drop = len && (output_overflow != STDIO_OUTPUT_OVERFLOW_BLOCK || __get_current_exception() ||
+                            (!is_nil_time(until) && time_reached(until)));
+        if (drop) ring->dropped += len;
+        restore_interrupts(save);
+        // the drain worker empties all the rings every time it runs, so only needs to be woken if this ring was empty
+        // or we are waiting for space
+        if ((n && !used) || len) async_context_set_work_pending(output_context, &output_drain_worker);
+        if (drop || !len) break;
+        if (is_nil_time(until)) until = make_timeout_time_ms(PICO_STDIO_DEADLOCK_TIMEOUT_MS);
+        output_wait_for_worker();
+    }
+}
+
+#if LIB_PICO_PRINTF_PICO
+static void output_append_printer(const char *s, size_t len, __unused void *arg) {
+    output_append(s, (uint)len);
+}
+#endif
+
+bool stdio_set_buffered_output(async_context_t *context) {
+    if (output_context) {
+        output_wait_for_drain();
+        async_context_remove_when_pending_worker(output_context, &output_drain_worker);
+        async_context_remove_at_time_worker(output_context, &output_retry_worker);
+        output_context = NULL;
+    }
+    if (context) {
+        if (!async_context_add_when_pending_worker(context, &output_drain_worker)) return false;
+        output_context = context;
+    }
+    return true;
+}
+
+void stdio_set_output_overflow(enum stdio_output_overflow overflow) {
+    output_overflow = overflow;
+}
+
+void stdio_get_output_stats(stdio_output_stats_t *stats) {
+    stats->dropped = 0;
+    stats->overwritten = 0;
+    for (uint core = 0; core < NUM_CORES; core++) {
+        stats->dropped += output_rings[core].dropped;
+        stats->overwritten += output_rings[core].overwritten;
+    }
+}
+#else
+bool stdio_set_buffered_output(__unused async_context_t *context) {
+    panic_unsupported();
+}
+
+void stdio_set_output_overflow(__unused enum stdio_output_overflow overflow) {
+    panic_unsupported();
+}
+
+void stdio_get_output_stats(stdio_output_stats_t *stats) {
+    stats->dropped = 0;
+    stats->overwritten = 0;
+}
+#endif
+
+// true if output is currently being buffered
+static inline bool stdio_output_buffered(void) {
+#if PICO_STDIO_BUFFERED_OUTPUT
+    return output_context != NULL;
+#else
+    return false;
+#endif
+}
+
 int stdio_put_string(const char *s, int len, bool newline, bool cr_translation) {
+    if (len == -1) len = (int)strlen(s);
+#if PICO_STDIO_BUFFERED_OUTPUT
+    if (stdio_output_buffered()) {
+        if (cr_translation) {
+            output_append(s, (uint)len);
+            if (newline) output_append("\n", 1);
+            return len;
+        }
+        // the buffered output is always CR/LF translated, so raw output must be written directly, after anything
+        // already buffered
+        output_wait_for_drain();
+    }
+#endif
     bool serialized = stdout_serialize_begin();
     if (!serialized) {
 #if PICO_STDIO_IGNORE_NESTED_STDOUT
         return 0;
 #endif
     }
-    if (len == -1) len = (int)strlen(s);
-    void (*out_func)(stdio_driver_t *, const char *, int) = cr_translation ? stdio_out_chars_crlf : stdio_out_chars_no_crlf;
-    for (stdio_driver_t *driver = drivers; driver; driver = driver->next) {
-        if (!driver->out_chars) continue;
-        if (filter && filter != driver) continue;
-        out_func(driver, s, len);
-        if (newline) {
-            const char c = '\n';
-            out_func(driver, &c, 1);
-        }
+    stdio_out_chars_all(s, len, cr_translation);
+    if (newline) {
+        stdio_out_chars_all("\n", 1, cr_translation);
     }
     if (serialized) {
         stdout_serialize_end();
@@ -113,28 +420,60 @@ int stdio_put_string(const char *s, int len, bool newline, bool cr_translation)
     return len;
 }
 
+static inline stdio_driver_t *stdio_next_driver(stdio_driver_t *driver) {
+    return driver->next ? driver->next : drivers;
+}
+
+// reads from the first driver, starting with next_input_driver, which has input
+static int stdio_get_next(char *buf, int len) {
+    stdio_driver_t *first = next_input_driver ? next_input_driver : drivers;
+    stdio_driver_t *driver = first;
+    if (driver) do {
+        if ((!filter || filter == driver) && driver->in_chars) {
+            int read = driver->in_chars(buf, len);
+            if (read > 0) {
+                next_input_driver = stdio_next_driver(driver);
+                return read;
+            }
+        }
+        driver = stdio_next_driver(driver);
+    } while (driver != first);
+    return PICO_ERROR_NO_DATA;
+}
+
 int stdio_get_until(char *buf, int len, absolute_time_t until) {
+#if PICO_STDIO_WAIT_FOR_CHARS_AVAILABLE
+    stdio_input_enable_notifications();
+#endif
     do {
-        // todo round robin might be nice on each call, but then again hopefully
-        //  no source will starve the others
-        for (stdio_driver_t *driver = drivers; driver; driver = driver->next) {
-            if (filter && filter != driver) continue;
-            if (driver->in_chars) {
-                int read = driver->in_chars(buf, len);
-                if (read > 0) {
-                    return read;
-                }
-            }
+        int read = stdio_get_next(buf, len);
+        if (read > 0) {
+            return read;
         }
         if (time_reached(until)) {
             return PICO_ERROR_TIMEOUT;
         }
-        // we sleep here in case the in_chars methods acquire mutexes or disable IRQs and
-        // potentially starve out what they are waiting on (have seen this with USB)
-        busy_wait_us(1);
+        // we sleep here rather than spinning, which also avoids starving out what the in_chars methods are
+        // waiting on if they acquire mutexes or disable IRQs (have seen this with USB). If the drivers notify us
+        // of input, the SEV in stdio_chars_available wakes us early (an SEV since the drivers were read above is
+        // not lost, as it leaves the event register set); we still poll, as a driver which has a chars available
+        // callback may not call it (e.g. stdio_usb without its background task)
+        absolute_time_t wake = make_timeout_time_us(PICO_STDIO_INPUT_POLL_INTERVAL_US);
+        if (absolute_time_diff_us(wake, until) < 0) wake = until;
+        best_effort_wfe_or_timeout(wake);
     } while (true);
 }
 
+int stdio_get_available(char *buf, int len) {
+    int total = 0;
+    while (total < len) {
+        int read = stdio_get_next(buf + total, len - total);
+        if (read <= 0) break;
+        total += read;
+    }
+    return total ? total : PICO_ERROR_NO_DATA;
+}
+
 int stdio_putchar_raw(int c) {
     char cc = (char)c;
     stdio_put_string(&cc, 1, false, false);
@@ -155,6 +494,12 @@ void stdio_set_driver_enabled(stdio_driver_t *driver, bool enable) {
             if (!enable) {
                 *prev = driver->next;
                 driver->next = NULL;
+                if (next_input_driver == driver) next_input_driver = NULL;
+#if PICO_STDIO_WAIT_FOR_CHARS_AVAILABLE
+                if (chars_available_for_callback || chars_available_for_input) {
+                    stdio_register_chars_available(driver, false);
+                }
+#endif
             }
             return;
         }
@@ -162,13 +507,19 @@ void stdio_set_driver_enabled(stdio_driver_t *driver, bool enable) {
     }
     if (enable) {
         *prev = driver;
+#if PICO_STDIO_WAIT_FOR_CHARS_AVAILABLE
+        if (chars_available_for_callback || chars_available_for_input) {
+            stdio_register_chars_available(driver, true);
+        }
+#endif
     }
 }
 
 void stdio_flush(void) {
-    for (stdio_driver_t *d = drivers; d; d = d->next) {
-        if (d->out_flush) d->out_flush();
-    }
+#if PICO_STDIO_BUFFERED_OUTPUT
+    if (stdio_output_buffered()) output_wait_for_drain();
+#endif
+    stdio_flush_drivers();
 }
 
 #if LIB_PICO_PRINTF_PICO
@@ -179,21 +530,23 @@ typedef struct stdio_stack_buffer {
 
 static void stdio_stack_buffer_flush(stdio_stack_buffer_t *buffer) {
     if (buffer->used) {
-        for (stdio_driver_t *d = drivers; d; d = d->next) {
-            if (!d->out_chars) continue;
-            if (filter && filter != d) continue;
-            stdio_out_chars_crlf(d, buffer->buf, buffer->used);
-        }
+        stdio_out_chars_all(buffer->buf, buffer->used, true);
         buffer->used = 0;
     }
 }
 
-static void stdio_buffered_printer(char c, void *arg) {
+static void stdio_buffered_printer(const char *s, size_t len, void *arg) {
     stdio_stack_buffer_t *buffer = (stdio_stack_buffer_t *)arg;
-    if (buffer->used == PICO_STDIO_STACK_BUFFER_SIZE) {
-        stdio_stack_buffer_flush(buffer);
+    while (len) {
+        if (buffer->used == PICO_STDIO_STACK_BUFFER_SIZE) {
+            stdio_stack_buffer_flush(buffer);
+        }
+        size_t n = MIN(len, (size_t)(PICO_STDIO_STACK_BUFFER_SIZE - buffer->used));
+        memcpy(buffer->buf + buffer->used, s, n);
+        buffer->used += (int)n;
+        s += n;
+        len -= n;
     }
-    buffer->buf[buffer->used++] = c;
 }
 #endif
 
@@ -280,9 +633,18 @@ void stdio_set_translate_crlf(stdio_driver_t *driver, bool enabled) {
 }
 
 void stdio_set_chars_available_callback(void (*fn)(void*), void *param) {
+#if PICO_STDIO_WAIT_FOR_CHARS_AVAILABLE
+    // don't let a driver IRQ call the new callback with the old param
+    chars_available_callback = NULL;
+    chars_available_param = param;
+    chars_available_callback = fn;
+    chars_available_for_callback = fn != NULL;
+    stdio_update_chars_available();
+#else
     for (stdio_driver_t *s = drivers; s; s = s->next) {
         if (s->set_chars_available_callback) s->set_chars_available_callback(fn, param);
     }
+#endif
 }
 
 #if PICO_STDIO_SHORT_CIRCUIT_CLIB_FUNCS
@@ -308,13 +670,20 @@ int PRIMARY_STDIO_FUNC(putchar)(int c) {
 int PRIMARY_STDIO_FUNC(puts)(const char *s) {
     int len = (int)strlen(s);
     stdio_put_string(s, len, true, true);
-    stdio_flush();
+    // buffered output is flushed by the drain worker
+    if (!stdio_output_buffered()) stdio_flush();
     return len;
 }
 
 int REAL_FUNC(vprintf)(const char *format, va_list va);
 
 int PRIMARY_STDIO_FUNC(vprintf)(const char *format, va_list va) {
+#if PICO_STDIO_BUFFERED_OUTPUT && LIB_PICO_PRINTF_PICO
+    if (stdio_output_buffered()) {
+        // format straight into this core's ring
+        return vspanprintf(output_append_printer, NULL, format, va);
+    }
+#endif
     bool serialized = stdout_serialize_begin();
     if (!serialized) {
 #if PICO_STDIO_IGNORE_NESTED_STDOUT
@@ -325,7 +694,7 @@ int PRIMARY_STDIO_FUNC(vprintf)(const char *format, va_list va) {
 #if LIB_PICO_PRINTF_PICO
     struct stdio_stack_buffer buffer;
     buffer.used = 0;
-    ret = vfctprintf(stdio_buffered_printer, &buffer, format, va);
+    ret = vspanprintf(stdio_buffered_printer, &buffer, format, va);
     stdio_stack_buffer_flush(&buffer);
     stdio_flush();
 #elif LIB_PICO_PRINTF_NONE
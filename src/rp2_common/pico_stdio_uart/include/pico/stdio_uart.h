@@ -41,6 +41,11 @@ extern stdio_driver_t stdio_uart;
  * and configures the baud rate as PICO_DEFAULT_UART_BAUD_RATE.
  *
  * \note this method is automatically called by \ref stdio_init_all() if `pico_stdio_uart` is included in the build
+ *
+ * \note the UART's IRQ is not used unless a chars available callback is set (see
+ * \ref stdio_set_chars_available_callback), or \ref PICO_STDIO_WAIT_FOR_CHARS_AVAILABLE is 1, in which case the first
+ * wait for input does so. The driver then installs an exclusive handler for the UART's IRQ, so the UART IRQ must not
+ * be used elsewhere; set \ref PICO_STDIO_UART_SUPPORT_CHARS_AVAILABLE_CALLBACK to 0 to stop this.
  */
 void stdio_uart_init(void);
 
@@ -65,6 +70,8 @@ void stdin_uart_init(void);
  * \param baud_rate the baud rate in Hz
  * \param tx_pin the UART pin to use for stdout (or -1 for no stdout)
  * \param rx_pin the UART pin to use for stdin (or -1 for no stdin)
+ *
+ * \note see \ref stdio_uart_init for when the UART's IRQ handler is installed
  */
 void stdio_uart_init_full(uart_inst_t *uart, uint baud_rate, int tx_pin, int rx_pin);
 
@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Host benchmark of an arena against malloc/free for a request handling pattern, where each request allocates a
+// number of small objects which are all freed when it completes. malloc and free are called with a mutex held, as
+// pico_malloc does when pico_multicore is in use.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pico/stdlib.h"
+#include "pico/mutex.h"
+#include "pico/util/arena.h"
+
+#define NUM_REQUESTS 200000
+#define OBJECTS_PER_REQUEST 24
+#define CHUNK_SIZE 2048
+
+typedef enum {
+    ALLOC_MALLOC,
+    ALLOC_ARENA,
+    ALLOC_ARENA_MARK,
+    ALLOC_COUNT
+} alloc_t;
+
+static const char *alloc_names[ALLOC_COUNT] = {"malloc", "arena", "mark"};
+
+static mutex_t malloc_mutex;
+
+static void *locked_malloc(size_t size) {
+    mutex_enter_blocking(&malloc_mutex);
+    void *mem = malloc(size);
+    mutex_exit(&malloc_mutex);
+    return mem;
+}
+
+static void locked_free(void *mem) {
+    mutex_enter_blocking(&malloc_mutex);
+    free(mem);
+    mutex_exit(&malloc_mutex);
+}
+
+static uint64_t wall_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// a request: a mix of header, string and buffer sized objects
+static uint object_size(uint i) {
+    static const uint16_t sizes[] = {16, 24, 8, 48, 32, 128, 12, 64};
+    return sizes[i % count_of(sizes)];
+}
+
+static uint run(alloc_t alloc) {
+    void *objects[OBJECTS_PER_REQUEST];
+    arena_t arena;
+    arena_init(&arena, NULL, 0, CHUNK_SIZE);
+    uint errors = 0;
+    for (uint request = 0; request < NUM_REQUESTS; request++) {
+        arena_mark_t mark = arena_mark(&arena);
+        for (uint i = 0; i < OBJECTS_PER_REQUEST; i++) {
+            uint size = object_size(i + request);
+            objects[i] = alloc == ALLOC_MALLOC ? locked_malloc(size) : arena_alloc(&arena, size);
+            if (!objects[i]) {
+                errors++;
+                continue;
+            }
+            memset(objects[i], (int)i, size);
+        }
+        for (uint i = 0; i < OBJECTS_PER_REQUEST; i++) {
+            if (objects[i] && ((uint8_t *)objects[i])[0] != i) errors++;
+        }
+        switch (alloc) {
+            case ALLOC_MALLOC:
+                for (uint i = 0; i < OBJECTS_PER_REQUEST; i++) locked_free(objects[i]);
+                break;
+            case ALLOC_ARENA:
+                arena_reset(&arena);
+                break;
+            default:
+                arena_reset_to_mark(&arena, mark);
+                break;
+        }
+    }
+    arena_deinit(&arena);
+    return errors;
+}
+
+int main(void) {
+    mutex_init(&malloc_mutex);
+    uint total_errors = 0;
+    printf("%-7s %14s %12s %8s\n", "alloc", "ns/request", "ns/object", "errors");
+    for (uint alloc = 0; alloc < ALLOC_COUNT; alloc++) {
+        uint64_t t0 = wall_time_ns();
+        uint errors = run((alloc_t)alloc);
+        uint64_t elapsed_ns = wall_time_ns() - t0;
+        printf("%-7s %14.1f %12.1f %8u\n", alloc_names[alloc], (double)elapsed_ns / NUM_REQUESTS,
+               (double)elapsed_ns / (NUM_REQUESTS * OBJECTS_PER_REQUEST), errors);
+        total_errors += errors;
+    }
+    printf("arena_benchmark: %s\n", total_errors ? "Failed" : "Success");
+    return total_errors ? -1 : 0;
+}
@@ -0,0 +1,144 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/test.h"
+#include "pico/util/arena.h"
+
+PICOTEST_MODULE_NAME("ARENA", "arena allocator test");
+
+#define CHUNK_SIZE 256
+#define CORE_ALLOCS 1000
+
+static arena_per_core_t per_core;
+static uint core_errors[NUM_CORES];
+
+static uint chunk_count(const arena_t *a) {
+    uint count = 0;
+    for (arena_chunk_t *chunk = a->chunk; chunk; chunk = chunk->prev) count++;
+    return count;
+}
+
+// fills allocations from this core's arena with a pattern, and checks none has been overwritten
+static void per_core_allocs(void) {
+    uint core = get_core_num();
+    arena_t *a = arena_per_core_get(&per_core);
+    uint8_t *allocs[CORE_ALLOCS];
+    for (uint round = 0; round < 10; round++) {
+        for (uint i = 0; i < CORE_ALLOCS; i++) {
+            uint size = 1 + (i * 7) % 40;
+            allocs[i] = (uint8_t *)arena_alloc(a, size);
+            if (!allocs[i]) {
+                core_errors[core]++;
+                continue;
+            }
+            memset(allocs[i], (int)(core * 64 + i % 64), size);
+        }
+        for (uint i = 0; i < CORE_ALLOCS; i++) {
+            uint size = 1 + (i * 7) % 40;
+            if (allocs[i] && (allocs[i][0] != core * 64 + i % 64 || allocs[i][size - 1] != core * 64 + i % 64)) {
+                core_errors[core]++;
+            }
+        }
+        arena_reset(a);
+    }
+}
+
+static void core1_main(void) {
+    per_core_allocs();
+    multicore_fifo_push_blocking(0);
+}
+
+int main() {
+    stdio_init_all();
+
+    PICOTEST_START();
+
+    PICOTEST_START_SECTION("caller supplied buffer");
+        static uint64_t buf[32];
+        arena_t a;
+        arena_init(&a, buf, sizeof(buf), 0);
+        uint8_t *first = (uint8_t *)arena_alloc(&a, 1);
+        PICOTEST_CHECK(first && first > (uint8_t *)buf && first < (uint8_t *)buf + sizeof(buf), "not allocated from buffer");
+        uint8_t *second = (uint8_t *)arena_alloc(&a, 3);
+        PICOTEST_CHECK(second == first + PICO_ARENA_DEFAULT_ALIGNMENT, "allocations not contiguous");
+        PICOTEST_CHECK(!((uintptr_t)second % PICO_ARENA_DEFAULT_ALIGNMENT), "allocation not aligned");
+        uint8_t *aligned = (uint8_t *)arena_alloc_aligned(&a, 16, 64);
+        PICOTEST_CHECK(aligned && !((uintptr_t)aligned % 64), "aligned allocation not aligned");
+        PICOTEST_CHECK(!arena_alloc(&a, sizeof(buf)), "allocation larger than the buffer succeeded");
+        uint count = 0;
+        while (arena_alloc(&a, 8)) count++;
+        PICOTEST_CHECK(count > 0 && count < sizeof(buf) / 8, "wrong number of allocations fit");
+        arena_reset(&a);
+        PICOTEST_CHECK(arena_alloc(&a, 1) == first, "reset didn't return to the start of the buffer");
+        uint32_t *zeroed = (uint32_t *)arena_alloc_zeroed(&a, 16);
+        PICOTEST_CHECK(zeroed && !zeroed[0] && !zeroed[3], "allocation not zeroed");
+        arena_deinit(&a);
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("heap chunks");
+        arena_t a;
+        arena_init(&a, NULL, 0, CHUNK_SIZE);
+        PICOTEST_CHECK(chunk_count(&a) == 0, "chunk allocated before use");
+        uint8_t *p = (uint8_t *)arena_alloc(&a, 100);
+        PICOTEST_CHECK(p && chunk_count(&a) == 1, "first chunk not allocated");
+        arena_alloc(&a, 100);
+        PICOTEST_CHECK(chunk_count(&a) == 1, "second allocation didn't fit in the first chunk");
+        arena_alloc(&a, 100);
+        PICOTEST_CHECK(chunk_count(&a) == 2, "second chunk not allocated");
+        uint8_t *large = (uint8_t *)arena_alloc(&a, CHUNK_SIZE * 4);
+        PICOTEST_CHECK(large && chunk_count(&a) == 3 && a.chunk->size > CHUNK_SIZE * 4, "large allocation didn't get its own chunk");
+        memset(large, 0xaa, CHUNK_SIZE * 4);
+        arena_reset(&a);
+        PICOTEST_CHECK(chunk_count(&a) == 0 && a.spare && a.spare->size == CHUNK_SIZE, "chunk not kept for reuse");
+        arena_chunk_t *spare = a.spare;
+        arena_alloc(&a, 8);
+        PICOTEST_CHECK(a.chunk == spare && !a.spare, "spare chunk not reused");
+        arena_deinit(&a);
+        PICOTEST_CHECK(!a.chunk && !a.spare, "chunks not freed");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("mark and reset");
+        static uint64_t buf[16];
+        arena_t a;
+        arena_init(&a, buf, sizeof(buf), CHUNK_SIZE);
+        arena_alloc(&a, 8);
+        arena_mark_t mark = arena_mark(&a);
+        uint8_t *after_mark = (uint8_t *)arena_alloc(&a, 8);
+        // spill into heap chunks
+        for (uint i = 0; i < 10; i++) arena_alloc(&a, 100);
+        PICOTEST_CHECK(chunk_count(&a) > 2, "heap chunks not allocated");
+        arena_reset_to_mark(&a, mark);
+        PICOTEST_CHECK(a.chunk == (arena_chunk_t *)buf && chunk_count(&a) == 1, "heap chunks not released");
+        PICOTEST_CHECK(arena_alloc(&a, 8) == after_mark, "not reset to the mark");
+        // a mark in a heap chunk
+        for (uint i = 0; i < 10; i++) arena_alloc(&a, 100);
+        mark = arena_mark(&a);
+        uint8_t *in_chunk = (uint8_t *)arena_alloc(&a, 8);
+        arena_alloc(&a, 200);
+        arena_reset_to_mark(&a, mark);
+        PICOTEST_CHECK(arena_alloc(&a, 8) == in_chunk, "not reset to the mark in a heap chunk");
+        arena_deinit(&a);
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("per-core arenas");
+        arena_per_core_init(&per_core, 1024);
+        multicore_launch_core1(core1_main);
+        per_core_allocs();
+        multicore_fifo_pop_blocking();
+        multicore_reset_core1();
+        PICOTEST_CHECK(!core_errors[0] && !core_errors[1], "allocations overwritten");
+        PICOTEST_CHECK(per_core.core[0].spare && per_core.core[1].spare &&
+                       per_core.core[0].spare != per_core.core[1].spare, "cores didn't use separate chunks");
+        arena_per_core_deinit(&per_core);
+    PICOTEST_END_SECTION();
+
+    PICOTEST_END_TEST();
+}
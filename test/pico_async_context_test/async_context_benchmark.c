@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Benchmark of async_context "at time" worker overhead as the number of workers grows; measures the cost of
+// polling when no worker is due, of re-adding an already present worker with a new time (as lwIP does on every
+// poll), and of running workers which re-add themselves
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "pico/async_context_poll.h"
+
+#define MAX_WORKERS 256
+#define POLL_ITERATIONS 20000
+#define READD_ITERATIONS 20000
+#define RUN_ITERATIONS 20000
+
+static async_context_poll_t context;
+static async_at_time_worker_t workers[MAX_WORKERS];
+static uint run_count;
+
+static void run_again_worker(async_context_t *context, async_at_time_worker_t *worker) {
+    // re-add at a random time which is already due, so that the worker lands at a varying position in the list
+    if (++run_count < RUN_ITERATIONS) {
+        async_context_add_at_time_worker_at(context, worker, delayed_by_us(nil_time, (uint64_t)rand() % 1000u));
+    }
+}
+
+static void noop_worker(__unused async_context_t *context, __unused async_at_time_worker_t *worker) {
+}
+
+static void add_workers(async_context_t *ctx, uint num_workers, absolute_time_t base, uint32_t spread_us,
+                        void (*do_work)(async_context_t *, async_at_time_worker_t *)) {
+    srand(num_workers);
+    for (uint i = 0; i < num_workers; i++) {
+        workers[i] = (async_at_time_worker_t) { .do_work = do_work };
+        async_context_add_at_time_worker_at(ctx, &workers[i], delayed_by_us(base, (uint64_t)rand() % spread_us));
+    }
+}
+
+static void remove_workers(async_context_t *ctx, uint num_workers) {
+    for (uint i = 0; i < num_workers; i++) {
+        async_context_remove_at_time_worker(ctx, &workers[i]);
+    }
+}
+
+static uint32_t ns_per_op(uint64_t start_us, uint ops) {
+    return (uint32_t)((time_us_64() - start_us) * 1000u / ops);
+}
+
+int main(void) {
+    stdio_init_all();
+    static const uint worker_counts[] = {1, 8, 32, 64, 256};
+    async_context_poll_init_with_defaults(&context);
+    async_context_t *ctx = &context.core;
+
+    printf("ns per operation\n");
+    printf("%8s %8s %8s %8s\n", "workers", "poll", "re-add", "run");
+    for (uint n = 0; n < count_of(worker_counts); n++) {
+        uint num_workers = worker_counts[n];
+
+        // all workers are far in the future, so each poll finds nothing due
+        add_workers(ctx, num_workers, make_timeout_time_ms(60000), 1000000, noop_worker);
+        uint64_t start = time_us_64();
+        for (uint i = 0; i < POLL_ITERATIONS; i++) {
+            async_context_poll(ctx);
+        }
+        uint32_t poll_ns = ns_per_op(start, POLL_ITERATIONS);
+
+        // re-add present workers with a new time
+        start = time_us_64();
+        for (uint i = 0; i < READD_ITERATIONS; i++) {
+            async_at_time_worker_t *worker = &workers[(uint)rand() % num_workers];
+            async_context_add_at_time_worker_at(ctx, worker, delayed_by_us(worker->next_time, (uint64_t)rand() % 1000u));
+        }
+        uint32_t readd_ns = ns_per_op(start, READD_ITERATIONS);
+        remove_workers(ctx, num_workers);
+
+        // all workers are due, and re-add themselves when run
+        add_workers(ctx, num_workers, nil_time, 1000, run_again_worker);
+        run_count = 0;
+        start = time_us_64();
+        async_context_poll(ctx);
+        uint32_t run_ns = ns_per_op(start, run_count);
+        remove_workers(ctx, num_workers);
+
+        printf("%8u %8u %8u %8u\n", num_workers, poll_ns, readd_ns, run_ns);
+    }
+    async_context_deinit(ctx);
+    printf("async_context_benchmark: Success\n");
+    return 0;
+}
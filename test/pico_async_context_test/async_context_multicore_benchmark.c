@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Benchmark of CPU bound "when pending" work, comparing async_context_poll (all work on core 0) with
+// async_context_multicore running work on core 1 only, and on both cores. On the host the cores are threads,
+// so the scaling depends on the number of CPUs available
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pico/async_context_poll.h"
+#include "pico/async_context_multicore.h"
+
+#define NUM_WORKERS 8
+#define NUM_JOBS 4000
+#define JOB_ITERATIONS 2000
+
+typedef struct {
+    async_when_pending_worker_t worker;
+    uint32_t jobs;
+    uint32_t result;
+} bench_worker_t;
+
+static bench_worker_t workers[NUM_WORKERS];
+static uint32_t jobs_done;
+
+static void job_worker(__unused async_context_t *context, async_when_pending_worker_t *worker) {
+    bench_worker_t *bw = (bench_worker_t *)worker;
+    uint32_t jobs = __atomic_exchange_n(&bw->jobs, 0, __ATOMIC_ACQUIRE);
+    for (uint32_t j = 0; j < jobs; j++) {
+        // stand-in for some CPU heavy work such as a checksum or crypto
+        uint32_t x = bw->result | 1;
+        for (uint i = 0; i < JOB_ITERATIONS; i++) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+        }
+        bw->result = x;
+    }
+    __atomic_add_fetch(&jobs_done, jobs, __ATOMIC_RELEASE);
+}
+
+static uint32_t run(async_context_t *context, bool poll) {
+    for (uint i = 0; i < NUM_WORKERS; i++) {
+        workers[i] = (bench_worker_t) { .worker = { .do_work = job_worker } };
+        async_context_add_when_pending_worker(context, &workers[i].worker);
+    }
+    __atomic_store_n(&jobs_done, 0, __ATOMIC_RELAXED);
+    uint64_t start = time_us_64();
+    for (uint j = 0; j < NUM_JOBS; j++) {
+        bench_worker_t *bw = &workers[j % NUM_WORKERS];
+        __atomic_add_fetch(&bw->jobs, 1, __ATOMIC_RELEASE);
+        async_context_set_work_pending(context, &bw->worker);
+        // submit a batch of jobs before doing any work ourselves
+        if (poll && (j % NUM_WORKERS) == NUM_WORKERS - 1) {
+            async_context_poll(context);
+        }
+    }
+    while (__atomic_load_n(&jobs_done, __ATOMIC_ACQUIRE) < NUM_JOBS) {
+        if (poll) async_context_poll(context);
+        async_context_wait_for_work_until(context, make_timeout_time_ms(1));
+    }
+    uint32_t elapsed_us = (uint32_t)(time_us_64() - start);
+    for (uint i = 0; i < NUM_WORKERS; i++) {
+        async_context_remove_when_pending_worker(context, &workers[i].worker);
+    }
+    return elapsed_us;
+}
+
+static void report(const char *name, uint32_t elapsed_us, uint32_t baseline_us) {
+    printf("%-24s %10u %10u %8.2f\n", name, elapsed_us, (uint32_t)((uint64_t)NUM_JOBS * 1000000 / elapsed_us),
+           (double)baseline_us / elapsed_us);
+}
+
+int main(void) {
+    stdio_init_all();
+    printf("%-24s %10s %10s %8s\n", "context", "us", "jobs/s", "speedup");
+
+    async_context_poll_t poll_context;
+    async_context_poll_init_with_defaults(&poll_context);
+    uint32_t baseline_us = run(&poll_context.core, true);
+    async_context_deinit(&poll_context.core);
+    report("poll (core 0)", baseline_us, baseline_us);
+
+    async_context_multicore_t multicore_context;
+    if (!async_context_multicore_init_with_defaults(&multicore_context)) {
+        printf("async_context_multicore_benchmark: Failed\n");
+        return -1;
+    }
+    report("multicore (core 1)", run(&multicore_context.core, false), baseline_us);
+    report("multicore (both cores)", run(&multicore_context.core, true), baseline_us);
+    async_context_deinit(&multicore_context.core);
+    printf("async_context_multicore_benchmark: Success\n");
+    return 0;
+}
@@ -0,0 +1,219 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pico/stdlib.h"
+#include "pico/test.h"
+#include "pico/async_context_multicore.h"
+
+PICOTEST_MODULE_NAME("ASYNC_CONTEXT_MULTICORE", "async_context_multicore test");
+
+#define NUM_WORKERS 6
+#define JOBS_PER_WORKER 200
+
+typedef struct {
+    async_when_pending_worker_t worker;
+    uint32_t jobs;       // jobs submitted but not yet done
+    uint32_t done;
+    uint32_t running;    // non-zero while do_work is running
+    uint32_t overlapped; // number of times do_work was entered concurrently
+    uint32_t core_mask;  // cores do_work ran on
+} test_worker_t;
+
+static async_context_multicore_t context;
+static test_worker_t workers[NUM_WORKERS];
+static uint32_t at_time_core_mask;
+static uint32_t at_time_count;
+
+static void job_worker(__unused async_context_t *context, async_when_pending_worker_t *worker) {
+    test_worker_t *tw = (test_worker_t *)worker;
+    if (__atomic_exchange_n(&tw->running, 1, __ATOMIC_ACQUIRE)) {
+        __atomic_add_fetch(&tw->overlapped, 1, __ATOMIC_RELAXED);
+    }
+    __atomic_or_fetch(&tw->core_mask, 1u << get_core_num(), __ATOMIC_RELAXED);
+    uint32_t jobs = __atomic_exchange_n(&tw->jobs, 0, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 0; i < jobs; i++) {
+        busy_wait_us(10);
+    }
+    __atomic_add_fetch(&tw->done, jobs, __ATOMIC_RELAXED);
+    __atomic_store_n(&tw->running, 0, __ATOMIC_RELEASE);
+}
+
+static void repending_worker(async_context_t *context, async_when_pending_worker_t *worker) {
+    test_worker_t *tw = (test_worker_t *)worker;
+    // marking ourselves as pending whilst running means we are run again afterwards
+    if (__atomic_add_fetch(&tw->done, 1, __ATOMIC_RELAXED) < JOBS_PER_WORKER) {
+        async_context_set_work_pending(context, worker);
+    }
+}
+
+static void at_time_worker_func(__unused async_context_t *context, __unused async_at_time_worker_t *worker) {
+    async_context_lock_check(context);
+    __atomic_or_fetch(&at_time_core_mask, 1u << get_core_num(), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&at_time_count, 1, __ATOMIC_RELAXED);
+}
+
+static uint32_t sync_func(void *param) {
+    async_context_lock_check(&context.core);
+    return *(uint32_t *)param + 1;
+}
+
+static uint32_t total_done(void) {
+    uint32_t total = 0;
+    for (uint i = 0; i < NUM_WORKERS; i++) {
+        total += __atomic_load_n(&workers[i].done, __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+static void init_workers(void (*do_work)(async_context_t *, async_when_pending_worker_t *)) {
+    for (uint i = 0; i < NUM_WORKERS; i++) {
+        workers[i] = (test_worker_t) { .worker = { .do_work = do_work } };
+        async_context_add_when_pending_worker(&context.core, &workers[i].worker);
+    }
+}
+
+static void remove_workers(void) {
+    // removal waits for core 1 to finish with a worker it is running, so the workers may then be reused
+    for (uint i = 0; i < NUM_WORKERS; i++) {
+        async_context_remove_when_pending_worker(&context.core, &workers[i].worker);
+    }
+}
+
+// a worker which runs for a while, to be removed whilst running
+static void slow_worker(__unused async_context_t *context, async_when_pending_worker_t *worker) {
+    test_worker_t *tw = (test_worker_t *)worker;
+    __atomic_store_n(&tw->running, 1, __ATOMIC_RELEASE);
+    busy_wait_ms(20);
+    __atomic_add_fetch(&tw->done, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&tw->running, 0, __ATOMIC_RELEASE);
+}
+
+static volatile uint32_t self_removed_count;
+
+// a heap allocated worker which removes and frees itself
+static void self_removing_worker(async_context_t *context, async_when_pending_worker_t *worker) {
+    async_context_remove_when_pending_worker(context, worker);
+    // set ourselves pending again, which must not cause us to be run again once removed
+    worker->work_pending = true;
+    free(worker);
+    self_removed_count++;
+}
+
+// poll on core 0 until the expected number of jobs are done
+static bool poll_until_done(uint32_t expected, bool poll) {
+    absolute_time_t timeout = make_timeout_time_ms(10000);
+    while (total_done() < expected && !time_reached(timeout)) {
+        if (poll) {
+            async_context_poll(&context.core);
+        }
+        async_context_wait_for_work_until(&context.core, make_timeout_time_ms(1));
+    }
+    return total_done() == expected;
+}
+
+int main() {
+    stdio_init_all();
+    PICOTEST_START();
+
+    PICOTEST_CHECK(async_context_multicore_init_with_defaults(&context), "failed to init context");
+    async_context_multicore_t other_context;
+    PICOTEST_CHECK(!async_context_multicore_init_with_defaults(&other_context), "initialized a second context");
+    async_context_t *ctx = &context.core;
+
+    for (uint pass = 0; pass < 2; pass++) {
+        bool poll = pass != 0;
+        printf("work %s\n", poll ? "on both cores" : "on core 1 only");
+        PICOTEST_START_SECTION("when pending workers");
+            init_workers(job_worker);
+            for (uint j = 0; j < JOBS_PER_WORKER; j++) {
+                for (uint i = 0; i < NUM_WORKERS; i++) {
+                    __atomic_add_fetch(&workers[i].jobs, 1, __ATOMIC_RELEASE);
+                    async_context_set_work_pending(ctx, &workers[i].worker);
+                }
+                if (poll) async_context_poll(ctx);
+            }
+            PICOTEST_CHECK(poll_until_done(NUM_WORKERS * JOBS_PER_WORKER, poll), "not all jobs were done");
+            uint32_t core_mask = 0;
+            for (uint i = 0; i < NUM_WORKERS; i++) {
+                PICOTEST_CHECK(!workers[i].overlapped, "worker ran concurrently with itself");
+                core_mask |= workers[i].core_mask;
+            }
+            // note with both cores working, core 0 may legitimately have done everything
+            PICOTEST_CHECK(poll || core_mask == 2, "work not done on core 1");
+            remove_workers();
+        PICOTEST_END_SECTION();
+
+        PICOTEST_START_SECTION("worker setting itself pending");
+            init_workers(repending_worker);
+            for (uint i = 0; i < NUM_WORKERS; i++) {
+                async_context_set_work_pending(ctx, &workers[i].worker);
+            }
+            PICOTEST_CHECK(poll_until_done(NUM_WORKERS * JOBS_PER_WORKER, poll), "re-pended workers were not run again");
+            remove_workers();
+        PICOTEST_END_SECTION();
+    }
+
+    PICOTEST_START_SECTION("remove while running");
+        // core 0 isn't polling, so the worker runs on core 1
+        test_worker_t *tw = (test_worker_t *)calloc(1, sizeof(test_worker_t));
+        tw->worker.do_work = slow_worker;
+        async_context_add_when_pending_worker(ctx, &tw->worker);
+        async_context_set_work_pending(ctx, &tw->worker);
+        while (!__atomic_load_n(&tw->running, __ATOMIC_ACQUIRE)) {
+            tight_loop_contents();
+        }
+        PICOTEST_CHECK(async_context_remove_when_pending_worker(ctx, &tw->worker), "worker not removed");
+        PICOTEST_CHECK(__atomic_load_n(&tw->done, __ATOMIC_ACQUIRE) == 1 && !__atomic_load_n(&tw->running, __ATOMIC_ACQUIRE),
+                       "removal returned whilst the worker was running");
+        free(tw);
+
+        async_when_pending_worker_t *self_removing = (async_when_pending_worker_t *)calloc(1, sizeof(async_when_pending_worker_t));
+        self_removing->do_work = self_removing_worker;
+        async_context_add_when_pending_worker(ctx, self_removing);
+        async_context_set_work_pending(ctx, self_removing);
+        absolute_time_t timeout = make_timeout_time_ms(1000);
+        while (!self_removed_count && !time_reached(timeout)) {
+            tight_loop_contents();
+        }
+        sleep_ms(10);
+        PICOTEST_CHECK(self_removed_count == 1, "self removing worker not run exactly once");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("at time workers");
+        static async_at_time_worker_t at_time_workers[4];
+        at_time_count = at_time_core_mask = 0;
+        for (uint i = 0; i < count_of(at_time_workers); i++) {
+            at_time_workers[i] = (async_at_time_worker_t) { .do_work = at_time_worker_func };
+            async_context_add_at_time_worker_in_ms(ctx, &at_time_workers[i], 5 + i * 5);
+        }
+        // core 0 isn't polling, so core 1 must run them
+        sleep_ms(100);
+        PICOTEST_CHECK(__atomic_load_n(&at_time_count, __ATOMIC_RELAXED) == count_of(at_time_workers), "at time workers did not run");
+        PICOTEST_CHECK(at_time_core_mask == 2, "at time workers not run on core 1");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("execute sync");
+        uint32_t value = 41;
+        PICOTEST_CHECK(async_context_execute_sync(ctx, sync_func, &value) == 42, "wrong result");
+    PICOTEST_END_SECTION();
+
+    async_context_deinit(ctx);
+
+    PICOTEST_START_SECTION("re-init after deinit");
+        PICOTEST_CHECK(async_context_multicore_init_with_defaults(&context), "failed to re-init context");
+        init_workers(job_worker);
+        workers[0].jobs = 1;
+        async_context_set_work_pending(ctx, &workers[0].worker);
+        PICOTEST_CHECK(poll_until_done(1, false), "work not done after re-init");
+        remove_workers();
+        async_context_deinit(ctx);
+    PICOTEST_END_SECTION();
+
+    PICOTEST_END_TEST();
+}
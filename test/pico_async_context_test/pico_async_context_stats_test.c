@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Tests async_context statistics; built with ASYNC_CONTEXT_INSTRUMENTATION=1
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "pico/test.h"
+#include "pico/async_context_poll.h"
+#include "pico/async_context_multicore.h"
+
+PICOTEST_MODULE_NAME("ASYNC_CONTEXT_STATS", "async_context stats test");
+
+#if !ASYNC_CONTEXT_INSTRUMENTATION
+#error this test requires ASYNC_CONTEXT_INSTRUMENTATION
+#endif
+
+#define AT_TIME_RUN_US 200
+#define WHEN_PENDING_RUN_US 100
+#define LATENESS_US 3000
+#define LOCK_HOLD_US 500
+
+static void busy_at_time_worker(__unused async_context_t *context, __unused async_at_time_worker_t *worker) {
+    busy_wait_us(AT_TIME_RUN_US);
+}
+
+static void busy_when_pending_worker(__unused async_context_t *context, __unused async_when_pending_worker_t *worker) {
+    busy_wait_us(WHEN_PENDING_RUN_US);
+}
+
+#define REMOVED_RUN_COUNT 1234
+
+// removes itself, after which the worker may no longer exist, so its stats must not be written when do_work returns
+static void self_removing_worker(async_context_t *context, async_when_pending_worker_t *worker) {
+    async_context_remove_when_pending_worker(context, worker);
+    worker->stats.run_count = REMOVED_RUN_COUNT;
+}
+
+static uint32_t histogram_total(const async_context_stats_t *stats) {
+    uint32_t total = 0;
+    for (uint i = 0; i < ASYNC_CONTEXT_LATENESS_HISTOGRAM_BUCKETS; i++) total += stats->lateness_histogram[i];
+    return total;
+}
+
+int main() {
+    stdio_init_all();
+    PICOTEST_START();
+
+    async_context_poll_t poll_context;
+    async_context_poll_init_with_defaults(&poll_context);
+    async_context_t *ctx = &poll_context.core;
+    static async_at_time_worker_t at_time_worker = { .do_work = busy_at_time_worker };
+    static async_when_pending_worker_t when_pending_worker = { .do_work = busy_when_pending_worker };
+
+    PICOTEST_START_SECTION("worker run time and lateness");
+        async_context_add_when_pending_worker(ctx, &when_pending_worker);
+        for (uint i = 0; i < 3; i++) {
+            async_context_set_work_pending(ctx, &when_pending_worker);
+            async_context_poll(ctx);
+        }
+        async_context_add_at_time_worker_in_ms(ctx, &at_time_worker, 1);
+        sleep_us(1000 + LATENESS_US);
+        async_context_poll(ctx);
+
+        PICOTEST_CHECK(when_pending_worker.stats.run_count == 3, "wrong when pending run count");
+        PICOTEST_CHECK(async_worker_stats_average_run_time_us(&when_pending_worker.stats) >= WHEN_PENDING_RUN_US, "when pending average run time too short");
+        PICOTEST_CHECK(at_time_worker.stats.run_count == 1, "wrong at time run count");
+        PICOTEST_CHECK(at_time_worker.stats.max_run_time_us >= AT_TIME_RUN_US, "at time max run time too short");
+        PICOTEST_CHECK(at_time_worker.stats.max_lateness_us >= LATENESS_US, "at time lateness too small");
+
+        async_context_stats_t stats;
+        async_context_get_stats(ctx, &stats);
+        PICOTEST_CHECK(histogram_total(&stats) == 1, "wrong lateness histogram total");
+        // 3000us late is in the 2048-4095us bucket, unless the test was held up
+        uint bucket = 0;
+        while (!stats.lateness_histogram[bucket]) bucket++;
+        PICOTEST_CHECK(bucket >= 12, "lateness in the wrong histogram bucket");
+        PICOTEST_CHECK(!stats.lock_count, "lock stats for non-locking context");
+        async_context_print_stats(ctx);
+
+        async_context_reset_stats(ctx);
+        async_context_get_stats(ctx, &stats);
+        PICOTEST_CHECK(!histogram_total(&stats), "histogram not reset");
+        PICOTEST_CHECK(!when_pending_worker.stats.run_count, "worker stats not reset");
+        async_context_remove_when_pending_worker(ctx, &when_pending_worker);
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("worker removed during do_work");
+        static async_when_pending_worker_t removed_worker = { .do_work = self_removing_worker };
+        async_context_add_when_pending_worker(ctx, &removed_worker);
+        async_context_set_work_pending(ctx, &removed_worker);
+        async_context_poll(ctx);
+        PICOTEST_CHECK(removed_worker.stats.run_count == REMOVED_RUN_COUNT, "stats written for a removed worker");
+    PICOTEST_END_SECTION();
+    async_context_deinit(ctx);
+
+    PICOTEST_START_SECTION("lock hold time");
+        async_context_multicore_t multicore_context;
+        PICOTEST_CHECK(async_context_multicore_init_with_defaults(&multicore_context), "failed to init context");
+        ctx = &multicore_context.core;
+        async_context_reset_stats(ctx);
+        async_context_acquire_lock_blocking(ctx);
+        async_context_acquire_lock_blocking(ctx);
+        busy_wait_us(LOCK_HOLD_US);
+        async_context_release_lock(ctx);
+        async_context_release_lock(ctx);
+        async_context_stats_t stats;
+        async_context_get_stats(ctx, &stats);
+        PICOTEST_CHECK(stats.lock_count >= 2, "lock acquisitions not counted");
+        PICOTEST_CHECK(stats.max_lock_hold_time_us >= LOCK_HOLD_US, "max lock hold time too short");
+        PICOTEST_CHECK(stats.total_lock_hold_time_us >= LOCK_HOLD_US, "total lock hold time too short");
+        async_context_print_stats(ctx);
+        async_context_deinit(ctx);
+    PICOTEST_END_SECTION();
+
+    PICOTEST_END_TEST();
+}
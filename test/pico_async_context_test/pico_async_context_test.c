@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "pico/test.h"
+#include "pico/async_context_poll.h"
+
+PICOTEST_MODULE_NAME("ASYNC_CONTEXT", "async_context test");
+
+#define NUM_WORKERS 8
+#define REPEAT_COUNT 10
+
+static async_context_poll_t context;
+static async_at_time_worker_t workers[NUM_WORKERS];
+static uint run_order[NUM_WORKERS];
+static uint run_count;
+
+static void record_worker(__unused async_context_t *context, async_at_time_worker_t *worker) {
+    if (run_count < NUM_WORKERS) run_order[run_count] = (uint)(uintptr_t)worker->user_data;
+    run_count++;
+}
+
+static void repeating_worker(async_context_t *context, async_at_time_worker_t *worker) {
+    run_count++;
+    if (run_count < REPEAT_COUNT) {
+        async_context_add_at_time_worker_in_ms(context, worker, 1);
+    }
+}
+
+static void init_workers(void) {
+    for (uint i = 0; i < NUM_WORKERS; i++) {
+        workers[i] = (async_at_time_worker_t) {
+            .do_work = record_worker,
+            .user_data = (void *)(uintptr_t)i,
+        };
+    }
+    run_count = 0;
+}
+
+static bool list_is_ordered(async_context_t *context) {
+    for (async_at_time_worker_t *worker = context->at_time_list; worker && worker->next; worker = worker->next) {
+        if (absolute_time_diff_us(worker->next_time, worker->next->next_time) < 0) return false;
+    }
+    return true;
+}
+
+int main() {
+    stdio_init_all();
+    PICOTEST_START();
+
+    async_context_poll_init_with_defaults(&context);
+    async_context_t *ctx = &context.core;
+
+    PICOTEST_START_SECTION("workers run in deadline order");
+        // offsets (in ms) are added out of order, with ties which should run in the order they were added
+        static const uint offsets[NUM_WORKERS] = {5, 1, 3, 3, 7, 1, 2, 3};
+        static const uint expected[NUM_WORKERS] = {1, 5, 6, 2, 3, 7, 0, 4};
+        init_workers();
+        absolute_time_t base = get_absolute_time();
+        for (uint i = 0; i < NUM_WORKERS; i++) {
+            PICOTEST_CHECK(async_context_add_at_time_worker_at(ctx, &workers[i], delayed_by_ms(base, offsets[i])), "failed to add worker");
+        }
+        PICOTEST_CHECK(list_is_ordered(ctx), "at time list not in deadline order");
+        async_context_poll(ctx);
+        PICOTEST_CHECK(absolute_time_diff_us(ctx->next_time, delayed_by_ms(base, 1)) == 0, "wrong next time");
+        sleep_until(delayed_by_ms(base, 10));
+        async_context_poll(ctx);
+        PICOTEST_CHECK(run_count == NUM_WORKERS, "not all workers ran");
+        for (uint i = 0; i < NUM_WORKERS; i++) {
+            PICOTEST_CHECK(run_order[i] == expected[i], "workers ran in the wrong order");
+        }
+        PICOTEST_CHECK(!ctx->at_time_list && is_at_the_end_of_time(ctx->next_time), "workers left after running");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("re-adding a present worker reschedules it");
+        init_workers();
+        absolute_time_t base = get_absolute_time();
+        PICOTEST_CHECK(async_context_add_at_time_worker_at(ctx, &workers[0], delayed_by_ms(base, 1000)), "failed to add worker");
+        PICOTEST_CHECK(async_context_add_at_time_worker_at(ctx, &workers[1], delayed_by_ms(base, 2000)), "failed to add worker");
+        PICOTEST_CHECK(!async_context_add_at_time_worker_at(ctx, &workers[1], delayed_by_ms(base, 2)), "re-added present worker");
+        PICOTEST_CHECK(ctx->at_time_list == &workers[1] && list_is_ordered(ctx), "rescheduled worker not moved");
+        workers[1].next_time = delayed_by_ms(base, 3000);
+        PICOTEST_CHECK(!async_context_add_at_time_worker(ctx, &workers[1]), "re-added present worker");
+        PICOTEST_CHECK(ctx->at_time_list == &workers[0] && list_is_ordered(ctx), "rescheduled worker not moved");
+        PICOTEST_CHECK(async_context_remove_at_time_worker(ctx, &workers[0]), "failed to remove worker");
+        PICOTEST_CHECK(!async_context_remove_at_time_worker(ctx, &workers[0]), "removed absent worker");
+        PICOTEST_CHECK(async_context_remove_at_time_worker(ctx, &workers[1]), "failed to remove worker");
+        PICOTEST_CHECK(!ctx->at_time_list, "workers left after removal");
+        async_context_poll(ctx);
+        PICOTEST_CHECK(!run_count, "removed worker ran");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("worker re-adding itself");
+        init_workers();
+        workers[0].do_work = repeating_worker;
+        async_context_add_at_time_worker_in_ms(ctx, &workers[0], 1);
+        absolute_time_t timeout = make_timeout_time_ms(1000);
+        while (run_count < REPEAT_COUNT && !time_reached(timeout)) {
+            async_context_poll(ctx);
+            async_context_wait_for_work_until(ctx, timeout);
+        }
+        PICOTEST_CHECK(run_count == REPEAT_COUNT, "repeating worker ran the wrong number of times");
+        PICOTEST_CHECK(!ctx->at_time_list, "repeating worker left after finishing");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("worker from deinitialized context");
+        init_workers();
+        async_context_add_at_time_worker_in_ms(ctx, &workers[0], 1000);
+        async_context_deinit(ctx);
+        async_context_poll_init_with_defaults(&context);
+        PICOTEST_CHECK(!async_context_remove_at_time_worker(ctx, &workers[0]), "removed worker from previous context");
+        PICOTEST_CHECK(async_context_add_at_time_worker_in_ms(ctx, &workers[0], 1000), "failed to add worker from previous context");
+        PICOTEST_CHECK(async_context_remove_at_time_worker(ctx, &workers[0]), "failed to remove worker");
+    PICOTEST_END_SECTION();
+
+    async_context_deinit(ctx);
+    PICOTEST_END_TEST();
+}
@@ -0,0 +1,187 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Host allocation stress benchmark of the pico_malloc allocation pool (PICO_MALLOC_POOL) against the C library
+// allocator behind a single mutex (as pico_malloc uses without the pool), running a random mix of allocation sizes
+// and lifetimes typical of networking code on both cores at once. The contents of each allocation are checked
+// before it is freed, and a fragmentation report for the pool is printed for the allocations live at the end.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/mutex.h"
+
+// pico_malloc is only built for the device, so compile the pool in directly
+#define PICO_MALLOC_POOL 1
+#define PICO_MALLOC_POOL_SIZE (128 * 1024)
+#include "malloc_pool.c"
+
+#define NUM_ITERATIONS 1000000
+#define NUM_SLOTS 1024
+
+typedef enum {
+    BACKEND_LIBC,
+    BACKEND_POOL,
+    BACKEND_COUNT
+} backend_t;
+
+static const char *backend_names[BACKEND_COUNT] = {"libc", "pool"};
+
+typedef struct {
+    uint8_t *mem;
+    uint32_t size;
+} slot_t;
+
+static slot_t slots[NUM_CORES][NUM_SLOTS];
+static uint errors[NUM_CORES];
+
+static mutex_t libc_mutex;
+
+static void *backend_alloc(backend_t backend, size_t size) {
+    if (backend == BACKEND_POOL) {
+        void *mem = malloc_pool_alloc(size);
+        if (mem) return mem;
+    }
+    mutex_enter_blocking(&libc_mutex);
+    void *mem = malloc(size);
+    mutex_exit(&libc_mutex);
+    return mem;
+}
+
+static void backend_free(backend_t backend, void *mem) {
+    if (backend == BACKEND_POOL && malloc_pool_owns(mem)) {
+        malloc_pool_free(mem);
+        return;
+    }
+    mutex_enter_blocking(&libc_mutex);
+    free(mem);
+    mutex_exit(&libc_mutex);
+}
+
+static uint32_t next_random(uint32_t *state) {
+    // xorshift32
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// mostly small control blocks and headers, with some buffers and the occasional full size packet
+static uint32_t random_size(uint32_t *state) {
+    uint32_t r = next_random(state);
+    uint32_t kind = r % 100;
+    r >>= 8;
+    if (kind < 50) return 8 + r % 57;
+    if (kind < 85) return 65 + r % 192;
+    if (kind < 97) return 257 + r % 344;
+    return 1024 + r % 513;
+}
+
+static void stress(backend_t backend, uint core) {
+    uint32_t state = 0x12345678u + core;
+    for (uint i = 0; i < NUM_ITERATIONS; i++) {
+        slot_t *slot = &slots[core][next_random(&state) % NUM_SLOTS];
+        uint8_t fill = (uint8_t)(slot - slots[core]);
+        if (slot->mem) {
+            if (slot->mem[0] != fill || slot->mem[slot->size - 1] != fill) errors[core]++;
+            backend_free(backend, slot->mem);
+            slot->mem = NULL;
+        } else {
+            slot->size = random_size(&state);
+            slot->mem = backend_alloc(backend, slot->size);
+            if (!slot->mem) {
+                errors[core]++;
+                continue;
+            }
+            memset(slot->mem, fill, slot->size);
+        }
+    }
+}
+
+static void free_all(backend_t backend) {
+    for (uint core = 0; core < NUM_CORES; core++) {
+        for (uint i = 0; i < NUM_SLOTS; i++) {
+            if (slots[core][i].mem) backend_free(backend, slots[core][i].mem);
+            slots[core][i].mem = NULL;
+        }
+    }
+}
+
+static void core1_main(void) {
+    while (true) {
+        backend_t backend = (backend_t)multicore_fifo_pop_blocking();
+        stress(backend, 1);
+        multicore_fifo_push_blocking(0);
+    }
+}
+
+static uint64_t wall_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void fragmentation_report(void) {
+    // the bytes requested by the live allocations in each size class
+    uint64_t requested[PICO_MALLOC_POOL_NUM_CLASSES] = {0};
+    for (uint core = 0; core < NUM_CORES; core++) {
+        for (uint i = 0; i < NUM_SLOTS; i++) {
+            slot_t *slot = &slots[core][i];
+            if (slot->mem && malloc_pool_owns(slot->mem)) {
+                requested[slab_class[slab_of(slot->mem)] - 1] += slot->size;
+            }
+        }
+    }
+    malloc_pool_stats_t stats;
+    malloc_pool_get_stats(&stats);
+    printf("\npool fragmentation report (live allocations at end of run)\n");
+    printf("%6s %6s %8s %8s %10s %10s %10s\n", "class", "slabs", "in use", "free", "requested", "internal", "slab used");
+    uint64_t total_requested = 0, total_in_use = 0, total_slab = 0;
+    for (uint cls = 0; cls < PICO_MALLOC_POOL_NUM_CLASSES; cls++) {
+        malloc_pool_class_stats_t *c = &stats.classes[cls];
+        uint64_t in_use = (uint64_t)c->blocks_in_use * c->block_size;
+        uint64_t slab = (uint64_t)c->slabs * PICO_MALLOC_POOL_SLAB_SIZE;
+        printf("%6u %6u %8u %8u %10llu %9.1f%% %9.1f%%\n", (uint)c->block_size, (uint)c->slabs, (uint)c->blocks_in_use,
+               (uint)c->blocks_free, (unsigned long long)requested[cls],
+               in_use ? 100.0 * (double)(in_use - requested[cls]) / (double)in_use : 0.0,
+               slab ? 100.0 * (double)in_use / (double)slab : 0.0);
+        total_requested += requested[cls];
+        total_in_use += in_use;
+        total_slab += slab;
+    }
+    printf("slabs used %u/%u; internal fragmentation %.1f%% (block bytes not requested); slab utilisation %.1f%% "
+           "(slab bytes in live blocks); %u allocations fell back to libc\n", (uint)stats.slabs_used,
+           (uint)stats.slabs_total, total_in_use ? 100.0 * (double)(total_in_use - total_requested) / (double)total_in_use : 0.0,
+           total_slab ? 100.0 * (double)total_in_use / (double)total_slab : 0.0, (uint)stats.fallback_allocs);
+}
+
+int main(void) {
+    mutex_init(&libc_mutex);
+    multicore_launch_core1(core1_main);
+    uint total_errors = 0;
+    printf("%-6s %10s %8s\n", "alloc", "ns/op", "errors");
+    for (uint backend = 0; backend < BACKEND_COUNT; backend++) {
+        uint64_t t0 = wall_time_ns();
+        multicore_fifo_push_blocking(backend);
+        stress((backend_t)backend, 0);
+        multicore_fifo_pop_blocking();
+        uint64_t elapsed_ns = wall_time_ns() - t0;
+        uint backend_errors = errors[0] + errors[1];
+        errors[0] = errors[1] = 0;
+        // both cores run NUM_ITERATIONS operations in the elapsed time
+        printf("%-6s %10.1f %8u\n", backend_names[backend], (double)elapsed_ns / NUM_ITERATIONS, backend_errors);
+        if (backend == BACKEND_POOL) fragmentation_report();
+        free_all((backend_t)backend);
+        total_errors += backend_errors;
+    }
+    multicore_reset_core1();
+    printf("malloc_benchmark: %s\n", total_errors ? "Failed" : "Success");
+    return total_errors ? -1 : 0;
+}
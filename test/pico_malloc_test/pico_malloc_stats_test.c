@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Host test of the heap statistics kept by pico_malloc (PICO_MALLOC_STATS). pico_malloc is only built for the device,
+// so the wrappers are compiled in directly and called by name. The "real" functions below stand in for picolibc,
+// whose calloc and realloc call the (wrapped) malloc and free, so the test also checks those nested calls are not
+// counted twice.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+
+#include "pico/stdlib.h"
+#include "pico/test.h"
+#include "pico/mutex.h"
+
+#define WRAPPER_FUNC(x) __wrap_ ## x
+#define REAL_FUNC(x) __real_ ## x
+#define __PICOLIBC__ 1
+#define PICO_USE_MALLOC_MUTEX 1
+#define PICO_MALLOC_PANIC 0
+#define PICO_MALLOC_STATS 1
+#include "malloc.c"
+
+PICOTEST_MODULE_NAME("MALLOC_STATS", "malloc stats test");
+
+// the linker symbols used for the heap size (which this test doesn't check)
+char __StackLimit;
+
+void *__real_malloc(size_t size) {
+    return malloc(size);
+}
+
+void __real_free(void *mem) {
+    free(mem);
+}
+
+void *__real_calloc(size_t count, size_t size) {
+    void *mem = __wrap_malloc(count * size);
+    if (mem) memset(mem, 0, count * size);
+    return mem;
+}
+
+void *__real_realloc(void *mem, size_t size) {
+    if (!mem) return __wrap_malloc(size);
+    if (!size) {
+        __wrap_free(mem);
+        return NULL;
+    }
+    void *rc = __wrap_malloc(size);
+    if (rc) {
+        memcpy(rc, mem, MIN(size, malloc_usable_size(mem)));
+        __wrap_free(mem);
+    }
+    return rc;
+}
+
+// two distinct call sites; the volatile results stop the calls being tail calls, so the return addresses are in these
+// functions, and the functions differ so they can't be merged
+static __noinline void *alloc_site_a(size_t size) {
+    void *volatile mem = __wrap_malloc(size);
+    return mem;
+}
+
+static __noinline void *alloc_site_b(size_t size) {
+    void *volatile mem = __wrap_malloc(size);
+    if (mem) memset(mem, 0xb, size);
+    return mem;
+}
+
+int main() {
+    stdio_init_all();
+    mutex_init(&malloc_mutex);
+    malloc_stats_t s;
+
+    PICOTEST_START();
+
+    PICOTEST_START_SECTION("bytes in use");
+        malloc_get_stats(&s);
+        PICOTEST_CHECK(!s.allocs && !s.frees && !s.bytes_in_use && !s.peak_bytes_in_use, "stats not initially zero");
+        void *a = alloc_site_a(10);
+        void *b = alloc_site_a(100);
+        void *c = alloc_site_b(2000);
+        uint32_t expected = (uint32_t)(malloc_usable_size(a) + malloc_usable_size(b) + malloc_usable_size(c));
+        malloc_get_stats(&s);
+        PICOTEST_CHECK(s.allocs == 3 && !s.frees, "wrong alloc count");
+        PICOTEST_CHECK(s.bytes_in_use == expected && s.peak_bytes_in_use == expected, "wrong bytes in use");
+        PICOTEST_CHECK(s.size_allocs[0] == 1 && s.size_allocs[3] == 1 &&
+                       s.size_allocs[PICO_MALLOC_STATS_NUM_SIZE_BUCKETS - 1] == 1, "wrong size buckets");
+        expected -= (uint32_t)malloc_usable_size(c);
+        __wrap_free(c);
+        malloc_get_stats(&s);
+        PICOTEST_CHECK(s.frees == 1 && s.bytes_in_use == expected, "free not counted");
+        PICOTEST_CHECK(s.peak_bytes_in_use > s.bytes_in_use, "peak not kept");
+        malloc_stats_reset_peak();
+        malloc_get_stats(&s);
+        PICOTEST_CHECK(s.peak_bytes_in_use == s.bytes_in_use, "peak not reset");
+        __wrap_free(a);
+        __wrap_free(b);
+        malloc_get_stats(&s);
+        PICOTEST_CHECK(!s.bytes_in_use && s.frees == 3, "bytes in use after freeing everything");
+        PICOTEST_CHECK(s.peak_bytes_in_use == expected, "peak lost after freeing");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("call sites");
+        malloc_call_site_stats_t sites[4];
+        uint n = malloc_get_call_site_stats(sites, count_of(sites));
+        PICOTEST_CHECK(n == 2, "wrong number of call sites");
+        PICOTEST_CHECK(sites[0].allocs == 1 && sites[0].bytes == 2000, "wrong totals for the largest call site");
+        PICOTEST_CHECK(sites[1].allocs == 2 && sites[1].bytes == 110, "wrong totals for the second call site");
+        PICOTEST_CHECK(malloc_get_call_site_stats(sites, 1) == 1 && sites[0].bytes == 2000, "call sites not sorted");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("calloc and realloc");
+        malloc_stats_t before;
+        malloc_get_stats(&before);
+        uint32_t *p = (uint32_t *)__wrap_calloc(8, 4);
+        malloc_get_stats(&s);
+        PICOTEST_CHECK(p && !p[0] && !p[7], "calloc failed");
+        PICOTEST_CHECK(s.allocs == before.allocs + 1 && s.frees == before.frees, "calloc counted more than once");
+        PICOTEST_CHECK(s.size_allocs[1] == before.size_allocs[1] + 1, "calloc size not counted");
+        PICOTEST_CHECK(s.bytes_in_use == malloc_usable_size(p), "wrong bytes in use after calloc");
+        p[7] = 1234;
+        p = (uint32_t *)__wrap_realloc(p, 600);
+        malloc_get_stats(&s);
+        PICOTEST_CHECK(p && p[7] == 1234, "realloc failed");
+        PICOTEST_CHECK(s.allocs == before.allocs + 2 && s.frees == before.frees + 1, "realloc counted more than once");
+        PICOTEST_CHECK(s.size_allocs[6] == before.size_allocs[6] + 1, "realloc size not counted");
+        PICOTEST_CHECK(s.bytes_in_use == malloc_usable_size(p), "wrong bytes in use after realloc");
+        PICOTEST_CHECK(!__wrap_realloc(p, 0), "realloc to size 0 returned an allocation");
+        malloc_get_stats(&s);
+        PICOTEST_CHECK(!s.bytes_in_use && s.frees == before.frees + 2, "realloc to size 0 not counted as a free");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("failed allocations");
+        malloc_get_stats(&s);
+        uint32_t allocs = s.allocs;
+        PICOTEST_CHECK(!__wrap_malloc(SIZE_MAX / 2), "impossible allocation succeeded");
+        malloc_get_stats(&s);
+        PICOTEST_CHECK(s.failed_allocs == 1 && s.allocs == allocs, "failed allocation not counted");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_END_TEST();
+}
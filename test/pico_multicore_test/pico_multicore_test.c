@@ -0,0 +1,234 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Stress test of inter-core communication and synchronization; core 1 runs commands sent to it over the FIFO
+// by core 0. On the host, the cores are threads, so this is also suitable for running under ThreadSanitizer.
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/sync.h"
+#include "pico/util/queue.h"
+#include "pico/test.h"
+
+PICOTEST_MODULE_NAME("MULTICORE", "multicore test");
+
+#define ECHO_COUNT 10000
+#define COUNT_ITERATIONS 100000
+#define QUEUE_VALUES 10000
+
+enum {
+    CMD_ECHO = 1,
+    CMD_SPIN_LOCK_COUNT,
+    CMD_MUTEX_COUNT,
+    CMD_QUEUE_ECHO,
+    CMD_DOORBELL,
+    CMD_LOCKOUT_VICTIM,
+};
+
+static spin_lock_t *count_spin_lock;
+static uint32_t spin_lock_count;
+
+static mutex_t count_mutex;
+static uint32_t mutex_count;
+static semaphore_t core1_done;
+
+static queue_t queue_to_core1;
+static queue_t queue_from_core1;
+
+#if NUM_DOORBELLS
+static uint doorbell_num;
+#endif
+
+static uint32_t victim_count;
+
+static uint32_t get_victim_count(void) {
+    return __atomic_load_n(&victim_count, __ATOMIC_RELAXED);
+}
+
+static void count_with_spin_lock(void) {
+    for (uint i = 0; i < COUNT_ITERATIONS; i++) {
+        uint32_t save = spin_lock_blocking(count_spin_lock);
+        spin_lock_count++;
+        spin_unlock(count_spin_lock, save);
+    }
+}
+
+static void count_with_mutex(void) {
+    for (uint i = 0; i < COUNT_ITERATIONS; i++) {
+        mutex_enter_blocking(&count_mutex);
+        mutex_count++;
+        mutex_exit(&count_mutex);
+    }
+}
+
+static void core1_main(void) {
+    while (true) {
+        uint32_t cmd = multicore_fifo_pop_blocking();
+        switch (cmd) {
+            case CMD_ECHO:
+                for (uint32_t value; (value = multicore_fifo_pop_blocking()) != 0; ) {
+                    multicore_fifo_push_blocking(value + 1);
+                }
+                break;
+            case CMD_SPIN_LOCK_COUNT:
+                count_with_spin_lock();
+                break;
+            case CMD_MUTEX_COUNT:
+                count_with_mutex();
+                sem_release(&core1_done);
+                break;
+            case CMD_QUEUE_ECHO:
+                for (uint i = 0; i < QUEUE_VALUES; i++) {
+                    uint32_t value;
+                    queue_remove_blocking(&queue_to_core1, &value);
+                    value *= 2;
+                    queue_add_blocking(&queue_from_core1, &value);
+                }
+                break;
+#if NUM_DOORBELLS
+            case CMD_DOORBELL:
+                multicore_doorbell_set_other_core(doorbell_num);
+                break;
+#endif
+            case CMD_LOCKOUT_VICTIM:
+                // note the FIFO may not be used once this core is a lockout victim, so we run until reset (on the
+                // host, tight_loop_contents is where this core takes the lockout and reset core IRQs)
+                multicore_lockout_victim_init();
+                for (uint32_t n = 1; ; n++) {
+                    __atomic_store_n(&victim_count, n, __ATOMIC_RELAXED);
+                    tight_loop_contents();
+                }
+            default:
+                break;
+        }
+        multicore_fifo_push_blocking(cmd);
+    }
+}
+
+static bool run_on_core1(uint32_t cmd) {
+    multicore_fifo_push_blocking(cmd);
+    return multicore_fifo_pop_blocking() == cmd;
+}
+
+static bool echo_test(void) {
+    multicore_fifo_push_blocking(CMD_ECHO);
+    bool ok = true;
+    for (uint32_t i = 1; i <= ECHO_COUNT; i++) {
+        multicore_fifo_push_blocking(i);
+        if (multicore_fifo_pop_blocking() != i + 1) ok = false;
+    }
+    multicore_fifo_push_blocking(0);
+    return multicore_fifo_pop_blocking() == CMD_ECHO && ok;
+}
+
+static bool queue_echo_test(void) {
+    multicore_fifo_push_blocking(CMD_QUEUE_ECHO);
+    uint32_t next_add = 0, next_remove = 0;
+    bool ok = true;
+    while (next_remove < QUEUE_VALUES) {
+        if (next_add < QUEUE_VALUES && queue_try_add(&queue_to_core1, &next_add)) {
+            next_add++;
+        }
+        uint32_t value;
+        if (queue_try_remove(&queue_from_core1, &value)) {
+            if (value != next_remove * 2) ok = false;
+            next_remove++;
+        }
+    }
+    return multicore_fifo_pop_blocking() == CMD_QUEUE_ECHO && ok;
+}
+
+int main() {
+    stdio_init_all();
+    PICOTEST_START();
+
+    count_spin_lock = spin_lock_init(spin_lock_claim_unused(true));
+    mutex_init(&count_mutex);
+    sem_init(&core1_done, 0, 1);
+    multicore_launch_core1(core1_main);
+
+    PICOTEST_START_SECTION("FIFO");
+        uint32_t value;
+        PICOTEST_CHECK(!multicore_fifo_pop_timeout_us(1000, &value), "popped from empty FIFO");
+        PICOTEST_CHECK(!(multicore_fifo_get_status() & SIO_FIFO_ST_VLD_BITS), "empty FIFO is valid");
+        PICOTEST_CHECK(echo_test(), "wrong values echoed");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("spin lock contention");
+        spin_lock_count = 0;
+        multicore_fifo_push_blocking(CMD_SPIN_LOCK_COUNT);
+        count_with_spin_lock();
+        PICOTEST_CHECK(multicore_fifo_pop_blocking() == CMD_SPIN_LOCK_COUNT, "wrong response");
+        PICOTEST_CHECK(spin_lock_count == 2 * COUNT_ITERATIONS, "lost spin lock protected increments");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("mutex contention");
+        mutex_count = 0;
+        multicore_fifo_push_blocking(CMD_MUTEX_COUNT);
+        count_with_mutex();
+        PICOTEST_CHECK(sem_acquire_timeout_ms(&core1_done, 10000), "core 1 did not release semaphore");
+        PICOTEST_CHECK(multicore_fifo_pop_blocking() == CMD_MUTEX_COUNT, "wrong response");
+        PICOTEST_CHECK(mutex_count == 2 * COUNT_ITERATIONS, "lost mutex protected increments");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("queues between cores");
+        queue_init(&queue_to_core1, sizeof(uint32_t), 4);
+        queue_init(&queue_from_core1, sizeof(uint32_t), 4);
+        PICOTEST_CHECK(queue_echo_test(), "wrong values through regular queues");
+        queue_free(&queue_to_core1);
+        queue_free(&queue_from_core1);
+        queue_init_spsc(&queue_to_core1, sizeof(uint32_t), 4);
+        queue_init_spsc(&queue_from_core1, sizeof(uint32_t), 4);
+        PICOTEST_CHECK(queue_echo_test(), "wrong values through single-producer/single-consumer queues");
+        queue_free(&queue_to_core1);
+        queue_free(&queue_from_core1);
+    PICOTEST_END_SECTION();
+
+#if NUM_DOORBELLS
+    PICOTEST_START_SECTION("doorbells");
+        doorbell_num = (uint)multicore_doorbell_claim_unused(0x3, true);
+        PICOTEST_CHECK(!multicore_doorbell_is_set_current_core(doorbell_num), "doorbell initially set");
+        PICOTEST_CHECK(run_on_core1(CMD_DOORBELL), "wrong response");
+        PICOTEST_CHECK(multicore_doorbell_is_set_current_core(doorbell_num), "doorbell not set by other core");
+        multicore_doorbell_clear_current_core(doorbell_num);
+        PICOTEST_CHECK(!multicore_doorbell_is_set_current_core(doorbell_num), "doorbell not cleared");
+        multicore_doorbell_unclaim(doorbell_num, 0x3);
+    PICOTEST_END_SECTION();
+#endif
+
+    PICOTEST_START_SECTION("lockout");
+        multicore_fifo_push_blocking(CMD_LOCKOUT_VICTIM);
+        while (!get_victim_count() || !multicore_lockout_victim_is_initialized(1)) {
+            tight_loop_contents();
+        }
+        PICOTEST_CHECK(multicore_lockout_start_timeout_us(1000000), "failed to lock out core 1");
+        uint32_t count = get_victim_count();
+        busy_wait_ms(20);
+        PICOTEST_CHECK(get_victim_count() == count, "core 1 ran while locked out");
+        PICOTEST_CHECK(multicore_lockout_end_timeout_us(1000000), "failed to end lockout");
+        absolute_time_t timeout = make_timeout_time_ms(1000);
+        while (get_victim_count() == count && !time_reached(timeout)) {
+            tight_loop_contents();
+        }
+        PICOTEST_CHECK(get_victim_count() != count, "core 1 did not resume after lockout");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("reset and relaunch core 1");
+        // core 1 is still a lockout victim, so can't use the FIFO; reset it from whatever it is doing
+        multicore_reset_core1();
+        PICOTEST_CHECK(!multicore_lockout_victim_is_initialized(1), "lockout victim state not reset");
+        uint32_t count = get_victim_count();
+        busy_wait_ms(20);
+        PICOTEST_CHECK(get_victim_count() == count, "core 1 ran after reset");
+        multicore_launch_core1(core1_main);
+        PICOTEST_CHECK(echo_test(), "wrong values echoed after relaunch");
+    PICOTEST_END_SECTION();
+
+    multicore_reset_core1();
+    PICOTEST_END_TEST();
+}
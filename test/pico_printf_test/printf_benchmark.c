@@ -0,0 +1,140 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Host benchmark of pico_printf throughput on typical log lines, comparing formatting into a buffer, output through
+// a per-character callback (vfctprintf) and output through a span callback (vspanprintf), with the C library's
+// vsnprintf for reference. The output of each is also checked against the C library.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "pico/stdlib.h"
+
+// the host build uses the C library's printf, so compile the pico_printf formatter in directly, under its own names
+#define LIB_PICO_PRINTF_PICO 1
+#define PICO_PRINTF_ALWAYS_INCLUDED 1
+#define WRAPPER_FUNC(x) pico_ ## x
+#include "printf.c"
+
+#define NUM_ITERATIONS 200000
+#define OUTPUT_BUFFER_SIZE 256
+
+typedef enum {
+    OUTPUT_BUFFER,
+    OUTPUT_CHAR_FCT,
+    OUTPUT_SPAN_FCT,
+    OUTPUT_LIBC,
+    OUTPUT_COUNT
+} output_t;
+
+static const char *output_names[OUTPUT_COUNT] = {"buffer", "char fct", "span fct", "libc"};
+
+typedef struct {
+    char buf[OUTPUT_BUFFER_SIZE];
+    size_t used;
+    uint calls;
+} sink_t;
+
+static void char_sink(char c, void *arg) {
+    sink_t *sink = (sink_t *)arg;
+    if (sink->used < OUTPUT_BUFFER_SIZE - 1) sink->buf[sink->used++] = c;
+    sink->calls++;
+}
+
+static void span_sink(const char *s, size_t len, void *arg) {
+    sink_t *sink = (sink_t *)arg;
+    size_t n = MIN(len, OUTPUT_BUFFER_SIZE - 1 - sink->used);
+    memcpy(sink->buf + sink->used, s, n);
+    sink->used += n;
+    sink->calls++;
+}
+
+static uint64_t wall_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int format(output_t output, sink_t *sink, const char *fmt, ...) {
+    va_list va;
+    va_start(va, fmt);
+    int len;
+    sink->used = 0;
+    switch (output) {
+        case OUTPUT_BUFFER:
+            len = pico_vsnprintf(sink->buf, OUTPUT_BUFFER_SIZE, fmt, va);
+            sink->used = strlen(sink->buf);
+            sink->calls = 0;
+            break;
+        case OUTPUT_CHAR_FCT:
+            len = vfctprintf(char_sink, sink, fmt, va);
+            break;
+        case OUTPUT_SPAN_FCT:
+            len = vspanprintf(span_sink, sink, fmt, va);
+            break;
+        default:
+            len = vsnprintf(sink->buf, OUTPUT_BUFFER_SIZE, fmt, va);
+            sink->used = strlen(sink->buf);
+            sink->calls = 0;
+            break;
+    }
+    va_end(va);
+    sink->buf[sink->used] = 0;
+    return len;
+}
+
+// formats each of the log lines once; returns the number of characters output
+static uint log_lines(output_t output, sink_t *sink, uint i, char *check, size_t check_size) {
+    uint chars = 0;
+    size_t check_used = 0;
+#define LOG_LINE(...) ({ \
+        chars += (uint)format(output, sink, __VA_ARGS__); \
+        if (check) check_used += (size_t)snprintf(check + check_used, check_size - check_used, "%s", sink->buf); \
+    })
+    LOG_LINE("[%8u.%06u] usb: device connected, address %d\n", i / 1000000u, i % 1000000u, 5);
+    LOG_LINE("%s:%d: assertion \"%s\" failed\n", "src/app/main.c", 1234, "count < MAX_COUNT");
+    LOG_LINE("sensor %-10s reading %5d mV (raw 0x%04x, %+d)\n", "vbus", 5012, 0x1f3c, -3);
+    LOG_LINE("temperature %.2f C, pressure %8.1f hPa\n", 21.5, 1013.25);
+    LOG_LINE("tx %llu bytes rx %lu bytes in %u ms\n", 123456789012ull, 987654ul, i);
+    LOG_LINE("ok\n");
+#undef LOG_LINE
+    return chars;
+}
+
+static int run(output_t output) {
+    sink_t sink = {0};
+    static char expected[1024], actual[1024];
+    uint calls = 0;
+    log_lines(OUTPUT_LIBC, &sink, 0, expected, sizeof(expected));
+    log_lines(output, &sink, 0, actual, sizeof(actual));
+    uint errors = strcmp(expected, actual) ? 1 : 0;
+    if (errors) {
+        printf("%s output differs:\n%s\nexpected:\n%s\n", output_names[output], actual, expected);
+    }
+
+    uint64_t chars = 0;
+    uint64_t t0 = wall_time_ns();
+    for (uint i = 0; i < NUM_ITERATIONS; i++) {
+        sink.calls = 0;
+        chars += log_lines(output, &sink, i, NULL, 0);
+        calls += sink.calls;
+    }
+    uint64_t elapsed_ns = wall_time_ns() - t0;
+    printf("%-9s %10.1f %10.1f %12.1f %8u\n", output_names[output], (double)elapsed_ns / (NUM_ITERATIONS * 6.0),
+           (double)chars * 1000.0 / (double)elapsed_ns, (double)calls / (NUM_ITERATIONS * 6.0), errors);
+    return errors ? -1 : 0;
+}
+
+int main(void) {
+    int rc = 0;
+    printf("%-9s %10s %10s %12s %8s\n", "output", "ns/line", "Mchar/s", "calls/line", "errors");
+    for (uint output = 0; output < OUTPUT_COUNT; output++) {
+        if (run((output_t)output)) rc = -1;
+    }
+    printf("printf_benchmark: %s\n", rc ? "Failed" : "Success");
+    return rc;
+}
@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/test.h"
+#include "pico/util/queue.h"
+
+PICOTEST_MODULE_NAME("QUEUE", "queue test");
+
+#define QUEUE_LENGTH 7
+#define TIMEOUT_US 20000
+
+static uint32_t timer_next_value;
+
+// adds increasing values to the queue from the alarm IRQ (or the timer thread on host)
+static bool add_from_timer(repeating_timer_t *rt) {
+    queue_t *q = (queue_t *)rt->user_data;
+    if (queue_try_add(q, &timer_next_value)) {
+        timer_next_value++;
+    }
+    return true;
+}
+
+static int test_queue(bool spsc) {
+    queue_t q;
+    if (spsc) {
+        queue_init_spsc(&q, sizeof(uint32_t), QUEUE_LENGTH);
+    } else {
+        queue_init(&q, sizeof(uint32_t), QUEUE_LENGTH);
+    }
+    printf("%s queue\n", spsc ? "Single-producer/single-consumer" : "Regular");
+
+    PICOTEST_START_SECTION("single add/remove");
+        uint32_t value;
+        PICOTEST_CHECK(!queue_try_remove(&q, &value), "removed from empty queue");
+        for (uint32_t i = 0; i < QUEUE_LENGTH; i++) {
+            PICOTEST_CHECK(queue_try_add(&q, &i), "failed to add to non-full queue");
+        }
+        PICOTEST_CHECK(queue_is_full(&q), "queue not full");
+        PICOTEST_CHECK(!queue_try_add(&q, &value), "added to full queue");
+        PICOTEST_CHECK(queue_try_peek(&q, &value) && value == 0, "wrong peeked value");
+        for (uint32_t i = 0; i < QUEUE_LENGTH; i++) {
+            PICOTEST_CHECK(queue_try_remove(&q, &value) && value == i, "wrong removed value");
+        }
+        PICOTEST_CHECK(queue_is_empty(&q), "queue not empty");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("bulk add/remove with wrap-around");
+        uint32_t values[QUEUE_LENGTH * 2];
+        uint32_t next_add = 0, next_remove = 0;
+        // vary the batch sizes so that the indexes wrap at every possible position
+        for (uint round = 0; round < 50; round++) {
+            uint add_count = 1 + round % (QUEUE_LENGTH + 2);
+            for (uint i = 0; i < add_count; i++) values[i] = next_add + i;
+            uint expected = MIN(add_count, QUEUE_LENGTH - queue_get_level(&q));
+            uint added = queue_try_add_many(&q, values, add_count);
+            PICOTEST_CHECK(added == expected, "wrong number of values added");
+            next_add += added;
+            uint remove_count = 1 + (round * 3) % (QUEUE_LENGTH + 2);
+            expected = MIN(remove_count, queue_get_level(&q));
+            uint removed = queue_try_remove_many(&q, values, remove_count);
+            PICOTEST_CHECK(removed == expected, "wrong number of values removed");
+            for (uint i = 0; i < removed; i++) {
+                PICOTEST_CHECK(values[i] == next_remove + i, "wrong removed value");
+            }
+            next_remove += removed;
+        }
+        PICOTEST_CHECK(queue_try_remove_many(&q, NULL, QUEUE_LENGTH) == next_add - next_remove, "wrong final level");
+        PICOTEST_CHECK(!queue_try_remove_many(&q, values, 1), "removed from empty queue");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("zero-copy reserve/commit with wrap-around");
+        uint32_t next_add = 0, next_remove = 0;
+        for (uint round = 0; round < 50; round++) {
+            uint count = 1 + round % (QUEUE_LENGTH + 2);
+            uint32_t *in = (uint32_t *)queue_try_reserve_add(&q, &count);
+            if (in) {
+                PICOTEST_CHECK(count && count <= QUEUE_LENGTH - queue_get_level(&q), "invalid reservation count");
+                // commit only some of what was reserved
+                uint commit = (count + 1) / 2;
+                for (uint i = 0; i < commit; i++) in[i] = next_add++;
+                queue_commit_add(&q, commit);
+            } else {
+                PICOTEST_CHECK(queue_is_full(&q), "failed to reserve in non-full queue");
+            }
+            count = 1 + (round * 5) % QUEUE_LENGTH;
+            const uint32_t *out = (const uint32_t *)queue_try_reserve_remove(&q, &count);
+            if (out) {
+                PICOTEST_CHECK(count && count <= queue_get_level(&q), "invalid reservation count");
+                for (uint i = 0; i < count; i++) {
+                    PICOTEST_CHECK(out[i] == next_remove + i, "wrong value read in place");
+                }
+                next_remove += count;
+                queue_commit_remove(&q, count);
+            } else {
+                PICOTEST_CHECK(queue_is_empty(&q), "failed to reserve in non-empty queue");
+            }
+        }
+        PICOTEST_CHECK(queue_get_level(&q) == next_add - next_remove, "wrong final level");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("timed blocking and wait for level");
+        uint32_t value = 0;
+        queue_try_remove_many(&q, NULL, QUEUE_LENGTH);
+        absolute_time_t start = get_absolute_time();
+        PICOTEST_CHECK(!queue_remove_block_until(&q, &value, make_timeout_time_us(TIMEOUT_US)), "removed from empty queue");
+        PICOTEST_CHECK(absolute_time_diff_us(start, get_absolute_time()) >= TIMEOUT_US, "remove timed out early");
+        PICOTEST_CHECK(!queue_peek_block_until(&q, &value, make_timeout_time_us(TIMEOUT_US)), "peeked empty queue");
+        PICOTEST_CHECK(!queue_wait_for_level_until(&q, 1, make_timeout_time_us(TIMEOUT_US)), "empty queue reached level");
+        PICOTEST_CHECK(queue_wait_for_level_until(&q, 0, make_timeout_time_us(TIMEOUT_US)), "empty queue did not reach level 0");
+        for (uint32_t i = 0; i < QUEUE_LENGTH; i++) {
+            PICOTEST_CHECK(queue_add_block_until(&q, &i, make_timeout_time_us(TIMEOUT_US)), "failed to add to non-full queue");
+        }
+        start = get_absolute_time();
+        PICOTEST_CHECK(!queue_add_block_until(&q, &value, make_timeout_time_us(TIMEOUT_US)), "added to full queue");
+        PICOTEST_CHECK(absolute_time_diff_us(start, get_absolute_time()) >= TIMEOUT_US, "add timed out early");
+        PICOTEST_CHECK(queue_wait_for_level_until(&q, QUEUE_LENGTH, make_timeout_time_us(TIMEOUT_US)), "full queue did not reach level");
+        PICOTEST_CHECK(queue_remove_block_until(&q, &value, make_timeout_time_us(TIMEOUT_US)) && value == 0, "wrong removed value");
+        queue_try_remove_many(&q, NULL, QUEUE_LENGTH);
+
+        // wait for values added asynchronously
+        repeating_timer_t timer;
+        timer_next_value = 0;
+        PICOTEST_CHECK_AND_ABORT(add_repeating_timer_us(-1000, add_from_timer, &q, &timer), "failed to add timer");
+        PICOTEST_CHECK(queue_wait_for_level_until(&q, 5, make_timeout_time_ms(1000)), "level not reached");
+        uint32_t values[QUEUE_LENGTH];
+        uint removed = queue_try_remove_many(&q, values, QUEUE_LENGTH);
+        PICOTEST_CHECK(removed >= 5, "too few values removed after waiting for level");
+        for (uint i = 0; i < removed; i++) {
+            PICOTEST_CHECK(values[i] == i, "wrong removed value");
+        }
+        PICOTEST_CHECK(queue_remove_block_until(&q, &value, make_timeout_time_ms(1000)) && value == removed, "wrong removed value");
+        cancel_repeating_timer(&timer);
+    PICOTEST_END_SECTION();
+
+    queue_free(&q);
+    return 0;
+}
+
+int main() {
+    stdio_init_all();
+
+    PICOTEST_START();
+    if (test_queue(false)) return -1;
+    if (test_queue(true)) return -1;
+    PICOTEST_END_TEST();
+}
@@ -0,0 +1,168 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Host benchmark of queue_t throughput between a producer thread and a consumer thread, comparing regular
+// (spin lock protected) queues with lock-free single-producer/single-consumer queues, for single element,
+// bulk, and zero-copy (reserve/commit) access
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include "pico/stdlib.h"
+#include "pico/util/queue.h"
+
+#define NUM_ELEMENTS 2000000
+#define QUEUE_LENGTH 64
+#define MAX_ELEMENT_SIZE 16
+#define BATCH_SIZE 16
+
+typedef enum {
+    ACCESS_TRY,
+    ACCESS_BLOCKING,
+    ACCESS_BULK,
+    ACCESS_ZERO_COPY,
+    ACCESS_COUNT
+} access_t;
+
+static const char *access_names[ACCESS_COUNT] = {"try", "blocking", "bulk", "zerocopy"};
+
+typedef struct {
+    queue_t queue;
+    access_t access;
+} bench_t;
+
+static uint64_t wall_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void *producer(void *arg) {
+    bench_t *bench = (bench_t *)arg;
+    uint element_size = bench->queue.element_size;
+    uint8_t elements[BATCH_SIZE * MAX_ELEMENT_SIZE] = {0};
+    uint32_t i = 0;
+    while (i < NUM_ELEMENTS) {
+        uint count = 0;
+        switch (bench->access) {
+            case ACCESS_TRY:
+                memcpy(elements, &i, sizeof(i));
+                count = queue_try_add(&bench->queue, elements);
+                break;
+            case ACCESS_BLOCKING:
+                memcpy(elements, &i, sizeof(i));
+                queue_add_blocking(&bench->queue, elements);
+                count = 1;
+                break;
+            case ACCESS_BULK:
+                count = MIN(BATCH_SIZE, NUM_ELEMENTS - i);
+                for (uint j = 0; j < count; j++) {
+                    uint32_t value = i + j;
+                    memcpy(elements + j * element_size, &value, sizeof(value));
+                }
+                count = queue_try_add_many(&bench->queue, elements, count);
+                break;
+            case ACCESS_ZERO_COPY: {
+                count = MIN(BATCH_SIZE, NUM_ELEMENTS - i);
+                uint8_t *in = (uint8_t *)queue_try_reserve_add(&bench->queue, &count);
+                if (in) {
+                    for (uint j = 0; j < count; j++) {
+                        uint32_t value = i + j;
+                        memcpy(in + j * element_size, &value, sizeof(value));
+                    }
+                    queue_commit_add(&bench->queue, count);
+                } else {
+                    count = 0;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        if (count) {
+            i += count;
+        } else {
+            // yield rather than spin, in case the host has fewer CPUs than threads
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static int run(bool spsc, access_t access, uint element_size) {
+    static bench_t bench;
+    if (spsc) {
+        queue_init_spsc(&bench.queue, element_size, QUEUE_LENGTH);
+    } else {
+        queue_init(&bench.queue, element_size, QUEUE_LENGTH);
+    }
+    bench.access = access;
+    uint errors = 0;
+    uint64_t t0 = wall_time_ns();
+    pthread_t thread;
+    pthread_create(&thread, NULL, producer, &bench);
+    uint8_t elements[BATCH_SIZE * MAX_ELEMENT_SIZE];
+    uint32_t i = 0;
+    while (i < NUM_ELEMENTS) {
+        uint count = 0;
+        const uint8_t *out = elements;
+        switch (access) {
+            case ACCESS_TRY:
+                count = queue_try_remove(&bench.queue, elements);
+                break;
+            case ACCESS_BLOCKING:
+                queue_remove_blocking(&bench.queue, elements);
+                count = 1;
+                break;
+            case ACCESS_BULK:
+                count = queue_try_remove_many(&bench.queue, elements, BATCH_SIZE);
+                break;
+            case ACCESS_ZERO_COPY:
+                count = BATCH_SIZE;
+                out = (const uint8_t *)queue_try_reserve_remove(&bench.queue, &count);
+                if (!out) count = 0;
+                break;
+            default:
+                break;
+        }
+        if (!count) {
+            sched_yield();
+            continue;
+        }
+        for (uint j = 0; j < count; j++) {
+            uint32_t value;
+            memcpy(&value, out + j * element_size, sizeof(value));
+            if (value != i + j) errors++;
+        }
+        if (access == ACCESS_ZERO_COPY) {
+            queue_commit_remove(&bench.queue, count);
+        }
+        i += count;
+    }
+    pthread_join(thread, NULL);
+    uint64_t elapsed_ns = wall_time_ns() - t0;
+    if (!queue_is_empty(&bench.queue)) errors++;
+    queue_free(&bench.queue);
+    printf("%-8s %-9s %6u %10.1f %12.2f %8u\n", spsc ? "spsc" : "spinlock", access_names[access], element_size,
+           (double)elapsed_ns / NUM_ELEMENTS, NUM_ELEMENTS * 1000.0 / (double)elapsed_ns, errors);
+    return errors ? -1 : 0;
+}
+
+int main(void) {
+    static const uint element_sizes[] = {4, 16};
+    int rc = 0;
+    printf("%-8s %-9s %6s %10s %12s %8s\n", "queue", "access", "size", "ns/elem", "Melem/s", "errors");
+    for (uint i = 0; i < count_of(element_sizes); i++) {
+        for (uint access = 0; access < ACCESS_COUNT; access++) {
+            if (run(false, (access_t)access, element_sizes[i])) rc = -1;
+            if (run(true, (access_t)access, element_sizes[i])) rc = -1;
+        }
+    }
+    printf("queue_benchmark: %s\n", rc ? "Failed" : "Success");
+    return rc;
+}
@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/rwlock.h"
+#include "pico/test.h"
+
+PICOTEST_MODULE_NAME("RWLOCK", "reader-writer lock test");
+
+#define TABLE_SIZE 16
+#define STRESS_ITERATIONS 100000
+
+// commands run by core 1, which pushes back the result
+enum {
+    CMD_READ_TRY_ENTER,
+    CMD_READ_EXIT,
+    CMD_WRITE_ENTER_BLOCKING,
+    CMD_WRITE_ENTER_TIMEOUT,
+    CMD_WRITE_EXIT,
+    CMD_STRESS,
+};
+
+static rwlock_t rw;
+static uint32_t table[TABLE_SIZE];
+static uint32_t writes[NUM_CORES];
+static uint errors[NUM_CORES];
+
+// mostly readers checking the table is consistent, with the occasional writer updating it
+static void stress(uint core) {
+    for (uint i = 0; i < STRESS_ITERATIONS; i++) {
+        if (!(i & 15)) {
+            rwlock_write_enter_blocking(&rw);
+            for (uint j = 0; j < TABLE_SIZE; j++) table[j]++;
+            rwlock_write_exit(&rw);
+            writes[core]++;
+        } else {
+            rwlock_read_enter_blocking(&rw);
+            for (uint j = 1; j < TABLE_SIZE; j++) {
+                if (table[j] != table[0]) errors[core]++;
+            }
+            rwlock_read_exit(&rw);
+        }
+    }
+}
+
+static void core1_main(void) {
+    while (true) {
+        uint32_t result = 0;
+        switch (multicore_fifo_pop_blocking()) {
+            case CMD_READ_TRY_ENTER:
+                result = rwlock_read_try_enter(&rw);
+                break;
+            case CMD_READ_EXIT:
+                rwlock_read_exit(&rw);
+                break;
+            case CMD_WRITE_ENTER_BLOCKING:
+                rwlock_write_enter_blocking(&rw);
+                result = true;
+                break;
+            case CMD_WRITE_ENTER_TIMEOUT:
+                result = rwlock_write_enter_timeout_ms(&rw, 10);
+                break;
+            case CMD_WRITE_EXIT:
+                rwlock_write_exit(&rw);
+                break;
+            case CMD_STRESS:
+                stress(1);
+                break;
+        }
+        multicore_fifo_push_blocking(result);
+    }
+}
+
+static uint32_t core1_run(uint32_t cmd) {
+    multicore_fifo_push_blocking(cmd);
+    return multicore_fifo_pop_blocking();
+}
+
+int main() {
+    stdio_init_all();
+    rwlock_init(&rw);
+
+    PICOTEST_START();
+
+    PICOTEST_START_SECTION("try_enter");
+        PICOTEST_CHECK(rwlock_read_try_enter(&rw), "read lock not taken");
+        PICOTEST_CHECK(rwlock_read_try_enter(&rw), "second read lock not taken");
+        PICOTEST_CHECK(!rwlock_write_try_enter(&rw), "write lock taken with readers");
+        rwlock_read_exit(&rw);
+        PICOTEST_CHECK(!rwlock_write_try_enter(&rw), "write lock taken with a reader");
+        rwlock_read_exit(&rw);
+        PICOTEST_CHECK(rwlock_write_try_enter(&rw), "write lock not taken");
+        PICOTEST_CHECK(!rwlock_read_try_enter(&rw), "read lock taken with a writer");
+        PICOTEST_CHECK(!rwlock_write_try_enter(&rw), "second write lock taken");
+        PICOTEST_CHECK(!rwlock_read_enter_timeout_us(&rw, 100), "read lock taken with a writer");
+        PICOTEST_CHECK(!rwlock_write_enter_timeout_us(&rw, 100), "second write lock taken");
+        rwlock_write_exit(&rw);
+        PICOTEST_CHECK(rwlock_read_enter_timeout_us(&rw, 100), "read lock not taken");
+        rwlock_read_exit(&rw);
+    PICOTEST_END_SECTION();
+
+    multicore_launch_core1(core1_main);
+
+    PICOTEST_START_SECTION("readers on both cores");
+        rwlock_read_enter_blocking(&rw);
+        PICOTEST_CHECK(core1_run(CMD_READ_TRY_ENTER), "readers serialized");
+        PICOTEST_CHECK(rw.readers == 2, "wrong number of readers");
+        core1_run(CMD_READ_EXIT);
+        rwlock_read_exit(&rw);
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("writer timeout");
+        rwlock_read_enter_blocking(&rw);
+        PICOTEST_CHECK(!core1_run(CMD_WRITE_ENTER_TIMEOUT), "write lock taken with a reader");
+        PICOTEST_CHECK(!rw.writers_waiting, "timed out writer still waiting");
+        PICOTEST_CHECK(rwlock_read_try_enter(&rw), "readers held off after writer timed out");
+        rwlock_read_exit(&rw);
+        rwlock_read_exit(&rw);
+        PICOTEST_CHECK(core1_run(CMD_WRITE_ENTER_TIMEOUT), "write lock not taken");
+        PICOTEST_CHECK(!rwlock_read_enter_timeout_ms(&rw, 10), "read lock taken with a writer");
+        PICOTEST_CHECK(!rwlock_write_enter_timeout_ms(&rw, 10), "second write lock taken");
+        core1_run(CMD_WRITE_EXIT);
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("writer preference");
+        rwlock_read_enter_blocking(&rw);
+        multicore_fifo_push_blocking(CMD_WRITE_ENTER_BLOCKING);
+        while (!*(volatile uint16_t *)&rw.writers_waiting) {
+            tight_loop_contents();
+        }
+        PICOTEST_CHECK(!rwlock_read_try_enter(&rw), "read lock taken with a writer waiting");
+        rwlock_read_exit(&rw);
+        PICOTEST_CHECK(multicore_fifo_pop_blocking(), "waiting writer not woken");
+        PICOTEST_CHECK(!rwlock_read_enter_timeout_ms(&rw, 10), "read lock taken with a writer");
+        core1_run(CMD_WRITE_EXIT);
+        PICOTEST_CHECK(rwlock_read_enter_timeout_ms(&rw, 100), "reader not woken");
+        rwlock_read_exit(&rw);
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("stress");
+        multicore_fifo_push_blocking(CMD_STRESS);
+        stress(0);
+        multicore_fifo_pop_blocking();
+        PICOTEST_CHECK(!errors[0] && !errors[1], "readers saw a partial write");
+        PICOTEST_CHECK(table[0] == writes[0] + writes[1], "writes lost");
+        PICOTEST_CHECK(!rw.readers && !lock_is_owner_id_valid(rw.writer) && !rw.writers_waiting, "lock not released");
+    PICOTEST_END_SECTION();
+
+    multicore_reset_core1();
+
+    PICOTEST_END_TEST();
+}
@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/seqlock.h"
+#include "pico/test.h"
+
+PICOTEST_MODULE_NAME("SEQLOCK", "sequence lock test");
+
+#define NUM_WRITES 200000
+
+typedef struct {
+    uint32_t count;
+    uint32_t inverse;
+    uint32_t values[8];
+} snapshot_t;
+
+static seqlock_t sl;
+static snapshot_t shared;
+
+static volatile uint timer_reads;
+static volatile uint timer_errors;
+
+static void make_snapshot(snapshot_t *s, uint32_t count) {
+    s->count = count;
+    s->inverse = ~count;
+    for (uint i = 0; i < count_of(s->values); i++) s->values[i] = count * (i + 1);
+}
+
+static bool snapshot_valid(const snapshot_t *s) {
+    if (s->inverse != ~s->count) return false;
+    for (uint i = 0; i < count_of(s->values); i++) {
+        if (s->values[i] != s->count * (i + 1)) return false;
+    }
+    return true;
+}
+
+static void writer(uint32_t first) {
+    snapshot_t s;
+    for (uint32_t count = first; count < first + NUM_WRITES; count++) {
+        make_snapshot(&s, count);
+        seqlock_write(&sl, &shared, &s, sizeof(s));
+    }
+}
+
+static void core1_main(void) {
+    writer(multicore_fifo_pop_blocking());
+    multicore_fifo_push_blocking(0);
+}
+
+static bool timer_callback(__unused repeating_timer_t *rt) {
+    snapshot_t s;
+    seqlock_read(&sl, &s, &shared, sizeof(s));
+    if (!snapshot_valid(&s)) timer_errors++;
+    timer_reads++;
+    return true;
+}
+
+int main() {
+    stdio_init_all();
+    seqlock_init(&sl);
+    snapshot_t s;
+    make_snapshot(&shared, 0);
+
+    PICOTEST_START();
+
+    PICOTEST_START_SECTION("read and write");
+        uint32_t seq = sl.sequence;
+        make_snapshot(&s, 1);
+        seqlock_write(&sl, &shared, &s, sizeof(s));
+        PICOTEST_CHECK(sl.sequence == seq + 2, "sequence not advanced by a write");
+        snapshot_t r;
+        PICOTEST_CHECK(!seqlock_read(&sl, &r, &shared, sizeof(r)), "read retried with no writer");
+        PICOTEST_CHECK(r.count == 1 && snapshot_valid(&r), "wrong snapshot read");
+        seq = seqlock_read_begin(&sl);
+        PICOTEST_CHECK(!seqlock_read_retry(&sl, seq), "retry with no writer");
+        uint32_t save = seqlock_write_begin(&sl);
+        shared.count = 2;
+        seqlock_write_end(&sl, save);
+        PICOTEST_CHECK(seqlock_read_retry(&sl, seq), "no retry after a write");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("reader with a writer on the other core");
+        make_snapshot(&shared, 0);
+        multicore_launch_core1(core1_main);
+        multicore_fifo_push_blocking(1);
+        uint reads = 0, retries = 0, errors = 0;
+        uint32_t last = 0;
+        do {
+            retries += seqlock_read(&sl, &s, &shared, sizeof(s));
+            if (!snapshot_valid(&s) || s.count < last) errors++;
+            last = s.count;
+            reads++;
+        } while (!multicore_fifo_rvalid());
+        multicore_fifo_pop_blocking();
+        multicore_reset_core1();
+        printf("%u reads, %u retries\n", reads, retries);
+        PICOTEST_CHECK(!errors, "inconsistent snapshot read");
+        PICOTEST_CHECK(shared.count == NUM_WRITES, "wrong final snapshot");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("reader in a timer callback");
+        repeating_timer_t timer;
+        add_repeating_timer_us(-50, timer_callback, NULL, &timer);
+        writer(NUM_WRITES);
+        while (!timer_reads) tight_loop_contents();
+        cancel_repeating_timer(&timer);
+        PICOTEST_CHECK(!timer_errors, "inconsistent snapshot read in timer callback");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_END_TEST();
+}
@@ -0,0 +1,200 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef PICO_STDIO_LOG_DECODER
+#include <unistd.h>
+#endif
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/stdio_log.h"
+#include "pico/test.h"
+
+PICOTEST_MODULE_NAME("STDIO_LOG", "deferred binary logging test");
+
+#define CORE1_RECORDS 20
+
+static uint8_t stream[PICO_STDIO_LOG_BUFFER_WORDS * 4 * NUM_CORES];
+
+static uint32_t stream_word(uint pos) {
+    uint32_t word;
+    memcpy(&word, stream + pos, 4);
+    return word;
+}
+
+static uint record_arg_words(uint pos) {
+    return stream_word(pos) & 0xffu;
+}
+
+static uint record_words(uint pos) {
+    return PICO_STDIO_LOG_RECORD_HEADER_WORDS + record_arg_words(pos);
+}
+
+static void core1_main(void) {
+    for (uint i = 0; i < CORE1_RECORDS; i++) {
+        PICO_LOG("core 1 record %u\n", i);
+        busy_wait_us(10);
+    }
+    multicore_fifo_push_blocking(0);
+}
+
+#ifdef PICO_STDIO_LOG_DECODER
+// runs the decoder on this executable and the given stream; returns the decoded text, or NULL if python (or the
+// executable) can't be found
+static char *decode(const uint8_t *data, uint len) {
+    static char text[1024];
+    if (system("python3 --version > /dev/null 2>&1")) return NULL;
+    FILE *f = fopen("pico_stdio_log_test.bin", "wb");
+    fwrite(data, 1, len, f);
+    fclose(f);
+    char exe[256], command[512];
+    ssize_t exe_len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (exe_len < 0) return NULL;
+    exe[exe_len] = 0;
+    snprintf(command, sizeof(command), "python3 %s --no-timestamps %s pico_stdio_log_test.bin", PICO_STDIO_LOG_DECODER, exe);
+    f = popen(command, "r");
+    size_t n = fread(text, 1, sizeof(text) - 1, f);
+    text[n] = 0;
+    pclose(f);
+    remove("pico_stdio_log_test.bin");
+    return text;
+}
+#endif
+
+int main() {
+    stdio_init_all();
+
+    PICOTEST_START();
+
+    PICOTEST_START_SECTION("record encoding");
+        PICOTEST_CHECK(stdio_log_read(stream, sizeof(stream)) == 0, "read from empty log");
+        uint32_t start = time_us_32();
+        PICOTEST_CHECK(PICO_LOG("no arguments\n"), "record not written");
+        PICOTEST_CHECK(PICO_LOG("int %d unsigned %u\n", -5, 7u), "record not written");
+        char c = 'x';
+        short s = -2;
+        PICOTEST_CHECK(PICO_LOG("%c %hd %llu %f %f\n", c, s, 0x123456789ull, 1.5f, 2.25), "record not written");
+        uint len = stdio_log_read(stream, sizeof(stream));
+        PICOTEST_CHECK_AND_ABORT(len == 4 * (3 * PICO_STDIO_LOG_RECORD_HEADER_WORDS + 2 + 1 + 1 + 2 + 2 + 2), "wrong stream length");
+        uint pos = 0;
+        static const uint expected_arg_words[] = {0, 2, 8};
+        for (uint i = 0; i < count_of(expected_arg_words); i++) {
+            uint32_t header = stream_word(pos);
+            PICOTEST_CHECK(header >> 24 == PICO_STDIO_LOG_RECORD_MAGIC, "wrong record magic");
+            PICOTEST_CHECK(((header >> 12) & 0xfu) == get_core_num(), "wrong core");
+            PICOTEST_CHECK(((header >> 16) & 0xffu) == 0, "records reported dropped");
+            PICOTEST_CHECK(record_arg_words(pos) == expected_arg_words[i], "wrong argument word count");
+            PICOTEST_CHECK((int32_t)(stream_word(pos + 8) - start) >= 0, "wrong timestamp");
+            pos += record_words(pos) * 4;
+        }
+        // the second record follows the first's header, and the third the second's two argument words
+        PICOTEST_CHECK((int32_t)stream_word(12 + 12) == -5 && stream_word(12 + 16) == 7, "wrong int arguments");
+        pos = 12 + 20;
+        PICOTEST_CHECK(stream_word(pos + 12) == 'x' && (int32_t)stream_word(pos + 16) == -2, "wrong promoted arguments");
+        uint64_t u64;
+        double d;
+        memcpy(&u64, stream + pos + 20, 8);
+        PICOTEST_CHECK(u64 == 0x123456789ull, "wrong 64-bit argument");
+        memcpy(&d, stream + pos + 28, 8);
+        PICOTEST_CHECK(d == 1.5, "wrong float argument");
+        memcpy(&d, stream + pos + 36, 8);
+        PICOTEST_CHECK(d == 2.25, "wrong double argument");
+#if !PICO_ON_DEVICE
+        // the format strings are only loaded on the host
+        PICOTEST_CHECK(!strcmp(__start_pico_log_fmt + stream_word(4), "no arguments\n"), "wrong format id");
+        PICOTEST_CHECK(!strcmp(__start_pico_log_fmt + stream_word(12 + 4), "int %d unsigned %u\n"), "wrong format id");
+#endif
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("partial reads");
+        for (uint i = 0; i < 3; i++) {
+            PICO_LOG("record %u\n", i);
+        }
+        uint record_len = (PICO_STDIO_LOG_RECORD_HEADER_WORDS + 1) * 4;
+        PICOTEST_CHECK(stdio_log_read(stream, record_len - 1) == 0, "read a partial record");
+        PICOTEST_CHECK(stdio_log_read(stream, record_len * 2 + 1) == record_len * 2, "didn't read whole records");
+        PICOTEST_CHECK(stream_word(12) == 0 && stream_word(record_len + 12) == 1, "wrong records read");
+        PICOTEST_CHECK(stdio_log_read(stream, sizeof(stream)) == record_len && stream_word(12) == 2, "wrong last record");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("overflow");
+        uint32_t dropped = stdio_log_get_dropped_count();
+        uint written = 0;
+        while (PICO_LOG("fill %u %u %u\n", written, 0u, 0u)) written++;
+        PICOTEST_CHECK(written == PICO_STDIO_LOG_BUFFER_WORDS / (PICO_STDIO_LOG_RECORD_HEADER_WORDS + 3), "wrong number of records fit");
+        PICOTEST_CHECK(!PICO_LOG("dropped %u %u %u\n", 0u, 0u, 0u), "record written to full log");
+        PICOTEST_CHECK(stdio_log_get_dropped_count() == dropped + 2, "wrong dropped count");
+        // make room for one more record, which should report the drops
+        uint record_len = (PICO_STDIO_LOG_RECORD_HEADER_WORDS + 3) * 4;
+        PICOTEST_CHECK(stdio_log_read(stream, record_len) == record_len, "failed to read record");
+        PICOTEST_CHECK(PICO_LOG("after %u\n", written), "record not written");
+        uint len = stdio_log_read(stream, sizeof(stream));
+        PICOTEST_CHECK(len == (written - 1) * record_len + (PICO_STDIO_LOG_RECORD_HEADER_WORDS + 1) * 4, "wrong stream length");
+        uint32_t header = stream_word(len - (PICO_STDIO_LOG_RECORD_HEADER_WORDS + 1) * 4);
+        PICOTEST_CHECK(((header >> 16) & 0xffu) == 2, "drops not reported in the next record");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("multicore");
+        multicore_launch_core1(core1_main);
+        for (uint i = 0; i < CORE1_RECORDS; i++) {
+            PICO_LOG("core 0 record %u\n", i);
+            busy_wait_us(10);
+        }
+        multicore_fifo_pop_blocking();
+        multicore_reset_core1();
+        uint len = stdio_log_read(stream, sizeof(stream));
+        PICOTEST_CHECK(len == CORE1_RECORDS * 2 * (PICO_STDIO_LOG_RECORD_HEADER_WORDS + 1) * 4, "wrong stream length");
+        uint next[NUM_CORES] = {0};
+        uint32_t last_time = stream_word(8);
+        for (uint pos = 0; pos < len; pos += record_words(pos) * 4) {
+            uint core = (stream_word(pos) >> 12) & 0xfu;
+            PICOTEST_CHECK_AND_ABORT(core < NUM_CORES, "invalid core");
+            PICOTEST_CHECK(stream_word(pos + 12) == next[core]++, "records out of order");
+            PICOTEST_CHECK((int32_t)(stream_word(pos + 8) - last_time) >= 0, "records not in timestamp order");
+            last_time = stream_word(pos + 8);
+        }
+        PICOTEST_CHECK(next[0] == CORE1_RECORDS && next[1] == CORE1_RECORDS, "missing records");
+    PICOTEST_END_SECTION();
+
+#ifdef PICO_STDIO_LOG_DECODER
+    PICOTEST_START_SECTION("decoder");
+        static const char *str = "a string";
+        PICO_LOG("plain\n");
+        PICO_LOG("%d %5u %-4x| %08X %o %#x\n", -42, 17u, 0xabu, 0xdeadbeefu, 8u, 255u);
+        PICO_LOG("%c%c %hhd %hd %ld %lld %llu\n", 'o', 'k', (char)-1, (short)-300, -100000l, -5000000000ll, 18000000000000000000ull);
+        PICO_LOG("%.3f %8.2f %e %g\n", 3.14159, -2.5f, 12345.678, 0.0001);
+        PICO_LOG("%*d|%-*d|%.*f\n", 5, 42, 4, 7, 2, 1.005);
+        PICO_LOG("%s %zu %%\n", str, sizeof(int));
+        char expected[512];
+        snprintf(expected, sizeof(expected),
+                 "plain\n"
+                 "%d %5u %-4x| %08X %o %#x\n"
+                 "%c%c %hhd %hd %ld %lld %llu\n"
+                 "%.3f %8.2f %e %g\n"
+                 "%*d|%-*d|%.*f\n"
+                 "<string@0x%" PRIxPTR "> %zu %%\n",
+                 -42, 17u, 0xabu, 0xdeadbeefu, 8u, 255u,
+                 'o', 'k', (char)-1, (short)-300, -100000l, -5000000000ll, 18000000000000000000ull,
+                 3.14159, -2.5f, 12345.678, 0.0001,
+                 5, 42, 4, 7, 2, 1.005,
+                 (uintptr_t)str, sizeof(int));
+        uint len = stdio_log_read(stream, sizeof(stream));
+        const char *text = decode(stream, len);
+        if (text) {
+            PICOTEST_CHECK(!strcmp(text, expected), "wrong decoded text");
+            if (strcmp(text, expected)) printf("decoded:\n%s\nexpected:\n%s\n", text, expected);
+        } else {
+            printf("python3 not found; skipping decoder test\n");
+        }
+    PICOTEST_END_SECTION();
+#endif
+
+    PICOTEST_END_TEST();
+}
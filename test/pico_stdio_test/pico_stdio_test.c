@@ -8,6 +8,10 @@
 #include "pico/stdlib.h"
 #include "pico/multicore.h"
 #include "pico/test.h"
+#if PICO_STDIO_BUFFERED_OUTPUT
+#include "pico/async_context_threadsafe_background.h"
+#include "pico/async_context_poll.h"
+#endif
 
 PICOTEST_MODULE_NAME("pico_stdio_test", "pico_stdio test harness");
 
@@ -52,6 +56,80 @@ int main() {
     PICOTEST_CHECK(deadlock_test_irq_called, "deadlock_test_irq was not called");
     PICOTEST_END_SECTION();
 
+    PICOTEST_START_SECTION("STDIO input test");
+    absolute_time_t t0 = get_absolute_time();
+    PICOTEST_CHECK(getchar_timeout_us(100000) == PICO_ERROR_TIMEOUT, "someone pressed a key!");
+    PICOTEST_CHECK(absolute_time_diff_us(t0, get_absolute_time()) >= 100000, "input wait returned early");
+    char input[16];
+    PICOTEST_CHECK(stdio_get_available(input, sizeof(input)) == PICO_ERROR_NO_DATA, "someone pressed a key!");
+    PICOTEST_END_SECTION();
+
+#if PICO_STDIO_BUFFERED_OUTPUT
+    PICOTEST_START_SECTION("STDIO buffered output test");
+    static async_context_threadsafe_background_t context;
+    async_context_threadsafe_background_config_t config = async_context_threadsafe_background_default_config();
+    PICOTEST_CHECK_AND_ABORT(async_context_threadsafe_background_init(&context, &config), "failed to init async_context");
+    PICOTEST_CHECK_AND_ABORT(stdio_set_buffered_output(&context.core), "failed to enable buffered output");
+
+    // this would take several milliseconds to write to the UART
+    absolute_time_t start = get_absolute_time();
+    for (int i = 0; i < 10; i++) {
+        printf("Buffered line %d\n", i);
+    }
+    PICOTEST_CHECK(absolute_time_diff_us(start, get_absolute_time()) < 1000, "buffered printf waited for output");
+    stdio_flush();
+
+    // the drain worker runs from an IRQ on this core, so can't run while interrupts are disabled
+    stdio_output_stats_t before, after;
+    stdio_get_output_stats(&before);
+    stdio_set_output_overflow(STDIO_OUTPUT_OVERFLOW_DROP);
+    uint32_t save = save_and_disable_interrupts();
+    for (int i = 0; i < PICO_STDIO_OUTPUT_BUFFER_SIZE + 100; i++) {
+        putchar('.');
+    }
+    restore_interrupts(save);
+    stdio_get_output_stats(&after);
+    PICOTEST_CHECK(after.dropped == before.dropped + 100, "wrong number of characters dropped");
+    stdio_flush();
+
+    stdio_set_output_overflow(STDIO_OUTPUT_OVERFLOW_OVERWRITE);
+    save = save_and_disable_interrupts();
+    for (int i = 0; i < PICO_STDIO_OUTPUT_BUFFER_SIZE + 100; i++) {
+        putchar('*');
+    }
+    restore_interrupts(save);
+    stdio_flush();
+    stdio_get_output_stats(&after);
+    PICOTEST_CHECK(after.overwritten == before.overwritten + 100, "wrong number of characters overwritten");
+    printf("\n");
+
+    PICOTEST_CHECK(stdio_set_buffered_output(NULL), "failed to disable buffered output");
+    async_context_deinit(&context.core);
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("STDIO buffered output with a polled context");
+    static async_context_poll_t poll_context;
+    PICOTEST_CHECK_AND_ABORT(async_context_poll_init_with_defaults(&poll_context), "failed to init async_context");
+    PICOTEST_CHECK_AND_ABORT(stdio_set_buffered_output(&poll_context.core), "failed to enable buffered output");
+    stdio_output_stats_t before, after;
+    stdio_get_output_stats(&before);
+    // nothing polls the context here, so flushing (and waiting for space in the buffer) must poll it
+    stdio_set_output_overflow(STDIO_OUTPUT_OVERFLOW_BLOCK);
+    absolute_time_t start = get_absolute_time();
+    for (int i = 0; i < PICO_STDIO_OUTPUT_BUFFER_SIZE + 100; i++) {
+        putchar('-');
+    }
+    printf("\n");
+    stdio_flush();
+    PICOTEST_CHECK(absolute_time_diff_us(start, get_absolute_time()) < PICO_STDIO_DEADLOCK_TIMEOUT_MS * 500,
+                   "waited for the deadlock timeout");
+    stdio_get_output_stats(&after);
+    PICOTEST_CHECK(after.dropped == before.dropped && after.overwritten == before.overwritten, "output lost");
+    PICOTEST_CHECK(stdio_set_buffered_output(NULL), "failed to disable buffered output");
+    async_context_deinit(&poll_context.core);
+    PICOTEST_END_SECTION();
+#endif
+
     PICOTEST_END_TEST();
 }
 
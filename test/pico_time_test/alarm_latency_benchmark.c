@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Host benchmark of alarm callback latency (the time from an alarm's target to its callback being called)
+// for alarm pools driven by the host timer thread, reported as a distribution
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "pico/stdlib.h"
+
+#define RUN_TIME_US 2000000
+#define MAX_SAMPLES 200000
+
+typedef struct {
+    repeating_timer_t rt;
+    int64_t expected_us;
+} latency_timer_t;
+
+static uint32_t latencies[MAX_SAMPLES];
+static volatile uint num_samples;
+static uint early_count;
+
+static bool latency_timer_callback(repeating_timer_t *rt) {
+    latency_timer_t *lt = (latency_timer_t *)rt->user_data;
+    int64_t latency = (int64_t)time_us_64() - lt->expected_us;
+    if (latency < 0) {
+        early_count++;
+    } else if (num_samples < MAX_SAMPLES) {
+        latencies[num_samples++] = (uint32_t)latency;
+    }
+    // negative delay means the period is relative to the previous target
+    lt->expected_us += -rt->delay_us;
+    return true;
+}
+
+static int compare_uint32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int run_pool(const char *name, alarm_pool_t *pool, uint num_timers) {
+    latency_timer_t *timers = (latency_timer_t *)calloc(num_timers, sizeof(latency_timer_t));
+    num_samples = early_count = 0;
+    srand(num_timers);
+    for (uint i = 0; i < num_timers; i++) {
+        int64_t period_us = 200 + rand() % 5000;
+        timers[i].expected_us = (int64_t)time_us_64() + period_us;
+        if (!alarm_pool_add_repeating_timer_us(pool, -period_us, latency_timer_callback, &timers[i], &timers[i].rt)) {
+            printf("failed to add timer %u\n", i);
+            return -1;
+        }
+    }
+    sleep_us(RUN_TIME_US);
+    for (uint i = 0; i < num_timers; i++) {
+        cancel_repeating_timer(&timers[i].rt);
+    }
+    free(timers);
+
+    uint n = num_samples;
+    if (!n) {
+        printf("%-6s %6u: no callbacks\n", name, num_timers);
+        return -1;
+    }
+    qsort(latencies, n, sizeof(latencies[0]), compare_uint32);
+    printf("%-6s %6u %8u %8u %8u %8u %8u %8u\n", name, num_timers, n, latencies[n / 2], latencies[n * 9 / 10],
+           latencies[n * 99 / 100], latencies[n - 1], early_count);
+    return early_count ? -1 : 0;
+}
+
+int main(void) {
+    static const uint pool_sizes[] = {1, 16, 128};
+    int rc = 0;
+    printf("latencies in us\n");
+    printf("%-6s %6s %8s %8s %8s %8s %8s %8s\n", "pool", "timers", "samples", "p50", "p90", "p99", "max", "early");
+    alarm_pool_t *heap_pool = alarm_pool_create_with_unused_hardware_alarm(256);
+    for (uint i = 0; i < count_of(pool_sizes); i++) {
+        if (run_pool("heap", heap_pool, pool_sizes[i])) rc = -1;
+    }
+    alarm_pool_destroy(heap_pool);
+    // note timer wheel latencies include up to a tick (here 100us) of rounding up to the next tick boundary
+    alarm_pool_t *wheel_pool = alarm_pool_create_timer_wheel_with_unused_hardware_alarm(256, 100);
+    for (uint i = 0; i < count_of(pool_sizes); i++) {
+        if (run_pool("wheel", wheel_pool, pool_sizes[i])) rc = -1;
+    }
+    alarm_pool_destroy(wheel_pool);
+    printf("alarm_latency_benchmark: %s\n", rc ? "Failed" : "Success");
+    return rc;
+}
@@ -0,0 +1,126 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Host benchmark of the alarm pool IRQ handler cost versus the number of live alarms in the pool, for
+// both regular and timer wheel alarm pools.
+//
+// The time adapter is replaced with a simulated timer, so that time only advances when the benchmark
+// "fires" the alarm IRQ; this makes the fire times exactly checkable, and means the measured time is
+// just the cost of the handler itself.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "pico/stdlib.h"
+#include "sim_timer.h"
+
+#define WHEEL_TICK_US 100
+
+static uint64_t wall_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+typedef struct {
+    repeating_timer_t rt;
+    int64_t expected_us;
+    uint32_t fire_count;
+} bench_timer_t;
+
+static uint32_t total_fires;
+static uint32_t timing_errors;
+static uint64_t last_fire_us;
+static uint32_t fire_tolerance_us;
+
+static bool bench_timer_callback(repeating_timer_t *rt) {
+    bench_timer_t *bt = (bench_timer_t *)rt->user_data;
+    int64_t late = (int64_t)sim_time_us - bt->expected_us;
+    if (late < 0 || late > fire_tolerance_us || sim_time_us < last_fire_us) timing_errors++;
+    last_fire_us = sim_time_us;
+    bt->expected_us += -rt->delay_us;
+    bt->fire_count++;
+    total_fires++;
+    return true;
+}
+
+static int64_t one_shot_callback(__unused alarm_id_t id, __unused void *user_data) {
+    return 0;
+}
+
+static int run_pool_size(uint num_timers, uint num_fires, uint32_t wheel_tick_us) {
+    sim_time_us = 1000;
+    alarm_pool_t *pool;
+    if (wheel_tick_us) {
+        pool = alarm_pool_create_timer_wheel_on_timer(&sim_timer_instance, 0, num_timers + 1, wheel_tick_us);
+        // alarms fire on the first tick boundary at or after their target time
+        fire_tolerance_us = wheel_tick_us - 1;
+    } else {
+        pool = alarm_pool_create_on_timer(&sim_timer_instance, 0, num_timers + 1);
+        fire_tolerance_us = 0;
+    }
+    bench_timer_t *timers = (bench_timer_t *)calloc(num_timers, sizeof(bench_timer_t));
+    srand(num_timers);
+    for (uint i = 0; i < num_timers; i++) {
+        // negative delay means the period is relative to the previous target, so fire times are exact
+        int64_t period_us = 1000 + rand() % 10000;
+        timers[i].expected_us = (int64_t)sim_time_us + period_us;
+        if (!alarm_pool_add_repeating_timer_us(pool, -period_us, bench_timer_callback, &timers[i], &timers[i].rt)) {
+            printf("failed to add timer %u\n", i);
+            return -1;
+        }
+    }
+    // the adds all forced the IRQ, but we only need to take it once
+    sim_irq();
+
+    total_fires = timing_errors = 0;
+    last_fire_us = 0;
+    uint irq_count = sim_irq_count;
+    uint64_t t0 = wall_time_ns();
+    while (total_fires < num_fires) {
+        sim_time_us = (uint64_t)sim_target;
+        sim_irq();
+    }
+    uint64_t fire_ns = wall_time_ns() - t0;
+    irq_count = sim_irq_count - irq_count;
+
+    // now measure the cost of adding and canceling a one shot alarm (including the IRQ to process each)
+    uint num_add_cancel = 10000;
+    t0 = wall_time_ns();
+    for (uint i = 0; i < num_add_cancel; i++) {
+        alarm_id_t id = alarm_pool_add_alarm_in_us(pool, 500 + (i * 7919) % 20000, one_shot_callback, NULL, true);
+        sim_irq();
+        alarm_pool_cancel_alarm(pool, id);
+        sim_irq();
+    }
+    uint64_t add_cancel_ns = wall_time_ns() - t0;
+
+    for (uint i = 0; i < num_timers; i++) {
+        cancel_repeating_timer(&timers[i].rt);
+    }
+    sim_irq();
+    alarm_pool_destroy(pool);
+    free(timers);
+
+    printf("%-6s %8u %10u %10.2f %10.1f %14.1f %8u\n", wheel_tick_us ? "wheel" : "heap", num_timers, irq_count,
+           (double)total_fires / irq_count, (double)fire_ns / total_fires, (double)add_cancel_ns / num_add_cancel,
+           timing_errors);
+    return timing_errors ? -1 : 0;
+}
+
+int main(void) {
+    static const uint pool_sizes[] = {4, 16, 64, 256, 1024, 4096, 16384};
+    int rc = 0;
+    printf("%-6s %8s %10s %10s %10s %14s %8s\n", "pool", "alarms", "irqs", "fires/irq", "ns/fire", "ns/add_cancel", "errors");
+    for (uint i = 0; i < count_of(pool_sizes); i++) {
+        if (run_pool_size(pool_sizes[i], 200000, 0)) rc = -1;
+    }
+    for (uint i = 0; i < count_of(pool_sizes); i++) {
+        if (run_pool_size(pool_sizes[i], 200000, WHEEL_TICK_US)) rc = -1;
+    }
+    printf("alarm_pool_benchmark: %s\n", rc ? "Failed" : "Success");
+    return rc;
+}
@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "sim_timer.h"
+#include "pico/time_adapter.h"
+
+uint64_t sim_time_us;
+int64_t sim_target = INT64_MAX;
+bool sim_force_pending;
+uint sim_irq_count;
+uint sim_timer_instance;
+static void (*sim_irq_handler)(void);
+
+uint64_t time_us_64(void) {
+    return sim_time_us;
+}
+
+void ta_clear_force_irq(__unused alarm_pool_timer_t *timer, __unused uint hardware_alarm_num) {
+    sim_force_pending = false;
+}
+
+void ta_clear_irq(__unused alarm_pool_timer_t *timer, __unused uint hardware_alarm_num) {
+}
+
+void ta_force_irq(__unused alarm_pool_timer_t *timer, __unused uint hardware_alarm_num) {
+    sim_force_pending = true;
+}
+
+void ta_set_timeout(__unused alarm_pool_timer_t *timer, __unused uint hardware_alarm_num, int64_t target) {
+    sim_target = target;
+}
+
+bool ta_wakes_up_on_or_before(__unused alarm_pool_timer_t *timer, __unused uint alarm_num, int64_t target) {
+    return sim_target <= target;
+}
+
+void ta_enable_irq_handler(__unused alarm_pool_timer_t *timer, __unused uint hardware_alarm_num, void (*irq_handler)(void)) {
+    sim_irq_handler = irq_handler;
+}
+
+void ta_disable_irq_handler(__unused alarm_pool_timer_t *timer, __unused uint hardware_alarm_num, __unused void (*irq_handler)(void)) {
+    sim_irq_handler = NULL;
+    sim_target = INT64_MAX;
+    sim_force_pending = false;
+}
+
+void ta_hardware_alarm_claim(__unused alarm_pool_timer_t *timer, __unused uint hardware_alarm_num) {
+}
+
+int ta_hardware_alarm_claim_unused(__unused alarm_pool_timer_t *timer, __unused bool required) {
+    return 0;
+}
+
+alarm_pool_timer_t *ta_from_current_irq(uint *alarm_num) {
+    *alarm_num = 0;
+    return &sim_timer_instance;
+}
+
+uint ta_timer_num(__unused alarm_pool_timer_t *timer) {
+    return 0;
+}
+
+alarm_pool_timer_t *ta_timer_instance(__unused uint instance_num) {
+    return &sim_timer_instance;
+}
+
+alarm_pool_timer_t *ta_default_timer_instance(void) {
+    return &sim_timer_instance;
+}
+
+void sim_irq(void) {
+    sim_target = INT64_MAX;
+    sim_irq_count++;
+    sim_irq_handler();
+}
+
+void sim_advance_to(uint64_t time_us) {
+    while (true) {
+        if (sim_force_pending) {
+            sim_irq();
+        } else if (sim_target <= (int64_t)time_us) {
+            if ((int64_t)sim_time_us < sim_target) sim_time_us = (uint64_t)sim_target;
+            sim_irq();
+        } else {
+            break;
+        }
+    }
+    sim_time_us = time_us;
+}
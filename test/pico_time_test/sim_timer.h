@@ -0,0 +1,29 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _SIM_TIMER_H
+#define _SIM_TIMER_H
+
+// A simulated replacement for the host time adapter (and time_us_64), for host only alarm pool tests
+// and benchmarks. Time only advances when the test says so, and the alarm IRQ handler is called
+// synchronously, so results are exactly reproducible.
+
+#include "pico/time.h"
+
+extern uint64_t sim_time_us;
+// the time the (one shot) simulated timer alarm is set for, or INT64_MAX if not set
+extern int64_t sim_target;
+extern bool sim_force_pending;
+extern uint sim_irq_count;
+extern uint sim_timer_instance;
+
+// call the alarm IRQ handler as the hardware would (the alarm is one shot, so it is disarmed first)
+void sim_irq(void);
+
+// advance time to the given time, taking IRQs along the way when they are due
+void sim_advance_to(uint64_t time_us);
+
+#endif
@@ -0,0 +1,171 @@
+/**
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Host test of timer wheel alarm pools, driven by a simulated timer
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "pico/stdlib.h"
+#include "pico/test.h"
+#include "sim_timer.h"
+
+PICOTEST_MODULE_NAME("pico_time_timer_wheel_test", "timer wheel alarm pool test harness");
+
+#define TICK_US 1000
+#define MAX_ALARMS 1000
+
+static struct test_alarm {
+    int64_t target;
+    uint64_t fired_at;
+    uint fired_count;
+    uint fired_irq;
+} alarms[MAX_ALARMS];
+
+static int64_t alarm_callback(__unused alarm_id_t id, void *user_data) {
+    struct test_alarm *alarm = (struct test_alarm *)user_data;
+    alarm->fired_at = sim_time_us;
+    alarm->fired_irq = sim_irq_count;
+    alarm->fired_count++;
+    return 0;
+}
+
+static int64_t tick_ceil(int64_t base, int64_t t) {
+    return base + ((t - base + TICK_US - 1) / TICK_US) * TICK_US;
+}
+
+static alarm_id_t add_test_alarm(alarm_pool_t *pool, struct test_alarm *alarm, int64_t target) {
+    alarm->target = target;
+    alarm->fired_count = 0;
+    absolute_time_t t;
+    update_us_since_boot(&t, (uint64_t)target);
+    return alarm_pool_add_alarm_at(pool, t, alarm_callback, alarm, true);
+}
+
+typedef struct {
+    repeating_timer_t rt;
+    int64_t expected;
+    uint fired_count;
+    uint errors;
+} test_repeating_timer_t;
+
+static bool repeating_callback(repeating_timer_t *rt) {
+    test_repeating_timer_t *trt = (test_repeating_timer_t *)rt->user_data;
+    int64_t late = (int64_t)sim_time_us - trt->expected;
+    if (late < 0 || late >= TICK_US) trt->errors++;
+    trt->expected -= rt->delay_us;
+    trt->fired_count++;
+    return true;
+}
+
+int main(void) {
+    PICOTEST_START();
+
+    sim_time_us = 123456;
+    alarm_pool_t *pool = alarm_pool_create_timer_wheel_on_timer(&sim_timer_instance, 0, MAX_ALARMS, TICK_US);
+    int64_t base = (int64_t)sim_time_us;
+    PICOTEST_CHECK_AND_ABORT(alarm_pool_timer_wheel_tick_us(pool) == TICK_US, "Wrong tick");
+
+    PICOTEST_START_SECTION("Alarm fires on the first tick at or after its target");
+        int64_t target = base + 2500;
+        alarm_id_t id = add_test_alarm(pool, &alarms[0], target);
+        PICOTEST_CHECK(id > 0, "Failed to add alarm");
+        sim_advance_to((uint64_t)tick_ceil(base, target) - 1);
+        PICOTEST_CHECK(!alarms[0].fired_count, "Alarm fired early");
+        PICOTEST_CHECK(alarm_pool_remaining_alarm_time_us(pool, id) == target - (int64_t)sim_time_us, "Wrong remaining time");
+        sim_advance_to((uint64_t)tick_ceil(base, target));
+        PICOTEST_CHECK(alarms[0].fired_count == 1, "Alarm did not fire");
+        PICOTEST_CHECK((int64_t)alarms[0].fired_at == tick_ceil(base, target), "Alarm fired at wrong time");
+        PICOTEST_CHECK(!alarm_pool_cancel_alarm(pool, id), "Canceling a fired alarm should fail");
+        PICOTEST_CHECK(alarm_pool_remaining_alarm_time_us(pool, id) < 0, "Fired alarm should have no remaining time");
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("Alarms due in the same tick fire from one IRQ");
+        base = tick_ceil(base, (int64_t)sim_time_us);
+        for (uint i = 0; i < 50; i++) {
+            add_test_alarm(pool, &alarms[i], base + 10 * TICK_US + 1 + i * (TICK_US / 50));
+        }
+        sim_advance_to((uint64_t)(base + 12 * TICK_US));
+        for (uint i = 0; i < 50; i++) {
+            PICOTEST_CHECK(alarms[i].fired_count == 1, "Alarm did not fire");
+            PICOTEST_CHECK(alarms[i].fired_irq == alarms[0].fired_irq, "Alarms in the same tick fired in different IRQs");
+            PICOTEST_CHECK((int64_t)alarms[i].fired_at == base + 11 * TICK_US, "Alarm fired at wrong time");
+        }
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("Alarms across all levels, and beyond the wheel");
+        srand(1234);
+        base = (int64_t)sim_time_us;
+        for (uint i = 0; i < MAX_ALARMS; i++) {
+            // spread targets logarithmically from a few ticks up to well beyond 64^4 ticks
+            int64_t delta = 1 + (int64_t)(rand() % 1000) * (1ll << (rand() % 36));
+            add_test_alarm(pool, &alarms[i], base + delta);
+        }
+        struct test_alarm extra_alarm;
+        alarm_id_t id = add_test_alarm(pool, &extra_alarm, base + 1);
+        PICOTEST_CHECK(id < 0, "Should not be able to add more alarms than the pool holds");
+        sim_advance_to((uint64_t)(base + (1ll << 46)));
+        uint errors = 0;
+        for (uint i = 0; i < MAX_ALARMS; i++) {
+            if (alarms[i].fired_count != 1 || (int64_t)alarms[i].fired_at != tick_ceil(base, alarms[i].target)) {
+                errors++;
+            }
+        }
+        PICOTEST_CHECK(!errors, "Alarms did not fire exactly once on the correct tick");
+        printf("%u alarms over %" PRIu64 " us took %u IRQs\n", MAX_ALARMS, sim_time_us - (uint64_t)base, sim_irq_count);
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("Canceled alarms do not fire");
+        base = (int64_t)sim_time_us;
+        alarm_id_t ids[MAX_ALARMS];
+        for (uint i = 0; i < MAX_ALARMS; i++) {
+            ids[i] = add_test_alarm(pool, &alarms[i], base + 1 + (i * 7919) % 5000000);
+            PICOTEST_CHECK(ids[i] > 0, "Failed to add alarm");
+        }
+        sim_advance_to((uint64_t)base + 1);
+        for (uint i = 0; i < MAX_ALARMS; i += 2) {
+            PICOTEST_CHECK(alarm_pool_cancel_alarm(pool, ids[i]), "Failed to cancel alarm");
+            PICOTEST_CHECK(!alarm_pool_cancel_alarm(pool, ids[i]), "Re-canceling alarm should fail");
+        }
+        sim_advance_to((uint64_t)base + 6000000);
+        for (uint i = 0; i < MAX_ALARMS; i++) {
+            PICOTEST_CHECK(alarms[i].fired_count == (i & 1), "Alarm fired when canceled or not fired when not canceled");
+        }
+        // all the entries must have been returned to the pool
+        for (uint i = 0; i < MAX_ALARMS; i++) {
+            ids[i] = add_test_alarm(pool, &alarms[i], (int64_t)sim_time_us + 1000);
+            PICOTEST_CHECK(ids[i] > 0, "Failed to add alarm after cancellation");
+        }
+        sim_advance_to(sim_time_us + 2000);
+    PICOTEST_END_SECTION();
+
+    PICOTEST_START_SECTION("Repeating timers do not drift");
+        static test_repeating_timer_t timers[10];
+        for (uint i = 0; i < count_of(timers); i++) {
+            int64_t period = 333 + i * 1777;
+            timers[i].expected = (int64_t)sim_time_us + period;
+            PICOTEST_CHECK(alarm_pool_add_repeating_timer_us(pool, -period, repeating_callback, &timers[i], &timers[i].rt),
+                           "Failed to add repeating timer");
+        }
+        uint64_t end = sim_time_us + 10000000;
+        sim_advance_to(end);
+        for (uint i = 0; i < count_of(timers); i++) {
+            PICOTEST_CHECK(!timers[i].errors, "Repeating timer fired at the wrong time");
+            PICOTEST_CHECK(timers[i].fired_count >= (10000000 - TICK_US) / (333 + i * 1777), "Repeating timer fired too few times");
+            PICOTEST_CHECK(cancel_repeating_timer(&timers[i].rt), "Failed to cancel repeating timer");
+        }
+        sim_irq();
+        uint counts[count_of(timers)];
+        for (uint i = 0; i < count_of(timers); i++) counts[i] = timers[i].fired_count;
+        sim_advance_to(sim_time_us + 1000000);
+        for (uint i = 0; i < count_of(timers); i++) {
+            PICOTEST_CHECK(counts[i] == timers[i].fired_count, "Canceled repeating timer fired");
+        }
+    PICOTEST_END_SECTION();
+
+    alarm_pool_destroy(pool);
+    PICOTEST_END_TEST();
+}
@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+#
+# Script to decode the byte stream of log records written by PICO_LOG (see pico/stdio_log.h), using the format
+# strings in the pico_log_fmt section of the ELF file of the program which wrote them
+#
+# Usage:
+#
+# tools/pico_log_decode.py [--no-timestamps] <elf file> [stream file]
+#
+# If the stream file is not specified (or is -), the stream is read from stdin. Each record is output as a line of
+# text, prefixed with its timestamp (in seconds) and core number unless --no-timestamps is given.
+
+
+import argparse
+import re
+import struct
+import sys
+
+RECORD_MAGIC = 0xA5
+RECORD_HEADER_WORDS = 3
+
+SHT_PROGBITS = 1
+SHF_ALLOC = 2
+
+# flags, width, precision, length, conversion
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|j|z|t|L)?([diouxXcsfFeEgGaApbn%])")
+
+
+class Elf:
+    def __init__(self, filename):
+        with open(filename, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF" or data[5] != 1:
+            raise ValueError(f"{filename} is not a little-endian ELF file")
+        self.is_64bit = data[4] == 2
+        if self.is_64bit:
+            shoff, = struct.unpack_from("<Q", data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x3A)
+            section_header = "<IIQQQQ"
+        else:
+            shoff, = struct.unpack_from("<I", data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+            section_header = "<IIIIII"
+        sections = []
+        for i in range(shnum):
+            sections.append(struct.unpack_from(section_header, data, shoff + i * shentsize))
+        names = sections[shstrndx][4]
+        self.fmt = None
+        # (address, contents) of the loaded sections, for looking up %s arguments
+        self.loaded = []
+        for name, sh_type, flags, addr, offset, size in sections:
+            end = data.index(b"\0", names + name)
+            name = data[names + name:end].decode()
+            if name == "pico_log_fmt":
+                self.fmt = data[offset:offset + size]
+            elif sh_type == SHT_PROGBITS and (flags & SHF_ALLOC) and addr:
+                self.loaded.append((addr, data[offset:offset + size]))
+        if self.fmt is None:
+            raise ValueError(f"{filename} has no pico_log_fmt section")
+
+    @property
+    def pointer_size(self):
+        return 8 if self.is_64bit else 4
+
+    def string_at(self, contents, offset):
+        end = contents.find(b"\0", offset)
+        return contents[offset:end if end >= 0 else len(contents)].decode(errors="replace")
+
+    def format_string(self, fmt_id):
+        return self.string_at(self.fmt, fmt_id) if fmt_id < len(self.fmt) else None
+
+    def lookup_string(self, addr):
+        for start, contents in self.loaded:
+            if start <= addr < start + len(contents):
+                return self.string_at(contents, addr - start)
+        return None
+
+
+class Arguments:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, size, signed=False):
+        if self.pos + size > len(self.data):
+            self.pos = len(self.data)
+            return None
+        value = int.from_bytes(self.data[self.pos:self.pos + size], "little", signed=signed)
+        self.pos += size
+        return value
+
+
+def format_record(elf, fmt, args):
+    int_sizes = {None: 4, "hh": 4, "h": 4, "l": elf.pointer_size, "ll": 8, "j": 8, "z": elf.pointer_size,
+                 "t": elf.pointer_size, "L": 8}
+
+    def convert(match):
+        flags, width, precision, length, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        if width == "*":
+            width = args.take(4, signed=True)
+            if width is None:
+                return "<missing>"
+            if width < 0:
+                flags += "-"
+                width = -width
+        if precision == "*":
+            precision = args.take(4, signed=True)
+            if precision is None:
+                return "<missing>"
+            if precision < 0:
+                precision = None
+        spec = "%" + flags + (str(width) if width is not None else "")
+        if precision is not None:
+            spec += "." + (str(precision) or "0")
+        if conversion in "fFeEgGaA":
+            value = args.take(8)
+            if value is None:
+                return "<missing>"
+            value, = struct.unpack("<d", value.to_bytes(8, "little"))
+            if conversion in "aA":
+                text = value.hex()
+                return text.upper() if conversion == "A" else text
+            return (spec + conversion) % value
+        if conversion in "spn":
+            value = args.take(elf.pointer_size)
+            if value is None:
+                return "<missing>"
+            if conversion == "n":
+                return ""
+            if conversion == "p":
+                # as pico_printf
+                return "%0*X" % (elf.pointer_size * 2, value)
+            string = elf.lookup_string(value)
+            if string is None:
+                string = "<string@0x%x>" % value
+            return (spec + "s") % string
+        value = args.take(int_sizes[length], signed=conversion in "di")
+        if value is None:
+            return "<missing>"
+        bits = {"hh": 8, "h": 16}.get(length)
+        if bits:
+            value &= (1 << bits) - 1
+            if conversion in "di" and value >= 1 << (bits - 1):
+                value -= 1 << bits
+        if conversion == "c":
+            return (spec + "c") % chr(value & 0xFF)
+        if conversion == "b":
+            return (spec.replace("#", "") + "s") % format(value, "b")
+        if conversion == "o" and "#" in flags:
+            return (spec.replace("#", "") + "s") % ("0%o" % value if value else "0")
+        return (spec + {"i": "d", "u": "d"}.get(conversion, conversion)) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(elf, stream, out, timestamps=True):
+    pos = 0
+    skipped = 0
+    while pos + RECORD_HEADER_WORDS * 4 <= len(stream):
+        header, fmt_id, time = struct.unpack_from("<III", stream, pos)
+        if header >> 24 != RECORD_MAGIC or header & 0xF00:
+            skipped += 4
+            pos += 4
+            continue
+        if skipped:
+            out.write(f"*** skipped {skipped} bytes of invalid data ***\n")
+            skipped = 0
+        core = (header >> 12) & 0xF
+        dropped = (header >> 16) & 0xFF
+        arg_bytes = (header & 0xFF) * 4
+        if pos + RECORD_HEADER_WORDS * 4 + arg_bytes > len(stream):
+            break
+        args = Arguments(stream[pos + RECORD_HEADER_WORDS * 4:pos + RECORD_HEADER_WORDS * 4 + arg_bytes])
+        pos += RECORD_HEADER_WORDS * 4 + arg_bytes
+        if dropped:
+            out.write(f"*** {dropped}{'+' if dropped == 0xFF else ''} records dropped on core {core} ***\n")
+        fmt = elf.format_string(fmt_id)
+        text = format_record(elf, fmt, args) if fmt is not None else f"*** unknown format id 0x{fmt_id:x} ***"
+        prefix = f"[{time // 1000000:4d}.{time % 1000000:06d} c{core}] " if timestamps else ""
+        out.write(prefix + text.rstrip("\n") + "\n")
+    if skipped:
+        out.write(f"*** skipped {skipped} bytes of invalid data ***\n")
+    if pos < len(stream) and len(stream) - pos >= 4:
+        print(f"warning: {len(stream) - pos} bytes at the end of the stream are not a whole record", file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a stream of PICO_LOG records")
+    parser.add_argument("elf", help="ELF file of the program which wrote the records")
+    parser.add_argument("stream", nargs="?", default="-", help="captured stream (default stdin)")
+    parser.add_argument("--no-timestamps", action="store_true", help="don't prefix lines with timestamp and core")
+    args = parser.parse_args()
+    try:
+        elf = Elf(args.elf)
+    except (OSError, ValueError) as e:
+        sys.exit(f"error: {e}")
+    if args.stream == "-":
+        stream = sys.stdin.buffer.read()
+    else:
+        with open(args.stream, "rb") as f:
+            stream = f.read()
+    decode(elf, stream, sys.stdout, not args.no_timestamps)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <iostream>
+#include "output_format.h"
+
+#ifdef _MSC_VER
+#pragma warning(disable : 4996) // fopen
+#endif
+
+// binary PIO program blobs, as loaded by pio_load_program_blob(); the layout must match pio_program_blob_header_t
+// in hardware/pio.h
+struct blob_output : public output_format {
+    struct factory {
+        factory() {
+            output_format::add(new blob_output());
+        }
+    };
+
+    static const uint32_t MAGIC = 0x424f4950u; // "PIOB"
+    static const uint8_t VERSION = 1;
+
+    enum {
+        FLAG_SIDESET_OPT = 0x01,
+        FLAG_SIDESET_PINDIRS = 0x02,
+        FLAG_IN_SHIFT_RIGHT = 0x04,
+        FLAG_AUTOPUSH = 0x08,
+        FLAG_OUT_SHIFT_RIGHT = 0x10,
+        FLAG_AUTOPULL = 0x20,
+    };
+
+    blob_output() : output_format("blob") {}
+
+    std::string get_description() override {
+        return "Binary program blobs for pio_load_program_blob() (one after another for multiple programs)";
+    }
+
+    static void put8(std::vector<uint8_t> &data, uint v) {
+        data.push_back((uint8_t)v);
+    }
+
+    static void put16(std::vector<uint8_t> &data, uint v) {
+        put8(data, v);
+        put8(data, v >> 8u);
+    }
+
+    static void put32(std::vector<uint8_t> &data, uint v) {
+        put16(data, v);
+        put16(data, v >> 16u);
+    }
+
+    // as enum pio_fifo_join
+    static uint fifo_join(fifo_config fifo) {
+        switch (fifo) {
+            case fifo_config::tx: return 1;
+            case fifo_config::rx: return 2;
+            case fifo_config::txget: return 4;
+            case fifo_config::txput: return 8;
+            case fifo_config::putget: return 12;
+            default: return 0;
+        }
+    }
+
+    static std::vector<uint8_t> blob(const compiled_source::program &program) {
+        std::vector<uint8_t> data;
+        uint relocation_mask = 0;
+        for (uint i = 0; i < program.instructions.size(); i++) {
+            if (!(program.instructions[i] & 0xe000u)) relocation_mask |= 1u << i;
+        }
+        uint flags = 0;
+        if (program.sideset_opt) flags |= FLAG_SIDESET_OPT;
+        if (program.sideset_pindirs) flags |= FLAG_SIDESET_PINDIRS;
+        if (program.in.right) flags |= FLAG_IN_SHIFT_RIGHT;
+        if (program.in.autop) flags |= FLAG_AUTOPUSH;
+        if (program.out.right) flags |= FLAG_OUT_SHIFT_RIGHT;
+        if (program.out.autop) flags |= FLAG_AUTOPULL;
+
+        put32(data, MAGIC);
+        put8(data, VERSION);
+        put8(data, program.instructions.size());
+        put8(data, program.origin.get());
+        put8(data, program.pio_version);
+        put32(data, relocation_mask);
+        put8(data, program.wrap_target);
+        put8(data, program.wrap);
+        put8(data, program.sideset_bits_including_opt.is_specified() ? program.sideset_bits_including_opt.get() : 0);
+        put8(data, flags);
+        put8(data, program.in.pin_count);
+        put8(data, program.in.threshold);
+        put8(data, program.out.pin_count);
+        put8(data, program.out.threshold);
+        put8(data, program.set_count);
+        put8(data, fifo_join(program.fifo));
+        put8(data, program.mov_status_type);
+        put8(data, program.mov_status_n);
+        put16(data, program.clock_div_int);
+        put8(data, program.clock_div_frac);
+        put8(data, program.used_gpio_ranges);
+        for (uint inst : program.instructions) {
+            put16(data, inst);
+        }
+        while (data.size() & 3u) put8(data, 0);
+        return data;
+    }
+
+    int output(std::string destination, std::vector<std::string> output_options,
+               const compiled_source &source) override {
+        FILE *out = destination == "-" ? stdout : fopen(destination.c_str(), "wb");
+        if (!out) {
+            std::cerr << "Can't open output file '" << destination << "'" << std::endl;
+            return 1;
+        }
+        for (const auto &program : source.programs) {
+            if (program.instructions.empty()) {
+                std::cerr << "warning: program '" << program.name << "' has no instructions, so has no blob\n";
+                continue;
+            }
+            std::vector<uint8_t> data = blob(program);
+            fwrite(data.data(), 1, data.size(), out);
+        }
+        if (out != stdout) { fclose(out); }
+        return 0;
+    }
+};
+
+static blob_output::factory creator;
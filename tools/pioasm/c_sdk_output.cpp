@@ -9,6 +9,7 @@
 #include <sstream>
 #include "output_format.h"
 #include "pio_disassembler.h"
+#include "pio_packer.h"
 #include "version.h"
 
 struct c_sdk_output : public output_format {
@@ -21,7 +22,8 @@ struct c_sdk_output : public output_format {
     c_sdk_output() : output_format("c-sdk") {}
 
     std::string get_description() override {
-        return "C header suitable for use with the Raspberry Pi Pico SDK";
+        return "C header suitable for use with the Raspberry Pi Pico SDK (use -p pack=<name> to also add an image of all "
+               "the programs packed together)";
     }
 
     void output_symbols(FILE *out, std::string prefix, const std::vector<compiled_source::symbol> &symbols) {
@@ -55,8 +57,68 @@ struct c_sdk_output : public output_format {
         fprintf(out, "\n");
     }
 
+    // a single pio_program containing all the programs, which can be loaded with one pio_add_program(); the
+    // offset passed to each program's get_default_config() (and added to its label offsets) is then the offset
+    // the packed program was loaded at plus <pack_name>_<program>_offset
+    int output_packed(FILE *out, const std::string &pack_name, const compiled_source &source) {
+        pio_packing packing = pack_programs(source.programs);
+        if (!packing.error.empty()) {
+            std::cerr << "error: cannot pack programs into '" << pack_name << "': " << packing.error << "\n";
+            return 1;
+        }
+        std::stringstream title;
+        title << pack_name << " (" << source.programs.size() << " programs packed into " << packing.instructions.size()
+              << " instructions, " << packing.unpacked_length << " unpacked)";
+        header(out, title.str());
+
+        std::string prefix = pack_name + "_";
+        for (uint i = 0; i < source.programs.size(); i++) {
+            fprintf(out, "#define %s%s_offset %du\n", prefix.c_str(), source.programs[i].name.c_str(), packing.offsets[i]);
+        }
+        fprintf(out, "#define %spio_version %d\n", prefix.c_str(), packing.pio_version);
+        fprintf(out, "\n");
+
+        fprintf(out, "static const uint16_t %spacked_instructions[] = {\n", prefix.c_str());
+        for (uint i = 0; i < packing.instructions.size(); i++) {
+            // disassemble using the side-set of the first program covering the instruction
+            const compiled_source::program *owner = nullptr;
+            for (uint p = 0; p < source.programs.size(); p++) {
+                const auto &program = source.programs[p];
+                if (packing.offsets[p] == i) {
+                    fprintf(out, "            //     %s\n", program.name.c_str());
+                }
+                if (!owner && i >= packing.offsets[p] && i < packing.offsets[p] + program.instructions.size()) {
+                    owner = &program;
+                }
+            }
+            uint inst = packing.instructions[i];
+            fprintf(out, "    0x%04x, // %2d: %s\n", (uint16_t)inst, i, owner ?
+                    disassemble(inst, owner->sideset_bits_including_opt.get(), owner->sideset_opt).c_str() : "(unused)");
+        }
+        fprintf(out, "};\n");
+        fprintf(out, "\n");
+
+        fprintf(out, "#if !PICO_NO_HARDWARE\n");
+        fprintf(out, "static const struct pio_program %spacked_program = {\n", prefix.c_str());
+        fprintf(out, "    .instructions = %spacked_instructions,\n", prefix.c_str());
+        fprintf(out, "    .length = %d,\n", (int) packing.instructions.size());
+        fprintf(out, "    .origin = %d,\n", packing.origin);
+        fprintf(out, "    .pio_version = %spio_version,\n", prefix.c_str());
+        fprintf(out, "#if PICO_PIO_VERSION > 0\n");
+        fprintf(out, "    .used_gpio_ranges = 0x%x\n", packing.used_gpio_ranges);
+        fprintf(out, "#endif\n");
+        fprintf(out, "};\n");
+        fprintf(out, "#endif\n");
+        fprintf(out, "\n");
+        return 0;
+    }
+
     int output(std::string destination, std::vector<std::string> output_options,
                const compiled_source &source) override {
+        std::string pack_name;
+        for (const auto &o : output_options) {
+            if (o.compare(0, 5, "pack=") == 0) pack_name = o.substr(5);
+        }
 
         for (const auto &program : source.programs) {
             for(const auto &p : program.lang_opts) {
@@ -182,8 +244,9 @@ struct c_sdk_output : public output_format {
             fprintf(out, "#endif\n");
             fprintf(out, "\n");
         }
+        int rc = pack_name.empty() ? 0 : output_packed(out, pack_name, source);
         if (out != stdout) { fclose(out); }
-        return 0;
+        return rc;
     }
 };
 
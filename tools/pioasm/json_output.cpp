@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <iostream>
 #include "output_format.h"
+#include "pio_analyzer.h"
 #include "pio_disassembler.h"
 
 struct json_output : public output_format {
@@ -62,6 +63,29 @@ struct json_output : public output_format {
         fprintf(out, "%s},\n", prefix.c_str());
     }
 
+    void output_timing(FILE *out, std::string prefix, const compiled_source::program &program, double sys_clock_hz) {
+        pio_timing timing = analyze_timing(program);
+        fprintf(out, "%s\"timing\": {\"loop\": %s", prefix.c_str(), timing.loop ? "true" : "false");
+        if (timing.loop) {
+            fprintf(out, ", \"minCycles\": %u, \"maxCycles\": %u, \"unbounded\": %s,", timing.min_cycles,
+                    timing.max_cycles, timing.unbounded ? "true" : "false");
+            fprintf(out, " \"mayStall\": %s, \"dynamic\": %s,", timing.may_stall ? "true" : "false",
+                    timing.dynamic ? "true" : "false");
+            fprintf(out, "\n%s\t\"minBitsOut\": %u, \"maxBitsOut\": %u, \"minBitsIn\": %u, \"maxBitsIn\": %u,",
+                    prefix.c_str(), timing.min_bits_out, timing.max_bits_out, timing.min_bits_in, timing.max_bits_in);
+            fprintf(out, "\n%s\t\"clockDiv\": %g, \"sysClockHz\": %.0f,", prefix.c_str(), timing.clock_div, sys_clock_hz);
+            fprintf(out, "\n%s\t\"maxOutBitRate\": %.3f, \"minOutBitRate\": %.3f, \"maxInBitRate\": %.3f, \"minInBitRate\": %.3f,",
+                    prefix.c_str(), timing.rate(timing.max_out_bits_per_cycle, sys_clock_hz),
+                    timing.rate(timing.min_out_bits_per_cycle, sys_clock_hz),
+                    timing.rate(timing.max_in_bits_per_cycle, sys_clock_hz),
+                    timing.rate(timing.min_in_bits_per_cycle, sys_clock_hz));
+            fprintf(out, "\n%s\t\"maxTxWordRate\": %.3f, \"maxRxWordRate\": %.3f", prefix.c_str(),
+                    timing.rate(timing.max_tx_words_per_cycle, sys_clock_hz),
+                    timing.rate(timing.max_rx_words_per_cycle, sys_clock_hz));
+        }
+        fprintf(out, "},\n");
+    }
+
     int output(std::string destination, std::vector<std::string> output_options,
                const compiled_source &source) override {
 
@@ -105,6 +129,8 @@ struct json_output : public output_format {
                 fprintf(out, "%s\"sideset\": {\"size\": 0, \"optional\": false, \"pindirs\": false},\n", tabs);
             }
 
+            output_timing(out, tabs, program, sys_clock_hz_option(output_options, program));
+
             output_symbols(out, true, tabs, program.symbols);
 
             fprintf(out, "%s\"instructions\": [\n", tabs);
@@ -268,6 +268,9 @@ void pio_assembler::scan_begin ()
       std::cerr << "cannot open " << source << ": " << strerror(errno) << '\n';
       exit (EXIT_FAILURE);
     }
+  // start afresh, as the scanner may already have been used for another file
+  yyrestart (yyin);
+  BEGIN (INITIAL);
 }
 
 void pio_assembler::scan_end ()
@@ -6,6 +6,9 @@
 
 #include <iostream>
 #include "pio_assembler.h"
+#include "pio_batch.h"
+#include "pio_simulator.h"
+#include "pio_source_disassembler.h"
 #include "version.h"
 
 #define DEFAULT_OUTPUT_FORMAT "c-sdk"
@@ -25,6 +28,16 @@ void usage() {
     }
     std::cerr << "  -p <output_param>    add a parameter to be passed to the output format generator" << std::endl;
     std::cerr << "  -v <version>         specify the default PIO version (0 or 1)" << std::endl;
+    std::cerr << "  -O                   optimize the program(s) to use fewer instructions, without changing their timing;" << std::endl;
+    std::cerr << "                       each optimized program is checked against the original by searching the states" << std::endl;
+    std::cerr << "                       both reach from a bounded set of starting conditions and inputs (see the info" << std::endl;
+    std::cerr << "                       message for whether the search was complete, or how many cycles it covered)" << std::endl;
+    std::cerr << "  --batch <manifest>   assemble each '<input> <output>' line of the manifest file ('-' for stdin) rather than" << std::endl;
+    std::cerr << "                       a single input, only replacing outputs whose contents have changed" << std::endl;
+    std::cerr << "  --simulate <stimulus>  simulate the program(s) driven by the stimulus file rather than generating output;" << std::endl;
+    std::cerr << "                       a summary is printed, and a VCD trace is written to <output> if specified" << std::endl;
+    std::cerr << "  --disassemble        reconstruct .pio source from <input>, which is the output of the json, hex or blob" << std::endl;
+    std::cerr << "                       output formats (for hex, the side-set may be given by -p side_set=<count>[,opt][,pindirs])" << std::endl;
     std::cerr << "  --version            print pioasm version information" << std::endl;
     std::cerr << "  -?, --help           print this help and exit\n";
 }
@@ -36,6 +49,9 @@ int main(int argc, char *argv[]) {
     const char *input = nullptr;
     const char *output = nullptr;
     std::vector<std::string> options;
+    const char *stimulus = nullptr;
+    const char *manifest = nullptr;
+    bool disassemble = false;
     int i = 1;
     for (; !res && i < argc; i++) {
         if (argv[i][0] != '-') break;
@@ -65,6 +81,24 @@ int main(int argc, char *argv[]) {
                 std::cerr << "error: -v requires version number" << std::endl;
                 res = 1;
             }
+        } else if (argv[i] == std::string("-O")) {
+            pioasm.optimize = true;
+        } else if (argv[i] == std::string("--batch")) {
+            if (++i < argc) {
+                manifest = argv[i];
+            } else {
+                std::cerr << "error: --batch requires manifest filename" << std::endl;
+                res = 1;
+            }
+        } else if (argv[i] == std::string("--simulate")) {
+            if (++i < argc) {
+                stimulus = argv[i];
+            } else {
+                std::cerr << "error: --simulate requires stimulus filename" << std::endl;
+                res = 1;
+            }
+        } else if (argv[i] == std::string("--disassemble")) {
+            disassemble = true;
         } else if (argv[i] == std::string("-?") || argv[i] == std::string("--help")) {
             usage();
             return 1;
@@ -76,7 +110,15 @@ int main(int argc, char *argv[]) {
             res = 1;
         }
     }
-    if (!res) {
+    if (!res && manifest && stimulus) {
+        std::cerr << "error: --batch cannot be used with --simulate" << std::endl;
+        res = 1;
+    }
+    if (!res && disassemble && (manifest || stimulus)) {
+        std::cerr << "error: --disassemble cannot be used with --batch or --simulate" << std::endl;
+        res = 1;
+    }
+    if (!res && !manifest) {
         if (i != argc) {
             input = argv[i++];
         } else {
@@ -84,7 +126,7 @@ int main(int argc, char *argv[]) {
             res = 1;
         }
     }
-    if (!res) {
+    if (!res && !manifest) {
         if (i != argc) {
             output = argv[i++];
         } else {
@@ -96,7 +138,11 @@ int main(int argc, char *argv[]) {
         res = 1;
     }
     std::shared_ptr<output_format> oformat;
-    if (!res) {
+    if (!res && disassemble) {
+        // no output format is involved
+    } else if (!res && stimulus) {
+        oformat = pio_simulation_output(stimulus);
+    } else if (!res) {
         const auto& e = std::find_if(output_format::all().begin(), output_format::all().end(),
                                      [&](const std::shared_ptr<output_format> &f) {
                                          return f->name == format;
@@ -111,6 +157,10 @@ int main(int argc, char *argv[]) {
     if (res) {
         std::cerr << std::endl;
         usage();
+    } else if (disassemble) {
+        res = disassemble_file(input, output, options);
+    } else if (manifest) {
+        res = run_batch(manifest, oformat, options, pioasm.default_pio_version, pioasm.optimize);
     } else {
         res = pioasm.generate(oformat, input, output, options);
     }
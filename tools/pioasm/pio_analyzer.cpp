@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include "pio_analyzer.h"
+
+namespace {
+
+// give up enumerating paths after this many steps; real programs are nowhere near this
+const uint MAX_STEPS = 1000000;
+
+struct path_totals {
+    uint cycles;
+    uint bits_out;
+    uint bits_in;
+    double tx_words;
+    double rx_words;
+};
+
+struct analyzer {
+    const compiled_source::program &program;
+    pio_timing timing;
+    uint steps = 0;
+    bool first_path = true;
+
+    explicit analyzer(const compiled_source::program &program) : program(program) {
+        timing.clock_div = program.clock_div_int + program.clock_div_frac / 256.0;
+    }
+
+    uint next(uint pc) const {
+        return (int)pc == program.wrap ? program.wrap_target : pc + 1;
+    }
+
+    // adds the cost of the instruction at pc to totals, and returns its possible successors
+    std::vector<uint> visit(uint pc, path_totals &totals) {
+        uint inst = program.instructions[pc];
+        uint major = (inst >> 13u) & 7u;
+        uint arg1 = (inst >> 5u) & 7u;
+        uint arg2 = inst & 0x1fu;
+        uint sideset_bits = program.sideset_bits_including_opt.get();
+        totals.cycles += 1 + (((inst >> 8u) & 0x1fu) & ((1u << (5 - sideset_bits)) - 1u));
+        uint n = arg2 ? arg2 : 32;
+        switch (major) {
+            case 0: // jmp
+                if (arg1 == 0) return {arg2};
+                return {arg2, next(pc)};
+            case 1: // wait
+                timing.may_stall = true;
+                break;
+            case 2: // in
+                totals.bits_in += n;
+                if (program.in.pin_count >= 0 && program.in.autop) {
+                    totals.rx_words += (double)n / program.in.threshold;
+                    timing.may_stall = true;
+                }
+                break;
+            case 3: // out
+                totals.bits_out += n;
+                if (program.out.pin_count >= 0 && program.out.autop) {
+                    totals.tx_words += (double)n / program.out.threshold;
+                    timing.may_stall = true;
+                }
+                if (arg1 == 5 || arg1 == 7) {
+                    timing.dynamic = true;
+                    return {};
+                }
+                break;
+            case 4: // push/pull
+                if (!(arg2 & 0x10u)) {
+                    if (arg1 & 4u) totals.tx_words++; else totals.rx_words++;
+                    if (arg1 & 1u) timing.may_stall = true;
+                }
+                break;
+            case 5: // mov
+                if (arg1 == 4 || arg1 == 5) {
+                    timing.dynamic = true;
+                    return {};
+                }
+                break;
+            case 6: // irq
+                if ((arg1 & 3u) == 1) timing.may_stall = true;
+                break;
+            default:
+                break;
+        }
+        return {next(pc)};
+    }
+
+    void path_complete(const path_totals &t) {
+        double out_rate = (double)t.bits_out / t.cycles;
+        double in_rate = (double)t.bits_in / t.cycles;
+        double tx_rate = t.tx_words / t.cycles;
+        double rx_rate = t.rx_words / t.cycles;
+        if (first_path) {
+            first_path = false;
+            timing.loop = true;
+            timing.min_cycles = timing.max_cycles = t.cycles;
+            timing.min_bits_out = timing.max_bits_out = t.bits_out;
+            timing.min_bits_in = timing.max_bits_in = t.bits_in;
+            timing.min_out_bits_per_cycle = timing.max_out_bits_per_cycle = out_rate;
+            timing.min_in_bits_per_cycle = timing.max_in_bits_per_cycle = in_rate;
+            timing.max_tx_words_per_cycle = tx_rate;
+            timing.max_rx_words_per_cycle = rx_rate;
+            return;
+        }
+        timing.min_cycles = std::min(timing.min_cycles, t.cycles);
+        timing.max_cycles = std::max(timing.max_cycles, t.cycles);
+        timing.min_bits_out = std::min(timing.min_bits_out, t.bits_out);
+        timing.max_bits_out = std::max(timing.max_bits_out, t.bits_out);
+        timing.min_bits_in = std::min(timing.min_bits_in, t.bits_in);
+        timing.max_bits_in = std::max(timing.max_bits_in, t.bits_in);
+        timing.min_out_bits_per_cycle = std::min(timing.min_out_bits_per_cycle, out_rate);
+        timing.max_out_bits_per_cycle = std::max(timing.max_out_bits_per_cycle, out_rate);
+        timing.min_in_bits_per_cycle = std::min(timing.min_in_bits_per_cycle, in_rate);
+        timing.max_in_bits_per_cycle = std::max(timing.max_in_bits_per_cycle, in_rate);
+        timing.max_tx_words_per_cycle = std::max(timing.max_tx_words_per_cycle, tx_rate);
+        timing.max_rx_words_per_cycle = std::max(timing.max_rx_words_per_cycle, rx_rate);
+    }
+
+    void walk(uint pc, path_totals totals, uint32_t on_path) {
+        if (++steps > MAX_STEPS) {
+            timing.unbounded = true;
+            return;
+        }
+        for (uint succ : visit(pc, totals)) {
+            if ((int)succ == program.wrap_target) {
+                path_complete(totals);
+            } else if (on_path & (1u << succ)) {
+                // a loop which doesn't pass through .wrap_target; its iteration count depends on the data
+                timing.unbounded = true;
+            } else {
+                walk(succ, totals, on_path | (1u << succ));
+            }
+        }
+    }
+};
+
+}
+
+pio_timing analyze_timing(const compiled_source::program &program) {
+    analyzer a(program);
+    if (!program.instructions.empty()) {
+        a.walk(program.wrap_target, path_totals{}, 1u << program.wrap_target);
+    }
+    return a.timing;
+}
+
+double sys_clock_hz_option(const std::vector<std::string> &output_options, const compiled_source::program &program) {
+    double mhz = program.pio_version ? 150.0 : 125.0;
+    for (const auto &o : output_options) {
+        if (o.compare(0, 7, "sysclk=") == 0) {
+            try {
+                double v = std::stod(o.substr(7));
+                if (v > 0) mhz = v;
+            } catch (std::exception &) {
+            }
+        }
+    }
+    return mhz * 1000000.0;
+}
+
+std::string timing_description(const compiled_source::program &program, const pio_timing &timing,
+                               double sys_clock_hz) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    auto range = [&](double min, double max) {
+        std::stringstream r;
+        r << std::fixed << std::setprecision(3) << min;
+        if (max != min) r << "-" << max;
+        return r.str();
+    };
+    ss << "program " << program.name << " (clock divider " << timing.clock_div << ", system clock "
+       << sys_clock_hz / 1000000.0 << " MHz)\n";
+    if (!timing.loop) {
+        ss << "  no path returns to .wrap_target\n";
+    } else {
+        ss << "  cycles per iteration: " << timing.min_cycles;
+        if (timing.max_cycles != timing.min_cycles) ss << "-" << timing.max_cycles;
+        if (timing.unbounded) ss << " (plus data dependent inner loops)";
+        ss << "\n";
+        auto bits = [&](const char *dir, uint min_bits, uint max_bits, double min_rate, double max_rate) {
+            if (!max_bits) return;
+            ss << "  " << dir << ": " << min_bits;
+            if (max_bits != min_bits) ss << "-" << max_bits;
+            ss << " bits per iteration, " << range(min_rate, max_rate) << " bits/cycle, max bit rate "
+               << timing.rate(max_rate, sys_clock_hz) / 1000000.0 << " Mbit/s";
+            if (min_rate != max_rate) ss << " (" << timing.rate(min_rate, sys_clock_hz) / 1000000.0 << " Mbit/s on the slowest path)";
+            ss << "\n";
+        };
+        bits("out", timing.min_bits_out, timing.max_bits_out, timing.min_out_bits_per_cycle, timing.max_out_bits_per_cycle);
+        bits("in", timing.min_bits_in, timing.max_bits_in, timing.min_in_bits_per_cycle, timing.max_in_bits_per_cycle);
+        if (timing.max_tx_words_per_cycle > 0) {
+            ss << "  TX FIFO drained at up to " << timing.max_tx_words_per_cycle << " words/cycle ("
+               << timing.rate(timing.max_tx_words_per_cycle, sys_clock_hz) / 1000000.0 << " Mwords/s)\n";
+        }
+        if (timing.max_rx_words_per_cycle > 0) {
+            ss << "  RX FIFO filled at up to " << timing.max_rx_words_per_cycle << " words/cycle ("
+               << timing.rate(timing.max_rx_words_per_cycle, sys_clock_hz) / 1000000.0 << " Mwords/s)\n";
+        }
+    }
+    if (timing.may_stall) ss << "  note: may stall (on wait, irq wait or FIFO access), so rates are upper bounds\n";
+    if (timing.dynamic) ss << "  note: jumps via OUT/MOV to PC or EXEC are not followed\n";
+    return ss.str();
+}
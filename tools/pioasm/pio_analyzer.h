@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _PIO_ANALYZER_H
+#define _PIO_ANALYZER_H
+
+#include <string>
+#include <vector>
+#include "output_format.h"
+
+// Static timing of one iteration of a program's main loop, i.e. of every path from .wrap_target back to it
+// (following jmp targets, and .wrap back to .wrap_target). Cycle counts are state machine clock cycles including
+// delays, assuming no instruction stalls.
+struct pio_timing {
+    bool loop = false;       // some path returns to .wrap_target
+    bool unbounded = false;  // some path has a data dependent inner loop, or never returns to .wrap_target
+    bool dynamic = false;    // some path jumps via OUT/MOV to PC or EXEC, which cannot be followed
+    bool may_stall = false;  // the loop contains instructions which can stall (wait, blocking FIFO access etc.)
+    uint min_cycles = 0;
+    uint max_cycles = 0;     // of the paths without inner loops
+    uint min_bits_out = 0;
+    uint max_bits_out = 0;
+    uint min_bits_in = 0;
+    uint max_bits_in = 0;
+    // bits shifted per cycle of the slowest/fastest path
+    double min_out_bits_per_cycle = 0;
+    double max_out_bits_per_cycle = 0;
+    double min_in_bits_per_cycle = 0;
+    double max_in_bits_per_cycle = 0;
+    // worst case FIFO drain (TX) and fill (RX) rate, including autopull/autopush
+    double max_tx_words_per_cycle = 0;
+    double max_rx_words_per_cycle = 0;
+    double clock_div = 1.0;
+
+    // rate in Hz at the given system clock frequency of something happening per_cycle times per state machine cycle
+    double rate(double per_cycle, double sys_clock_hz) const {
+        return per_cycle * sys_clock_hz / clock_div;
+    }
+};
+
+pio_timing analyze_timing(const compiled_source::program &program);
+
+// the system clock frequency given by a sysclk=<MHz> output option, or the default for the program's PIO version
+double sys_clock_hz_option(const std::vector<std::string> &output_options, const compiled_source::program &program);
+
+// human readable summary of the timing
+std::string timing_description(const compiled_source::program &program, const pio_timing &timing,
+                               double sys_clock_hz);
+
+#endif
@@ -8,6 +8,7 @@
 #include <iterator>
 #include "pio_assembler.h"
 #include "parser.hpp"
+#include "pio_optimizer.h"
 
 #ifdef _MSC_VER
 #pragma warning(disable : 4996) // fopen
@@ -69,7 +70,7 @@ void program::set_clock_div(const yy::location &l, float clock_div) {
     if (clock_div_int == 0) {
         clock_div_frac = 0;
     } else {
-        clock_div_frac = (uint8_t)((clock_div - (float)clock_div_frac) * (1u << 8u));
+        clock_div_frac = (uint8_t)((clock_div - (float)clock_div_int) * (1u << 8u));
     }
 }
 
@@ -528,6 +529,7 @@ int pio_assembler::write_output() {
         cprogram.lang_opts = program.lang_opts;
         cprogram.symbols = public_symbols(program);
     }
+    if (optimize) optimize_programs(source);
     if (programs.empty()) {
         std::cout << "warning: input contained no programs" << std::endl;
     }
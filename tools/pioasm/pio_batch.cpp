@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include "pio_assembler.h"
+#include "pio_batch.h"
+#include "pio_optimizer.h"
+
+namespace {
+
+// an output format which keeps the compiled source, so the real output can be generated later
+struct capture_output : public output_format {
+    compiled_source source;
+
+    capture_output() : output_format("capture") {}
+
+    std::string get_description() override {
+        return "";
+    }
+
+    int output(std::string destination, std::vector<std::string> output_options,
+               const compiled_source &compiled) override {
+        source = compiled;
+        return 0;
+    }
+};
+
+struct batch_entry {
+    std::string input;
+    std::string output;
+    int result = 0;
+    bool updated = false;
+};
+
+// the scanner uses global state, so only one input may be parsed at a time
+std::mutex parse_mutex;
+
+bool read_manifest(std::istream &in, const std::string &name, std::vector<batch_entry> &entries) {
+    std::string line;
+    uint line_number = 0;
+    while (std::getline(in, line)) {
+        line_number++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        batch_entry e;
+        bool ok;
+        size_t tab = line.find('\t');
+        if (tab != std::string::npos) {
+            // tab separated, so the filenames may contain spaces
+            e.input = line.substr(0, tab);
+            e.output = line.substr(tab + 1);
+            if (e.input.empty() || e.input[0] == '#') continue;
+            ok = !e.output.empty() && e.output.find('\t') == std::string::npos;
+        } else {
+            std::istringstream fields(line);
+            std::string extra;
+            if (!(fields >> e.input) || e.input[0] == '#') continue;
+            ok = (fields >> e.output) && !(fields >> extra);
+        }
+        if (!ok) {
+            std::cerr << name << ":" << line_number << ": error: expected '<input> <output>'\n";
+            return false;
+        }
+        if (e.output == "-") {
+            std::cerr << name << ":" << line_number << ": error: batch output cannot be written to stdout\n";
+            return false;
+        }
+        entries.push_back(e);
+    }
+    return true;
+}
+
+bool read_file(const std::string &filename, std::string &contents) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) return false;
+    std::stringstream ss;
+    ss << in.rdbuf();
+    contents = ss.str();
+    return true;
+}
+
+void build(batch_entry &e, const std::shared_ptr<output_format> &format, const std::vector<std::string> &options,
+           int default_pio_version, bool optimize) {
+    if (!std::ifstream(e.input)) {
+        std::cerr << "cannot open " << e.input << "\n";
+        e.result = 1;
+        return;
+    }
+    auto capture = std::make_shared<capture_output>();
+    {
+        std::lock_guard<std::mutex> lock(parse_mutex);
+        pio_assembler pioasm;
+        pioasm.default_pio_version = default_pio_version;
+        e.result = pioasm.generate(capture, e.input, e.output, options);
+    }
+    if (e.result) return;
+    if (optimize) optimize_programs(capture->source);
+
+    // write to a temporary file, and only replace the output if it differs
+    std::string temp = e.output + ".tmp";
+    e.result = format->output(temp, options, capture->source);
+    std::string old_contents, new_contents;
+    if (e.result || !read_file(temp, new_contents)) {
+        std::remove(temp.c_str());
+        e.result = 1;
+        return;
+    }
+    if (read_file(e.output, old_contents) && old_contents == new_contents) {
+        std::remove(temp.c_str());
+        return;
+    }
+    std::remove(e.output.c_str());
+    if (std::rename(temp.c_str(), e.output.c_str())) {
+        std::cerr << "Can't replace output file '" << e.output << "'" << std::endl;
+        std::remove(temp.c_str());
+        e.result = 1;
+        return;
+    }
+    e.updated = true;
+}
+
+}
+
+int run_batch(const std::string &manifest, const std::shared_ptr<output_format> &format,
+              const std::vector<std::string> &options, int default_pio_version, bool optimize) {
+    std::vector<batch_entry> entries;
+    if (manifest == "-") {
+        if (!read_manifest(std::cin, "<stdin>", entries)) return 1;
+    } else {
+        std::ifstream in(manifest);
+        if (!in) {
+            std::cerr << "cannot open " << manifest << "\n";
+            return 1;
+        }
+        if (!read_manifest(in, manifest, entries)) return 1;
+    }
+
+    std::atomic<uint> next(0);
+    auto worker = [&]() {
+        for (uint i = next++; i < entries.size(); i = next++) {
+            try {
+                build(entries[i], format, options, default_pio_version, optimize);
+            } catch (std::exception &ex) {
+                std::cerr << entries[i].input << ": error: " << ex.what() << "\n";
+                entries[i].result = 1;
+            }
+        }
+    };
+    uint thread_count = std::min(std::max(std::thread::hardware_concurrency(), 1u), (uint)entries.size());
+    std::vector<std::thread> threads;
+    for (uint i = 1; i < thread_count; i++) threads.emplace_back(worker);
+    worker();
+    for (auto &t : threads) t.join();
+
+    int res = 0;
+    uint updated = 0;
+    for (const auto &e : entries) {
+        if (e.result) res = 1;
+        if (e.updated) updated++;
+    }
+    std::cout << "pioasm: " << updated << " of " << entries.size() << " outputs updated" << std::endl;
+    return res;
+}
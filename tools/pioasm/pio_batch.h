@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _PIO_BATCH_H
+#define _PIO_BATCH_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "output_format.h"
+
+// Assembles every input listed in a manifest (or "-" for stdin) in one go; each non-empty line of the manifest
+// which doesn't start with '#' is an input filename and an output filename separated by a tab (or by whitespace if
+// there is no tab).
+//
+// Outputs are generated in parallel (parsing itself is serialized, as the scanner is not reentrant), and an output
+// file is only replaced if its contents have changed, so that its timestamp does not cause its dependents to be
+// rebuilt needlessly. Returns non zero if any input failed.
+int run_batch(const std::string &manifest, const std::shared_ptr<output_format> &format,
+              const std::vector<std::string> &options, int default_pio_version, bool optimize);
+
+#endif
@@ -126,7 +126,7 @@ std::string disassemble(uint inst, uint sideset_bits_including_opt, bool sideset
             if (source.empty() || dest.empty() || operation == 3) {
                 invalid = true;
             }
-            if (dest == source && !operation && (arg1 == 1 || arg2 == 2)) {
+            if (dest == source && !operation && arg1 == 2) { // only mov y, y is assembled from nop
                 op("nop");
                 op_guts("");
             } else {
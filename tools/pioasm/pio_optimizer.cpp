@@ -0,0 +1,434 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <sstream>
+#include <unordered_set>
+#include "pio_optimizer.h"
+#include "pio_simulator.h"
+
+namespace {
+
+uint major(uint inst) { return (inst >> 13u) & 7u; }
+uint arg1(uint inst) { return (inst >> 5u) & 7u; }
+uint arg2(uint inst) { return inst & 0x1fu; }
+
+bool is_jmp(uint inst) {
+    return major(inst) == 0;
+}
+
+// OUT/MOV to PC or EXEC
+bool is_computed_jump(uint inst) {
+    return (major(inst) == 3 && (arg1(inst) == 5 || arg1(inst) == 7)) ||
+           (major(inst) == 5 && (arg1(inst) == 4 || arg1(inst) == 5));
+}
+
+struct optimizer {
+    compiled_source::program &program;
+    pio_optimization result;
+    uint delay_mask;
+
+    explicit optimizer(compiled_source::program &program) : program(program) {
+        delay_mask = (1u << (5 - program.sideset_bits_including_opt.get())) - 1u;
+        result.original_length = program.instructions.size();
+        for (uint i = 0; i < program.instructions.size(); i++) result.original_index.push_back(i);
+    }
+
+    uint size() const { return program.instructions.size(); }
+    uint delay(uint inst) const { return (inst >> 8u) & delay_mask; }
+    // the side-set bits of the delay/side-set field (which are zero if an optional side-set is not specified)
+    uint sideset(uint inst) const { return (inst >> 8u) & 0x1fu & ~delay_mask; }
+    bool has_sideset(uint inst) const {
+        return program.sideset_bits_including_opt.get() && (!program.sideset_opt || (inst & 0x1000u));
+    }
+    uint with_delay_sideset(uint inst, uint delay, uint sideset) const {
+        return (inst & ~(0x1fu << 8u)) | ((sideset | delay) << 8u);
+    }
+
+    uint next(uint pc) const {
+        return (int)pc == program.wrap ? program.wrap_target : pc + 1;
+    }
+
+    // the instructions which may be started from outside the program
+    uint32_t entry_mask() const {
+        uint32_t mask = 1u | (1u << program.wrap_target);
+        for (const auto &s : program.symbols) {
+            if (s.is_label) mask |= 1u << s.value;
+        }
+        return mask;
+    }
+
+    uint32_t jump_target_mask() const {
+        uint32_t mask = 0;
+        for (uint inst : program.instructions) {
+            if (is_jmp(inst)) mask |= 1u << arg2(inst);
+        }
+        return mask;
+    }
+
+    bool is_nop(uint pc) const {
+        uint inst = program.instructions[pc];
+        switch (major(inst)) {
+            case 0: // a jmp to the next instruction, which doesn't decrement x or y
+                return arg2(inst) == next(pc) && arg1(inst) != 2 && arg1(inst) != 4;
+            case 5: // mov x, x or mov y, y
+                return (arg1(inst) == 1 || arg1(inst) == 2) && arg2(inst) == arg1(inst);
+            default:
+                return false;
+        }
+    }
+
+    // set x/y or mov x/y, whose only effect is writing the register
+    static int written_register(uint inst) {
+        if ((major(inst) == 7 || major(inst) == 5) && (arg1(inst) == 1 || arg1(inst) == 2)) return (int)arg1(inst);
+        return -1;
+    }
+
+    // set x/y or mov x/y which doesn't read the register it writes, nor anything which changes over time
+    static bool overwrites_register(uint inst, int reg) {
+        if (written_register(inst) != reg) return false;
+        if (major(inst) == 7) return true;
+        uint src = arg2(inst) & 7u;
+        return (int)src != reg && src != 0 /* pins */ && src != 5 /* status */;
+    }
+
+    // removes an instruction which is not referenced by anything which is kept
+    void remove(uint index) {
+        auto remap = [&](uint v) { return v > index ? v - 1 : v; };
+        program.instructions.erase(program.instructions.begin() + index);
+        result.original_index.erase(result.original_index.begin() + index);
+        for (auto &inst : program.instructions) {
+            if (is_jmp(inst)) inst = (inst & ~0x1fu) | remap(arg2(inst));
+        }
+        if (program.wrap == (int)index && index) program.wrap = index - 1;
+        else program.wrap = remap(program.wrap);
+        program.wrap_target = remap(program.wrap_target);
+        for (auto &s : program.symbols) {
+            if (s.is_label) s.value = remap(s.value);
+        }
+    }
+
+    bool remove_unreachable() {
+        uint32_t reachable = 0;
+        std::vector<uint> pending;
+        uint32_t entries = entry_mask();
+        for (uint i = 0; i < size(); i++) {
+            if (entries & (1u << i)) pending.push_back(i);
+        }
+        while (!pending.empty()) {
+            uint pc = pending.back();
+            pending.pop_back();
+            if (reachable & (1u << pc)) continue;
+            reachable |= 1u << pc;
+            uint inst = program.instructions[pc];
+            if (is_jmp(inst)) {
+                pending.push_back(arg2(inst));
+                if (!arg1(inst)) continue;
+            }
+            pending.push_back(next(pc));
+        }
+        bool wrap_removed = !(reachable & (1u << program.wrap));
+        bool changed = false;
+        for (int i = (int)size() - 1; i >= 0; i--) {
+            if (!(reachable & (1u << i))) {
+                remove(i);
+                changed = true;
+            }
+        }
+        // nothing which is left falls through to the old .wrap, so put it at the end
+        if (wrap_removed) program.wrap = size() - 1;
+        return changed;
+    }
+
+    // whether instruction n can be removed, with its cycles added to the delay of the preceding instruction p
+    bool can_merge(uint p, uint n) const {
+        uint32_t fixed = entry_mask() | jump_target_mask();
+        uint pi = program.instructions[p], ni = program.instructions[n];
+        return !(fixed & (1u << n)) && (int)p != program.wrap && !is_jmp(pi) &&
+               (!has_sideset(ni) || sideset(ni) == sideset(pi)) &&
+               delay(pi) + 1 + delay(ni) <= delay_mask;
+    }
+
+    bool merge_pairs() {
+        for (uint n = 1; n < size(); n++) {
+            uint p = n - 1;
+            if (!can_merge(p, n)) continue;
+            uint pi = program.instructions[p], ni = program.instructions[n];
+            uint total_delay = delay(pi) + 1 + delay(ni);
+            if (is_nop(n)) {
+                program.instructions[p] = with_delay_sideset(pi, total_delay, sideset(pi));
+            } else if (written_register(pi) >= 0 && overwrites_register(ni, written_register(pi))) {
+                // the value written by p is never used, so do n (with p's side-set) in its place
+                program.instructions[p] = with_delay_sideset(ni, total_delay, sideset(pi));
+            } else {
+                continue;
+            }
+            remove(n);
+            return true;
+        }
+        return false;
+    }
+
+    bool remove_trailing_jmp() {
+        uint w = program.wrap;
+        if (!w) return false;
+        uint inst = program.instructions[w];
+        if (!is_jmp(inst) || arg1(inst) || !can_merge(w - 1, w)) return false;
+        uint pi = program.instructions[w - 1];
+        program.instructions[w - 1] = with_delay_sideset(pi, delay(pi) + 1 + delay(inst), sideset(pi));
+        program.wrap_target = arg2(inst);
+        remove(w);
+        return true;
+    }
+
+    void run() {
+        for (uint pc = 0; pc < size(); pc++) {
+            uint inst = program.instructions[pc];
+            if (is_computed_jump(inst)) {
+                result.skipped_reason = "it jumps via OUT/MOV to PC or EXEC";
+                break;
+            }
+            bool falls_through = !is_jmp(inst) || arg1(inst);
+            if (falls_through && next(pc) >= size()) {
+                result.skipped_reason = "it runs off the end of the program";
+                break;
+            }
+        }
+        if (result.skipped_reason.empty() && size()) {
+            while (remove_unreachable() || merge_pairs() || remove_trailing_jmp()) {}
+        }
+        result.optimized_length = size();
+    }
+};
+
+}
+
+pio_optimization optimize_program(compiled_source::program &program) {
+    optimizer o(program);
+    o.run();
+    return o.result;
+}
+
+namespace {
+
+// a choice the environment makes before a cycle of the equivalence check
+struct environment_choice {
+    uint32_t pin_inputs;
+    uint8_t irq_set;
+    int tx_word; // index into TX_WORDS, or -1 to leave the TX FIFO alone
+    bool rx_get;
+};
+
+const uint32_t TX_WORDS[] = {0, 0xa5a5a5a5u};
+const uint32_t XY_VALUES[] = {0, 1, 0xffffffffu};
+
+// the pins (relative to gpio_base) read by wait and jmp pin instructions, whose every combination of levels is tried,
+// and whether the program reads pins as data (by in or mov), for which all low and all high levels are tried
+void find_pin_inputs(const pio_simulator &sim, const pio_simulator::sm_config &c, uint32_t &control_pins,
+                     bool &data_pins, uint8_t &waited_irqs) {
+    control_pins = 0;
+    data_pins = false;
+    waited_irqs = 0;
+    for (uint i = 0; i < pio_simulator::INSTRUCTION_COUNT; i++) {
+        if (!(sim.used_instr_mask & (1u << i))) continue;
+        uint inst = sim.instr_mem[i];
+        switch (major(inst)) {
+            case 0:
+                if (arg1(inst) == 6) control_pins |= 1u << (c.jmp_pin % 32);
+                break;
+            case 1:
+                switch (arg1(inst) & 3u) {
+                    case 0: control_pins |= 1u << (arg2(inst) % 32); break;
+                    case 1: control_pins |= 1u << ((c.in_base + arg2(inst)) % 32); break;
+                    case 2: waited_irqs |= (uint8_t)(1u << (arg2(inst) & 7u)); break;
+                    default: control_pins |= 1u << ((c.jmp_pin + (arg2(inst) & 3u)) % 32); break;
+                }
+                break;
+            case 2:
+                if (arg1(inst) == 0) data_pins = true;
+                break;
+            case 5:
+                if ((arg2(inst) & 7u) == 0) data_pins = true;
+                break;
+        }
+    }
+}
+
+struct equivalence_state {
+    uint config;
+    pio_simulator a, b;
+};
+
+}
+
+pio_equivalence check_equivalence(const compiled_source::program &original, const compiled_source::program &optimized,
+                                  const pio_optimization &optimization) {
+    const uint MAX_STATES = 1u << 17;
+    const uint MAX_CYCLES = 1000;
+    pio_equivalence result;
+    result.complete = true;
+    result.cycles = MAX_CYCLES;
+    // pairs of the same entry point in the original and optimized programs
+    std::vector<std::pair<uint, uint>> entries;
+    entries.emplace_back(0, 0);
+    for (uint i = 0; i < original.symbols.size() && i < optimized.symbols.size(); i++) {
+        if (original.symbols[i].is_label) entries.emplace_back(original.symbols[i].value, optimized.symbols[i].value);
+    }
+    for (const auto &entry : entries) {
+        pio_simulator a(original.pio_version), b(optimized.pio_version);
+        int offset_a = a.add_program(original);
+        int offset_b = b.add_program(optimized);
+        if (offset_a < 0 || offset_b < 0) {
+            result.difference = "program could not be loaded";
+            return result;
+        }
+        // the pin mappings (overlapping, or separate) and, unless specified by the program, the shift configuration
+        // are chosen at runtime
+        std::vector<std::pair<pio_simulator::sm_config, pio_simulator::sm_config>> configs;
+        for (uint mapping = 0; mapping < 2; mapping++) {
+            for (uint autop = 0; autop < 4; autop++) {
+                auto ca = pio_simulator::default_config(original, offset_a);
+                auto cb = pio_simulator::default_config(optimized, offset_b);
+                for (auto *c : {&ca, &cb}) {
+                    if (mapping) {
+                        c->set_base = 8;
+                        c->sideset_base = 13;
+                        c->in_base = 16;
+                        c->jmp_pin = 24;
+                    }
+                    if (original.out.pin_count < 0) {
+                        c->out_count = 8;
+                        c->autopull = autop & 1u;
+                        c->pull_threshold = 8;
+                    }
+                    if (original.set_count < 0) c->set_count = 5;
+                    if (original.in.pin_count < 0) {
+                        c->autopush = autop & 2u;
+                        c->push_threshold = 8;
+                    }
+                }
+                if (original.out.pin_count >= 0 && (autop & 1u)) continue;
+                if (original.in.pin_count >= 0 && (autop & 2u)) continue;
+                configs.emplace_back(ca, cb);
+            }
+        }
+        std::vector<equivalence_state> frontier;
+        std::unordered_set<std::string> visited;
+        std::vector<std::vector<environment_choice>> choices;
+        for (uint ci = 0; ci < configs.size(); ci++) {
+            uint32_t control_pins;
+            bool data_pins;
+            uint8_t waited_irqs;
+            find_pin_inputs(a, configs[ci].first, control_pins, data_pins, waited_irqs);
+            choices.emplace_back();
+            for (uint32_t data : {0u, 0xffffffffu}) {
+                if (data && !data_pins) break;
+                // every combination of levels on the control pins
+                uint32_t levels = 0;
+                do {
+                    for (uint irq = 0; irq <= pio_simulator::NUM_IRQS; irq++) {
+                        uint8_t irq_set = irq < pio_simulator::NUM_IRQS ? (uint8_t)(1u << irq) : 0;
+                        if (irq_set && !(waited_irqs & irq_set)) continue;
+                        for (int tx_word = -1; tx_word < (int)(sizeof(TX_WORDS) / sizeof(TX_WORDS[0])); tx_word++) {
+                            for (bool rx_get : {false, true}) {
+                                choices.back().push_back({(data & ~control_pins) | levels, irq_set, tx_word, rx_get});
+                            }
+                        }
+                    }
+                    levels = (levels - control_pins) & control_pins;
+                } while (levels);
+            }
+            for (uint32_t x : XY_VALUES) {
+                for (uint32_t y : XY_VALUES) {
+                    equivalence_state state{ci, a, b};
+                    state.a.sm_init(0, offset_a + entry.first, configs[ci].first);
+                    state.b.sm_init(0, offset_b + entry.second, configs[ci].second);
+                    state.a.sms[0].x = state.b.sms[0].x = x;
+                    state.a.sms[0].y = state.b.sms[0].y = y;
+                    state.a.sm_set_enabled(0, true);
+                    state.b.sm_set_enabled(0, true);
+                    frontier.push_back(std::move(state));
+                }
+            }
+        }
+        // breadth first search of the states the pair of programs can reach, so that when the number of states is
+        // limited, every behaviour of up to a given number of cycles has still been checked
+        uint cycle;
+        bool truncated = false;
+        for (cycle = 0; cycle < MAX_CYCLES && !frontier.empty() && !truncated; cycle++) {
+            std::vector<equivalence_state> next;
+            for (const auto &state : frontier) {
+                for (const auto &choice : choices[state.config]) {
+                    equivalence_state s = state;
+                    for (auto *sim : {&s.a, &s.b}) {
+                        sim->pin_inputs = choice.pin_inputs;
+                        sim->irq_flags |= choice.irq_set;
+                        if (choice.tx_word >= 0) sim->tx_fifo_put(0, TX_WORDS[choice.tx_word]);
+                    }
+                    if (choice.rx_get) {
+                        // the RX FIFO contents are compared after every cycle, so the data read is the same
+                        uint32_t ignored;
+                        s.a.rx_fifo_get(0, ignored);
+                        s.b.rx_fifo_get(0, ignored);
+                    }
+                    s.a.step();
+                    s.b.step();
+                    const auto &sa = s.a.sms[0], &sb = s.b.sms[0];
+                    const char *what = nullptr;
+                    if (s.a.pin_values != s.b.pin_values) what = "pin values";
+                    else if (s.a.pin_dirs != s.b.pin_dirs) what = "pin directions";
+                    else if (s.a.irq_flags != s.b.irq_flags) what = "IRQ flags";
+                    else if (sa.tx_fifo.size() != sb.tx_fifo.size()) what = "TX FIFO level";
+                    else if (sa.rx_fifo != sb.rx_fifo) what = "RX FIFO contents";
+                    if (what) {
+                        std::stringstream ss;
+                        ss << "entry " << entry.first << ", cycle " << cycle << ": " << what << " differ";
+                        result.difference = ss.str();
+                        return result;
+                    }
+                    if (truncated) continue;
+                    std::string key((const char *)&s.config, sizeof(s.config));
+                    s.a.append_state_key(key);
+                    s.b.append_state_key(key);
+                    if (visited.insert(std::move(key)).second) {
+                        next.push_back(std::move(s));
+                        truncated = visited.size() >= MAX_STATES;
+                    }
+                }
+            }
+            frontier = std::move(next);
+        }
+        if (!frontier.empty()) {
+            result.complete = false;
+            result.cycles = std::min(result.cycles, cycle);
+        }
+    }
+    return result;
+}
+
+void optimize_programs(compiled_source &source) {
+    for (auto &program : source.programs) {
+        compiled_source::program original = program;
+        pio_optimization result = optimize_program(program);
+        if (!result.skipped_reason.empty()) {
+            std::cerr << "info: program '" << program.name << "' not optimized as " << result.skipped_reason << "\n";
+        } else if (result.optimized_length != result.original_length) {
+            pio_equivalence equivalence = check_equivalence(original, program, result);
+            if (!equivalence.difference.empty()) {
+                std::cerr << "warning: optimized program '" << program.name << "' does not match the original ("
+                          << equivalence.difference << "), so it has not been optimized\n";
+                program = original;
+            } else {
+                std::cerr << "info: program '" << program.name << "' optimized from " << result.original_length
+                          << " to " << result.optimized_length << " instructions (";
+                if (equivalence.complete) std::cerr << "checked exhaustively";
+                else std::cerr << "checked exhaustively for " << equivalence.cycles << " cycles";
+                std::cerr << ")\n";
+            }
+        }
+    }
+}
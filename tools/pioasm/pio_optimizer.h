@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _PIO_OPTIMIZER_H
+#define _PIO_OPTIMIZER_H
+
+#include <string>
+#include <vector>
+#include "output_format.h"
+
+// Peephole optimization of an assembled program to reduce the number of instruction slots it uses, whilst
+// preserving its behaviour cycle for cycle (pins, pin directions, IRQ flags and FIFO accesses). The passes are:
+//
+// - removal of instructions which cannot be reached from the start of the program, .wrap_target or a public label
+// - folding of instructions which do nothing (nop, mov x, x, or a jmp to the next instruction) into the delay of the
+//   preceding instruction, when the side-set allows
+// - merging a set/mov to x or y whose value is overwritten by the next instruction into that instruction (as a delay)
+// - replacing an unconditional jmp at .wrap by moving .wrap and .wrap_target, folding the jmp into the delay of the
+//   preceding instruction
+//
+// Programs which jump via OUT/MOV to PC or EXEC are left alone, as any instruction may be a jump target.
+struct pio_optimization {
+    uint original_length = 0;
+    uint optimized_length = 0;
+    // for each instruction of the optimized program, the index of the original instruction it replaces
+    std::vector<uint> original_index;
+    std::string skipped_reason; // non empty if the program could not be optimized
+};
+
+pio_optimization optimize_program(compiled_source::program &program);
+
+struct pio_equivalence {
+    std::string difference; // non empty if a difference was found
+    bool complete = false;  // every state the programs can reach was checked
+    uint cycles = 0;        // if not complete, the number of cycles for which every behaviour was checked
+};
+
+// Checks that the optimized program behaves the same as the original one (pins, pin directions, IRQ flags and FIFO
+// accesses, cycle by cycle) from each entry point (the start of the program and any public labels). Both programs
+// are simulated in lockstep, searching every state they can reach from a bounded set of starting conditions: x and y
+// of 0, 1 or 0xffffffff, overlapping or separate pin mappings, and autopull/autopush on or off unless the program
+// specifies them. On every cycle the environment may drive each pin read by wait or jmp pin either way (and the pins
+// read by in or mov all low or all high), write one of two words to the TX FIFO, read the RX FIFO, and set any IRQ
+// flag the program waits on. If there are too many states, the check covers every behaviour up to some number of
+// cycles rather than every reachable state.
+pio_equivalence check_equivalence(const compiled_source::program &original, const compiled_source::program &optimized,
+                                  const pio_optimization &optimization);
+
+// optimizes each program, reporting the result on stderr; a program which fails check_equivalence() is left as it was
+void optimize_programs(compiled_source &source);
+
+#endif
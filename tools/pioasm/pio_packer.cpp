@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <algorithm>
+#include <sstream>
+#include "pio_packer.h"
+
+namespace {
+
+const uint INSTRUCTION_COUNT = 32;
+const uint NOP = 0xa042; // mov y, y
+
+bool is_jmp(uint inst) {
+    return !((inst >> 13u) & 7u);
+}
+
+struct slot {
+    bool used = false;
+    uint inst = 0; // with the jmp target cleared
+    int target = -1; // for a jmp, the target relative to the start of the chain (or image)
+};
+
+// a sequence of instructions containing one or more programs
+struct chain {
+    std::vector<slot> slots;
+    std::vector<std::pair<uint, uint>> members; // program index, offset within the chain
+};
+
+bool slots_match(const slot &a, const slot &b, int b_shift) {
+    return a.inst == b.inst && (a.target < 0 || a.target == b.target + b_shift);
+}
+
+// the number of slots shared if b is placed at shift within a, or 0 if the instructions don't match
+uint overlap(const chain &a, const chain &b, uint shift) {
+    uint shared = std::min(a.slots.size() - shift, b.slots.size());
+    for (uint i = 0; i < shared; i++) {
+        if (!slots_match(a.slots[shift + i], b.slots[i], shift)) return 0;
+    }
+    return shared;
+}
+
+void merge(chain &a, const chain &b, uint shift) {
+    for (uint i = a.slots.size() - shift; i < b.slots.size(); i++) {
+        slot s = b.slots[i];
+        if (s.target >= 0) s.target += shift;
+        a.slots.push_back(s);
+    }
+    for (const auto &m : b.members) a.members.emplace_back(m.first, m.second + shift);
+}
+
+}
+
+pio_packing pack_programs(const std::vector<compiled_source::program> &programs) {
+    pio_packing packing;
+    packing.offsets.resize(programs.size());
+    std::vector<chain> anchored, floating;
+    for (uint i = 0; i < programs.size(); i++) {
+        const auto &program = programs[i];
+        packing.pio_version = std::max(packing.pio_version, program.pio_version);
+        packing.used_gpio_ranges |= program.used_gpio_ranges;
+        packing.unpacked_length += program.instructions.size();
+        chain c;
+        c.members.emplace_back(i, 0);
+        for (uint inst : program.instructions) {
+            slot s;
+            s.used = true;
+            if (is_jmp(inst)) {
+                s.inst = inst & ~0x1fu;
+                s.target = (int)(inst & 0x1fu);
+            } else {
+                s.inst = inst;
+            }
+            c.slots.push_back(s);
+        }
+        if (program.origin.get() >= 0) anchored.push_back(c); else floating.push_back(c);
+    }
+
+    // greedily share the most slots we can between pairs of floating chains
+    while (true) {
+        uint best = 0, best_a = 0, best_b = 0, best_shift = 0;
+        for (uint a = 0; a < floating.size(); a++) {
+            for (uint b = 0; b < floating.size(); b++) {
+                if (a == b) continue;
+                for (uint shift = 0; shift < floating[a].slots.size(); shift++) {
+                    uint shared = overlap(floating[a], floating[b], shift);
+                    if (shared > best) {
+                        best = shared;
+                        best_a = a;
+                        best_b = b;
+                        best_shift = shift;
+                    }
+                }
+            }
+        }
+        if (!best) break;
+        merge(floating[best_a], floating[best_b], best_shift);
+        floating.erase(floating.begin() + best_b);
+    }
+
+    // now lay out the instruction memory, with the programs with an .origin where they must be
+    std::vector<slot> mem(INSTRUCTION_COUNT);
+    auto fits = [&](const chain &c, uint offset, uint &shared) {
+        shared = 0;
+        if (offset + c.slots.size() > INSTRUCTION_COUNT) return false;
+        for (uint i = 0; i < c.slots.size(); i++) {
+            const slot &m = mem[offset + i];
+            if (!m.used) continue;
+            if (!slots_match(m, c.slots[i], offset)) return false;
+            shared++;
+        }
+        return true;
+    };
+    auto place = [&](const chain &c, uint offset) {
+        for (uint i = 0; i < c.slots.size(); i++) {
+            slot s = c.slots[i];
+            if (s.target >= 0) s.target += offset;
+            mem[offset + i] = s;
+        }
+        for (const auto &m : c.members) packing.offsets[m.first] = offset + m.second;
+    };
+    for (const auto &c : anchored) {
+        const auto &program = programs[c.members[0].first];
+        uint origin = program.origin.get(), shared;
+        if (!fits(c, origin, shared)) {
+            packing.error = "program '" + program.name + "' cannot be placed at its .origin " + std::to_string(origin) +
+                            " as it overlaps another program";
+            return packing;
+        }
+        place(c, origin);
+        packing.origin = 0;
+    }
+    std::sort(floating.begin(), floating.end(), [](const chain &a, const chain &b) {
+        return a.slots.size() > b.slots.size();
+    });
+    for (const auto &c : floating) {
+        int best_offset = -1;
+        uint best_shared = 0;
+        for (uint offset = 0; offset < INSTRUCTION_COUNT; offset++) {
+            uint shared;
+            if (fits(c, offset, shared) && (best_offset < 0 || shared > best_shared)) {
+                best_offset = (int)offset;
+                best_shared = shared;
+            }
+        }
+        if (best_offset < 0) {
+            std::stringstream ss;
+            ss << "programs do not fit in " << INSTRUCTION_COUNT << " instructions (" << packing.unpacked_length
+               << " without sharing)";
+            packing.error = ss.str();
+            return packing;
+        }
+        place(c, best_offset);
+    }
+
+    // the image starts at the first used slot (which is its origin if any programs have one)
+    uint start = INSTRUCTION_COUNT, end = 0;
+    for (uint i = 0; i < INSTRUCTION_COUNT; i++) {
+        if (mem[i].used) {
+            start = std::min(start, i);
+            end = i + 1;
+        }
+    }
+    if (start == INSTRUCTION_COUNT) start = 0;
+    if (packing.origin >= 0) packing.origin = (int)start;
+    for (auto &offset : packing.offsets) offset -= std::min(offset, start);
+    for (uint i = start; i < end; i++) {
+        const slot &s = mem[i];
+        if (!s.used) packing.instructions.push_back(NOP);
+        else if (s.target >= 0) packing.instructions.push_back(s.inst | (uint)(s.target - start));
+        else packing.instructions.push_back(s.inst);
+    }
+    return packing;
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _PIO_PACKER_H
+#define _PIO_PACKER_H
+
+#include <string>
+#include <vector>
+#include "output_format.h"
+
+// A single instruction memory image holding a group of programs, so that they can be loaded together with one
+// pio_add_program() rather than each one searching for space (and possibly failing due to fragmentation).
+//
+// Programs share instruction slots where they can: a program identical to part of another is placed within it, and
+// a program whose first instructions are the same as the last instructions of another overlaps it. Instructions
+// only match if their encoding is the same once loaded, so jmps must have the same target relative to the image.
+// Programs with an .origin are placed at that offset within the instruction memory (and the image then has an
+// origin), with the other programs filling the gaps.
+struct pio_packing {
+    // the image, with jmp targets relative to its start (like a single program)
+    std::vector<uint> instructions;
+    // the offset of each program within the image
+    std::vector<uint> offsets;
+    int origin = -1;
+    int pio_version = 0;
+    uint8_t used_gpio_ranges = 0;
+    // the number of instruction slots the programs would use if loaded separately
+    uint unpacked_length = 0;
+    std::string error; // non empty if the programs could not be packed
+};
+
+pio_packing pack_programs(const std::vector<compiled_source::program> &programs);
+
+#endif
@@ -0,0 +1,532 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <algorithm>
+#include "pio_simulator.h"
+
+static uint32_t bit_reverse(uint32_t v) {
+    uint32_t result = 0;
+    for (uint i = 0; i < 32; i++) {
+        result = (result << 1u) | (v & 1u);
+        v >>= 1u;
+    }
+    return result;
+}
+
+static uint32_t rotate_right(uint32_t v, uint n) {
+    n &= 31u;
+    return n ? (v >> n) | (v << (32u - n)) : v;
+}
+
+static uint32_t low_bits(uint n) {
+    return n >= 32 ? 0xffffffffu : (1u << n) - 1u;
+}
+
+uint pio_simulator::state_machine::tx_depth() const {
+    switch (config.fifo) {
+        case fifo_config::tx:
+            return FIFO_DEPTH * 2;
+        case fifo_config::rx:
+            return 0;
+        default:
+            return FIFO_DEPTH;
+    }
+}
+
+uint pio_simulator::state_machine::rx_depth() const {
+    switch (config.fifo) {
+        case fifo_config::txrx:
+            return FIFO_DEPTH;
+        case fifo_config::rx:
+            return FIFO_DEPTH * 2;
+        default:
+            // joined into the TX FIFO, or used as FIFO registers
+            return 0;
+    }
+}
+
+int pio_simulator::add_program(const compiled_source::program &program) {
+    uint length = program.instructions.size();
+    if (!length || length > INSTRUCTION_COUNT) return -1;
+    uint32_t program_mask = low_bits(length);
+    int offset = -1;
+    if (program.origin.get() >= 0) {
+        uint origin = program.origin.get();
+        if (origin <= INSTRUCTION_COUNT - length && !(used_instr_mask & (program_mask << origin))) {
+            offset = (int)origin;
+        }
+    } else {
+        // work down from the top like pio_add_program
+        for (int i = (int)(INSTRUCTION_COUNT - length); i >= 0; i--) {
+            if (!(used_instr_mask & (program_mask << (uint) i))) {
+                offset = i;
+                break;
+            }
+        }
+    }
+    if (offset < 0) return -1;
+    for (uint i = 0; i < length; i++) {
+        uint instr = program.instructions[i];
+        uint major = (instr >> 13u) & 7u;
+        if (major == 0) {
+            instr += (uint)offset;
+        } else if (major == 1 && !(((instr >> 5u) & 3u))) {
+            // wait gpio; the assembler stores bit 5 of the GPIO number above the 16 bits of instruction
+            uint gpio = (instr & 0x1fu) | (((instr >> 16u) & 1u) << 5u);
+            instr = (instr & ~0x1fu) | ((gpio - gpio_base) & 0x1fu);
+        }
+        instr_mem[offset + i] = instr & 0xffffu;
+    }
+    used_instr_mask |= program_mask << (uint)offset;
+    return offset;
+}
+
+pio_simulator::sm_config pio_simulator::default_config(const compiled_source::program &program, uint offset) {
+    sm_config c;
+    c.wrap_target = offset + program.wrap_target;
+    c.wrap = offset + program.wrap;
+    if (program.in.pin_count >= 0) {
+        c.in_count = program.in.pin_count;
+        c.in_shift_right = program.in.right;
+        c.autopush = program.in.autop;
+        c.push_threshold = program.in.threshold;
+    }
+    if (program.out.pin_count >= 0) {
+        c.out_count = program.out.pin_count;
+        c.out_shift_right = program.out.right;
+        c.autopull = program.out.autop;
+        c.pull_threshold = program.out.threshold;
+    }
+    if (program.set_count >= 0) {
+        c.set_count = program.set_count;
+    }
+    if (program.sideset_bits_including_opt.is_specified()) {
+        c.sideset_bits_including_opt = program.sideset_bits_including_opt.get();
+        c.sideset_opt = program.sideset_opt;
+        c.sideset_pindirs = program.sideset_pindirs;
+    }
+    if (program.mov_status_type != -1) {
+        c.mov_status_type = program.mov_status_type;
+        c.mov_status_n = program.mov_status_n;
+    }
+    c.fifo = program.fifo;
+    c.clkdiv_int = program.clock_div_int;
+    c.clkdiv_frac = program.clock_div_frac;
+    return c;
+}
+
+void pio_simulator::sm_init(uint sm_num, uint initial_pc, const sm_config &config) {
+    state_machine &sm = sms[sm_num];
+    sm.enabled = false;
+    sm.config = config;
+    sm.tx_fifo.clear();
+    sm.rx_fifo.clear();
+    sm.isr = sm.osr = 0;
+    sm.isr_count = 0;
+    sm.osr_count = 32;
+    sm.delay = 0;
+    sm.exec_pending = false;
+    sm.irq_wait_set = false;
+    sm.stalled = not_stalled;
+    sm.pc = initial_pc % INSTRUCTION_COUNT;
+    sm.stats = {};
+}
+
+void pio_simulator::sm_set_enabled(uint sm_num, bool enabled) {
+    state_machine &sm = sms[sm_num];
+    if (enabled && !sm.enabled) {
+        // so that the state machine ticks on the first cycle it is enabled
+        uint div = sm.config.clkdiv_int * 256 + sm.config.clkdiv_frac;
+        sm.clkdiv_acc = div - 256;
+    }
+    sm.enabled = enabled;
+}
+
+void pio_simulator::sm_exec(uint sm_num, uint instr) {
+    state_machine &sm = sms[sm_num];
+    sm.exec_pending = true;
+    sm.exec_instr = instr & 0xffffu;
+    sm.delay = 0;
+}
+
+bool pio_simulator::tx_fifo_put(uint sm_num, uint32_t value) {
+    state_machine &sm = sms[sm_num];
+    if (sm.tx_fifo.size() >= sm.tx_depth()) return false;
+    sm.tx_fifo.push_back(value);
+    return true;
+}
+
+bool pio_simulator::rx_fifo_get(uint sm_num, uint32_t &value) {
+    state_machine &sm = sms[sm_num];
+    if (sm.rx_fifo.empty()) return false;
+    value = sm.rx_fifo.front();
+    sm.rx_fifo.erase(sm.rx_fifo.begin());
+    return true;
+}
+
+void pio_simulator::step() {
+    // inputs reach the state machines through a 2 flip-flop synchronizer
+    sync_pins[1] = sync_pins[0];
+    sync_pins[0] = (pin_dirs & pin_values) | (~pin_dirs & pin_inputs);
+    irq_set_next = irq_clear_next = 0;
+    // state machines are evaluated in order, so a higher numbered state machine wins when driving the same pin
+    for (uint i = 0; i < NUM_STATE_MACHINES; i++) {
+        state_machine &sm = sms[i];
+        if (!sm.enabled) continue;
+        sm.stats.cycles++;
+        uint div = sm.config.clkdiv_int * 256 + sm.config.clkdiv_frac;
+        sm.clkdiv_acc += 256;
+        if (sm.clkdiv_acc >= div) {
+            sm.clkdiv_acc -= div;
+            tick(i);
+        }
+    }
+    // IRQ flag changes are seen by all state machines on the following cycle
+    irq_flags = (uint8_t)((irq_flags & ~irq_clear_next) | irq_set_next);
+    cycle++;
+}
+
+void pio_simulator::append_state_key(std::string &key) const {
+    auto append = [&](uint32_t v) { key.append((const char *)&v, sizeof(v)); };
+    append(irq_flags | (irq_set_next << 8u) | (irq_clear_next << 16u));
+    append(pin_values);
+    append(pin_dirs);
+    append(pin_inputs);
+    append(sync_pins[0]);
+    append(sync_pins[1]);
+    for (uint i = 0; i < NUM_STATE_MACHINES; i++) {
+        const state_machine &sm = sms[i];
+        if (!sm.enabled) continue;
+        append(sm.pc | (sm.delay << 8u) | (sm.stalled << 16u) | (sm.exec_pending << 24u) | (sm.irq_wait_set << 25u) |
+               (i << 26u));
+        append(sm.exec_instr);
+        append(sm.x);
+        append(sm.y);
+        append(sm.isr);
+        append(sm.osr);
+        append(sm.isr_count | (sm.osr_count << 8u) | (sm.clkdiv_acc << 16u));
+        append((uint32_t)sm.tx_fifo.size() | ((uint32_t)sm.rx_fifo.size() << 8u));
+        for (uint32_t v : sm.tx_fifo) append(v);
+        for (uint32_t v : sm.rx_fifo) append(v);
+        for (uint32_t v : sm.rx_regs) append(v);
+    }
+}
+
+void pio_simulator::tick(uint sm_num) {
+    state_machine &sm = sms[sm_num];
+    sm.stats.ticks++;
+    // autopull refills an empty OSR in the background
+    if (sm.config.autopull && sm.osr_count >= sm.config.pull_threshold && !sm.tx_fifo.empty()) {
+        sm.osr = sm.tx_fifo.front();
+        sm.tx_fifo.erase(sm.tx_fifo.begin());
+        sm.osr_count = 0;
+        sm.stats.words_pulled++;
+    }
+    if (sm.delay) {
+        sm.delay--;
+        sm.stats.delay_ticks++;
+        return;
+    }
+    bool exec = sm.exec_pending;
+    uint instr = exec ? sm.exec_instr : instr_mem[sm.pc];
+    uint delay_side = (instr >> 8u) & 0x1fu;
+    uint sideset_bits = sm.config.sideset_bits_including_opt;
+    if (execute(sm_num, instr, exec)) {
+        sm.stats.instructions++;
+        uint major = instr >> 13u, arg1 = (instr >> 5u) & 7u;
+        bool is_exec = (major == 3 && arg1 == 7) || (major == 5 && arg1 == 4);
+        // the delay of an OUT/MOV EXEC is ignored; the executed instruction's delay applies instead
+        if (!is_exec) sm.delay = delay_side & low_bits(5 - sideset_bits);
+    } else {
+        sm.stats.stall_ticks[sm.stalled]++;
+    }
+    // side-set takes effect on the first cycle of the instruction, even if it stalls, and has priority over
+    // OUT/SET/MOV to the same pins
+    if (sideset_bits && (!sm.config.sideset_opt || (delay_side & 0x10u))) {
+        uint count = sideset_bits - (sm.config.sideset_opt ? 1 : 0);
+        uint value = (delay_side >> (5 - sideset_bits)) & low_bits(count);
+        write_pins(sm.config.sideset_base, count, value, sm.config.sideset_pindirs);
+    }
+}
+
+uint32_t pio_simulator::read_pins(const state_machine &sm) const {
+    uint32_t value = rotate_right(sync_pins[1], sm.config.in_base);
+    if (pio_version > 0) value &= low_bits(sm.config.in_count);
+    return value;
+}
+
+void pio_simulator::write_pins(uint base, uint count, uint32_t value, bool dirs) {
+    uint32_t &reg = dirs ? pin_dirs : pin_values;
+    for (uint i = 0; i < count; i++) {
+        uint32_t bit = 1u << ((base + i) % NUM_PINS);
+        if (value & (1u << i)) reg |= bit; else reg &= ~bit;
+    }
+}
+
+uint pio_simulator::irq_index(uint sm_num, uint index, bool &local) const {
+    uint type = (index >> 3u) & 3u;
+    // types 1 and 3 are the previous and next PIO blocks
+    local = !(type & 1u);
+    if (type == 2) {
+        return (index & 4u) | ((index + sm_num) & 3u);
+    }
+    return index & 7u;
+}
+
+void pio_simulator::advance_pc(state_machine &sm) {
+    if (sm.pc == sm.config.wrap) {
+        sm.pc = sm.config.wrap_target;
+    } else {
+        sm.pc = (sm.pc + 1) % INSTRUCTION_COUNT;
+    }
+}
+
+// returns false if the instruction stalled (with the reason in stalled), true if it completed
+bool pio_simulator::execute(uint sm_num, uint instr, bool exec) {
+    state_machine &sm = sms[sm_num];
+    sm_config &c = sm.config;
+    uint major = (instr >> 13u) & 7u;
+    uint arg1 = (instr >> 5u) & 7u;
+    uint arg2 = instr & 0x1fu;
+    bool jumped = false;
+    bool exec_next = false;
+    uint32_t exec_value = 0;
+
+    auto stall = [&](stall_reason reason) {
+        sm.stalled = reason;
+        return false;
+    };
+    auto pull_word = [&]() {
+        if (sm.tx_fifo.empty()) return false;
+        sm.osr = sm.tx_fifo.front();
+        sm.tx_fifo.erase(sm.tx_fifo.begin());
+        sm.osr_count = 0;
+        sm.stats.words_pulled++;
+        return true;
+    };
+    auto push_word = [&]() {
+        sm.rx_fifo.push_back(sm.isr);
+        sm.isr = 0;
+        sm.isr_count = 0;
+        sm.stats.words_pushed++;
+    };
+    auto rx_full = [&]() {
+        return sm.rx_fifo.size() >= sm.rx_depth();
+    };
+    auto pin_sample = [&](uint pin) {
+        return (bool)((sync_pins[1] >> (pin % NUM_PINS)) & 1u);
+    };
+    auto mov_status = [&]() -> uint32_t {
+        switch (c.mov_status_type) {
+            case 0:
+                return sm.tx_fifo.size() < c.mov_status_n ? 0xffffffffu : 0;
+            case 1:
+                return sm.rx_fifo.size() < c.mov_status_n ? 0xffffffffu : 0;
+            case 2:
+                return c.mov_status_n < NUM_IRQS && (irq_flags & (1u << c.mov_status_n)) ? 0xffffffffu : 0;
+            default:
+                return 0;
+        }
+    };
+
+    switch (major) {
+        case 0: { // jmp
+            bool take;
+            switch (arg1) {
+                case 0: take = true; break;
+                case 1: take = !sm.x; break;
+                case 2: take = sm.x != 0; sm.x--; break;
+                case 3: take = !sm.y; break;
+                case 4: take = sm.y != 0; sm.y--; break;
+                case 5: take = sm.x != sm.y; break;
+                case 6: take = pin_sample(c.jmp_pin); break;
+                default: take = sm.osr_count < c.pull_threshold; break;
+            }
+            if (take) {
+                sm.pc = arg2;
+                jumped = true;
+            }
+            break;
+        }
+        case 1: { // wait
+            bool polarity = arg1 & 4u;
+            bool level;
+            switch (arg1 & 3u) {
+                case 0:
+                    level = pin_sample(arg2);
+                    break;
+                case 1:
+                    level = pin_sample(c.in_base + arg2);
+                    break;
+                case 2: {
+                    bool local;
+                    uint n = irq_index(sm_num, arg2, local);
+                    level = local && (irq_flags & (1u << n));
+                    if (polarity && level) irq_clear_next |= (uint8_t)(1u << n);
+                    break;
+                }
+                default:
+                    level = pin_sample(c.jmp_pin + (arg2 & 3u));
+                    break;
+            }
+            if (level != polarity) return stall(stall_wait);
+            break;
+        }
+        case 2: { // in
+            uint n = arg2 ? arg2 : 32;
+            uint32_t data;
+            switch (arg1) {
+                case 0: data = read_pins(sm); break;
+                case 1: data = sm.x; break;
+                case 2: data = sm.y; break;
+                case 6: data = sm.isr; break;
+                case 7: data = sm.osr; break;
+                default: data = 0; break;
+            }
+            if (c.autopush && sm.isr_count + n >= c.push_threshold && rx_full()) return stall(stall_rx_full);
+            data &= low_bits(n);
+            if (n == 32) {
+                sm.isr = data;
+            } else if (c.in_shift_right) {
+                sm.isr = (sm.isr >> n) | (data << (32 - n));
+            } else {
+                sm.isr = (sm.isr << n) | data;
+            }
+            sm.isr_count = std::min(32u, sm.isr_count + n);
+            sm.stats.bits_in += n;
+            if (c.autopush && sm.isr_count >= c.push_threshold) push_word();
+            break;
+        }
+        case 3: { // out
+            uint n = arg2 ? arg2 : 32;
+            if (c.autopull && sm.osr_count >= c.pull_threshold && !pull_word()) return stall(stall_tx_empty);
+            uint32_t data;
+            if (n == 32) {
+                data = sm.osr;
+                sm.osr = 0;
+            } else if (c.out_shift_right) {
+                data = sm.osr & low_bits(n);
+                sm.osr >>= n;
+            } else {
+                data = sm.osr >> (32 - n);
+                sm.osr <<= n;
+            }
+            sm.osr_count = std::min(32u, sm.osr_count + n);
+            sm.stats.bits_out += n;
+            switch (arg1) {
+                case 0: write_pins(c.out_base, c.out_count, data, false); break;
+                case 1: sm.x = data; break;
+                case 2: sm.y = data; break;
+                case 4: write_pins(c.out_base, c.out_count, data, true); break;
+                case 5: sm.pc = data & 0x1fu; jumped = true; break;
+                case 6: sm.isr = data; sm.isr_count = n; break;
+                case 7: exec_next = true; exec_value = data; break;
+                default: break;
+            }
+            break;
+        }
+        case 4: { // push/pull, and mov to/from the FIFO registers
+            if (arg2 & 0x10u) {
+                uint index = (arg2 & 8u) ? (arg2 & 3u) : (sm.y & 3u);
+                if (arg1 & 4u) {
+                    sm.osr = sm.rx_regs[index];
+                    sm.osr_count = 0;
+                } else {
+                    sm.rx_regs[index] = sm.isr;
+                }
+            } else if (arg1 & 4u) {
+                bool if_empty = arg1 & 2u;
+                bool block = arg1 & 1u;
+                // with ifempty or autopull, pull does nothing unless the OSR is empty
+                if ((if_empty || c.autopull) && sm.osr_count < c.pull_threshold) break;
+                if (!pull_word()) {
+                    if (block) return stall(stall_tx_empty);
+                    sm.osr = sm.x;
+                    sm.osr_count = 0;
+                }
+            } else {
+                bool if_full = arg1 & 2u;
+                bool block = arg1 & 1u;
+                if (if_full && sm.isr_count < c.push_threshold) break;
+                if (rx_full()) {
+                    if (block) return stall(stall_rx_full);
+                    sm.stats.words_dropped++;
+                    sm.isr = 0;
+                    sm.isr_count = 0;
+                } else {
+                    push_word();
+                }
+            }
+            break;
+        }
+        case 5: { // mov
+            uint32_t data;
+            switch (arg2 & 7u) {
+                case 0: data = read_pins(sm); break;
+                case 1: data = sm.x; break;
+                case 2: data = sm.y; break;
+                case 5: data = mov_status(); break;
+                case 6: data = sm.isr; break;
+                case 7: data = sm.osr; break;
+                default: data = 0; break;
+            }
+            switch ((arg2 >> 3u) & 3u) {
+                case 1: data = ~data; break;
+                case 2: data = bit_reverse(data); break;
+                default: break;
+            }
+            switch (arg1) {
+                case 0: write_pins(c.out_base, c.out_count, data, false); break;
+                case 1: sm.x = data; break;
+                case 2: sm.y = data; break;
+                case 3: if (pio_version > 0) write_pins(c.out_base, c.out_count, data, true); break;
+                case 4: exec_next = true; exec_value = data; break;
+                case 5: sm.pc = data & 0x1fu; jumped = true; break;
+                case 6: sm.isr = data; sm.isr_count = 0; break;
+                default: sm.osr = data; sm.osr_count = 0; break;
+            }
+            break;
+        }
+        case 6: { // irq
+            bool local;
+            uint n = irq_index(sm_num, arg2, local);
+            uint8_t bit = (uint8_t)(local ? 1u << n : 0);
+            if (arg1 & 2u) {
+                irq_clear_next |= bit;
+            } else if (arg1 & 1u) {
+                if (!sm.irq_wait_set) {
+                    irq_set_next |= bit;
+                    sm.irq_wait_set = true;
+                    return stall(stall_irq);
+                }
+                if (!local || (irq_flags & bit)) return stall(stall_irq);
+                sm.irq_wait_set = false;
+            } else {
+                irq_set_next |= bit;
+            }
+            break;
+        }
+        default: { // set
+            switch (arg1) {
+                case 0: write_pins(c.set_base, c.set_count, arg2, false); break;
+                case 1: sm.x = arg2; break;
+                case 2: sm.y = arg2; break;
+                case 4: write_pins(c.set_base, c.set_count, arg2, true); break;
+                default: break;
+            }
+            break;
+        }
+    }
+    sm.stalled = not_stalled;
+    if (exec) sm.exec_pending = false;
+    if (exec_next) {
+        sm.exec_pending = true;
+        sm.exec_instr = exec_value & 0xffffu;
+    }
+    // an instruction run via EXEC doesn't advance the PC (unless it is itself a jump)
+    if (!jumped && !exec) advance_pc(sm);
+    return true;
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _PIO_SIMULATOR_H
+#define _PIO_SIMULATOR_H
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "output_format.h"
+
+// Cycle by cycle model of a single PIO block (four state machines sharing 32 instruction slots, 8 IRQ flags and
+// a bank of 32 pins), executing the encoded instructions of compiled_source programs.
+//
+// The model covers the TX/RX FIFOs (including joins and the PIO version 1 FIFO registers), the input and output
+// shift registers with autopush/autopull thresholds, side-set, wrap, delays, IRQ flags, OUT/MOV EXEC, the fractional
+// clock divider and the 2 cycle GPIO input synchronizer. IRQs to the previous/next PIO block (PIO version 1) are
+// not modelled: setting them has no effect, and waiting on them stalls.
+struct pio_simulator {
+    static const uint NUM_STATE_MACHINES = 4;
+    static const uint INSTRUCTION_COUNT = 32;
+    static const uint NUM_IRQS = 8;
+    static const uint NUM_PINS = 32;
+    static const uint FIFO_DEPTH = 4;
+
+    // the equivalent of a pio_sm_config
+    struct sm_config {
+        uint clkdiv_int = 1;
+        uint clkdiv_frac = 0;
+        uint wrap_target = 0;
+        uint wrap = INSTRUCTION_COUNT - 1;
+        uint out_base = 0;
+        uint out_count = 0;
+        uint set_base = 0;
+        uint set_count = 0;
+        uint sideset_base = 0;
+        uint sideset_bits_including_opt = 0;
+        bool sideset_opt = false;
+        bool sideset_pindirs = false;
+        uint in_base = 0;
+        uint in_count = 32; // PIO version 1 only
+        uint jmp_pin = 0;
+        bool in_shift_right = true;
+        bool autopush = false;
+        uint push_threshold = 32;
+        bool out_shift_right = true;
+        bool autopull = false;
+        uint pull_threshold = 32;
+        fifo_config fifo = fifo_config::txrx;
+        int mov_status_type = 0; // as compiled_source::program::mov_status_type
+        uint mov_status_n = 0;
+    };
+
+    enum stall_reason {
+        not_stalled,
+        stall_tx_empty, // pull or autopull from an empty TX FIFO
+        stall_rx_full,  // push or autopush to a full RX FIFO
+        stall_wait,     // wait instruction
+        stall_irq,      // irq wait for the flag to be cleared
+    };
+
+    struct sm_stats {
+        uint64_t cycles;          // system clock cycles while enabled
+        uint64_t ticks;           // state machine clock ticks (after the clock divider)
+        uint64_t instructions;    // instructions completed
+        uint64_t delay_ticks;
+        uint64_t stall_ticks[stall_irq + 1];
+        uint64_t bits_out;        // bits shifted out of the OSR
+        uint64_t bits_in;         // bits shifted into the ISR
+        uint64_t words_pulled;    // words taken from the TX FIFO (including autopull)
+        uint64_t words_pushed;    // words put in the RX FIFO (including autopush)
+        uint64_t words_dropped;   // words lost by a non-blocking push to a full RX FIFO
+
+        uint64_t total_stall_ticks() const {
+            uint64_t total = 0;
+            for (uint i = stall_tx_empty; i <= stall_irq; i++) total += stall_ticks[i];
+            return total;
+        }
+    };
+
+    struct state_machine {
+        sm_config config;
+        bool enabled = false;
+        uint pc = 0;
+        uint32_t x = 0, y = 0;
+        uint32_t isr = 0, osr = 0;
+        uint isr_count = 0;
+        uint osr_count = 32; // the OSR starts empty
+        uint delay = 0;
+        bool exec_pending = false;
+        uint exec_instr = 0;
+        bool irq_wait_set = false; // irq wait has set its flag and is waiting for it to clear
+        stall_reason stalled = not_stalled;
+        uint clkdiv_acc = 0;
+        std::vector<uint32_t> tx_fifo;
+        std::vector<uint32_t> rx_fifo;
+        uint32_t rx_regs[FIFO_DEPTH] = {}; // FIFO registers for the put/get FIFO joins
+        sm_stats stats = {};
+
+        uint tx_depth() const;
+        uint rx_depth() const;
+    };
+
+    int pio_version;
+    uint gpio_base = 0; // PIO version 1 only; 0 or 16
+    uint instr_mem[INSTRUCTION_COUNT] = {};
+    uint32_t used_instr_mask = 0;
+    state_machine sms[NUM_STATE_MACHINES];
+    uint8_t irq_flags = 0;
+    uint32_t pin_values = 0;    // output values driven by the PIO
+    uint32_t pin_dirs = 0;      // output enables driven by the PIO
+    uint32_t pin_inputs = 0;    // levels driven on the pins from outside (when the PIO is not driving them)
+    uint64_t cycle = 0;
+
+    explicit pio_simulator(int pio_version) : pio_version(pio_version) {}
+
+    // load a program into the instruction memory (at its origin, or the highest free offset like pio_add_program),
+    // relocating its jmp instructions; returns the offset or -1 if there is not enough space
+    int add_program(const compiled_source::program &program);
+
+    // the equivalent of <program>_program_get_default_config()
+    static sm_config default_config(const compiled_source::program &program, uint offset);
+
+    // the equivalent of pio_sm_init(); the state machine is left disabled
+    void sm_init(uint sm, uint initial_pc, const sm_config &config);
+    void sm_set_enabled(uint sm, bool enabled);
+    // execute an instruction on the state machine immediately (the equivalent of pio_sm_exec())
+    void sm_exec(uint sm, uint instr);
+
+    bool tx_fifo_put(uint sm, uint32_t value);
+    bool rx_fifo_get(uint sm, uint32_t &value);
+
+    // the level of a pin (0-31 relative to gpio_base), as driven by the PIO or from outside
+    bool pin_level(uint pin) const {
+        return ((pin_dirs & pin_values) | (~pin_dirs & pin_inputs)) & (1u << pin);
+    }
+
+    // advance the simulation by one system clock cycle
+    void step();
+
+    // appends the state of the PIO block (excluding the instruction memory, configuration, statistics and cycle count)
+    // to key, so that identical states can be recognized when searching the states a program may reach
+    void append_state_key(std::string &key) const;
+
+    // the number of bits the state machine's clock ticks over the number of system clock cycles
+    static double clkdiv_ratio(const sm_config &config) {
+        return 256.0 / (config.clkdiv_int * 256 + config.clkdiv_frac);
+    }
+
+private:
+    uint32_t sync_pins[2] = {}; // input synchronizer stages
+    uint8_t irq_set_next = 0, irq_clear_next = 0;
+
+    void tick(uint sm_num);
+    bool execute(uint sm_num, uint instr, bool exec);
+    uint32_t read_pins(const state_machine &sm) const;
+    void write_pins(uint base, uint count, uint32_t value, bool dirs);
+    uint irq_index(uint sm_num, uint index, bool &local) const;
+    void advance_pc(state_machine &sm);
+};
+
+// runs the stimulus script in stimulus_filename against the programs in source, writing a summary of the run
+// (instructions, stalls, throughput) to report, and a VCD trace to vcd_destination if it is not empty
+int run_pio_simulation(const compiled_source &source, const std::string &stimulus_filename,
+                       const std::string &vcd_destination, std::ostream &report);
+
+// an output_format (not listed with the others) which runs the simulator rather than generating output
+std::shared_ptr<output_format> pio_simulation_output(const std::string &stimulus_filename);
+
+#endif
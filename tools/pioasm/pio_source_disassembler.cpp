@@ -0,0 +1,583 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include "pio_disassembler.h"
+#include "pio_source_disassembler.h"
+
+#ifdef _MSC_VER
+#pragma warning(disable : 4996) // fopen
+#endif
+
+namespace {
+
+const uint32_t BLOB_MAGIC = 0x424f4950u; // "PIOB"
+const uint BLOB_VERSION = 1;
+const uint BLOB_HEADER_SIZE = 28;
+
+enum {
+    BLOB_FLAG_SIDESET_OPT = 0x01,
+    BLOB_FLAG_SIDESET_PINDIRS = 0x02,
+    BLOB_FLAG_IN_SHIFT_RIGHT = 0x04,
+    BLOB_FLAG_AUTOPUSH = 0x08,
+    BLOB_FLAG_OUT_SHIFT_RIGHT = 0x10,
+    BLOB_FLAG_AUTOPULL = 0x20,
+};
+
+// a program with everything unspecified, as the assembler would produce for a bare .program
+compiled_source::program new_program(const std::string &name) {
+    compiled_source::program program(name);
+    program.wrap_target = 0;
+    program.wrap = -1;
+    program.pio_version = -1; // not known
+    program.mov_status_type = -1;
+    program.mov_status_n = 0;
+    program.in = {-1, true, false, 32};
+    program.out = {-1, true, false, 32};
+    program.set_count = -1;
+    program.clock_div_int = 1;
+    program.clock_div_frac = 0;
+    program.used_gpio_ranges = 0;
+    program.fifo = fifo_config::txrx;
+    return program;
+}
+
+// just enough JSON to read back the output of the json output format
+struct json_value {
+    enum { null_value, boolean_value, number_value, string_value, array_value, object_value } type = null_value;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<json_value> array;
+    std::vector<std::pair<std::string, json_value>> object;
+
+    const json_value *get(const std::string &key) const {
+        for (const auto &e : object) {
+            if (e.first == key) return &e.second;
+        }
+        return nullptr;
+    }
+};
+
+struct json_parser {
+    const std::string &text;
+    size_t pos = 0;
+
+    explicit json_parser(const std::string &text) : text(text) {}
+
+    void skip_whitespace() {
+        while (pos < text.size() && isspace((unsigned char)text[pos])) pos++;
+    }
+
+    bool consume(char c) {
+        skip_whitespace();
+        if (pos < text.size() && text[pos] == c) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    bool consume_word(const char *word) {
+        size_t len = strlen(word);
+        if (text.compare(pos, len, word) != 0) return false;
+        pos += len;
+        return true;
+    }
+
+    bool parse_string(std::string &s) {
+        if (!consume('"')) return false;
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c == '\\') {
+                if (pos >= text.size()) return false;
+                c = text[pos++];
+                switch (c) {
+                    case 'n': c = '\n'; break;
+                    case 't': c = '\t'; break;
+                    case 'r': c = '\r'; break;
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    case 'u': return false; // never output by pioasm
+                    default: break;
+                }
+            }
+            s += c;
+        }
+        return consume('"');
+    }
+
+    bool parse(json_value &v) {
+        skip_whitespace();
+        if (pos >= text.size()) return false;
+        char c = text[pos];
+        if (c == '{') {
+            pos++;
+            v.type = json_value::object_value;
+            if (consume('}')) return true;
+            do {
+                std::string key;
+                json_value element;
+                if (!parse_string(key) || !consume(':') || !parse(element)) return false;
+                v.object.emplace_back(key, element);
+            } while (consume(','));
+            return consume('}');
+        } else if (c == '[') {
+            pos++;
+            v.type = json_value::array_value;
+            if (consume(']')) return true;
+            do {
+                json_value element;
+                if (!parse(element)) return false;
+                v.array.push_back(element);
+            } while (consume(','));
+            return consume(']');
+        } else if (c == '"') {
+            v.type = json_value::string_value;
+            return parse_string(v.string);
+        } else if (consume_word("true")) {
+            v.type = json_value::boolean_value;
+            v.boolean = true;
+            return true;
+        } else if (consume_word("false")) {
+            v.type = json_value::boolean_value;
+            return true;
+        } else if (consume_word("null")) {
+            return true;
+        }
+        const char *start = text.c_str() + pos;
+        char *end;
+        v.type = json_value::number_value;
+        v.number = strtod(start, &end);
+        if (end == start) return false;
+        pos += end - start;
+        return true;
+    }
+};
+
+int json_int(const json_value *v, int default_value) {
+    return v && v->type == json_value::number_value ? (int)v->number : default_value;
+}
+
+bool json_bool(const json_value *v) {
+    return v && v->type == json_value::boolean_value && v->boolean;
+}
+
+void json_symbols(const json_value *v, bool is_label, std::vector<compiled_source::symbol> &symbols) {
+    if (!v) return;
+    for (const auto &e : v->object) {
+        symbols.emplace_back(e.first, json_int(&e.second, 0), is_label);
+    }
+}
+
+bool read_json(const std::string &text, const std::string &filename, compiled_source &source) {
+    json_value root;
+    json_parser parser(text);
+    if (!parser.parse(root) || root.type != json_value::object_value) {
+        std::cerr << filename << ": error: invalid JSON\n";
+        return false;
+    }
+    json_symbols(root.get("publicSymbols"), false, source.global_symbols);
+    const json_value *programs = root.get("programs");
+    if (!programs || programs->type != json_value::array_value) {
+        std::cerr << filename << ": error: expected a \"programs\" array\n";
+        return false;
+    }
+    for (const auto &p : programs->array) {
+        const json_value *name = p.get("name");
+        compiled_source::program program = new_program(name ? name->string : "");
+        program.wrap_target = json_int(p.get("wrapTarget"), 0);
+        program.wrap = json_int(p.get("wrap"), -1);
+        int origin = json_int(p.get("origin"), -1);
+        if (origin >= 0) program.origin = origin;
+        const json_value *sideset = p.get("sideset");
+        if (sideset) {
+            program.sideset_bits_including_opt = json_int(sideset->get("size"), 0);
+            program.sideset_opt = json_bool(sideset->get("optional"));
+            program.sideset_pindirs = json_bool(sideset->get("pindirs"));
+        }
+        // the clock divider is only present as part of the timing analysis
+        const json_value *timing = p.get("timing");
+        const json_value *clock_div = timing ? timing->get("clockDiv") : nullptr;
+        if (clock_div && clock_div->type == json_value::number_value && clock_div->number >= 1) {
+            program.clock_div_int = (uint)clock_div->number;
+            program.clock_div_frac = (uint)std::lround((clock_div->number - program.clock_div_int) * 256);
+            if (program.clock_div_frac > 255) {
+                program.clock_div_int++;
+                program.clock_div_frac = 0;
+            }
+        }
+        json_symbols(p.get("publicSymbols"), false, program.symbols);
+        json_symbols(p.get("publicLabels"), true, program.symbols);
+        const json_value *instructions = p.get("instructions");
+        if (instructions) {
+            for (const auto &i : instructions->array) {
+                const json_value *hex = i.get("hex");
+                if (!hex) {
+                    std::cerr << filename << ": error: instruction of program '" << program.name << "' has no \"hex\"\n";
+                    return false;
+                }
+                program.instructions.push_back((uint)strtoul(hex->string.c_str(), nullptr, 16));
+            }
+        }
+        source.programs.push_back(program);
+    }
+    return true;
+}
+
+bool read_hex(const std::string &text, const std::string &filename, compiled_source &source) {
+    compiled_source::program program = new_program("program");
+    std::istringstream lines(text);
+    std::string line;
+    uint line_number = 0;
+    while (std::getline(lines, line)) {
+        line_number++;
+        std::istringstream fields(line);
+        std::string word;
+        if (!(fields >> word)) continue;
+        char *end;
+        unsigned long inst = strtoul(word.c_str(), &end, 16);
+        if (*end || inst > 0x1ffffu) {
+            std::cerr << filename << ":" << line_number << ": error: expected a hex instruction word\n";
+            return false;
+        }
+        program.instructions.push_back((uint)inst);
+    }
+    program.wrap = (int)program.instructions.size() - 1;
+    source.programs.push_back(program);
+    return true;
+}
+
+uint get16(const std::string &data, size_t offset) {
+    return (uint8_t)data[offset] | ((uint8_t)data[offset + 1] << 8u);
+}
+
+uint get32(const std::string &data, size_t offset) {
+    return get16(data, offset) | (get16(data, offset + 2) << 16u);
+}
+
+// as enum pio_fifo_join
+fifo_config fifo_from_join(uint join) {
+    switch (join) {
+        case 1: return fifo_config::tx;
+        case 2: return fifo_config::rx;
+        case 4: return fifo_config::txget;
+        case 8: return fifo_config::txput;
+        case 12: return fifo_config::putget;
+        default: return fifo_config::txrx;
+    }
+}
+
+bool read_blobs(const std::string &data, const std::string &filename, compiled_source &source) {
+    size_t offset = 0;
+    std::vector<compiled_source::program> programs;
+    while (offset < data.size()) {
+        if (data.size() - offset < BLOB_HEADER_SIZE || get32(data, offset) != BLOB_MAGIC) {
+            std::cerr << filename << ": error: invalid program blob at offset " << offset << "\n";
+            return false;
+        }
+        auto byte = [&](uint field) { return (uint)(uint8_t)data[offset + field]; };
+        auto signed_byte = [&](uint field) { return (int)(int8_t)data[offset + field]; };
+        if (byte(4) != BLOB_VERSION) {
+            std::cerr << filename << ": error: unsupported program blob version " << byte(4) << "\n";
+            return false;
+        }
+        uint length = byte(5);
+        size_t size = (BLOB_HEADER_SIZE + length * 2 + 3) & ~(size_t)3;
+        if (data.size() - offset < size) {
+            std::cerr << filename << ": error: truncated program blob at offset " << offset << "\n";
+            return false;
+        }
+        compiled_source::program program = new_program("program_" + std::to_string(programs.size()));
+        if (signed_byte(6) >= 0) program.origin = signed_byte(6);
+        program.pio_version = byte(7);
+        program.wrap_target = byte(12);
+        program.wrap = byte(13);
+        uint flags = byte(15);
+        if (byte(14)) {
+            program.sideset_bits_including_opt = byte(14);
+            program.sideset_opt = flags & BLOB_FLAG_SIDESET_OPT;
+            program.sideset_pindirs = flags & BLOB_FLAG_SIDESET_PINDIRS;
+        }
+        program.in = {signed_byte(16), (flags & BLOB_FLAG_IN_SHIFT_RIGHT) != 0, (flags & BLOB_FLAG_AUTOPUSH) != 0, (int)byte(17)};
+        program.out = {signed_byte(18), (flags & BLOB_FLAG_OUT_SHIFT_RIGHT) != 0, (flags & BLOB_FLAG_AUTOPULL) != 0, (int)byte(19)};
+        program.set_count = signed_byte(20);
+        program.fifo = fifo_from_join(byte(21));
+        program.mov_status_type = signed_byte(22);
+        program.mov_status_n = byte(23);
+        program.clock_div_int = get16(data, offset + 24);
+        program.clock_div_frac = byte(26);
+        program.used_gpio_ranges = byte(27);
+        for (uint i = 0; i < length; i++) {
+            uint inst = get16(data, offset + BLOB_HEADER_SIZE + i * 2);
+            // a blob only holds the low 5 bits of a wait gpio number; gpios 32-47 are indicated by the used ranges
+            if ((program.used_gpio_ranges & 4u) && (inst & 0xe060u) == 0x2000u && !(inst & 0x10u)) inst |= 0x10000u;
+            program.instructions.push_back(inst);
+        }
+        programs.push_back(program);
+        offset += size;
+    }
+    if (programs.size() == 1) programs[0].name = "program";
+    source.programs.insert(source.programs.end(), programs.begin(), programs.end());
+    return true;
+}
+
+// -p side_set=<count>[,opt][,pindirs] supplies the side-set for inputs which don't record it
+bool apply_sideset_option(const std::vector<std::string> &options, compiled_source &source) {
+    for (const auto &option : options) {
+        if (option.compare(0, 9, "side_set=") != 0) continue;
+        std::istringstream fields(option.substr(9));
+        std::string field;
+        int count = -1;
+        bool opt = false, pindirs = false;
+        while (std::getline(fields, field, ',')) {
+            if (field == "opt") opt = true;
+            else if (field == "pindirs") pindirs = true;
+            else if (count < 0 && !field.empty() && field.find_first_not_of("0123456789") == std::string::npos) count = std::stoi(field);
+            else count = 99;
+        }
+        if (count < 0 || count + opt > 5) {
+            std::cerr << "error: invalid option '" << option << "'; expected side_set=<count>[,opt][,pindirs]\n";
+            return false;
+        }
+        for (auto &program : source.programs) {
+            if (program.sideset_bits_including_opt.is_specified()) continue;
+            program.sideset_bits_including_opt = count + opt;
+            program.sideset_opt = opt;
+            program.sideset_pindirs = pindirs;
+        }
+    }
+    return true;
+}
+
+bool needs_pio_version_1(uint inst) {
+    uint major = (inst >> 13u) & 0x7u;
+    uint arg1 = (inst >> 5u) & 0x7u;
+    uint arg2 = inst & 0x1fu;
+    switch (major) {
+        case 0b001: // wait jmppin, wait irq prev/next or wait gpio >= 32
+            return (arg1 & 3u) == 3 || ((arg1 & 3u) == 2 && (arg2 & 8u)) || (inst & 0x10000u);
+        case 0b100: // mov to/from rxfifo[]
+            return arg2 != 0;
+        case 0b101: // mov pindirs
+            return arg1 == 3;
+        case 0b110: // irq prev/next
+            return (arg2 & 8u) != 0;
+        default:
+            return false;
+    }
+}
+
+// whether the disassembly of inst reassembles to the same encoding; reserved fields are not preserved
+bool disassembly_is_exact(uint inst, uint sideset_bits, bool sideset_opt) {
+    uint major = (inst >> 13u) & 0x7u;
+    uint arg2 = inst & 0x1fu;
+    if (major == 0b100 && arg2 && (arg2 & ((arg2 & 8u) ? 4u : 7u))) return false;
+    uint delay = (inst >> 8u) & 0x1fu;
+    uint delay_mask = (1u << (5 - sideset_bits)) - 1u;
+    if (sideset_opt && !(delay & 0x10u) && (delay & 0xfu & ~delay_mask)) return false;
+    return true;
+}
+
+std::string clock_div_string(uint clock_div_int, uint clock_div_frac) {
+    std::stringstream ss;
+    ss << clock_div_int;
+    if (clock_div_frac) {
+        // n/256 is always exact in 8 decimal places
+        char frac[16];
+        snprintf(frac, sizeof(frac), "%08u", clock_div_frac * 390625u);
+        std::string digits(frac);
+        digits.erase(digits.find_last_not_of('0') + 1);
+        ss << "." << digits;
+    }
+    return ss.str();
+}
+
+void disassemble_program(std::stringstream &out, const compiled_source::program &program) {
+    uint sideset_bits = program.sideset_bits_including_opt.is_specified() ? program.sideset_bits_including_opt.get() : 0;
+    uint length = program.instructions.size();
+
+    std::map<uint, std::vector<std::string>> labels;
+    std::map<uint, std::string> jmp_labels;
+    for (const auto &s : program.symbols) {
+        if (s.is_label && s.value >= 0 && (uint)s.value <= length) {
+            labels[s.value].push_back("public " + s.name);
+            if (!jmp_labels.count(s.value)) jmp_labels[s.value] = s.name;
+        }
+    }
+    // the FIFO configuration is not known for json or hex input, but the rxfifo[] accesses imply it
+    fifo_config fifo = program.fifo;
+    bool rxfifo_get = false, rxfifo_put = false;
+    bool v1 = program.pio_version > 0;
+    for (uint inst : program.instructions) {
+        v1 |= needs_pio_version_1(inst);
+        if ((inst & 0xe000u) == 0x8000u && (inst & 0x1fu)) {
+            if (inst & 0x80u) rxfifo_get = true;
+            else rxfifo_put = true;
+        }
+        uint target = inst & 0x1fu;
+        if (!(inst & 0xe000u) && target < length && !jmp_labels.count(target)) {
+            jmp_labels[target] = "label_" + std::to_string(target);
+            labels[target].push_back(jmp_labels[target]);
+        }
+    }
+
+    if (fifo == fifo_config::txrx && (rxfifo_get || rxfifo_put)) {
+        fifo = rxfifo_get && rxfifo_put ? fifo_config::putget : rxfifo_get ? fifo_config::txget : fifo_config::txput;
+    }
+    v1 |= fifo == fifo_config::txget || fifo == fifo_config::txput || fifo == fifo_config::putget;
+
+    out << ".program " << program.name << "\n";
+    if (!program.sideset_bits_including_opt.is_specified()) {
+        out << "; the side-set and configuration were not known (hex input), so any side-set bits are shown as delay\n";
+    }
+    if (v1 || program.pio_version >= 0) out << ".pio_version " << (v1 ? 1 : 0) << "\n";
+    if (program.origin.get() >= 0) out << ".origin " << program.origin.get() << "\n";
+    if (sideset_bits) {
+        out << ".side_set " << sideset_bits - program.sideset_opt;
+        if (program.sideset_opt) out << " opt";
+        if (program.sideset_pindirs) out << " pindirs";
+        out << "\n";
+    }
+    auto in_out = [&](const char *directive, const compiled_source::in_out &io) {
+        if (io.pin_count < 0) return;
+        out << directive << " " << io.pin_count << (io.right ? " right" : " left") << (io.autop ? " auto" : " manual")
+            << " " << io.threshold << "\n";
+    };
+    in_out(".in", program.in);
+    in_out(".out", program.out);
+    if (program.set_count >= 0) out << ".set " << program.set_count << "\n";
+    static const char *fifo_names[] = {"txrx", "tx", "rx", "txget", "txput", "putget"};
+    if (fifo != fifo_config::txrx) out << ".fifo " << fifo_names[(int)fifo] << "\n";
+    switch (program.mov_status_type) {
+        case 0:
+            out << ".mov_status txfifo < " << program.mov_status_n << "\n";
+            break;
+        case 1:
+            out << ".mov_status rxfifo < " << program.mov_status_n << "\n";
+            break;
+        case 2: {
+            static const char *irq_prefix[] = {"", "prev ", "next ", ""};
+            out << ".mov_status irq " << irq_prefix[(program.mov_status_n >> 3u) & 3u] << "set "
+                << (program.mov_status_n & 7u) << "\n";
+            break;
+        }
+        default:
+            break;
+    }
+    if (program.clock_div_int != 1 || program.clock_div_frac) {
+        out << ".clock_div " << clock_div_string(program.clock_div_int, program.clock_div_frac) << "\n";
+    }
+    for (const auto &s : program.symbols) {
+        if (!s.is_label) out << ".define public " << s.name << " " << s.value << "\n";
+    }
+    out << "\n";
+
+    for (uint i = 0; i < length; i++) {
+        uint inst = program.instructions[i];
+        if ((int)i == program.wrap_target) out << ".wrap_target\n";
+        for (const auto &l : labels[i]) out << l << ":\n";
+        std::string text = disassemble(inst, sideset_bits, program.sideset_opt);
+        // a jmp beyond the end of the program cannot be assembled, but may be found in a packed image
+        bool bad_jmp = !(inst & 0xe000u) && (inst & 0x1fu) >= length;
+        if (text == "reserved" || bad_jmp || !disassembly_is_exact(inst, sideset_bits, program.sideset_opt)) {
+            std::stringstream word;
+            word << ".word 0x" << std::hex << std::setw(4) << std::setfill('0') << inst;
+            text = word.str();
+        } else if (!(inst & 0xe000u) && jmp_labels.count(inst & 0x1fu)) {
+            // replace the numeric target (at the end of the jmp's operands) with its label
+            std::string guts = text.size() > 7 ? text.substr(7, 16) : "";
+            std::string rest = text.size() > 23 ? text.substr(23) : "";
+            guts.erase(guts.find_last_not_of(' ') + 1);
+            guts.erase(guts.find_last_not_of("0123456789") + 1);
+            std::stringstream ss;
+            ss << std::left << std::setw(7) << "jmp" << std::setw(16) << guts + jmp_labels[inst & 0x1fu] << rest;
+            text = ss.str();
+            text.erase(text.find_last_not_of(' ') + 1);
+        }
+        out << "    " << text << "\n";
+        if ((int)i == program.wrap) out << ".wrap\n";
+    }
+    for (const auto &l : labels[length]) out << l << ":\n";
+}
+
+}
+
+bool read_compiled_source(const std::string &filename, const std::vector<std::string> &options,
+                          compiled_source &source) {
+    std::string data;
+    if (filename == "-") {
+        std::stringstream ss;
+        ss << std::cin.rdbuf();
+        data = ss.str();
+    } else {
+        std::ifstream in(filename, std::ios::binary);
+        if (!in) {
+            std::cerr << "error: cannot open " << filename << "\n";
+            return false;
+        }
+        std::stringstream ss;
+        ss << in.rdbuf();
+        data = ss.str();
+    }
+    bool ok;
+    size_t first = data.find_first_not_of(" \t\r\n");
+    if (data.size() >= 4 && get32(data, 0) == BLOB_MAGIC) {
+        ok = read_blobs(data, filename, source);
+    } else if (first != std::string::npos && data[first] == '{') {
+        ok = read_json(data, filename, source);
+    } else {
+        ok = read_hex(data, filename, source);
+    }
+    if (!ok || !apply_sideset_option(options, source)) return false;
+    // only hex input leaves the side-set unknown
+    for (const auto &program : source.programs) {
+        if (!program.sideset_bits_including_opt.is_specified()) {
+            std::cerr << filename << ": warning: the side-set of hex input is not known, so any side-set bits are "
+                         "shown as delay; give it with -p side_set=<count>[,opt][,pindirs]\n";
+            break;
+        }
+    }
+    return true;
+}
+
+std::string disassemble_source(const compiled_source &source) {
+    std::stringstream out;
+    for (const auto &s : source.global_symbols) {
+        out << ".define public " << s.name << " " << s.value << "\n";
+    }
+    if (!source.global_symbols.empty()) out << "\n";
+    bool first = true;
+    for (const auto &program : source.programs) {
+        if (!first) out << "\n";
+        first = false;
+        disassemble_program(out, program);
+    }
+    return out.str();
+}
+
+int disassemble_file(const std::string &input, const std::string &output, const std::vector<std::string> &options) {
+    compiled_source source;
+    if (!read_compiled_source(input, options, source)) return 1;
+    std::string text = "; disassembled by pioasm from " + (input == "-" ? std::string("<stdin>") : input) + "\n\n" +
+                       disassemble_source(source);
+    FILE *out = output == "-" ? stdout : fopen(output.c_str(), "w");
+    if (!out) {
+        std::cerr << "Can't open output file '" << output << "'" << std::endl;
+        return 1;
+    }
+    fwrite(text.data(), 1, text.size(), out);
+    if (out != stdout) { fclose(out); }
+    return 0;
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _PIO_SOURCE_DISASSEMBLER_H
+#define _PIO_SOURCE_DISASSEMBLER_H
+
+#include <string>
+#include <vector>
+#include "output_format.h"
+
+// Reconstruction of assemble-able .pio source from pioasm output, for auditing programs which have been optimized
+// or packed, or which have been pulled out of a production image.
+//
+// The input format is detected from its contents:
+//
+// - blob: one or more program blobs (as written by the "blob" output format), which carry the full program
+//   configuration but no names or public symbols
+// - json: the "json" output format, which carries names, public symbols and labels, wrap, origin and side-set
+//   but not the .in/.out/.set/.fifo/.mov_status configuration
+// - hex: one instruction per line (as written by the "hex" output format); nothing else is known, so the side-set
+//   may be given with "-p side_set=<count>[,opt][,pindirs]" (without it, side-set bits are shown as delay, and the
+//   output says so)
+//
+// Jump targets become labels (the public labels where known), and any encoding which is not a valid instruction
+// is emitted as a .word, so that reassembling the source reproduces the original instructions exactly.
+bool read_compiled_source(const std::string &filename, const std::vector<std::string> &options,
+                          compiled_source &source);
+
+std::string disassemble_source(const compiled_source &source);
+
+// reads input (or stdin if "-") and writes the disassembled source to output (or stdout if "-")
+int disassemble_file(const std::string &input, const std::string &output, const std::vector<std::string> &options);
+
+#endif
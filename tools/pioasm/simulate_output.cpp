@@ -0,0 +1,666 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Runs a stimulus script against the assembled programs using pio_simulator.
+//
+// A stimulus script has one command per line; '#' starts a comment. GPIO numbers are absolute, and values may be
+// decimal or 0x prefixed hex.
+//
+//   sysclk <mhz>                           system clock frequency (for the trace and bit rates)
+//   program <name> [<sm>]                  load the program (if not already loaded), and initialize the state
+//                                          machine (default 0) at its start with the program's default config
+//   clkdiv <sm> <divider>                  set the clock divider, e.g. 2.5
+//   out_pins <sm> <gpio> <count>           set the OUT pin mapping
+//   set_pins <sm> <gpio> <count>           set the SET pin mapping
+//   sideset_pins <sm> <gpio>               set the side-set pin base
+//   in_pins <sm> <gpio> [<count>]          set the IN pin base (and the number of pins to trace)
+//   jmp_pin <sm> <gpio>                    set the JMP PIN
+//   in_shift <sm> left|right [<autopush threshold>]
+//   out_shift <sm> left|right [<autopull threshold>]
+//   pindirs <gpio> <count> in|out          set pin directions, like pio_sm_set_consecutive_pindirs
+//   pins <gpio> <count> <value>            set pin output values, like pio_sm_set_pins_with_mask
+//   exec <sm> <instruction>                execute an encoded instruction, like pio_sm_exec
+//   enable <sm>... / disable <sm>...
+//   gpio <gpio> 0|1                        drive a pin from outside (seen when the PIO isn't driving it)
+//   tx <sm> <value>...                     queue words to be written to the TX FIFO as soon as there is space
+//   drain <sm>                             read the RX FIFO as soon as there is data
+//   put <sm> <index> <value>               write a FIFO register (for the txget and putget FIFO joins)
+//   irq set|clear <n>                      set or clear an IRQ flag
+//   run <cycles>                           run for a number of system clock cycles
+//   wait_tx <sm> [<max cycles>]            run until all the words queued by tx have been taken by the state machine
+//   expect gpio <gpio> 0|1                 check the level of a pin
+//   expect rx <sm> <value>                 check the next word read by drain
+//   expect rx_reg <sm> <index> <value>     check a FIFO register (for the txput and putget FIFO joins)
+//   expect x|y|pc|isr|osr <sm> <value>     check a state machine register (pc is relative to the program start)
+//
+// Failed expectations are reported, and make pioasm return an error.
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include "pio_simulator.h"
+
+#ifdef _MSC_VER
+#pragma warning(disable : 4996) // fopen
+#endif
+
+namespace {
+
+struct stimulus_error : public std::runtime_error {
+    explicit stimulus_error(const std::string &msg) : std::runtime_error(msg) {}
+};
+
+struct stimulus_command {
+    uint line;
+    std::vector<std::string> args;
+};
+
+struct vcd_writer {
+    struct signal {
+        std::string scope;
+        std::string name;
+        uint width;
+        std::string id;
+        uint64_t value;
+    };
+
+    FILE *out;
+    std::vector<signal> signals;
+    bool started = false;
+
+    explicit vcd_writer(FILE *out) : out(out) {}
+
+    uint add(const std::string &scope, const std::string &name, uint width) {
+        // identifiers are printable characters from '!' to '~'
+        std::string id;
+        uint n = signals.size();
+        do {
+            id += (char)('!' + n % 94);
+            n /= 94;
+        } while (n);
+        signals.push_back({scope, name, width, id, 0});
+        return signals.size() - 1;
+    }
+
+    void header(uint64_t timescale_ps) {
+        fprintf(out, "$version pioasm simulator $end\n");
+        fprintf(out, "$timescale %llups $end\n", (unsigned long long)timescale_ps);
+        std::string scope;
+        fprintf(out, "$scope module pio $end\n");
+        for (const auto &s : signals) {
+            if (s.scope != scope) {
+                if (!scope.empty()) fprintf(out, "$upscope $end\n");
+                scope = s.scope;
+                if (!scope.empty()) fprintf(out, "$scope module %s $end\n", scope.c_str());
+            }
+            fprintf(out, "$var wire %u %s %s $end\n", s.width, s.id.c_str(), s.name.c_str());
+        }
+        if (!scope.empty()) fprintf(out, "$upscope $end\n");
+        fprintf(out, "$upscope $end\n$enddefinitions $end\n");
+    }
+
+    void write_value(const signal &s) {
+        if (s.width == 1) {
+            fprintf(out, "%c%s\n", s.value ? '1' : '0', s.id.c_str());
+        } else {
+            std::string bits;
+            for (int i = (int)s.width - 1; i >= 0; i--) {
+                if (bits.empty() && i && !((s.value >> i) & 1u)) continue;
+                bits += ((s.value >> i) & 1u) ? '1' : '0';
+            }
+            fprintf(out, "b%s %s\n", bits.c_str(), s.id.c_str());
+        }
+    }
+
+    void sample(uint64_t time, const std::vector<uint64_t> &values) {
+        bool time_written = false;
+        for (uint i = 0; i < signals.size(); i++) {
+            auto &s = signals[i];
+            if (started && s.value == values[i]) continue;
+            if (!time_written) {
+                fprintf(out, "#%llu\n", (unsigned long long)time);
+                if (!started) fprintf(out, "$dumpvars\n");
+                time_written = true;
+            }
+            s.value = values[i];
+            write_value(s);
+        }
+        if (!started) {
+            fprintf(out, "$end\n");
+            started = true;
+        }
+    }
+};
+
+struct simulation {
+    struct sm_runner {
+        const compiled_source::program *program = nullptr;
+        int offset = -1;
+        std::deque<uint32_t> pending_tx;
+        bool drain = false;
+        std::deque<uint32_t> received;
+        uint in_trace_count = 0;
+    };
+
+    const compiled_source &source;
+    pio_simulator pio;
+    sm_runner runners[pio_simulator::NUM_STATE_MACHINES];
+    std::map<std::string, int> offsets;
+    double sysclk_mhz;
+    bool dry_run;
+    // only used by the dry run
+    uint32_t traced_pins = 0;
+    uint used_sms = 0;
+    // only used by the real run
+    vcd_writer *vcd = nullptr;
+    uint64_t period_ps = 0;
+    std::vector<uint64_t> values;
+    std::vector<std::string> failures;
+
+    simulation(const compiled_source &source, int pio_version, bool dry_run) : source(source), pio(pio_version),
+                                                                              dry_run(dry_run) {
+        sysclk_mhz = pio_version ? 150.0 : 125.0;
+        for (const auto &p : source.programs) {
+            // use the upper GPIOs if any program needs them
+            if (pio_version && (p.used_gpio_ranges & 4u)) pio.gpio_base = 16;
+        }
+    }
+
+    static uint32_t parse_uint(const std::string &s, const std::string &what) {
+        try {
+            size_t pos;
+            unsigned long v = std::stoul(s, &pos, 0);
+            if (pos == s.size() && s[0] != '-' && v <= 0xffffffffu) return (uint32_t)v;
+        } catch (std::exception &) {
+        }
+        throw stimulus_error("invalid " + what + " '" + s + "'");
+    }
+
+    static uint parse_sm(const std::string &s) {
+        uint sm = parse_uint(s, "state machine");
+        if (sm >= pio_simulator::NUM_STATE_MACHINES) throw stimulus_error("state machine must be 0-3");
+        return sm;
+    }
+
+    uint parse_gpio(const std::string &s) const {
+        uint gpio = parse_uint(s, "GPIO");
+        if (gpio < pio.gpio_base || gpio >= pio.gpio_base + pio_simulator::NUM_PINS) {
+            std::stringstream msg;
+            msg << "GPIO " << gpio << " is not accessible to the PIO (GPIO base " << pio.gpio_base << ")";
+            throw stimulus_error(msg.str());
+        }
+        return gpio - pio.gpio_base;
+    }
+
+    static void check_args(const stimulus_command &cmd, size_t min, size_t max) {
+        if (cmd.args.size() < min + 1 || cmd.args.size() > max + 1) {
+            throw stimulus_error("wrong number of arguments for '" + cmd.args[0] + "'");
+        }
+    }
+
+    pio_simulator::state_machine &initialized_sm(const std::string &s) {
+        uint sm = parse_sm(s);
+        if (!runners[sm].program) throw stimulus_error("state machine " + s + " has no program");
+        return pio.sms[sm];
+    }
+
+    static uint32_t pin_mask(uint base, uint count) {
+        uint32_t mask = 0;
+        for (uint i = 0; i < count; i++) mask |= 1u << ((base + i) % pio_simulator::NUM_PINS);
+        return mask;
+    }
+
+    void track_pins() {
+        for (uint i = 0; i < pio_simulator::NUM_STATE_MACHINES; i++) {
+            if (!pio.sms[i].enabled) continue;
+            const auto &c = pio.sms[i].config;
+            traced_pins |= pin_mask(c.out_base, c.out_count) | pin_mask(c.set_base, c.set_count);
+            traced_pins |= pin_mask(c.sideset_base, c.sideset_bits_including_opt - (c.sideset_opt ? 1 : 0));
+            traced_pins |= pin_mask(c.in_base, runners[i].in_trace_count);
+            used_sms |= 1u << i;
+        }
+    }
+
+    void run_command(const stimulus_command &cmd) {
+        const auto &a = cmd.args;
+        const std::string &op = a[0];
+        if (op == "sysclk") {
+            check_args(cmd, 1, 1);
+            try {
+                sysclk_mhz = std::stod(a[1]);
+            } catch (std::exception &) {
+                sysclk_mhz = 0;
+            }
+            if (!(sysclk_mhz > 0)) throw stimulus_error("invalid system clock '" + a[1] + "'");
+            if (!dry_run && vcd) throw stimulus_error("sysclk must precede the first run");
+        } else if (op == "program") {
+            check_args(cmd, 1, 2);
+            uint sm = a.size() > 2 ? parse_sm(a[2]) : 0;
+            auto p = std::find_if(source.programs.begin(), source.programs.end(),
+                                  [&](const compiled_source::program &p) { return p.name == a[1]; });
+            if (p == source.programs.end()) throw stimulus_error("unknown program '" + a[1] + "'");
+            auto o = offsets.find(p->name);
+            int offset;
+            if (o != offsets.end()) {
+                offset = o->second;
+            } else {
+                offset = pio.add_program(*p);
+                if (offset < 0) throw stimulus_error("no space in instruction memory for program '" + a[1] + "'");
+                offsets[p->name] = offset;
+            }
+            pio.sm_init(sm, offset, pio_simulator::default_config(*p, offset));
+            runners[sm] = sm_runner();
+            runners[sm].program = &*p;
+            runners[sm].offset = offset;
+        } else if (op == "clkdiv") {
+            check_args(cmd, 2, 2);
+            auto &sm = initialized_sm(a[1]);
+            double div;
+            try {
+                div = std::stod(a[2]);
+            } catch (std::exception &) {
+                div = 0;
+            }
+            if (!(div >= 1.0 && div < 65536.0)) throw stimulus_error("clock divider must be between 1 and 65535");
+            sm.config.clkdiv_int = (uint)div;
+            sm.config.clkdiv_frac = (uint)((div - sm.config.clkdiv_int) * 256);
+        } else if (op == "out_pins" || op == "set_pins") {
+            check_args(cmd, 3, 3);
+            auto &sm = initialized_sm(a[1]);
+            uint base = parse_gpio(a[2]);
+            uint count = parse_uint(a[3], "pin count");
+            if (op == "out_pins") {
+                if (count > 32) throw stimulus_error("out pin count must be 0-32");
+                sm.config.out_base = base;
+                sm.config.out_count = count;
+            } else {
+                if (count > 5) throw stimulus_error("set pin count must be 0-5");
+                sm.config.set_base = base;
+                sm.config.set_count = count;
+            }
+        } else if (op == "sideset_pins") {
+            check_args(cmd, 2, 2);
+            initialized_sm(a[1]).config.sideset_base = parse_gpio(a[2]);
+        } else if (op == "in_pins") {
+            check_args(cmd, 2, 3);
+            auto &sm = initialized_sm(a[1]);
+            sm.config.in_base = parse_gpio(a[2]);
+            runners[parse_sm(a[1])].in_trace_count = 1;
+            if (a.size() > 3) {
+                uint count = parse_uint(a[3], "pin count");
+                if (count < 1 || count > 32) throw stimulus_error("in pin count must be 1-32");
+                runners[parse_sm(a[1])].in_trace_count = count;
+                if (pio.pio_version > 0) sm.config.in_count = count;
+            }
+        } else if (op == "jmp_pin") {
+            check_args(cmd, 2, 2);
+            uint pin = parse_gpio(a[2]);
+            initialized_sm(a[1]).config.jmp_pin = pin;
+            traced_pins |= 1u << pin;
+        } else if (op == "in_shift" || op == "out_shift") {
+            check_args(cmd, 2, 3);
+            auto &sm = initialized_sm(a[1]);
+            if (a[2] != "left" && a[2] != "right") throw stimulus_error("shift direction must be 'left' or 'right'");
+            bool right = a[2] == "right";
+            bool autop = a.size() > 3;
+            uint threshold = autop ? parse_uint(a[3], "threshold") : 32;
+            if (threshold < 1 || threshold > 32) throw stimulus_error("threshold must be 1-32");
+            if (op == "in_shift") {
+                sm.config.in_shift_right = right;
+                sm.config.autopush = autop;
+                sm.config.push_threshold = threshold;
+            } else {
+                sm.config.out_shift_right = right;
+                sm.config.autopull = autop;
+                sm.config.pull_threshold = threshold;
+            }
+        } else if (op == "pindirs" || op == "pins") {
+            check_args(cmd, 3, 3);
+            uint base = parse_gpio(a[1]);
+            uint count = parse_uint(a[2], "pin count");
+            if (count > 32) throw stimulus_error("pin count must be 0-32");
+            uint32_t mask = pin_mask(base, count);
+            uint32_t value;
+            if (op == "pindirs") {
+                if (a[3] != "in" && a[3] != "out") throw stimulus_error("pin direction must be 'in' or 'out'");
+                value = a[3] == "out" ? mask : 0;
+                pio.pin_dirs = (pio.pin_dirs & ~mask) | value;
+            } else {
+                uint32_t v = parse_uint(a[3], "value");
+                value = 0;
+                for (uint i = 0; i < count; i++) {
+                    if (v & (1u << i)) value |= 1u << ((base + i) % pio_simulator::NUM_PINS);
+                }
+                pio.pin_values = (pio.pin_values & ~mask) | value;
+            }
+            traced_pins |= mask;
+        } else if (op == "exec") {
+            check_args(cmd, 2, 2);
+            initialized_sm(a[1]);
+            uint instr = parse_uint(a[2], "instruction");
+            if (instr > 0xffff) throw stimulus_error("instruction must be a 16 bit value");
+            pio.sm_exec(parse_sm(a[1]), instr);
+        } else if (op == "enable" || op == "disable") {
+            if (a.size() < 2) throw stimulus_error("expected state machine number(s)");
+            for (size_t i = 1; i < a.size(); i++) {
+                initialized_sm(a[i]);
+                pio.sm_set_enabled(parse_sm(a[i]), op == "enable");
+            }
+        } else if (op == "gpio") {
+            check_args(cmd, 2, 2);
+            uint pin = parse_gpio(a[1]);
+            uint level = parse_uint(a[2], "level");
+            if (level > 1) throw stimulus_error("level must be 0 or 1");
+            if (level) pio.pin_inputs |= 1u << pin; else pio.pin_inputs &= ~(1u << pin);
+            traced_pins |= 1u << pin;
+        } else if (op == "tx") {
+            if (a.size() < 3) throw stimulus_error("expected state machine number and value(s)");
+            initialized_sm(a[1]);
+            auto &r = runners[parse_sm(a[1])];
+            for (size_t i = 2; i < a.size(); i++) r.pending_tx.push_back(parse_uint(a[i], "value"));
+        } else if (op == "drain") {
+            check_args(cmd, 1, 1);
+            initialized_sm(a[1]);
+            runners[parse_sm(a[1])].drain = true;
+        } else if (op == "put") {
+            check_args(cmd, 3, 3);
+            auto &sm = initialized_sm(a[1]);
+            uint index = parse_uint(a[2], "index");
+            if (index >= pio_simulator::FIFO_DEPTH) throw stimulus_error("FIFO register index must be 0-3");
+            sm.rx_regs[index] = parse_uint(a[3], "value");
+        } else if (op == "irq") {
+            check_args(cmd, 2, 2);
+            uint n = parse_uint(a[2], "irq number");
+            if (n >= pio_simulator::NUM_IRQS) throw stimulus_error("irq number must be 0-7");
+            if (a[1] == "set") pio.irq_flags |= (uint8_t)(1u << n);
+            else if (a[1] == "clear") pio.irq_flags &= (uint8_t)~(1u << n);
+            else throw stimulus_error("expected 'set' or 'clear'");
+        } else if (op == "run") {
+            check_args(cmd, 1, 1);
+            uint cycles = parse_uint(a[1], "cycle count");
+            for (uint i = 0; i < cycles && !dry_run; i++) step();
+        } else if (op == "wait_tx") {
+            check_args(cmd, 1, 2);
+            initialized_sm(a[1]);
+            uint sm = parse_sm(a[1]);
+            uint max = a.size() > 2 ? parse_uint(a[2], "cycle count") : 1000000;
+            if (dry_run) return;
+            uint i = 0;
+            while (!runners[sm].pending_tx.empty() || !pio.sms[sm].tx_fifo.empty()) {
+                if (i++ == max) {
+                    std::stringstream msg;
+                    msg << "TX words not consumed by state machine " << sm << " within " << max << " cycles";
+                    throw stimulus_error(msg.str());
+                }
+                step();
+            }
+        } else if (op == "expect") {
+            if (a.size() < 2) throw stimulus_error("expected what to check");
+            expect(cmd);
+        } else {
+            throw stimulus_error("unknown command '" + op + "'");
+        }
+    }
+
+    void expect(const stimulus_command &cmd) {
+        const auto &a = cmd.args;
+        const std::string &what = a[1];
+        uint32_t actual = 0, expected;
+        std::string name;
+        if (what == "gpio") {
+            check_args(cmd, 3, 3);
+            uint pin = parse_gpio(a[2]);
+            expected = parse_uint(a[3], "level");
+            actual = pio.pin_level(pin);
+            name = "gpio " + a[2];
+        } else if (what == "rx") {
+            check_args(cmd, 3, 3);
+            initialized_sm(a[2]);
+            expected = parse_uint(a[3], "value");
+            if (dry_run) return;
+            auto &received = runners[parse_sm(a[2])].received;
+            if (received.empty()) {
+                failure(cmd, "no word received from the RX FIFO of state machine " + a[2]);
+                return;
+            }
+            actual = received.front();
+            received.pop_front();
+            name = "rx " + a[2];
+        } else if (what == "rx_reg") {
+            check_args(cmd, 4, 4);
+            auto &sm = initialized_sm(a[2]);
+            uint index = parse_uint(a[3], "index");
+            if (index >= pio_simulator::FIFO_DEPTH) throw stimulus_error("FIFO register index must be 0-3");
+            expected = parse_uint(a[4], "value");
+            actual = sm.rx_regs[index];
+            name = "rx_reg " + a[2] + " " + a[3];
+        } else if (what == "x" || what == "y" || what == "pc" || what == "isr" || what == "osr") {
+            check_args(cmd, 3, 3);
+            auto &sm = initialized_sm(a[2]);
+            expected = parse_uint(a[3], "value");
+            if (what == "x") actual = sm.x;
+            else if (what == "y") actual = sm.y;
+            else if (what == "pc") actual = (sm.pc - runners[parse_sm(a[2])].offset) % pio_simulator::INSTRUCTION_COUNT;
+            else if (what == "isr") actual = sm.isr;
+            else actual = sm.osr;
+            name = what + " " + a[2];
+        } else {
+            throw stimulus_error("unknown expectation '" + what + "'");
+        }
+        if (!dry_run && actual != expected) {
+            std::stringstream msg;
+            msg << name << " is 0x" << std::hex << actual << ", expected 0x" << expected;
+            failure(cmd, msg.str());
+        }
+    }
+
+    void failure(const stimulus_command &cmd, const std::string &msg) {
+        std::stringstream ss;
+        ss << cmd.line << ": expectation failed: " << msg;
+        failures.push_back(ss.str());
+    }
+
+    void add_trace_signals() {
+        vcd->add("", "irq", pio_simulator::NUM_IRQS);
+        for (uint pin = 0; pin < pio_simulator::NUM_PINS; pin++) {
+            if (traced_pins & (1u << pin)) vcd->add("", "gpio" + std::to_string(pin + pio.gpio_base), 1);
+        }
+        for (uint i = 0; i < pio_simulator::NUM_STATE_MACHINES; i++) {
+            if (!(used_sms & (1u << i))) continue;
+            std::string scope = "sm" + std::to_string(i);
+            vcd->add(scope, "enabled", 1);
+            vcd->add(scope, "pc", 5);
+            vcd->add(scope, "stalled", 1);
+            vcd->add(scope, "x", 32);
+            vcd->add(scope, "y", 32);
+            vcd->add(scope, "isr", 32);
+            vcd->add(scope, "isr_count", 6);
+            vcd->add(scope, "osr", 32);
+            vcd->add(scope, "osr_count", 6);
+            vcd->add(scope, "tx_level", 4);
+            vcd->add(scope, "rx_level", 4);
+        }
+        values.resize(vcd->signals.size());
+        period_ps = (uint64_t)std::llround(1000000.0 / sysclk_mhz);
+        vcd->header(period_ps);
+    }
+
+    void trace() {
+        if (!vcd) return;
+        uint n = 0;
+        values[n++] = pio.irq_flags;
+        for (uint pin = 0; pin < pio_simulator::NUM_PINS; pin++) {
+            if (traced_pins & (1u << pin)) values[n++] = pio.pin_level(pin);
+        }
+        for (uint i = 0; i < pio_simulator::NUM_STATE_MACHINES; i++) {
+            if (!(used_sms & (1u << i))) continue;
+            const auto &sm = pio.sms[i];
+            values[n++] = sm.enabled;
+            values[n++] = sm.pc;
+            values[n++] = sm.stalled != pio_simulator::not_stalled;
+            values[n++] = sm.x;
+            values[n++] = sm.y;
+            values[n++] = sm.isr;
+            values[n++] = sm.isr_count;
+            values[n++] = sm.osr;
+            values[n++] = sm.osr_count;
+            values[n++] = sm.tx_fifo.size();
+            values[n++] = sm.rx_fifo.size();
+        }
+        vcd->sample(pio.cycle * period_ps, values);
+    }
+
+    void step() {
+        // the stimulus writes and reads the FIFOs at most once per cycle, like DMA
+        for (uint i = 0; i < pio_simulator::NUM_STATE_MACHINES; i++) {
+            auto &r = runners[i];
+            if (!r.pending_tx.empty() && pio.tx_fifo_put(i, r.pending_tx.front())) r.pending_tx.pop_front();
+            uint32_t value;
+            if (r.drain && pio.rx_fifo_get(i, value)) r.received.push_back(value);
+        }
+        trace();
+        pio.step();
+    }
+
+    void print_report(std::ostream &report) {
+        auto rate = [&](uint64_t bits, uint64_t cycles) {
+            std::stringstream ss;
+            ss << std::fixed << std::setprecision(3) << (cycles ? (double)bits / (double)cycles : 0.0)
+               << " bits/cycle, " << (cycles ? (double)bits * sysclk_mhz / (double)cycles : 0.0) << " Mbit/s";
+            return ss.str();
+        };
+        report << "simulated " << pio.cycle << " cycles (" << std::fixed << std::setprecision(3)
+               << (double)pio.cycle / sysclk_mhz << " us at " << sysclk_mhz << " MHz)\n";
+        for (uint i = 0; i < pio_simulator::NUM_STATE_MACHINES; i++) {
+            const auto &r = runners[i];
+            if (!r.program) continue;
+            const auto &sm = pio.sms[i];
+            const auto &s = sm.stats;
+            report << "sm" << i << ": " << r.program->name << " at offset " << r.offset << ", clock divider "
+                   << std::setprecision(3) << (double)sm.config.clkdiv_int + sm.config.clkdiv_frac / 256.0 << "\n";
+            report << "  cycles " << s.cycles << ", ticks " << s.ticks << ", instructions " << s.instructions
+                   << ", delay ticks " << s.delay_ticks << "\n";
+            report << "  stall ticks " << s.total_stall_ticks() << " (tx empty "
+                   << s.stall_ticks[pio_simulator::stall_tx_empty] << ", rx full "
+                   << s.stall_ticks[pio_simulator::stall_rx_full] << ", wait " << s.stall_ticks[pio_simulator::stall_wait]
+                   << ", irq " << s.stall_ticks[pio_simulator::stall_irq] << ")\n";
+            report << "  out " << s.bits_out << " bits (" << rate(s.bits_out, s.cycles) << "), " << s.words_pulled
+                   << " words pulled\n";
+            report << "  in " << s.bits_in << " bits (" << rate(s.bits_in, s.cycles) << "), " << s.words_pushed
+                   << " words pushed";
+            if (s.words_dropped) report << ", " << s.words_dropped << " words dropped";
+            report << "\n";
+            if (sm.config.fifo == fifo_config::txput || sm.config.fifo == fifo_config::putget) {
+                report << "  rx_regs";
+                for (uint j = 0; j < pio_simulator::FIFO_DEPTH; j++) {
+                    report << " 0x" << std::hex << sm.rx_regs[j] << std::dec;
+                }
+                report << "\n";
+            }
+            if (!r.received.empty()) {
+                report << "  rx unchecked";
+                for (uint32_t v : r.received) report << " 0x" << std::hex << v << std::dec;
+                report << "\n";
+            }
+        }
+    }
+};
+
+}
+
+int run_pio_simulation(const compiled_source &source, const std::string &stimulus_filename,
+                       const std::string &vcd_destination, std::ostream &report) {
+    std::ifstream in(stimulus_filename);
+    if (!in) {
+        std::cerr << "error: can't open stimulus file '" << stimulus_filename << "'" << std::endl;
+        return 1;
+    }
+    std::vector<stimulus_command> commands;
+    std::string line;
+    for (uint line_num = 1; std::getline(in, line); line_num++) {
+        auto comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+        std::istringstream tokens(line);
+        stimulus_command cmd{line_num, {}};
+        std::string token;
+        while (tokens >> token) cmd.args.push_back(token);
+        if (!cmd.args.empty()) commands.push_back(cmd);
+    }
+
+    int pio_version = 0;
+    for (const auto &p : source.programs) pio_version = std::max(pio_version, p.pio_version);
+
+    // check the whole script, and find which pins and state machines to trace, before running anything
+    simulation dry(source, pio_version, true);
+    simulation sim(source, pio_version, false);
+    const stimulus_command *current = nullptr;
+    try {
+        for (const auto &cmd : commands) {
+            current = &cmd;
+            dry.run_command(cmd);
+            // pin mappings only matter once the state machines are running
+            if (cmd.args[0] == "run" || cmd.args[0] == "wait_tx") dry.track_pins();
+        }
+        current = nullptr;
+        FILE *out = nullptr;
+        if (!vcd_destination.empty()) {
+            out = fopen(vcd_destination.c_str(), "w");
+            if (!out) {
+                std::cerr << "Can't open output file '" << vcd_destination << "'" << std::endl;
+                return 1;
+            }
+        }
+        vcd_writer vcd(out);
+        sim.traced_pins = dry.traced_pins;
+        sim.used_sms = dry.used_sms;
+        for (const auto &cmd : commands) {
+            current = &cmd;
+            if (out && !sim.vcd && (cmd.args[0] == "run" || cmd.args[0] == "wait_tx")) {
+                sim.vcd = &vcd;
+                sim.add_trace_signals();
+            }
+            sim.run_command(cmd);
+        }
+        current = nullptr;
+        sim.trace();
+        if (out) fclose(out);
+    } catch (stimulus_error &e) {
+        std::cerr << stimulus_filename;
+        if (current) std::cerr << ":" << current->line;
+        std::cerr << ": error: " << e.what() << std::endl;
+        return 1;
+    }
+    sim.print_report(report);
+    for (const auto &f : sim.failures) {
+        std::cerr << stimulus_filename << ":" << f << std::endl;
+    }
+    return sim.failures.empty() ? 0 : 1;
+}
+
+struct simulation_output : public output_format {
+    std::string stimulus_filename;
+
+    explicit simulation_output(std::string stimulus_filename) : output_format("simulate"),
+                                                                stimulus_filename(std::move(stimulus_filename)) {}
+
+    std::string get_description() override {
+        return "Simulate the program(s), writing a VCD trace";
+    }
+
+    int output(std::string destination, std::vector<std::string> output_options,
+               const compiled_source &source) override {
+        return run_pio_simulation(source, stimulus_filename, destination == "-" ? "" : destination, std::cout);
+    }
+};
+
+std::shared_ptr<output_format> pio_simulation_output(const std::string &stimulus_filename) {
+    return std::make_shared<simulation_output>(stimulus_filename);
+}
@@ -0,0 +1,62 @@
+# Checks the instruction slots saved by pioasm -O; run with cmake -P
+#
+#   PIOASM      the pioasm executable
+#   PIO_FILE    the .pio file to assemble
+#   PIO_VERSION the default PIO version (0 or 1)
+#   SAVINGS     the number of instructions -O should save, for each program of the file in order
+#
+# Each program must be reported as optimized and checked equivalent to the original, rather than left as it was.
+
+foreach(VAR IN ITEMS PIOASM PIO_FILE PIO_VERSION SAVINGS)
+    if (NOT DEFINED ${VAR})
+        message(FATAL_ERROR "${VAR} must be defined")
+    endif()
+endforeach()
+
+# the number of instructions in each program of the json output
+function(program_lengths JSON VAR)
+    string(REGEX MATCHALL "\"instructions\": \\[[^]]*\\]" PROGRAMS "${JSON}")
+    set(LENGTHS)
+    foreach(PROGRAM IN LISTS PROGRAMS)
+        string(REGEX MATCHALL "\"hex\"" INSTRUCTIONS "${PROGRAM}")
+        list(LENGTH INSTRUCTIONS LENGTH)
+        list(APPEND LENGTHS ${LENGTH})
+    endforeach()
+    set(${VAR} ${LENGTHS} PARENT_SCOPE)
+endfunction()
+
+execute_process(COMMAND ${PIOASM} -v ${PIO_VERSION} -o json ${PIO_FILE}
+        RESULT_VARIABLE RESULT OUTPUT_VARIABLE JSON ERROR_VARIABLE ERROR)
+if (RESULT)
+    message(FATAL_ERROR "pioasm failed:\n${ERROR}")
+endif()
+program_lengths("${JSON}" ORIGINAL)
+
+execute_process(COMMAND ${PIOASM} -v ${PIO_VERSION} -O -o json ${PIO_FILE}
+        RESULT_VARIABLE RESULT OUTPUT_VARIABLE JSON ERROR_VARIABLE ERROR)
+if (RESULT)
+    message(FATAL_ERROR "pioasm -O failed:\n${ERROR}")
+endif()
+if (ERROR MATCHES "warning")
+    message(FATAL_ERROR "pioasm -O left a program unoptimized:\n${ERROR}")
+endif()
+program_lengths("${JSON}" OPTIMIZED)
+
+list(LENGTH SAVINGS COUNT)
+list(LENGTH ORIGINAL ACTUAL_COUNT)
+if (NOT COUNT EQUAL ACTUAL_COUNT)
+    message(FATAL_ERROR "expected ${COUNT} programs in ${PIO_FILE}, but there are ${ACTUAL_COUNT}")
+endif()
+math(EXPR LAST "${COUNT} - 1")
+foreach(I RANGE ${LAST})
+    list(GET SAVINGS ${I} SAVED)
+    list(GET ORIGINAL ${I} FROM)
+    list(GET OPTIMIZED ${I} TO)
+    math(EXPR ACTUAL_SAVED "${FROM} - ${TO}")
+    if (NOT SAVED EQUAL ACTUAL_SAVED)
+        message(FATAL_ERROR "program ${I} of ${PIO_FILE} optimized from ${FROM} to ${TO} instructions; expected to save ${SAVED}:\n${ERROR}")
+    endif()
+    if (SAVED AND NOT ERROR MATCHES "optimized from ${FROM} to ${TO} instructions \\(checked exhaustively")
+        message(FATAL_ERROR "program ${I} of ${PIO_FILE} was not checked against the original:\n${ERROR}")
+    endif()
+endforeach()
@@ -0,0 +1,50 @@
+# Checks the layout of the image pioasm -p pack=<PACK_NAME> adds to the C header; run with cmake -P
+#
+#   PIOASM      the pioasm executable
+#   PIO_FILE    the .pio file to assemble
+#   PACK_NAME   the name to pack the programs as
+#   UNPACKED    the number of instructions in the programs of the file
+#   LENGTH      the number of instructions in the packed image
+#   ORIGIN      the origin of the packed image (-1 for none)
+#   OFFSETS     the offset of each program within the image, as a list of <program>=<offset>
+
+foreach(VAR IN ITEMS PIOASM PIO_FILE PACK_NAME UNPACKED LENGTH ORIGIN OFFSETS)
+    if (NOT DEFINED ${VAR})
+        message(FATAL_ERROR "${VAR} must be defined")
+    endif()
+endforeach()
+
+execute_process(COMMAND ${PIOASM} -p pack=${PACK_NAME} ${PIO_FILE}
+        RESULT_VARIABLE RESULT OUTPUT_VARIABLE HEADER ERROR_VARIABLE ERROR)
+if (RESULT)
+    message(FATAL_ERROR "pioasm failed:\n${ERROR}")
+endif()
+
+if (NOT HEADER MATCHES "// ${PACK_NAME} \\([0-9]+ programs packed into ([0-9]+) instructions, ([0-9]+) unpacked\\)")
+    message(FATAL_ERROR "no packed image ${PACK_NAME} in the output:\n${HEADER}")
+endif()
+if (NOT CMAKE_MATCH_1 EQUAL LENGTH OR NOT CMAKE_MATCH_2 EQUAL UNPACKED)
+    message(FATAL_ERROR "${CMAKE_MATCH_2} instructions packed into ${CMAKE_MATCH_1}; expected ${UNPACKED} into ${LENGTH}")
+endif()
+
+if (NOT HEADER MATCHES "${PACK_NAME}_packed_program = {[^}]*\\.length = ([0-9]+),[^}]*\\.origin = (-?[0-9]+),")
+    message(FATAL_ERROR "no pio_program for the packed image ${PACK_NAME} in the output:\n${HEADER}")
+endif()
+if (NOT CMAKE_MATCH_1 EQUAL LENGTH)
+    message(FATAL_ERROR "the packed program has length ${CMAKE_MATCH_1}; expected ${LENGTH}")
+endif()
+if (NOT CMAKE_MATCH_2 EQUAL ORIGIN)
+    message(FATAL_ERROR "the packed program has origin ${CMAKE_MATCH_2}; expected ${ORIGIN}")
+endif()
+
+foreach(OFFSET IN LISTS OFFSETS)
+    string(REPLACE "=" ";" OFFSET "${OFFSET}")
+    list(GET OFFSET 0 PROGRAM)
+    list(GET OFFSET 1 EXPECTED)
+    if (NOT HEADER MATCHES "#define ${PACK_NAME}_${PROGRAM}_offset ([0-9]+)u")
+        message(FATAL_ERROR "no offset for program ${PROGRAM} in the output:\n${HEADER}")
+    endif()
+    if (NOT CMAKE_MATCH_1 EQUAL EXPECTED)
+        message(FATAL_ERROR "program ${PROGRAM} was packed at offset ${CMAKE_MATCH_1}; expected ${EXPECTED}")
+    endif()
+endforeach()
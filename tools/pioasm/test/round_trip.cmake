@@ -0,0 +1,50 @@
+# Checks that pioasm --disassemble reproduces the programs of a .pio file; run with cmake -P
+#
+#   PIOASM      the pioasm executable
+#   PIO_FILE    the .pio file to assemble
+#   PIO_VERSION the default PIO version (0 or 1)
+#   WORK_DIR    directory for intermediate files
+#
+# The file is assembled to json and blob outputs, each of which is disassembled and reassembled. The blobs must match
+# exactly; the json must match apart from the timing analysis, which depends on configuration json does not record.
+
+foreach(VAR IN ITEMS PIOASM PIO_FILE PIO_VERSION WORK_DIR)
+    if (NOT DEFINED ${VAR})
+        message(FATAL_ERROR "${VAR} must be defined")
+    endif()
+endforeach()
+
+get_filename_component(NAME ${PIO_FILE} NAME_WE)
+set(BASE ${WORK_DIR}/${NAME}_v${PIO_VERSION})
+file(MAKE_DIRECTORY ${WORK_DIR})
+
+function(pioasm)
+    execute_process(COMMAND ${PIOASM} ${ARGN} RESULT_VARIABLE RESULT ERROR_VARIABLE ERROR)
+    if (RESULT)
+        message(FATAL_ERROR "pioasm ${ARGN} failed:\n${ERROR}")
+    endif()
+endfunction()
+
+function(read_json FILE VAR)
+    file(READ ${FILE} JSON)
+    string(REGEX REPLACE "\"timing\": {[^}]*},?" "" JSON "${JSON}")
+    set(${VAR} "${JSON}" PARENT_SCOPE)
+endfunction()
+
+pioasm(-v ${PIO_VERSION} -o json ${PIO_FILE} ${BASE}.json)
+pioasm(--disassemble ${BASE}.json ${BASE}_json.pio)
+pioasm(-v ${PIO_VERSION} -o json ${BASE}_json.pio ${BASE}_json.json)
+read_json(${BASE}.json EXPECTED)
+read_json(${BASE}_json.json ACTUAL)
+if (NOT EXPECTED STREQUAL ACTUAL)
+    message(FATAL_ERROR "json round trip of ${PIO_FILE} differs; see ${BASE}_json.pio")
+endif()
+
+pioasm(-v ${PIO_VERSION} -o blob ${PIO_FILE} ${BASE}.blob)
+pioasm(--disassemble ${BASE}.blob ${BASE}_blob.pio)
+pioasm(-v ${PIO_VERSION} -o blob ${BASE}_blob.pio ${BASE}_blob.blob)
+file(SHA256 ${BASE}.blob EXPECTED)
+file(SHA256 ${BASE}_blob.blob ACTUAL)
+if (NOT EXPECTED STREQUAL ACTUAL)
+    message(FATAL_ERROR "blob round trip of ${PIO_FILE} differs; see ${BASE}_blob.pio")
+endif()
@@ -0,0 +1,39 @@
+# Checks the timing analysis in the json output of pioasm; run with cmake -P
+#
+#   PIOASM      the pioasm executable
+#   PIO_FILE    the .pio file to assemble
+#   PIO_VERSION the default PIO version (0 or 1)
+#   TIMING      the expected timing, as a list of <program>:<field>=<value> with the fields named as in the json
+#               "timing" object
+
+foreach(VAR IN ITEMS PIOASM PIO_FILE PIO_VERSION TIMING)
+    if (NOT DEFINED ${VAR})
+        message(FATAL_ERROR "${VAR} must be defined")
+    endif()
+endforeach()
+
+execute_process(COMMAND ${PIOASM} -v ${PIO_VERSION} -o json ${PIO_FILE}
+        RESULT_VARIABLE RESULT OUTPUT_VARIABLE JSON ERROR_VARIABLE ERROR)
+if (RESULT)
+    message(FATAL_ERROR "pioasm failed:\n${ERROR}")
+endif()
+
+foreach(EXPECTED IN LISTS TIMING)
+    if (NOT EXPECTED MATCHES "^([^:]+):([^=]+)=(.*)$")
+        message(FATAL_ERROR "invalid expected timing ${EXPECTED}")
+    endif()
+    set(PROGRAM ${CMAKE_MATCH_1})
+    set(FIELD ${CMAKE_MATCH_2})
+    set(VALUE ${CMAKE_MATCH_3})
+    string(FIND "${JSON}" "\"name\": \"${PROGRAM}\"," START)
+    if (START LESS 0)
+        message(FATAL_ERROR "no program ${PROGRAM} in the output:\n${JSON}")
+    endif()
+    string(SUBSTRING "${JSON}" ${START} -1 PROGRAM_JSON)
+    if (NOT PROGRAM_JSON MATCHES "\"timing\": {[^}]*\"${FIELD}\": ([^,}]+)")
+        message(FATAL_ERROR "no timing ${FIELD} for program ${PROGRAM} in the output:\n${JSON}")
+    endif()
+    if (NOT CMAKE_MATCH_1 STREQUAL VALUE)
+        message(FATAL_ERROR "program ${PROGRAM} has timing ${FIELD} ${CMAKE_MATCH_1}; expected ${VALUE}")
+    endif()
+endforeach()
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2025 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <iostream>
+#include "output_format.h"
+#include "pio_analyzer.h"
+
+struct timing_output : public output_format {
+    struct factory {
+        factory() {
+            output_format::add(new timing_output());
+        }
+    };
+
+    timing_output() : output_format("timing") {}
+
+    std::string get_description() override {
+        return "Static timing and throughput of each program's loop (use -p sysclk=<MHz> to set the system clock)";
+    }
+
+    int output(std::string destination, std::vector<std::string> output_options,
+               const compiled_source &source) override {
+        FILE *out = open_single_output(destination);
+        if (!out) return 1;
+
+        for (const auto &program : source.programs) {
+            pio_timing timing = analyze_timing(program);
+            fprintf(out, "%s", timing_description(program, timing, sys_clock_hz_option(output_options, program)).c_str());
+        }
+        if (out != stdout) { fclose(out); }
+        return 0;
+    }
+};
+
+static timing_output::factory creator;